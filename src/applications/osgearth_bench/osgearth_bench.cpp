@@ -0,0 +1,586 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+* Copyright 2020 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#define LC "[osgearth_bench] "
+
+#include <osgEarth/Notify>
+#include <osgEarth/Feature>
+#include <osgEarth/FilterContext>
+#include <osgEarth/ExtrudeGeometryFilter>
+#include <osgEarth/ExtrusionSymbol>
+#include <osgEarth/GeometryCompiler>
+#include <osgEarth/PolygonSymbol>
+#include <osgEarth/Memory>
+#include <osgEarth/URI>
+#include <osgEarth/Viewshed>
+#include <osg/ArgumentParser>
+#include <osg/NodeVisitor>
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/Timer>
+#include <osgDB/FileUtils>
+#include <osgDB/FileNameUtils>
+#include <osgDB/Registry>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+// documentation
+int usage(char** argv)
+{
+    std::cout
+        << "Runs performance benchmarks on osgEarth components.\n\n"
+        << argv[0]
+        << "\n    --extrude                           : extrude synthetic building footprints"
+        << "\n    --count [n]                         : number of footprints (default = 50000)"
+        << "\n    --threads [n]                       : worker threads for the parallel runs"
+        << "\n                                          (default = number of cores)"
+        << "\n    --runs [n]                          : average each timing over [n] runs (default = 3)"
+        << "\n"
+        << "\n    --compile                           : compile synthetic footprints with and without arenas"
+        << "\n    --count [n]                         : number of footprints (default = 50000)"
+        << "\n    --extruded                          : extrude the footprints instead of draping them"
+        << "\n    --threads [n]                       : worker threads for the parallel runs"
+        << "\n    --runs [n]                          : average each timing over [n] runs (default = 3)"
+        << "\n"
+        << "\n    --gltf [path] ...                   : decode b3dm/glb files (or folders of them)"
+        << "\n    --copy-buffers                      : use the copying glTF load path for comparison"
+        << "\n    --runs [n]                          : number of passes over the files (default = 3)"
+        << "\n"
+        << "\n    --viewshed                          : viewshed analysis on synthetic fractal terrain"
+        << "\n    --size [n]                          : grid cells per side (default = 1025)"
+        << "\n    --threads [n]                       : worker threads for the parallel runs"
+        << "\n    --runs [n]                          : average each timing over [n] runs (default = 3)"
+        << std::endl;
+
+    return 0;
+}
+
+// Counts drawables, vertices, and triangles in a graph.
+struct StatsVisitor : public osg::NodeVisitor
+{
+    unsigned _drawables, _verts, _tris;
+
+    StatsVisitor() : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN), _drawables(0), _verts(0), _tris(0) { }
+
+    void apply(osg::Drawable& drawable)
+    {
+        osg::Geometry* geom = drawable.asGeometry();
+        if (geom)
+        {
+            ++_drawables;
+            if (geom->getVertexArray())
+                _verts += geom->getVertexArray()->getNumElements();
+            for (unsigned i = 0; i < geom->getNumPrimitiveSets(); ++i)
+            {
+                const osg::PrimitiveSet* p = geom->getPrimitiveSet(i);
+                if (p->getMode() == GL_TRIANGLES)
+                    _tris += p->getNumIndices() / 3;
+            }
+        }
+    }
+};
+
+//..........................................................................
+// Extrusion
+
+// Builds a city block grid of rectangular and L-shaped footprints with
+// a random "height" attribute, in meters on a flat, non-georeferenced plane.
+void createFootprints(unsigned count, FeatureList& output)
+{
+    unsigned dim = (unsigned)ceil(sqrt((double)count));
+    const double spacing = 40.0;
+
+    srand(1234);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        double x0 = (double)(i % dim) * spacing;
+        double y0 = (double)(i / dim) * spacing;
+        double w = 10.0 + (double)(rand() % 20);
+        double h = 10.0 + (double)(rand() % 20);
+
+        Polygon* poly = new Polygon();
+        if (i % 3 == 0)
+        {
+            // L-shape
+            poly->push_back(osg::Vec3d(x0, y0, 0));
+            poly->push_back(osg::Vec3d(x0 + w, y0, 0));
+            poly->push_back(osg::Vec3d(x0 + w, y0 + h * 0.5, 0));
+            poly->push_back(osg::Vec3d(x0 + w * 0.5, y0 + h * 0.5, 0));
+            poly->push_back(osg::Vec3d(x0 + w * 0.5, y0 + h, 0));
+            poly->push_back(osg::Vec3d(x0, y0 + h, 0));
+        }
+        else
+        {
+            poly->push_back(osg::Vec3d(x0, y0, 0));
+            poly->push_back(osg::Vec3d(x0 + w, y0, 0));
+            poly->push_back(osg::Vec3d(x0 + w, y0 + h, 0));
+            poly->push_back(osg::Vec3d(x0, y0 + h, 0));
+        }
+
+        Feature* feature = new Feature(poly, 0L, Style(), i);
+        feature->set("height", 5.0 + (double)(rand() % 100));
+        output.push_back(feature);
+    }
+}
+
+// Time (ms) to extrude a copy of the footprints with the given thread count
+double timeExtrude(const FeatureList& footprints, const Style& style, unsigned numThreads, StatsVisitor& stats)
+{
+    // extrusion modifies the input geometry, so work on a copy.
+    FeatureList features;
+    for (FeatureList::const_iterator i = footprints.begin(); i != footprints.end(); ++i)
+        features.push_back(new Feature(*i->get()));
+
+    FilterContext cx;
+    ExtrudeGeometryFilter extrude;
+    extrude.setStyle(style);
+    extrude.setNumThreads(numThreads);
+
+    osg::Timer_t start = osg::Timer::instance()->tick();
+    osg::ref_ptr<osg::Node> node = extrude.push(features, cx);
+    double ms = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+    stats._drawables = stats._verts = stats._tris = 0;
+    if (node.valid())
+        node->accept(stats);
+
+    return ms;
+}
+
+int benchExtrude(osg::ArgumentParser& args)
+{
+    unsigned count = 50000;
+    args.read("--count", count);
+
+    unsigned threads = std::thread::hardware_concurrency();
+    args.read("--threads", threads);
+    if (threads == 0) threads = 1;
+
+    unsigned runs = 3;
+    args.read("--runs", runs);
+    if (runs == 0) runs = 1;
+
+    FeatureList footprints;
+    createFootprints(count, footprints);
+
+    Style style;
+    ExtrusionSymbol* extrusion = style.getOrCreate<ExtrusionSymbol>();
+    extrusion->heightExpression() = NumericExpression("[height]");
+    extrusion->flatten() = true;
+    style.getOrCreate<PolygonSymbol>()->fill()->color() = Color(Color::White, 0.9f);
+
+    std::cout << "Extruding " << count << " footprints, " << runs << " run(s) each" << std::endl;
+    std::cout
+        << std::setw(10) << "threads"
+        << std::setw(12) << "ms"
+        << std::setw(10) << "speedup"
+        << std::setw(12) << "drawables"
+        << std::setw(12) << "verts"
+        << std::setw(12) << "tris" << std::endl;
+
+    double serialMS = 0.0;
+
+    // serial, then powers of two up to (and including) the requested count
+    std::vector<unsigned> threadCounts;
+    threadCounts.push_back(0);
+    for (unsigned t = 1; t < threads; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(threads);
+
+    for (unsigned i = 0; i < threadCounts.size(); ++i)
+    {
+        unsigned t = threadCounts[i];
+
+        StatsVisitor stats;
+        double total = 0.0;
+        for (unsigned r = 0; r < runs; ++r)
+            total += timeExtrude(footprints, style, t, stats);
+        double ms = total / (double)runs;
+
+        if (t == 0)
+            serialMS = ms;
+
+        std::cout
+            << std::setw(10) << (t == 0 ? std::string("serial") : std::to_string(t))
+            << std::setw(12) << std::fixed << std::setprecision(1) << ms
+            << std::setw(10) << std::setprecision(2) << (ms > 0.0 ? serialMS / ms : 0.0)
+            << std::setw(12) << stats._drawables
+            << std::setw(12) << stats._verts
+            << std::setw(12) << stats._tris << std::endl;
+    }
+
+    return 0;
+}
+
+//..........................................................................
+// Geometry compilation
+
+// Time (ms) to compile a copy of the footprints through the GeometryCompiler
+double timeCompile(const FeatureList& footprints, const Style& style, bool arenas, unsigned numThreads, StatsVisitor& stats)
+{
+    FeatureList features;
+    for (FeatureList::const_iterator i = footprints.begin(); i != footprints.end(); ++i)
+        features.push_back(new Feature(*i->get()));
+
+    GeometryCompilerOptions options;
+    options.arenaAllocation() = arenas;
+    options.tessellationThreads() = numThreads;
+    if (numThreads > 0)
+        options.extrusionThreads() = numThreads;
+    GeometryCompiler compiler(options);
+
+    osg::Timer_t start = osg::Timer::instance()->tick();
+    osg::ref_ptr<osg::Node> node = compiler.compile(features, style, FilterContext());
+    double ms = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+    stats._drawables = stats._verts = stats._tris = 0;
+    if (node.valid())
+        node->accept(stats);
+
+    return ms;
+}
+
+int benchCompile(osg::ArgumentParser& args)
+{
+    unsigned count = 50000;
+    args.read("--count", count);
+
+    bool extruded = args.read("--extruded");
+
+    unsigned threads = std::thread::hardware_concurrency();
+    args.read("--threads", threads);
+    if (threads == 0) threads = 1;
+
+    unsigned runs = 3;
+    args.read("--runs", runs);
+    if (runs == 0) runs = 1;
+
+    FeatureList footprints;
+    createFootprints(count, footprints);
+
+    Style style;
+    style.getOrCreate<PolygonSymbol>()->fill()->color() = Color(Color::White, 0.9f);
+    if (extruded)
+    {
+        ExtrusionSymbol* extrusion = style.getOrCreate<ExtrusionSymbol>();
+        extrusion->heightExpression() = NumericExpression("[height]");
+        extrusion->flatten() = true;
+    }
+
+    std::cout << "Compiling " << count << (extruded ? " extruded" : " draped")
+        << " footprints, " << runs << " run(s) each" << std::endl;
+    std::cout
+        << std::setw(10) << "mode"
+        << std::setw(10) << "threads"
+        << std::setw(12) << "ms"
+        << std::setw(10) << "speedup"
+        << std::setw(12) << "drawables"
+        << std::setw(12) << "verts"
+        << std::setw(12) << "tris" << std::endl;
+
+    double baselineMS = 0.0;
+
+    // per-feature geometry (the baseline), then arenas, serial and threaded
+    struct Run { bool arenas; unsigned threads; };
+    Run configs[3] = { { false, 0u }, { true, 0u }, { true, threads } };
+
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        const Run& run = configs[i];
+
+        StatsVisitor stats;
+        double total = 0.0;
+        for (unsigned r = 0; r < runs; ++r)
+            total += timeCompile(footprints, style, run.arenas, run.threads, stats);
+        double ms = total / (double)runs;
+
+        if (i == 0)
+            baselineMS = ms;
+
+        std::cout
+            << std::setw(10) << (run.arenas ? "arena" : "feature")
+            << std::setw(10) << (run.threads == 0 ? std::string("serial") : std::to_string(run.threads))
+            << std::setw(12) << std::fixed << std::setprecision(1) << ms
+            << std::setw(10) << std::setprecision(2) << (ms > 0.0 ? baselineMS / ms : 0.0)
+            << std::setw(12) << stats._drawables
+            << std::setw(12) << stats._verts
+            << std::setw(12) << stats._tris << std::endl;
+    }
+
+    return 0;
+}
+
+//..........................................................................
+// glTF / 3D Tiles ingest
+
+// Recursively collects the b3dm and glb files under a path.
+void findModelFiles(const std::string& path, std::vector<std::string>& output)
+{
+    if (osgDB::fileType(path) == osgDB::DIRECTORY)
+    {
+        osgDB::DirectoryContents files = osgDB::getDirectoryContents(path);
+        for (osgDB::DirectoryContents::const_iterator f = files.begin(); f != files.end(); ++f)
+        {
+            if (*f != "." && *f != "..")
+                findModelFiles(osgDB::concatPaths(path, *f), output);
+        }
+    }
+    else
+    {
+        std::string ext = osgDB::getLowerCaseFileExtension(path);
+        if (ext == "b3dm" || ext == "glb")
+            output.push_back(path);
+    }
+}
+
+int benchGLTF(osg::ArgumentParser& args)
+{
+    unsigned runs = 3;
+    args.read("--runs", runs);
+    if (runs == 0) runs = 1;
+
+    bool copyBuffers = args.read("--copy-buffers");
+
+    std::vector<std::string> files;
+    for (int i = 1; i < args.argc(); ++i)
+    {
+        if (!args.isOption(i))
+            findModelFiles(args[i], files);
+    }
+
+    if (files.empty())
+    {
+        std::cout << "No b3dm or glb files found" << std::endl;
+        return -1;
+    }
+
+    osgDB::ReaderWriter* rw = osgDB::Registry::instance()->getReaderWriterForExtension("gltf");
+    if (!rw)
+    {
+        std::cout << "The gltf plugin is not available" << std::endl;
+        return -1;
+    }
+
+    // Load everything into memory up front so the timings exclude disk I/O.
+    std::vector<std::string> buffers(files.size());
+    size_t totalBytes = 0;
+    for (unsigned i = 0; i < files.size(); ++i)
+    {
+        std::ifstream in(files[i].c_str(), std::ios::binary);
+        buffers[i].assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        totalBytes += buffers[i].size();
+    }
+
+    std::cout << "Decoding " << files.size() << " files ("
+        << std::fixed << std::setprecision(1) << (double)totalBytes / 1048576.0 << " MB), "
+        << runs << " run(s), " << (copyBuffers ? "copying" : "aliasing") << " buffers" << std::endl;
+    std::cout
+        << std::setw(10) << "run"
+        << std::setw(12) << "ms"
+        << std::setw(12) << "MB/s"
+        << std::setw(12) << "files/s"
+        << std::setw(12) << "failed"
+        << std::setw(12) << "verts"
+        << std::setw(12) << "tris" << std::endl;
+
+    for (unsigned r = 0; r < runs; ++r)
+    {
+        StatsVisitor stats;
+        unsigned failed = 0;
+        double ms = 0.0;
+
+        for (unsigned i = 0; i < files.size(); ++i)
+        {
+            osg::ref_ptr<osgDB::Options> options = new osgDB::Options(copyBuffers ? "gltfCopyBuffers" : "");
+            URIContext(files[i]).store(options.get());
+
+            std::istringstream in(buffers[i]);
+
+            osg::Timer_t start = osg::Timer::instance()->tick();
+            osgDB::ReaderWriter::ReadResult rr = rw->readNode(in, options.get());
+            ms += osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+            if (rr.validNode())
+                rr.getNode()->accept(stats);
+            else
+                ++failed;
+        }
+
+        double seconds = ms / 1000.0;
+        std::cout
+            << std::setw(10) << (r + 1)
+            << std::setw(12) << std::setprecision(1) << ms
+            << std::setw(12) << (seconds > 0.0 ? (double)totalBytes / 1048576.0 / seconds : 0.0)
+            << std::setw(12) << (seconds > 0.0 ? (double)files.size() / seconds : 0.0)
+            << std::setw(12) << failed
+            << std::setw(12) << stats._verts
+            << std::setw(12) << stats._tris << std::endl;
+    }
+
+    std::cout << "Peak memory: "
+        << std::setprecision(1) << (double)Memory::getProcessPeakPhysicalUsage() / 1048576.0 << " MB" << std::endl;
+
+    return 0;
+}
+
+//..........................................................................
+// Viewshed
+
+// Fills a (2^n + 1) square grid with diamond-square fractal terrain,
+// in meters, with a relief of a few hundred meters.
+void createFractalTerrain(unsigned size, std::vector<float>& heights)
+{
+    heights.assign(size*size, 0.0f);
+    srand(1234);
+
+    auto random = [](double scale) { return scale * ((double)rand() / (double)RAND_MAX - 0.5); };
+    auto at = [&](unsigned c, unsigned r) -> float& { return heights[r*size + c]; };
+
+    double scale = 800.0;
+    for (unsigned step = size - 1; step > 1; step /= 2, scale *= 0.55)
+    {
+        unsigned h = step / 2;
+
+        // diamond step
+        for (unsigned r = h; r < size; r += step)
+            for (unsigned c = h; c < size; c += step)
+                at(c, r) = (float)(0.25 * (at(c - h, r - h) + at(c + h, r - h) + at(c - h, r + h) + at(c + h, r + h)) + random(scale));
+
+        // square step
+        for (unsigned r = 0; r < size; r += h)
+        {
+            for (unsigned c = (r / h) % 2 == 0 ? h : 0; c < size; c += step)
+            {
+                double sum = 0.0;
+                unsigned n = 0;
+                if (c >= h) sum += at(c - h, r), ++n;
+                if (c + h < size) sum += at(c + h, r), ++n;
+                if (r >= h) sum += at(c, r - h), ++n;
+                if (r + h < size) sum += at(c, r + h), ++n;
+                at(c, r) = (float)(sum / (double)n + random(scale));
+            }
+        }
+    }
+}
+
+int benchViewshed(osg::ArgumentParser& args)
+{
+    unsigned size = 1025;
+    args.read("--size", size);
+
+    // diamond-square wants 2^n + 1 cells per side
+    unsigned pot = 2;
+    while (pot + 1 < size) pot *= 2;
+    size = pot + 1;
+
+    unsigned threads = std::thread::hardware_concurrency();
+    args.read("--threads", threads);
+    if (threads == 0) threads = 1;
+
+    unsigned runs = 3;
+    args.read("--runs", runs);
+    if (runs == 0) runs = 1;
+
+    const double cellSize = 30.0;
+
+    std::vector<float> heights;
+    createFractalTerrain(size, heights);
+
+    std::cout << "Viewshed on " << size << "x" << size << " cells of "
+        << cellSize << "m, " << runs << " run(s) each" << std::endl;
+    std::cout
+        << std::setw(10) << "threads"
+        << std::setw(12) << "ms"
+        << std::setw(10) << "speedup"
+        << std::setw(14) << "Mcells/s"
+        << std::setw(12) << "visible" << std::endl;
+
+    double serialMS = 0.0;
+
+    std::vector<unsigned> threadCounts;
+    for (unsigned t = 1; t < threads; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(threads);
+
+    for (unsigned i = 0; i < threadCounts.size(); ++i)
+    {
+        unsigned t = threadCounts[i];
+
+        Viewshed viewshed;
+        viewshed.setNumThreads(t);
+        viewshed.setObserverHeight(10.0);
+
+        double total = 0.0;
+        for (unsigned r = 0; r < runs; ++r)
+        {
+            osg::Timer_t start = osg::Timer::instance()->tick();
+            viewshed.run(heights, size, cellSize);
+            total += osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+        }
+        double ms = total / (double)runs;
+
+        if (i == 0)
+            serialMS = ms;
+
+        std::cout
+            << std::setw(10) << t
+            << std::setw(12) << std::fixed << std::setprecision(1) << ms
+            << std::setw(10) << std::setprecision(2) << (ms > 0.0 ? serialMS / ms : 0.0)
+            << std::setw(14) << (ms > 0.0 ? (double)(size*size) / (ms * 1000.0) : 0.0)
+            << std::setw(11) << std::setprecision(1)
+            << 100.0 * (double)viewshed.getNumVisible() / (double)(size*size) << "%" << std::endl;
+    }
+
+    return 0;
+}
+
+//..........................................................................
+
+int
+main(int argc, char** argv)
+{
+    osg::ArgumentParser args(&argc, argv);
+
+    if (args.read("--help") || argc < 2)
+        return usage(argv);
+
+    if (args.read("--extrude"))
+        return benchExtrude(args);
+
+    if (args.read("--compile"))
+        return benchCompile(args);
+
+    if (args.read("--gltf"))
+        return benchGLTF(args);
+
+    if (args.read("--viewshed"))
+        return benchViewshed(args);
+
+    return usage(argv);
+}
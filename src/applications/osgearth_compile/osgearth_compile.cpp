@@ -0,0 +1,201 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+* Copyright 2020 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#define LC "[osgearth_compile] "
+
+#include <osgEarth/Notify>
+#include <osgEarth/Config>
+#include <osgEarth/XmlUtils>
+#include <osgEarth/MapNode>
+#include <osgEarth/FileUtils>
+#include <osgEarth/StringUtils>
+#include <osgDB/ReadFile>
+#include <osgDB/FileNameUtils>
+#include <osg/ArgumentParser>
+#include <osg/Timer>
+#include <fstream>
+#include <iomanip>
+#include <set>
+
+using namespace osgEarth;
+
+// documentation
+int usage(char** argv)
+{
+    std::cout
+        << "Compiles an earth file into the compact binary format (.earthb) for fast loading.\n"
+        << "The earth plugin will automatically use a .earthb file that sits next to the\n"
+        << ".earth file you load, as long as none of the files it was compiled from\n"
+        << "(the earth file and its includes) has changed since.\n\n"
+        << argv[0] << " file.earth"
+        << "\n    --out [filename]                    : output file (default = file.earthb)"
+        << "\n    --benchmark [count]                 : time MapNode creation from the XML and"
+        << "\n                                          compiled versions, averaged over [count] runs"
+        << std::endl;
+
+    return 0;
+}
+
+// Collects the local files a document was read from: the document itself
+// and everything it includes.
+void collectSourceFiles(const Config& conf, std::set<std::string>& output)
+{
+    if (!conf.referrer().empty() && !osgDB::containsServerAddress(conf.referrer()))
+        output.insert(conf.referrer());
+
+    for (ConfigSet::const_iterator i = conf.children().begin(); i != conf.children().end(); ++i)
+        collectSourceFiles(*i, output);
+}
+
+// Time (ms) to parse the document alone, without building a map
+double timeParse(const std::string& filename, bool compiled)
+{
+    osg::Timer_t start = osg::Timer::instance()->tick();
+    if (compiled)
+    {
+        Config conf;
+        conf.fromBinaryFile(filename);
+    }
+    else
+    {
+        osg::ref_ptr<XmlDocument> doc = XmlDocument::load(filename);
+        if (doc.valid())
+            doc->getConfig();
+    }
+    return osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+}
+
+// Time (ms) to create a MapNode from the file
+double timeMapNode(const std::string& filename, const osgDB::Options* options)
+{
+    osg::Timer_t start = osg::Timer::instance()->tick();
+    osg::ref_ptr<osg::Node> node = osgDB::readNodeFile(filename, options);
+    double ms = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+    if (!MapNode::get(node.get()))
+    {
+        OE_WARN << LC << "Failed to create a MapNode from " << filename << std::endl;
+        return -1.0;
+    }
+    return ms;
+}
+
+int benchmark(const std::string& earthFile, const std::string& compiledFile, int count)
+{
+    // make sure the XML runs don't pick up the compiled file:
+    osg::ref_ptr<osgDB::Options> xmlOptions = new osgDB::Options("IgnoreCompiled");
+
+    double parseXML = 0.0, parseCompiled = 0.0;
+    double mapXML = 0.0, mapCompiled = 0.0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        parseXML += timeParse(earthFile, false);
+        parseCompiled += timeParse(compiledFile, true);
+
+        double t;
+        if ((t = timeMapNode(earthFile, xmlOptions.get())) < 0.0) return -1;
+        mapXML += t;
+        if ((t = timeMapNode(compiledFile, 0L)) < 0.0) return -1;
+        mapCompiled += t;
+    }
+
+    std::cout
+        << std::fixed << std::setprecision(2)
+        << "Averages over " << count << " runs (ms):\n"
+        << "                    XML    compiled\n"
+        << "    parse     " << std::setw(10) << parseXML/count << std::setw(12) << parseCompiled/count << "\n"
+        << "    MapNode   " << std::setw(10) << mapXML/count << std::setw(12) << mapCompiled/count
+        << std::endl;
+
+    return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+    osg::ArgumentParser args(&argc,argv);
+
+    if ( argc == 1 || args.read("--help") )
+        return usage(argv);
+
+    std::string outFile;
+    args.read("--out", outFile);
+
+    int count = 0;
+    args.read("--benchmark", count);
+
+    std::string inFile;
+    for (int pos = 1; pos < args.argc() && inFile.empty(); ++pos)
+    {
+        if (!args.isOption(pos))
+            inFile = args[pos];
+    }
+
+    if (inFile.empty())
+        return usage(argv);
+
+    if (outFile.empty())
+        outFile = osgDB::getNameLessExtension(inFile) + ".earthb";
+
+    // Parse the XML. This resolves any includes.
+    inFile = osgEarth::getAbsolutePath(inFile);
+    osg::ref_ptr<XmlDocument> doc = XmlDocument::load(inFile);
+    if (!doc.valid())
+    {
+        OE_WARN << LC << "Failed to read " << inFile << std::endl;
+        return -1;
+    }
+
+    Config docConf = doc->getConfig();
+
+    // Record every file the document came from, relative to the earth file,
+    // with its modification time; the earth plugin only uses the compiled
+    // file while all of them are unchanged.
+    std::set<std::string> sources;
+    collectSourceFiles(docConf, sources);
+
+    Config dependencies("dependencies");
+    for (std::set<std::string>::const_iterator i = sources.begin(); i != sources.end(); ++i)
+    {
+        Config file("file");
+        file.set("path", osgDB::getPathRelative(osgDB::getFilePath(inFile), *i));
+        file.set("modified", std::string(Stringify() << osgEarth::getLastModifiedTime(*i)));
+        dependencies.add(file);
+    }
+    docConf.add(dependencies);
+
+    std::ofstream out(outFile.c_str(), std::ios::out | std::ios::binary);
+    if (!out.is_open() || !docConf.toBinary(out))
+    {
+        OE_WARN << LC << "Failed to write " << outFile << std::endl;
+        return -1;
+    }
+    out.close();
+
+    std::cout << "Wrote " << outFile << std::endl;
+
+    if (count > 0)
+    {
+        return benchmark(inFile, outFile, count);
+    }
+
+    return 0;
+}
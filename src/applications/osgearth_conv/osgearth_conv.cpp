@@ -28,6 +28,7 @@
 #include <osgEarth/TileVisitor>
 #include <osgEarth/ImageLayer>
 #include <osgEarth/ElevationLayer>
+#include <osgEarth/ImageUtils>
 #include <osg/ArgumentParser>
 #include <osg/Timer>
 #include <iomanip>
@@ -50,6 +51,11 @@ int usage(char** argv)
         << "\n    --osg-options [OSG options string]  : options to pass to OSG readers/writers"
         << "\n    --extents [minLat] [minLong] [maxLat] [maxLong] : Lat/Long extends to copy"
         << "\n    --no-overwrite                      : skip tiles that already exist in the destination"
+        << "\n    --compress [method]                 : mipmap and compress image tiles before writing, e.g. bc1, bc3:best, bc7:kaiser"
+        << "\n                                          (the output format must support compressed images, e.g. dds)"
+        << "\n    --threads [int]                     : number of threads to use"
+        << "\n    --order [quadtree|morton|hilbert]   : order in which to visit tiles (default = quadtree)"
+        << "\n    --batch-size [int]                  : tiles per task when using threads (default = 16)"
         << std::endl;
 
     return 0;
@@ -58,8 +64,8 @@ int usage(char** argv)
 
 struct ImageLayerTileCopy : public TileHandler
 {
-    ImageLayerTileCopy(ImageLayer* source, ImageLayer* dest, bool overwrite)
-        : _source(source), _dest(dest), _overwrite(overwrite)
+    ImageLayerTileCopy(ImageLayer* source, ImageLayer* dest, bool overwrite, const std::string& compression)
+        : _source(source), _dest(dest), _overwrite(overwrite), _compression(compression)
     {
         //nop
     }
@@ -81,7 +87,13 @@ struct ImageLayerTileCopy : public TileHandler
         GeoImage image = _source->createImage(key);
         if (image.valid())
         {
-            Status status = _dest->writeImage(key, image.getImage(), 0L);
+            osg::ref_ptr<const osg::Image> output = image.getImage();
+            if (!_compression.empty())
+            {
+                output = ImageUtils::compressImage(output.get(), _compression);
+            }
+
+            Status status = _dest->writeImage(key, output.get(), 0L);
             ok = status.isOK();
             if (!ok)
             {
@@ -100,6 +112,7 @@ struct ImageLayerTileCopy : public TileHandler
     osg::ref_ptr<ImageLayer> _source;
     osg::ref_ptr<ImageLayer> _dest;
     bool _overwrite;
+    std::string _compression;
 };
 
 
@@ -231,6 +244,13 @@ struct ProgressReporter : public osgEarth::ProgressCallback
  *      --max-level [int]     : max level of detail to copy
  *      --extents [minLat] [minLong] [maxLat] [maxLong] : Lat/Long extends to copy (*)
  *      --no-overwrite        : don't overwrite data that already exists
+ *      --compress [method]   : mipmap and block-compress image tiles before writing,
+ *                              e.g. "bc1", "bc3:best", "bc7:kaiser" (see TexturePipeline)
+ *      --threads [int]       : number of threads to use
+ *      --order [order]       : "quadtree" (default), "morton" or "hilbert"; the curve
+ *                              orders copy one level at a time along a space-filling
+ *                              curve so that consecutive reads are spatial neighbors
+ *      --batch-size [int]    : consecutive tiles per task when using threads
  *
  * OSG arguments:
  *
@@ -360,10 +380,16 @@ main(int argc, char** argv)
     osg::ref_ptr<TileVisitor> visitor;
 
     unsigned numThreads = 1;
+    MultithreadedTileVisitor* mtv = 0L;
     if (args.read("--threads", numThreads))
     {
-        MultithreadedTileVisitor* mtv = new MultithreadedTileVisitor();
+        mtv = new MultithreadedTileVisitor();
         mtv->setNumThreads( numThreads < 1 ? 1 : numThreads );
+
+        unsigned batchSize = 0;
+        if (args.read("--batch-size", batchSize))
+            mtv->setBatchSize( batchSize );
+
         visitor = mtv;
     }
     else
@@ -371,16 +397,33 @@ main(int argc, char** argv)
         visitor = new TileVisitor();
     }
 
+    std::string order;
+    if (args.read("--order", order))
+    {
+        if (order == "hilbert")
+            visitor->setTileOrder( TileVisitor::ORDER_HILBERT );
+        else if (order == "morton" || order == "zorder")
+            visitor->setTileOrder( TileVisitor::ORDER_MORTON );
+        else if (order == "quadtree")
+            visitor->setTileOrder( TileVisitor::ORDER_QUADTREE );
+        else
+            OE_WARN << LC << "Unknown tile order \"" << order << "\"; using quadtree" << std::endl;
+    }
+
     bool overwrite = true;
     if (args.read("--no-overwrite"))
         overwrite = false;
 
+    std::string compression;
+    args.read("--compress", compression);
+
     if (dynamic_cast<ImageLayer*>(input.get()) && dynamic_cast<ImageLayer*>(output.get()))
     {
         visitor->setTileHandler(new ImageLayerTileCopy(
             dynamic_cast<ImageLayer*>(input.get()),
             dynamic_cast<ImageLayer*>(output.get()),
-            overwrite));
+            overwrite,
+            compression));
     }
     else if (dynamic_cast<ElevationLayer*>(input.get()) && dynamic_cast<ElevationLayer*>(output.get()))
     {
@@ -457,5 +500,20 @@ main(int argc, char** argv)
         << osg::Timer::instance()->delta_s(t0, t1)
         << " seconds." << std::endl;
 
+    if (mtv)
+    {
+        std::vector<MultithreadedTileVisitor::WorkerStats> stats = mtv->getWorkerStats();
+        for (unsigned i = 0; i < stats.size(); ++i)
+        {
+            std::cout
+                << "Worker " << i
+                << ": tiles = " << stats[i].numTiles
+                << ", tasks = " << stats[i].numBatches
+                << ", adjacent = " << std::setprecision(1) << (100.0 * stats[i].getAdjacency()) << "%"
+                << ", mean step = " << std::setprecision(2) << stats[i].getMeanDistance() << " tiles"
+                << std::endl;
+        }
+    }
+
     return 0;
 }
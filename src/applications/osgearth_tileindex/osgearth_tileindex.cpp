@@ -41,6 +41,9 @@ int main(int argc, char** argv)
     std::string indexFilename = "index.shp";
     while (arguments.read("--index", indexFilename));
 
+    unsigned numThreads = 0;
+    arguments.read("--threads", numThreads);
+
     OE_NOTICE << "index name = " << indexFilename << std::endl;
 
     std::vector< std::string > filenames;
@@ -71,6 +74,8 @@ int main(int argc, char** argv)
 
     TileIndexBuilder builder;
     builder.setProgressCallback( new ConsoleProgressCallback() );
+    if (numThreads > 0)
+        builder.setNumThreads( numThreads );
     for (unsigned int i = 0; i < filenames.size(); i++)
     {
         builder.getFilenames().push_back( filenames[i] );
@@ -34,6 +34,7 @@
 #include <osgEarth/PointDrawable>
 #include <osgEarth/StateSetCache>
 #include <osgEarth/Registry>
+#include <osgEarth/Threading>
 #include <osg/Geode>
 #include <osg/Geometry>
 #include <osg/LineStipple>
@@ -46,6 +47,8 @@
 #include <osgUtil/Simplifier>
 #include <osgDB/WriteFile>
 #include <osg/Version>
+#include <atomic>
+#include <functional>
 #include <iterator>
 
 #define LC "[BuildGeometryFilter] "
@@ -53,6 +56,7 @@
 #define OE_TEST OE_NULL
 
 using namespace osgEarth;
+using namespace osgEarth::Threading;
 
 namespace
 {
@@ -90,6 +94,121 @@ namespace
 
         return false;
     }
+
+    struct CollectTriangles
+    {
+        std::vector<GLuint>* _indices;
+        CollectTriangles() : _indices(0L) { }
+        void operator()(unsigned i1, unsigned i2, unsigned i3)
+        {
+            _indices->push_back(i1);
+            _indices->push_back(i2);
+            _indices->push_back(i3);
+        }
+    };
+
+    // Tessellates the rings stored back to back in verts, starting at
+    // "first", with the GLU tessellator. Used for polygons the triangulator
+    // rejects; any vertices it adds at self-intersections are appended.
+    bool tessellateRings(osg::Vec3Array* verts, unsigned first, const std::vector<unsigned>& ringSizes, std::vector<GLuint>& indices)
+    {
+        osg::ref_ptr<osg::Geometry> temp = new osg::Geometry();
+        temp->setVertexArray( new osg::Vec3Array(verts->begin() + first, verts->end()) );
+
+        unsigned start = 0u;
+        for(unsigned r = 0; r < ringSizes.size(); ++r)
+        {
+            if ( ringSizes[r] >= 3u )
+                temp->addPrimitiveSet( new osg::DrawArrays(GL_LINE_LOOP, start, ringSizes[r]) );
+            start += ringSizes[r];
+        }
+
+        if ( temp->getNumPrimitiveSets() == 0u )
+            return false;
+
+        osgUtil::Tessellator tess;
+        tess.setTessellationType( osgUtil::Tessellator::TESS_TYPE_GEOMETRY );
+        tess.setWindingType( osgUtil::Tessellator::TESS_WINDING_ODD );
+        tess.retessellatePolygons( *temp );
+
+        std::vector<GLuint> triangles;
+        osg::TriangleIndexFunctor<CollectTriangles> collect;
+        collect._indices = &triangles;
+        temp->accept( collect );
+
+        const osg::Vec3Array* tessVerts = dynamic_cast<const osg::Vec3Array*>(temp->getVertexArray());
+        if ( triangles.empty() || !tessVerts )
+            return false;
+
+        verts->resize( first );
+        verts->insert( verts->end(), tessVerts->begin(), tessVerts->end() );
+
+        indices.reserve( indices.size() + triangles.size() );
+        for(std::vector<GLuint>::const_iterator i = triangles.begin(); i != triangles.end(); ++i)
+            indices.push_back( first + *i );
+
+        return true;
+    }
+
+    // Vertex data for a run of polygon parts that share one drawable.
+    // Indices are GL_TRIANGLES into verts.
+    struct PolygonArena
+    {
+        osg::ref_ptr<osg::Vec3Array> verts;
+        osg::ref_ptr<osg::Vec3Array> normals;
+        osg::ref_ptr<osg::Vec4Array> colors;
+        std::vector<GLuint> indices;
+
+        unsigned size() const { return verts.valid() ? verts->size() : 0u; }
+
+        //! Fills in the colors and normals of the vertices appended since
+        //! firstVert, whose triangles start at firstIndex.
+        void finish(unsigned firstVert, unsigned firstIndex, const osg::Vec4f& color)
+        {
+            colors->resize( verts->size(), color );
+            normals->resize( verts->size(), osg::Vec3(0,0,0) );
+
+            for(unsigned i = firstIndex; i+2 < indices.size(); i += 3)
+            {
+                const osg::Vec3& v1 = (*verts)[indices[i]];
+                const osg::Vec3& v2 = (*verts)[indices[i+1]];
+                const osg::Vec3& v3 = (*verts)[indices[i+2]];
+                osg::Vec3 normal = (v2 - v1) ^ (v3 - v1);
+                normal.normalize();
+                (*normals)[indices[i]] += normal;
+                (*normals)[indices[i+1]] += normal;
+                (*normals)[indices[i+2]] += normal;
+            }
+
+            for(unsigned i = firstVert; i < normals->size(); ++i)
+                (*normals)[i].normalize();
+        }
+    };
+
+    osg::Geometry* createGeometry(const PolygonArena& arena)
+    {
+        osg::Geometry* geom = new osg::Geometry();
+        geom->setUseVertexBufferObjects(true);
+
+        geom->setVertexArray( arena.verts.get() );
+        geom->setNormalArray( arena.normals.get() );
+        geom->setColorArray( arena.colors.get() );
+
+        if ( arena.size() > 0xFFFF )
+        {
+            geom->addPrimitiveSet( new osg::DrawElementsUInt(GL_TRIANGLES, arena.indices.begin(), arena.indices.end()) );
+        }
+        else
+        {
+            osg::DrawElementsUShort* de = new osg::DrawElementsUShort(GL_TRIANGLES);
+            de->reserve( arena.indices.size() );
+            for(std::vector<GLuint>::const_iterator i = arena.indices.begin(); i != arena.indices.end(); ++i)
+                de->push_back( (GLushort)*i );
+            geom->addPrimitiveSet( de );
+        }
+
+        return geom;
+    }
 }
 
 BuildGeometryFilter::BuildGeometryFilter( const Style& style ) :
@@ -98,7 +217,9 @@ _maxAngle_deg ( 180.0 ),
 _geoInterp    ( GEOINTERP_RHUMB_LINE ),
 _maxPolyTilingAngle_deg( 45.0f ),
 _optimizeVertexOrdering( false ),
-_maximumCreaseAngle(Angle(0.0, Units::DEGREES))
+_maximumCreaseAngle(Angle(0.0, Units::DEGREES)),
+_arenaAllocation( false ),
+_numThreads   ( 0u )
 {
     //nop
 }
@@ -121,6 +242,19 @@ BuildGeometryFilter::processPolygons(FeatureList& features, FilterContext& conte
         makeECEF   = context.getOutputSRS()->isGeographic();
     }
 
+    // One polygon part to build. Symbols, scripts and names are resolved
+    // up front because expression evaluation is not thread-safe.
+    struct Job
+    {
+        Feature*                    input;
+        Geometry*                   part;
+        osg::Vec4f                  color;
+        std::string                 name;
+        osg::Matrixd                w2l, l2w;
+        osg::ref_ptr<osg::Geometry> osgGeom;
+    };
+    std::vector<Job> jobs;
+
     for( FeatureList::iterator f = features.begin(); f != features.end(); ++f )
     {
         Feature* input = f->get();
@@ -158,94 +292,345 @@ BuildGeometryFilter::processPolygons(FeatureList& features, FilterContext& conte
                 continue;
             }
 
-            // resolve the color:
-            osg::Vec4f primaryColor = poly->fill()->color();
+            Job job;
+            job.input = input;
+            job.part = part;
 
-            osg::ref_ptr<osg::Geometry> osgGeom = new osg::Geometry();
-            osgGeom->setUseVertexBufferObjects(true);
+            // resolve the color:
+            job.color = poly->fill()->color();
 
             // are we embedding a feature name?
             if ( _featureNameExpr.isSet() )
             {
-                const std::string& name = input->eval( _featureNameExpr.mutable_value(), &context );
-                osgGeom->setName( name );
+                job.name = input->eval( _featureNameExpr.mutable_value(), &context );
             }
 
-
             // compute localizing matrices or use globals
-            osg::Matrixd w2l, l2w;
             if (makeECEF)
             {
                 osgEarth::GeoExtent partExtent(featureSRS, part->getBounds());
-                computeLocalizers(context, partExtent, w2l, l2w);
+                computeLocalizers(context, partExtent, job.w2l, job.l2w);
             }
             else
             {
-                w2l = _world2local;
-                l2w = _local2world;
+                job.w2l = _world2local;
+                job.l2w = _local2world;
             }
 
-            // collect all the pre-transformation HAT (Z) values.
-            osg::ref_ptr<osg::FloatArray> hats = new osg::FloatArray();
-            hats->reserve( part->size() );
-            for(Geometry::const_iterator i = part->begin(); i != part->end(); ++i )
-                hats->push_back( i->z() );
+            jobs.push_back(job);
+        }
+    }
 
-            // build the geometry:
-            tileAndBuildPolygon(part, featureSRS, outputSRS, makeECEF, true, osgGeom.get(), w2l);
+    bool gpuClamping =
+        _style.has<AltitudeSymbol>() &&
+        _style.get<AltitudeSymbol>()->technique() == AltitudeSymbol::TECHNIQUE_GPU;
 
-            osg::Vec3Array* allPoints = static_cast<osg::Vec3Array*>(osgGeom->getVertexArray());
-            if (allPoints && allPoints->size() > 0)
+    // Arena mode: build every part straight into a few drawable-sized arenas
+    // instead of a geometry per part. Anything that needs a drawable per
+    // feature uses the per-part path below.
+    if ( _arenaAllocation == true &&
+         !useOSGTessellator().value() &&
+         !_featureNameExpr.isSet() &&
+         context.featureIndex() == 0L &&
+         !gpuClamping )
+    {
+        if ( jobs.empty() )
+            return geode;
+
+        unsigned maxVerts = Registry::instance()->getMaxNumberOfVertsPerDrawable();
+
+        // Partition the jobs into contiguous ranges of roughly equal vertex
+        // counts, so the partitions' output concatenates in feature order.
+        unsigned numPartitions = osg::maximum( 1u, osg::minimum(_numThreads, (unsigned)jobs.size()) );
+
+        std::vector<unsigned> numPoints( jobs.size() );
+        double totalPoints = 0.0;
+        for(unsigned j = 0; j < jobs.size(); ++j)
+        {
+            numPoints[j] = (unsigned)jobs[j].part->getTotalPointCount();
+            totalPoints += numPoints[j];
+        }
+
+        std::vector<unsigned> partitionStart( numPartitions+1, (unsigned)jobs.size() );
+        partitionStart[0] = 0;
+        {
+            double sum = 0.0;
+            unsigned p = 1;
+            for(unsigned j = 0; j < jobs.size() && p < numPartitions; ++j)
+            {
+                sum += numPoints[j];
+                if ( sum >= totalPoints * (double)p / (double)numPartitions )
+                    partitionStart[p++] = j+1;
+            }
+        }
+
+        // Per-partition output: arenas, each below the vertex limit.
+        typedef std::vector<PolygonArena> Arenas;
+        std::vector<Arenas> output( numPartitions );
+
+        auto buildRange = [&](unsigned p)
+        {
+            Arenas& arenas = output[p];
+            PolygonTriangulator triangulator;
+
+            // estimated number of vertices left, for pre-sizing.
+            unsigned remaining = 0u;
+            for(unsigned j = partitionStart[p]; j < partitionStart[p+1]; ++j)
+                remaining += numPoints[j];
+
+            auto getArena = [&](unsigned numVerts) -> PolygonArena&
             {
-                // subdivide the mesh if necessary to conform to an ECEF globe:
-                if ( makeECEF )
+                if ( arenas.empty() || (arenas.back().size() > 0 && arenas.back().size() + numVerts > maxVerts) )
                 {
-                    //convert back to world coords
-                    for( osg::Vec3Array::iterator i = allPoints->begin(); i != allPoints->end(); ++i )
-                    {
-                        osg::Vec3d v(*i);
-                        v = v * l2w;
-                        v = v * _world2local;
+                    arenas.push_back( PolygonArena() );
+                    PolygonArena& arena = arenas.back();
+                    unsigned reserve = osg::minimum( osg::maximum(remaining, numVerts), maxVerts );
+                    arena.verts = new osg::Vec3Array();
+                    arena.verts->reserve( reserve );
+                    arena.normals = new osg::Vec3Array( osg::Array::BIND_PER_VERTEX );
+                    arena.normals->reserve( reserve );
+                    arena.colors = new osg::Vec4Array( osg::Array::BIND_PER_VERTEX );
+                    arena.colors->reserve( reserve );
+                    arena.indices.reserve( reserve*3 );
+                }
+                remaining -= osg::minimum( remaining, numVerts );
+                return arenas.back();
+            };
 
-                        (*i)._v[0] = v[0];
-                        (*i)._v[1] = v[1];
-                        (*i)._v[2] = v[2];
-                    }
+            // geocentric parts are subdivided on their own before joining an
+            // arena, since the subdivider works on a whole geometry.
+            osg::ref_ptr<osg::Vec3Array> scratchVerts;
+            std::vector<GLuint> scratchIndices;
+
+            for(unsigned j = partitionStart[p]; j < partitionStart[p+1]; ++j)
+            {
+                Job& job = jobs[j];
 
-                    double threshold = osg::DegreesToRadians( *_maxAngle_deg );
-                    //OE_TEST << "Running mesh subdivider with threshold " << *_maxAngle_deg << std::endl;
+                if ( !makeECEF )
+                {
+                    PolygonArena& arena = getArena( numPoints[j] );
+                    unsigned firstVert = arena.verts->size();
+                    unsigned firstIndex = arena.indices.size();
 
-                    MeshSubdivider ms( _world2local, _local2world );
-                    if ( input->geoInterp().isSet() )
-                        ms.run( *osgGeom, threshold, *input->geoInterp() );
+                    triangulatePolygon(job.part, featureSRS, outputSRS, makeECEF, arena.verts.get(), arena.indices, job.w2l, triangulator);
+
+                    if ( arena.indices.size() > firstIndex )
+                        arena.finish( firstVert, firstIndex, job.color );
                     else
-                        ms.run( *osgGeom, threshold, *_geoInterp );
+                        arena.verts->resize( firstVert );
+                    continue;
                 }
 
-                // assign the primary color array. PER_VERTEX required in order to support
-                // vertex optimization later
-                unsigned count = osgGeom->getVertexArray()->getNumElements();
-                osg::Vec4Array* colors = new osg::Vec4Array(osg::Array::BIND_PER_VERTEX);
-                colors->assign( count, primaryColor );
-                osgGeom->setColorArray( colors );
-
-                geode->addDrawable( osgGeom );
+                scratchVerts = new osg::Vec3Array();
+                scratchIndices.clear();
 
-                // record the geometry's primitive set(s) in the index:
-                if ( context.featureIndex() )
-                    context.featureIndex()->tagDrawable( osgGeom.get(), input );
+                triangulatePolygon(job.part, featureSRS, outputSRS, makeECEF, scratchVerts.get(), scratchIndices, job.w2l, triangulator);
+                if ( scratchIndices.empty() )
+                    continue;
 
-                // install clamping attributes if necessary
-                if (_style.has<AltitudeSymbol>() &&
-                    _style.get<AltitudeSymbol>()->technique() == AltitudeSymbol::TECHNIQUE_GPU)
+                //convert back to world coords
+                for( osg::Vec3Array::iterator i = scratchVerts->begin(); i != scratchVerts->end(); ++i )
                 {
-                    Clamping::applyDefaultClampingAttrs( osgGeom.get(), input->getDouble("__oe_verticalOffset", 0.0) );
+                    osg::Vec3d v(*i);
+                    v = v * job.l2w;
+                    v = v * _world2local;
+                    (*i).set( v.x(), v.y(), v.z() );
                 }
+
+                osg::ref_ptr<osg::Geometry> scratch = new osg::Geometry();
+                scratch->setVertexArray( scratchVerts.get() );
+                scratch->addPrimitiveSet( new osg::DrawElementsUInt(GL_TRIANGLES, scratchIndices.begin(), scratchIndices.end()) );
+
+                MeshSubdivider ms( _world2local, _local2world );
+                double threshold = osg::DegreesToRadians( *_maxAngle_deg );
+                if ( job.input->geoInterp().isSet() )
+                    ms.run( *scratch, threshold, *job.input->geoInterp() );
+                else
+                    ms.run( *scratch, threshold, *_geoInterp );
+
+                const osg::Vec3Array* subdivided = static_cast<const osg::Vec3Array*>(scratch->getVertexArray());
+                PolygonArena& arena = getArena( subdivided->size() );
+                unsigned firstVert = arena.verts->size();
+                unsigned firstIndex = arena.indices.size();
+
+                arena.verts->insert( arena.verts->end(), subdivided->begin(), subdivided->end() );
+
+                scratchIndices.clear();
+                osg::TriangleIndexFunctor<CollectTriangles> collect;
+                collect._indices = &scratchIndices;
+                scratch->accept( collect );
+                for(std::vector<GLuint>::const_iterator i = scratchIndices.begin(); i != scratchIndices.end(); ++i)
+                    arena.indices.push_back( firstVert + *i );
+
+                arena.finish( firstVert, firstIndex, job.color );
+            }
+        };
+
+        // One partition per thread, in the shared compute pool.
+        parallelFor( numPartitions, buildRange, numPartitions );
+
+        // Lay out the drawables: consecutive arenas, in feature order, up to
+        // the vertex limit. A run of one arena becomes a drawable as is; a
+        // longer run is copied once into arrays of its exact final size.
+        std::vector<PolygonArena*> run;
+        unsigned runVerts = 0u, runIndices = 0u;
+
+        auto flush = [&]()
+        {
+            if ( run.empty() )
+                return;
+
+            if ( run.size() == 1 )
+            {
+                geode->addDrawable( createGeometry(*run[0]) );
             }
             else
             {
-                OE_TEST << LC << "Oh no. buildAndTilePolygon returned nothing.\n";
+                PolygonArena merged;
+                merged.verts = new osg::Vec3Array( runVerts );
+                merged.normals = new osg::Vec3Array( osg::Array::BIND_PER_VERTEX, runVerts );
+                merged.colors = new osg::Vec4Array( osg::Array::BIND_PER_VERTEX, runVerts );
+                merged.indices.resize( runIndices );
+
+                unsigned v = 0u, i = 0u;
+                for(std::vector<PolygonArena*>::const_iterator a = run.begin(); a != run.end(); ++a)
+                {
+                    const PolygonArena& arena = **a;
+                    std::copy( arena.verts->begin(), arena.verts->end(), merged.verts->begin() + v );
+                    std::copy( arena.normals->begin(), arena.normals->end(), merged.normals->begin() + v );
+                    std::copy( arena.colors->begin(), arena.colors->end(), merged.colors->begin() + v );
+                    for(std::vector<GLuint>::const_iterator k = arena.indices.begin(); k != arena.indices.end(); ++k)
+                        merged.indices[i++] = v + *k;
+                    v += arena.size();
+                }
+
+                geode->addDrawable( createGeometry(merged) );
             }
+
+            for(std::vector<PolygonArena*>::iterator a = run.begin(); a != run.end(); ++a)
+                **a = PolygonArena();
+
+            run.clear();
+            runVerts = runIndices = 0u;
+        };
+
+        for(unsigned p = 0; p < numPartitions; ++p)
+        {
+            for(Arenas::iterator a = output[p].begin(); a != output[p].end(); ++a)
+            {
+                if ( a->indices.empty() )
+                    continue;
+
+                if ( runVerts > 0 && runVerts + a->size() > maxVerts )
+                    flush();
+
+                run.push_back( &(*a) );
+                runVerts += a->size();
+                runIndices += a->indices.size();
+            }
+        }
+        flush();
+
+        OE_TEST << LC << "Num drawables = " << geode->getNumDrawables() << "\n";
+        return geode;
+    }
+
+    auto build = [&](Job& job, PolygonTriangulator& triangulator)
+    {
+        osg::ref_ptr<osg::Geometry> osgGeom = new osg::Geometry();
+        osgGeom->setUseVertexBufferObjects(true);
+
+        if ( !job.name.empty() )
+            osgGeom->setName( job.name );
+
+        // build the geometry:
+        if ( useOSGTessellator().value() )
+            tileAndBuildPolygon(job.part, featureSRS, outputSRS, makeECEF, true, osgGeom.get(), job.w2l);
+        else
+            triangulatePolygon(job.part, featureSRS, outputSRS, makeECEF, osgGeom.get(), job.w2l, triangulator);
+
+        osg::Vec3Array* allPoints = static_cast<osg::Vec3Array*>(osgGeom->getVertexArray());
+        if (allPoints && allPoints->size() > 0)
+        {
+            // subdivide the mesh if necessary to conform to an ECEF globe:
+            if ( makeECEF )
+            {
+                //convert back to world coords
+                for( osg::Vec3Array::iterator i = allPoints->begin(); i != allPoints->end(); ++i )
+                {
+                    osg::Vec3d v(*i);
+                    v = v * job.l2w;
+                    v = v * _world2local;
+
+                    (*i)._v[0] = v[0];
+                    (*i)._v[1] = v[1];
+                    (*i)._v[2] = v[2];
+                }
+
+                double threshold = osg::DegreesToRadians( *_maxAngle_deg );
+                //OE_TEST << "Running mesh subdivider with threshold " << *_maxAngle_deg << std::endl;
+
+                MeshSubdivider ms( _world2local, _local2world );
+                if ( job.input->geoInterp().isSet() )
+                    ms.run( *osgGeom, threshold, *job.input->geoInterp() );
+                else
+                    ms.run( *osgGeom, threshold, *_geoInterp );
+            }
+
+            // assign the primary color array. PER_VERTEX required in order to support
+            // vertex optimization later
+            unsigned count = osgGeom->getVertexArray()->getNumElements();
+            osg::Vec4Array* colors = new osg::Vec4Array(osg::Array::BIND_PER_VERTEX);
+            colors->assign( count, job.color );
+            osgGeom->setColorArray( colors );
+
+            job.osgGeom = osgGeom;
+        }
+        else
+        {
+            OE_TEST << LC << "Oh no. buildAndTilePolygon returned nothing.\n";
+        }
+    };
+
+    // Build the parts, on worker threads if requested. Each worker pulls the
+    // next unbuilt part and keeps its own triangulator.
+    unsigned numWorkers = useOSGTessellator().value() ? 0u : osg::minimum( _numThreads, (unsigned)jobs.size() );
+    if ( numWorkers > 1 )
+    {
+        std::atomic<unsigned> next( 0u );
+
+        parallelFor( numWorkers, [&](unsigned)
+        {
+            PolygonTriangulator triangulator;
+            for(unsigned j = next++; j < jobs.size(); j = next++)
+                build( jobs[j], triangulator );
+        },
+        numWorkers );
+    }
+    else
+    {
+        PolygonTriangulator triangulator;
+        for(std::vector<Job>::iterator j = jobs.begin(); j != jobs.end(); ++j)
+            build( *j, triangulator );
+    }
+
+    // Add the results in feature order.
+    for(std::vector<Job>::iterator j = jobs.begin(); j != jobs.end(); ++j)
+    {
+        osg::Geometry* osgGeom = j->osgGeom.get();
+        if ( !osgGeom )
+            continue;
+
+        geode->addDrawable( osgGeom );
+
+        // record the geometry's primitive set(s) in the index:
+        if ( context.featureIndex() )
+            context.featureIndex()->tagDrawable( osgGeom, j->input );
+
+        // install clamping attributes if necessary
+        if (gpuClamping)
+        {
+            Clamping::applyDefaultClampingAttrs( osgGeom, j->input->getDouble("__oe_verticalOffset", 0.0) );
         }
     }
 
@@ -750,31 +1135,20 @@ namespace
     }
 
     /**
-     * Tesselates an osg::Geometry using the osgEarth tesselator.
-     * If it fails, fall back to the osgUtil tesselator.
+     * Tesselates an osg::Geometry using the osgUtil tesselator. Only the
+     * use_osg_tessellator path gets here; the default path triangulates
+     * with PolygonTriangulator instead.
      */
-    bool tesselateGeometry(osg::Geometry* geometry, bool useOSGTessellator)
+    bool tesselateGeometry(osg::Geometry* geometry)
     {
-        if (useOSGTessellator) {
-            osgUtil::Tessellator tess;
-            tess.setTessellationType(osgUtil::Tessellator::TESS_TYPE_GEOMETRY);
-            tess.setWindingType(osgUtil::Tessellator::TESS_WINDING_ODD);
-            tess.retessellatePolygons(*geometry);
-        }
-        else {
-            osgEarth::Tessellator oeTess;
-            if (!oeTess.tessellateGeometry(*geometry))
-            {
-                osgUtil::Tessellator tess;
-                tess.setTessellationType(osgUtil::Tessellator::TESS_TYPE_GEOMETRY);
-                tess.setWindingType(osgUtil::Tessellator::TESS_WINDING_POSITIVE);
-                tess.retessellatePolygons(*geometry);
-            }
-        }
+        osgUtil::Tessellator tess;
+        tess.setTessellationType(osgUtil::Tessellator::TESS_TYPE_GEOMETRY);
+        tess.setWindingType(osgUtil::Tessellator::TESS_WINDING_ODD);
+        tess.retessellatePolygons(*geometry);
 
         // Make sure all of the primitive sets are osg::DrawElementsUInt
-        // The osgEarth tesselator will occassionally fail, and we fall back to the osgUtil::Tesselator which can produce a mix
-        // of DrawElementsUInt, DrawElementsUByte and DrawElementsUShort depending on the number of vertices.
+        // The osgUtil::Tesselator can produce a mix of DrawElementsUInt, DrawElementsUByte
+        // and DrawElementsUShort depending on the number of vertices.
         convertToDrawElementsUInt(geometry);
         return true;
     }
@@ -989,7 +1363,7 @@ BuildGeometryFilter::tileAndBuildPolygon(Geometry*               ring,
             if ( temp->getNumPrimitiveSets() > 0 )
             {
                 // Tesselate the polygon while the coordinates are still in the LTP
-                if (tesselateGeometry( temp.get(), useOSGTessellator().value() ))
+                if (tesselateGeometry( temp.get() ))
                 {
                     osg::Vec3Array* verts = static_cast<osg::Vec3Array*>(temp->getVertexArray());
                     if ( verts->getNumElements() > 0 )
@@ -1053,6 +1427,122 @@ BuildGeometryFilter::tileAndBuildPolygon(Geometry*               ring,
     }
 }
 
+// triangulates a polygon and its holes straight from the feature rings
+// into indexed triangles, one local tangent plane per tile
+void
+BuildGeometryFilter::triangulatePolygon(Geometry*               input,
+                                        const SpatialReference* featureSRS,
+                                        const SpatialReference* outputSRS,
+                                        bool                    makeECEF,
+                                        osg::Geometry*          osgGeom,
+                                        const osg::Matrixd      &world2local,
+                                        PolygonTriangulator&    triangulator)
+{
+    osg::ref_ptr<osg::Vec3Array> verts = new osg::Vec3Array();
+    std::vector<GLuint> indices;
+
+    triangulatePolygon(input, featureSRS, outputSRS, makeECEF, verts.get(), indices, world2local, triangulator);
+
+    if ( !indices.empty() )
+    {
+        osg::DrawElementsUInt* de = new osg::DrawElementsUInt(GL_TRIANGLES);
+        de->reserve( indices.size() );
+        de->insert( de->end(), indices.begin(), indices.end() );
+
+        osgGeom->setVertexArray( verts.get() );
+        osgGeom->addPrimitiveSet( de );
+    }
+}
+
+// appends the triangulated polygon to existing vertex and index arrays;
+// indices refer to positions in verts
+void
+BuildGeometryFilter::triangulatePolygon(Geometry*               input,
+                                        const SpatialReference* featureSRS,
+                                        const SpatialReference* outputSRS,
+                                        bool                    makeECEF,
+                                        osg::Vec3Array*         verts,
+                                        std::vector<GLuint>&    indices,
+                                        const osg::Matrixd      &world2local,
+                                        PolygonTriangulator&    triangulator)
+{
+    if ( input == 0L )
+        return;
+
+    // Tile the incoming polygon if necessary
+    GeometryCollection tiles;
+    if (_maxPolyTilingAngle_deg.isSet())
+        prepareForTesselation( input, featureSRS, _maxPolyTilingAngle_deg.get(), MAX_POINTS_PER_CROP_TILE, tiles);
+    else
+        tiles.push_back( input );
+
+    std::vector<unsigned> ringSizes;
+
+    for (unsigned t = 0; t < tiles.size(); ++t)
+    {
+        Geometry* geom = tiles[t].get();
+        if ( !geom || !geom->isValid() )
+            continue;
+
+        // establish a local plane for this cell based on its centroid:
+        GeoPoint cellCenter(featureSRS, geom->getBounds().center());
+        cellCenter.transform(outputSRS, cellCenter);
+        osg::Matrix world2cell;
+        cellCenter.createWorldToLocal( world2cell );
+
+        // localize the outer ring and each hole, back to back:
+        unsigned first = verts->size();
+        ringSizes.clear();
+
+        transformAndLocalize( geom->asVector(), featureSRS, verts, outputSRS, world2cell, makeECEF );
+        ringSizes.push_back( verts->size() - first );
+
+        Polygon* poly = dynamic_cast<Polygon*>(geom);
+        if ( poly )
+        {
+            for( RingCollection::const_iterator h = poly->getHoles().begin(); h != poly->getHoles().end(); ++h )
+            {
+                Geometry* hole = h->get();
+                if ( hole->isValid() )
+                {
+                    unsigned start = verts->size();
+                    transformAndLocalize( hole->asVector(), featureSRS, verts, outputSRS, world2cell, makeECEF );
+                    ringSizes.push_back( verts->size() - start );
+                }
+            }
+        }
+
+        bool ok = triangulator.triangulate(*verts, first, ringSizes, indices);
+
+        // fall back on the GLU tessellator for rings the triangulator can't handle
+        if ( !ok )
+        {
+            ok = tessellateRings(verts, first, ringSizes, indices);
+            if ( !ok )
+            {
+                OE_WARN << LC << "Failed to triangulate a polygon with " << (verts->size() - first) << " points; skipping it" << std::endl;
+            }
+        }
+
+        if ( ok )
+        {
+            // Convert the coordinates back to the master LTP.
+            osg::Matrix cell2world;
+            cell2world.invert( world2cell );
+            osg::Matrix cell2local = cell2world * world2local; // pre-multiply to avoid precision loss
+
+            for(unsigned i = first; i < verts->size(); ++i)
+            {
+                (*verts)[i] = (*verts)[i] * cell2local;
+            }
+        }
+        else
+        {
+            verts->resize( first );
+        }
+    }
+}
+
 // builds and tessellates a polygon (with or without holes)
 void
 BuildGeometryFilter::buildPolygon(Geometry*               ring,
@@ -1273,7 +1763,9 @@ namespace
         inline void apply(osg::Drawable& drawable)
         {
             osg::Geometry* geom = drawable.asGeometry();
-            if (geom)
+
+            // arena-built geometry arrives with its normals
+            if (geom && geom->getNormalArray() == 0L)
             {
                 osg::Vec3Array* verts = dynamic_cast<osg::Vec3Array*>(geom->getVertexArray());
 
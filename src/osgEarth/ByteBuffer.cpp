@@ -0,0 +1,183 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+ * Copyright 2020 Pelican Mapping
+ * http://osgearth.org
+ *
+ * osgEarth is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+#include <osgEarth/ByteBuffer>
+#include <osgEarth/MetricsRegistry>
+#include <cstring>
+#include <mutex>
+
+using namespace osgEarth::Util;
+
+namespace
+{
+    // Storage of released buffers, waiting to be reused
+    struct Pool
+    {
+        std::mutex mutex;
+        std::vector< std::vector<char> > free;
+        unsigned maxBuffers;
+        std::size_t maxCapacity;
+        MetricsRegistry::Counter* reused;
+        MetricsRegistry::Counter* allocated;
+
+        Pool() : maxBuffers(64u), maxCapacity(4u * 1024u * 1024u)
+        {
+            MetricsRegistry::Labels labels;
+            labels["source"] = "pool";
+            reused = MetricsRegistry::instance().counter(
+                "oe_byte_buffers_total", "Byte buffers created, by where their storage came from", labels);
+            labels["source"] = "heap";
+            allocated = MetricsRegistry::instance().counter(
+                "oe_byte_buffers_total", "Byte buffers created, by where their storage came from", labels);
+        }
+    };
+
+    Pool& getPool()
+    {
+        // never destroyed, so buffers may be released during static destruction
+        static Pool* s_pool = new Pool();
+        return *s_pool;
+    }
+}
+
+//........................................................................
+
+ByteBuffer::ByteBuffer() :
+    osg::Referenced(true)
+{
+    //nop
+}
+
+ByteBuffer::~ByteBuffer()
+{
+    if (_data.capacity() == 0u)
+        return;
+
+    Pool& pool = getPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if (pool.free.size() < pool.maxBuffers && _data.capacity() <= pool.maxCapacity)
+    {
+        _data.clear();
+        pool.free.push_back(std::vector<char>());
+        pool.free.back().swap(_data);
+    }
+}
+
+ByteBuffer*
+ByteBuffer::create(std::size_t capacity)
+{
+    ByteBuffer* buffer = new ByteBuffer();
+
+    Pool& pool = getPool();
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (!pool.free.empty())
+        {
+            buffer->_data.swap(pool.free.back());
+            pool.free.pop_back();
+        }
+    }
+
+    if (buffer->_data.capacity() > 0u)
+        pool.reused->increment();
+    else
+        pool.allocated->increment();
+
+    if (capacity > buffer->_data.capacity())
+        buffer->_data.reserve(capacity);
+
+    return buffer;
+}
+
+void
+ByteBuffer::append(const void* bytes, std::size_t count)
+{
+    if (count > 0u)
+    {
+        const char* ptr = static_cast<const char*>(bytes);
+        _data.insert(_data.end(), ptr, ptr + count);
+    }
+}
+
+void
+ByteBuffer::setPoolLimits(unsigned maxBuffers, std::size_t maxCapacity)
+{
+    Pool& pool = getPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.maxBuffers = maxBuffers;
+    pool.maxCapacity = maxCapacity;
+    if (pool.free.size() > maxBuffers)
+        pool.free.resize(maxBuffers);
+}
+
+//........................................................................
+
+ByteBufferStream::ByteBufferStream(ByteBuffer* buffer) :
+    std::istream(nullptr)
+{
+    _buf._buffer = buffer;
+    _buf.reset();
+    init(&_buf);
+}
+
+void
+ByteBufferStream::rewind()
+{
+    _buf.reset();
+    clear();
+}
+
+void
+ByteBufferStream::StreamBuf::reset()
+{
+    char* begin = _buffer.valid() ? _buffer->data() : nullptr;
+    char* end = begin ? begin + _buffer->size() : nullptr;
+    setg(begin, begin, end);
+}
+
+std::streambuf::pos_type
+ByteBufferStream::StreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    if ((which & std::ios_base::in) == 0)
+        return pos_type(off_type(-1));
+
+    off_type base =
+        dir == std::ios_base::beg ? 0 :
+        dir == std::ios_base::cur ? gptr() - eback() :
+        egptr() - eback();
+
+    off_type pos = base + off;
+    if (pos < 0 || pos > egptr() - eback())
+        return pos_type(off_type(-1));
+
+    setg(eback(), eback() + pos, egptr());
+    return pos_type(pos);
+}
+
+std::streambuf::pos_type
+ByteBufferStream::StreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+std::streamsize
+ByteBufferStream::StreamBuf::showmanyc()
+{
+    // the whole buffer is always in the get area, so nothing follows it
+    return egptr() > gptr() ? (std::streamsize)(egptr() - gptr()) : -1;
+}
@@ -25,6 +25,7 @@
 #include <osg/TextureBuffer>
 
 using namespace osgEarth;
+using namespace osgEarth::Util;
 
 
 // serializer for osg::DummyObject (not present in OSG)
@@ -340,3 +341,28 @@ namespace
     REGISTER_OSGPLUGIN(osgearth_cachebin, osgEarthReadImageFromCachePseudoLoader);
 
 }
+
+//------------------------------------------------------------------------
+
+CacheBin::CacheBin(const std::string& binID) :
+_binID   ( binID ),
+_hashKeys( true ),
+_minTime ( 0 )
+{
+    MetricsRegistry::Labels labels;
+    labels["bin"] = binID;
+
+    labels["result"] = "hit";
+    _hits = MetricsRegistry::instance().counter(
+        "oe_cache_reads_total", "Cache bin reads by result", labels);
+
+    labels["result"] = "miss";
+    _misses = MetricsRegistry::instance().counter(
+        "oe_cache_reads_total", "Cache bin reads by result", labels);
+}
+
+void
+CacheBin::recordRead(bool hit)
+{
+    (hit ? _hits : _misses)->increment();
+}
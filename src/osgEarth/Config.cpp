@@ -24,6 +24,8 @@
 #include <osgEarth/JsonUtils>
 #include <osgEarth/FileUtils>
 #include <osgDB/FileNameUtils>
+#include <unordered_map>
+#include <cstring>
 
 using namespace osgEarth;
 
@@ -448,3 +450,269 @@ Config::operator - ( const Config& rhs ) const
 
     return result;
 }
+
+//------------------------------------------------------------------------
+
+// Compact binary encoding:
+//   header   : "OEBC", version, byte order mark, string count, node count
+//   strings  : (length, bytes) for each unique string; keys, values and
+//              referrers are all interned so each appears only once
+//   nodes    : pre-order records of (key, value, referrer, externalRef,
+//              flags, child count), each field a string index or number
+//
+// Local referrers are stored relative to the document's own referrer, so a
+// compiled file still resolves its paths after it moves with its sources.
+
+namespace
+{
+    const char          BINARY_SIGNATURE[4] = { 'O', 'E', 'B', 'C' };
+    const std::uint32_t BINARY_VERSION = 2u;
+    const std::uint32_t BINARY_BYTE_ORDER = 0x01020304u;
+    const std::uint32_t BINARY_INHERIT_REFERRER = ~0u;
+    const std::uint32_t BINARY_HEADER_SIZE = 4u + 4u*4u;
+    const std::uint32_t BINARY_NODE_FIELDS = 6u;
+
+    enum BinaryFlags
+    {
+        BINARY_IS_LOCATION = 1u << 0,
+        BINARY_IS_NUMBER   = 1u << 1,
+        BINARY_RELATIVE_REFERRER = 1u << 2
+    };
+
+    struct BinaryStringTable
+    {
+        std::unordered_map<std::string, std::uint32_t> _index;
+        std::vector<const std::string*> _strings;
+
+        std::uint32_t intern(const std::string& value)
+        {
+            auto i = _index.find(value);
+            if (i != _index.end())
+                return i->second;
+            std::uint32_t index = _strings.size();
+            auto result = _index.emplace(value, index);
+            _strings.push_back(&result.first->first);
+            return index;
+        }
+    };
+
+    // Reads values from a binary buffer, with bounds checking
+    struct BinaryReader
+    {
+        const char* _ptr;
+        const char* _end;
+
+        BinaryReader(const char* data, std::size_t size) : _ptr(data), _end(data+size) { }
+
+        bool read(std::uint32_t& value)
+        {
+            if (_end - _ptr < 4) return false;
+            ::memcpy(&value, _ptr, 4);
+            _ptr += 4;
+            return true;
+        }
+
+        bool read(const char*& str, std::uint32_t len)
+        {
+            if ((std::size_t)(_end - _ptr) < len) return false;
+            str = _ptr;
+            _ptr += len;
+            return true;
+        }
+    };
+
+    struct BinaryString
+    {
+        const char* _data;
+        std::uint32_t _len;
+    };
+    bool isLocalPath(const std::string& path)
+    {
+        return !path.empty() && !osgDB::containsServerAddress(path);
+    }
+}
+
+namespace osgEarth
+{
+    // Helper with access to Config internals
+    struct ConfigBinaryCodec
+    {
+        static void encode(
+            const Config& conf,
+            const std::string& rootReferrer,
+            BinaryStringTable& table,
+            std::vector<std::uint32_t>& nodes)
+        {
+            std::uint32_t flags =
+                (conf._isLocation ? BINARY_IS_LOCATION : 0u) |
+                (conf._isNumber ? BINARY_IS_NUMBER : 0u);
+
+            std::uint32_t referrer = BINARY_INHERIT_REFERRER;
+            if (conf._referrer != rootReferrer)
+            {
+                std::string path = conf._referrer;
+                if (isLocalPath(rootReferrer) && isLocalPath(path) && !osgEarth::isRelativePath(path))
+                {
+                    std::string relative = osgDB::getPathRelative(osgDB::getFilePath(rootReferrer), path);
+                    if (osgEarth::isRelativePath(relative))
+                    {
+                        path = relative;
+                        flags |= BINARY_RELATIVE_REFERRER;
+                    }
+                }
+                referrer = table.intern(path);
+            }
+
+            nodes.push_back(table.intern(conf._key));
+            nodes.push_back(table.intern(conf._defaultValue));
+            nodes.push_back(referrer);
+            nodes.push_back(table.intern(conf._externalRef));
+            nodes.push_back(flags);
+            nodes.push_back(conf._children.size());
+
+            for (ConfigSet::const_iterator i = conf._children.begin(); i != conf._children.end(); ++i)
+                encode(*i, rootReferrer, table, nodes);
+        }
+
+        static bool decode(
+            Config& conf,
+            const std::vector<BinaryString>& strings,
+            const std::string& referrer,
+            BinaryReader& reader,
+            std::uint32_t& nodesRemaining)
+        {
+            if (nodesRemaining == 0u)
+                return false;
+            --nodesRemaining;
+
+            std::uint32_t fields[BINARY_NODE_FIELDS];
+            for (unsigned i = 0; i < BINARY_NODE_FIELDS; ++i)
+                if (!reader.read(fields[i]))
+                    return false;
+
+            const std::uint32_t numStrings = strings.size();
+            if (fields[0] >= numStrings || fields[1] >= numStrings || fields[3] >= numStrings)
+                return false;
+            if (fields[2] != BINARY_INHERIT_REFERRER && fields[2] >= numStrings)
+                return false;
+            if (fields[5] > nodesRemaining)
+                return false;
+
+            conf._key.assign(strings[fields[0]]._data, strings[fields[0]]._len);
+            conf._defaultValue.assign(strings[fields[1]]._data, strings[fields[1]]._len);
+            if (fields[2] == BINARY_INHERIT_REFERRER)
+            {
+                conf._referrer = referrer;
+            }
+            else
+            {
+                conf._referrer.assign(strings[fields[2]]._data, strings[fields[2]]._len);
+                if ((fields[4] & BINARY_RELATIVE_REFERRER) != 0u)
+                    conf._referrer = osgEarth::getFullPath(referrer, conf._referrer);
+            }
+            conf._externalRef.assign(strings[fields[3]]._data, strings[fields[3]]._len);
+            conf._isLocation = (fields[4] & BINARY_IS_LOCATION) != 0u;
+            conf._isNumber = (fields[4] & BINARY_IS_NUMBER) != 0u;
+
+            // decode children in place to avoid copying subtrees
+            for (std::uint32_t i = 0; i < fields[5]; ++i)
+            {
+                conf._children.push_back(Config());
+                if (!decode(conf._children.back(), strings, referrer, reader, nodesRemaining))
+                    return false;
+            }
+            return true;
+        }
+    };
+}
+
+bool
+Config::isBinary(const char* data, std::size_t size)
+{
+    return
+        data != 0L &&
+        size >= BINARY_HEADER_SIZE &&
+        ::memcmp(data, BINARY_SIGNATURE, 4) == 0;
+}
+
+bool
+Config::toBinary(std::ostream& out) const
+{
+    BinaryStringTable table;
+    std::vector<std::uint32_t> nodes;
+    ConfigBinaryCodec::encode(*this, _referrer, table, nodes);
+
+    std::uint32_t header[4] = {
+        BINARY_VERSION,
+        BINARY_BYTE_ORDER,
+        (std::uint32_t)table._strings.size(),
+        (std::uint32_t)(nodes.size() / BINARY_NODE_FIELDS) };
+
+    out.write(BINARY_SIGNATURE, 4);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    for (auto str : table._strings)
+    {
+        std::uint32_t len = str->size();
+        out.write(reinterpret_cast<const char*>(&len), 4);
+        out.write(str->data(), len);
+    }
+
+    out.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(std::uint32_t));
+
+    return out.good();
+}
+
+bool
+Config::fromBinary(const char* data, std::size_t size, const std::string& referrer)
+{
+    if (!isBinary(data, size))
+        return false;
+
+    BinaryReader reader(data + 4, size - 4);
+
+    std::uint32_t version, byteOrder, numStrings, numNodes;
+    if (!reader.read(version) || !reader.read(byteOrder) || !reader.read(numStrings) || !reader.read(numNodes))
+        return false;
+
+    if (version != BINARY_VERSION || byteOrder != BINARY_BYTE_ORDER)
+    {
+        OE_WARN << LC << "Unsupported binary config version or byte order" << std::endl;
+        return false;
+    }
+
+    // each string costs at least 4 bytes, so this guards the reserve:
+    if (numStrings > size/4u)
+        return false;
+
+    std::vector<BinaryString> strings(numStrings);
+    for (std::uint32_t i = 0; i < numStrings; ++i)
+    {
+        if (!reader.read(strings[i]._len) || !reader.read(strings[i]._data, strings[i]._len))
+            return false;
+    }
+
+    std::string absReferrer = referrer;
+    if (!absReferrer.empty() && !osgDB::containsServerAddress(absReferrer) && !osgDB::isAbsolutePath(absReferrer))
+        absReferrer = osgEarth::getAbsolutePath(absReferrer);
+
+    *this = Config();
+    if (!ConfigBinaryCodec::decode(*this, strings, absReferrer, reader, numNodes) || numNodes != 0u)
+    {
+        OE_WARN << LC << "Corrupt binary config" << std::endl;
+        *this = Config();
+        return false;
+    }
+
+    return true;
+}
+
+bool
+Config::fromBinaryFile(const std::string& filename, const std::string& referrer)
+{
+    MemoryMappedFile file;
+    if (!file.open(filename))
+        return false;
+
+    return fromBinary(file.data(), file.size(), referrer.empty() ? filename : referrer);
+}
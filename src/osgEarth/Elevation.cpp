@@ -19,6 +19,7 @@
 #include <osgEarth/Elevation>
 #include <osgEarth/Registry>
 #include <osgEarth/Map>
+#include <osgEarth/ImagePool>
 #include <osgEarth/Progress>
 #include <osgEarth/Metrics>
 
@@ -82,7 +83,7 @@ ElevationTexture::ElevationTexture(const TileKey& key, const GeoHeightField& in_
 
         osg::Vec4 value;
 
-        osg::Image* heights = new osg::Image();
+        osg::Image* heights = new Util::PooledImage();
         heights->allocateImage(_heightField->getNumColumns(), _heightField->getNumRows(), 1, GL_RED, GL_FLOAT);
         heights->setInternalTextureFormat(GL_R32F);
 
@@ -198,7 +199,7 @@ NormalMapGenerator::createNormalMap(
 
     ElevationPool::WorkingSet* workingSet = static_cast<ElevationPool::WorkingSet*>(ws);
 
-    osg::Image* image = new osg::Image();
+    osg::Image* image = new Util::PooledImage();
     image->allocateImage(
         ELEVATION_TILE_SIZE, ELEVATION_TILE_SIZE, 1,
         GL_RG, GL_UNSIGNED_BYTE);
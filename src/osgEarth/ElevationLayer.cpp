@@ -22,6 +22,7 @@
 #include <osgEarth/MemCache>
 #include <osgEarth/Metrics>
 #include <osgEarth/NetworkMonitor>
+#include <osgEarth/TileTracer>
 #include <cinttypes>
 
 using namespace osgEarth;
@@ -257,7 +258,10 @@ ElevationLayer::assembleHeightField(const TileKey& key,
 
             if ( isKeyInLegalRange(layerKey) )
             {
+                Util::TileTracer::Scope trace(Util::TileTracer::FETCH, layerKey, getName());
+                Util::MetricsRegistry::ScopedTimer timer(0L);
                 GeoHeightField hf = createHeightFieldImplementation(layerKey, progress);
+                recordTileLoad(timer.elapsed(), hf.valid(), progress && progress->isCanceled());
                 if (hf.valid())
                 {
                     heightFields.push_back( hf );
@@ -397,6 +401,9 @@ ElevationLayer::createHeightFieldInKeyProfile(const TileKey& key, ProgressCallba
 
         CacheBin* bin = _memCache->getOrCreateDefaultBin();
         ReadResult cacheResult = bin->readObject(memCacheKey, 0L);
+        bin->recordRead(cacheResult.succeeded());
+        Util::TileTracer::instance().record(
+            cacheResult.succeeded() ? Util::TileTracer::CACHE_HIT : Util::TileTracer::CACHE_MISS, key, getName());
         if ( cacheResult.succeeded() )
         {
             result = GeoHeightField(
@@ -442,6 +449,9 @@ ElevationLayer::createHeightFieldInKeyProfile(const TileKey& key, ProgressCallba
                     }
                 }
             }
+            cacheBin->recordRead(fromCache);
+            Util::TileTracer::instance().record(
+                fromCache ? Util::TileTracer::CACHE_HIT : Util::TileTracer::CACHE_MISS, key, getName());
         }
 
         // if we're cache-only, but didn't get data from the cache, fail silently.
@@ -461,7 +471,10 @@ ElevationLayer::createHeightFieldInKeyProfile(const TileKey& key, ProgressCallba
 
             if (key.getProfile()->isHorizEquivalentTo(getProfile()))
             {
+                Util::TileTracer::Scope trace(Util::TileTracer::FETCH, key, getName());
+                Util::MetricsRegistry::ScopedTimer timer(0L);
                 result = createHeightFieldImplementation(key, progress);
+                recordTileLoad(timer.elapsed(), result.valid(), progress && progress->isCanceled());
             }
             else
             {
@@ -365,6 +365,268 @@ NumericExpression::eval() const
 
 //------------------------------------------------------------------------
 
+namespace
+{
+    // Rows the batch interpreter evaluates together. Small enough that the
+    // working stack stays in cache, large enough that the per-instruction
+    // loops vectorize well.
+    const unsigned EVAL_BLOCK_SIZE = 256u;
+
+    // Stack size below which single-row evaluation avoids the heap
+    const unsigned EVAL_LOCAL_STACK = 32u;
+}
+
+CompiledNumericExpression::CompiledNumericExpression() :
+_maxStack( 0u ),
+_valid   ( false )
+{
+    //nop
+}
+
+bool
+CompiledNumericExpression::compile(const NumericExpression& expr)
+{
+    return compileImpl(expr, 0L);
+}
+
+bool
+CompiledNumericExpression::compile(const NumericExpression& expr, const std::vector<std::string>& schema)
+{
+    return compileImpl(expr, &schema);
+}
+
+bool
+CompiledNumericExpression::compileImpl(const NumericExpression& expr, const std::vector<std::string>* schema)
+{
+    _code.clear();
+    _columns.clear();
+    _maxStack = 0u;
+    _valid = false;
+
+    if (schema)
+        _columns = *schema;
+
+    Instruction ins;
+    ins.column = 0u;
+    ins.value = 0.0;
+
+    // literal expression; there is no RPN, just a value.
+    if (expr._rpn.empty())
+    {
+        ins.op = OP_CONSTANT;
+        ins.value = expr._dirty ? 0.0 : expr._value;
+        _code.push_back(ins);
+        _maxStack = 1u;
+        _valid = true;
+        return true;
+    }
+
+    // map each variable's RPN slot to its name:
+    std::vector<const std::string*> names(expr._rpn.size(), 0L);
+    for (unsigned i = 0; i < expr._vars.size(); ++i)
+    {
+        // script function calls need a script engine and cannot be compiled.
+        if (expr._vars[i].first.find('(') != std::string::npos)
+            return false;
+
+        names[expr._vars[i].second] = &expr._vars[i].first;
+    }
+
+    unsigned depth = 0u;
+
+    for (unsigned i = 0; i < expr._rpn.size(); ++i)
+    {
+        const NumericExpression::Atom& a = expr._rpn[i];
+
+        ins.column = 0u;
+        ins.value = 0.0;
+
+        if (a.first == NumericExpression::OPERAND)
+        {
+            ins.op = OP_CONSTANT;
+            ins.value = a.second;
+            ++depth;
+        }
+        else if (a.first == NumericExpression::VARIABLE)
+        {
+            int column = -1;
+            if (names[i])
+            {
+                for (unsigned c = 0; c < _columns.size() && column < 0; ++c)
+                    if (ciEquals(_columns[c], *names[i]))
+                        column = c;
+
+                if (column < 0 && !schema)
+                {
+                    column = _columns.size();
+                    _columns.push_back(toLower(*names[i]));
+                }
+            }
+
+            if (column >= 0)
+            {
+                ins.op = OP_COLUMN;
+                ins.column = column;
+            }
+            else
+            {
+                // unbound variable; same as a missing attribute.
+                ins.op = OP_CONSTANT;
+            }
+            ++depth;
+        }
+        else
+        {
+            switch (a.first)
+            {
+            case NumericExpression::ADD:  ins.op = OP_ADD;  break;
+            case NumericExpression::SUB:  ins.op = OP_SUB;  break;
+            case NumericExpression::MULT: ins.op = OP_MULT; break;
+            case NumericExpression::DIV:  ins.op = OP_DIV;  break;
+            case NumericExpression::MOD:  ins.op = OP_MOD;  break;
+            case NumericExpression::MIN:  ins.op = OP_MIN;  break;
+            case NumericExpression::MAX:  ins.op = OP_MAX;  break;
+            default: continue;
+            }
+
+            // NumericExpression::eval ignores an operator that does not
+            // have two operands, so drop it here too.
+            if (depth < 2u)
+                continue;
+
+            --depth;
+        }
+
+        _code.push_back(ins);
+        _maxStack = osg::maximum(_maxStack, depth);
+    }
+
+    if (_code.empty())
+    {
+        ins.op = OP_CONSTANT;
+        ins.column = 0u;
+        ins.value = 0.0;
+        _code.push_back(ins);
+        _maxStack = 1u;
+    }
+
+    _valid = true;
+    return true;
+}
+
+double
+CompiledNumericExpression::eval(const double* row) const
+{
+    if (!_valid)
+        return 0.0;
+
+    double local[EVAL_LOCAL_STACK];
+    std::vector<double> heap;
+    double* s = local;
+    if (_maxStack > EVAL_LOCAL_STACK)
+    {
+        heap.resize(_maxStack);
+        s = &heap[0];
+    }
+
+    unsigned sp = 0u;
+
+    for (std::vector<Instruction>::const_iterator i = _code.begin(); i != _code.end(); ++i)
+    {
+        switch (i->op)
+        {
+        case OP_CONSTANT: s[sp++] = i->value; break;
+        case OP_COLUMN:   s[sp++] = row[i->column]; break;
+        case OP_ADD:  --sp; s[sp-1] = s[sp-1] + s[sp]; break;
+        case OP_SUB:  --sp; s[sp-1] = s[sp-1] - s[sp]; break;
+        case OP_MULT: --sp; s[sp-1] = s[sp-1] * s[sp]; break;
+        case OP_DIV:  --sp; s[sp-1] = s[sp-1] / s[sp]; break;
+        case OP_MOD:  --sp; s[sp-1] = fmod(s[sp-1], s[sp]); break;
+        case OP_MIN:  --sp; s[sp-1] = osg::minimum(s[sp-1], s[sp]); break;
+        case OP_MAX:  --sp; s[sp-1] = osg::maximum(s[sp-1], s[sp]); break;
+        }
+    }
+
+    double value = sp > 0u ? s[sp-1] : 0.0;
+    return !osg::isNaN(value) ? value : 0.0;
+}
+
+void
+CompiledNumericExpression::eval(const double* const* columns, unsigned count, double* output) const
+{
+    if (!_valid)
+    {
+        std::fill(output, output + count, 0.0);
+        return;
+    }
+
+    // Run each instruction over a whole block of rows at a time.
+    // The stack is laid out as _maxStack slots of EVAL_BLOCK_SIZE values,
+    // so every operator is a simple loop over two contiguous arrays that
+    // the compiler can vectorize.
+    const unsigned B = EVAL_BLOCK_SIZE;
+    std::vector<double> stack(_maxStack * B);
+    double* s = &stack[0];
+
+    for (unsigned start = 0u; start < count; start += B)
+    {
+        const unsigned n = osg::minimum(B, count - start);
+        unsigned sp = 0u;
+
+        for (std::vector<Instruction>::const_iterator i = _code.begin(); i != _code.end(); ++i)
+        {
+            double* a = s + (sp >= 2u ? (sp-2u)*B : 0u);
+            const double* b = s + (sp >= 1u ? (sp-1u)*B : 0u);
+
+            switch (i->op)
+            {
+            case OP_CONSTANT:
+                std::fill(s + sp*B, s + sp*B + n, i->value);
+                ++sp;
+                break;
+            case OP_COLUMN:
+                std::copy(columns[i->column] + start, columns[i->column] + start + n, s + sp*B);
+                ++sp;
+                break;
+            case OP_ADD:
+                for (unsigned k = 0; k < n; ++k) a[k] = a[k] + b[k];
+                --sp;
+                break;
+            case OP_SUB:
+                for (unsigned k = 0; k < n; ++k) a[k] = a[k] - b[k];
+                --sp;
+                break;
+            case OP_MULT:
+                for (unsigned k = 0; k < n; ++k) a[k] = a[k] * b[k];
+                --sp;
+                break;
+            case OP_DIV:
+                for (unsigned k = 0; k < n; ++k) a[k] = a[k] / b[k];
+                --sp;
+                break;
+            case OP_MOD:
+                for (unsigned k = 0; k < n; ++k) a[k] = fmod(a[k], b[k]);
+                --sp;
+                break;
+            case OP_MIN:
+                for (unsigned k = 0; k < n; ++k) a[k] = a[k] < b[k] ? a[k] : b[k];
+                --sp;
+                break;
+            case OP_MAX:
+                for (unsigned k = 0; k < n; ++k) a[k] = a[k] > b[k] ? a[k] : b[k];
+                --sp;
+                break;
+            }
+        }
+
+        const double* result = s + (sp-1u)*B;
+        for (unsigned k = 0; k < n; ++k)
+            output[start + k] = !osg::isNaN(result[k]) ? result[k] : 0.0;
+    }
+}
+
+//------------------------------------------------------------------------
+
 StringExpression::StringExpression() :
 _dirty(true)
 {
@@ -31,6 +31,7 @@
 #include <osgEarth/LineDrawable>
 #include <osgEarth/StateSetCache>
 #include <osgEarth/Registry>
+#include <osgEarth/Threading>
 
 #include <osg/Geode>
 #include <osg/Geometry>
@@ -41,10 +42,16 @@
 #include <osgUtil/Simplifier>
 #include <osg/LineWidth>
 #include <osg/PolygonOffset>
+#include <osg/TriangleIndexFunctor>
+
+#include <atomic>
+#include <functional>
+#include <thread>
 
 #define LC "[ExtrudeGeometryFilter] "
 
 using namespace osgEarth;
+using namespace osgEarth::Threading;
 
 namespace
 {
@@ -75,15 +82,76 @@ namespace
     }
 }
 
+namespace
+{
+    // Appends "count" elements of src to dest (which holds "first" elements),
+    // creating dest or padding with "fill" when one side lacks the array.
+    template<typename ARRAY>
+    void appendArray(osg::ref_ptr<ARRAY>& dest, const ARRAY* src, unsigned first, unsigned count,
+                     const typename ARRAY::ElementDataType& fill)
+    {
+        if ( !dest.valid() )
+        {
+            if ( !src )
+                return;
+            dest = new ARRAY( osg::Array::BIND_PER_VERTEX );
+            dest->setNormalize( src->getNormalize() );
+        }
+
+        dest->reserve( first + count );
+        dest->resize( first, fill );
+
+        if ( src && src->size() >= count )
+            dest->insert( dest->end(), src->begin(), src->begin() + count );
+        else
+            dest->resize( first + count, fill );
+    }
+
+    // Collects the triangle indices of any primitive set.
+    struct CollectTriangles
+    {
+        std::vector<GLuint>* _indices;
+        CollectTriangles() : _indices(0L) { }
+        void operator()(unsigned i1, unsigned i2, unsigned i3)
+        {
+            _indices->push_back(i1);
+            _indices->push_back(i2);
+            _indices->push_back(i3);
+        }
+    };
+}
+
 #define AS_VEC4(V3, X) osg::Vec4f( (V3).x(), (V3).y(), (V3).z(), X )
 
 //------------------------------------------------------------------------
 
+void
+ExtrudeGeometryFilter::Arena::append(const Arena& rhs)
+{
+    unsigned first = size();
+    unsigned count = rhs.size();
+    if ( count == 0 )
+        return;
+
+    appendArray( verts,     rhs.verts.get(),     first, count, osg::Vec3() );
+    appendArray( normals,   rhs.normals.get(),   first, count, osg::Vec3(0,0,1) );
+    appendArray( texcoords, rhs.texcoords.get(), first, count, osg::Vec3() );
+    appendArray( colors,    rhs.colors.get(),    first, count, osg::Vec4(1,1,1,1) );
+    appendArray( anchors,   rhs.anchors.get(),   first, count, osg::Vec4() );
+
+    indices.reserve( indices.size() + rhs.indices.size() );
+    for(std::vector<GLuint>::const_iterator i = rhs.indices.begin(); i != rhs.indices.end(); ++i)
+        indices.push_back( first + *i );
+}
+
+//------------------------------------------------------------------------
+
 ExtrudeGeometryFilter::ExtrudeGeometryFilter() :
 _mergeGeometry         ( true ),
 _wallAngleThresh_deg   ( 60.0 ),
 _styleDirty            ( true ),
 _makeStencilVolume     ( false ),
+_numThreads            ( 0u ),
 _gpuClamping           ( false )
 {
     _cosWallAngleThresh = cos( _wallAngleThresh_deg );
@@ -529,25 +597,25 @@ ExtrudeGeometryFilter::buildStructure(const Geometry*         input,
 }
 
 
-bool
-ExtrudeGeometryFilter::buildWallGeometry(const Structure&     structure,
-                                         osg::Geometry*       walls,
-                                         const osg::Vec4&     wallColor,
-                                         const osg::Vec4&     wallBaseColor,
-                                         const SkinResource*  wallSkin)
+void
+ExtrudeGeometryFilter::appendWallGeometry(const Structure&     structure,
+                                          Arena&               arena,
+                                          const osg::Vec4&     wallColor,
+                                          const osg::Vec4&     wallBaseColor,
+                                          const SkinResource*  wallSkin,
+                                          bool                 computeNormals)
 {
-    bool madeGeom = true;
-
     // 6 verts per face total (3 triangles)
     unsigned numWallVerts = structure.getNumPoints();
+    if (numWallVerts == 0)
+        return;
 
     double texWidthM   = wallSkin ? *wallSkin->imageWidth()  : 1.0;
-    double texHeightM  = wallSkin ? *wallSkin->imageHeight() : 1.0;
     bool   useColor    = (!wallSkin || wallSkin->texEnvMode() != osg::TexEnv::DECAL) && !_makeStencilVolume;
     
     // Scale and bias:
     osg::Vec2f scale, bias;
-    float layer;
+    float layer = 0.0f;
     if ( wallSkin )
     {
         bias.set (wallSkin->imageBiasS().get(),  wallSkin->imageBiasT().get());
@@ -555,22 +623,31 @@ ExtrudeGeometryFilter::buildWallGeometry(const Structure&     structure,
         layer = (float)wallSkin->imageLayer().get();
     }
 
-    // create all the OSG geometry components
-    osg::Vec3Array* verts = new osg::Vec3Array( numWallVerts );
-    walls->setVertexArray( verts );
-    
+    // grow the arena arrays to make room for the new walls.
+    unsigned first = arena.size();
+    unsigned total = first + numWallVerts;
+
+    if ( !arena.verts.valid() )
+        arena.verts = new osg::Vec3Array();
+    arena.verts->resize( total );
+    osg::Vec3Array& verts = *arena.verts;
+
     osg::Vec3Array* tex = 0L;
     if ( wallSkin )
     { 
-        tex = new osg::Vec3Array( numWallVerts );
-        walls->setTexCoordArray( 0, tex );
+        if ( !arena.texcoords.valid() )
+            arena.texcoords = new osg::Vec3Array();
+        arena.texcoords->resize( total );
+        tex = arena.texcoords.get();
     }
 
     osg::Vec4Array* colors = 0L;
     if ( useColor )
     {
-        colors = new osg::Vec4Array( osg::Array::BIND_PER_VERTEX, numWallVerts );
-        walls->setColorArray( colors );
+        if ( !arena.colors.valid() )
+            arena.colors = new osg::Vec4Array( osg::Array::BIND_PER_VERTEX );
+        arena.colors->resize( total );
+        colors = arena.colors.get();
     }
 
     osg::Vec4Array* anchors = 0L;
@@ -578,39 +655,48 @@ ExtrudeGeometryFilter::buildWallGeometry(const Structure&     structure,
     // If GPU clamping is in effect, create clamping attributes.
     if ( _gpuClamping )
     {
-        anchors = new osg::Vec4Array( osg::Array::BIND_PER_VERTEX, numWallVerts );
-        anchors->setNormalize(false);
-        walls->setVertexAttribArray    ( Clamping::AnchorAttrLocation, anchors );
+        if ( !arena.anchors.valid() )
+        {
+            arena.anchors = new osg::Vec4Array( osg::Array::BIND_PER_VERTEX );
+            arena.anchors->setNormalize(false);
+        }
+        arena.anchors->resize( total );
+        anchors = arena.anchors.get();
+    }
+
+    osg::Vec3Array* normals = 0L;
+    if ( computeNormals )
+    {
+        if ( !arena.normals.valid() )
+            arena.normals = new osg::Vec3Array( osg::Array::BIND_PER_VERTEX );
+        arena.normals->resize( total );
+        normals = arena.normals.get();
     }
 
-    unsigned vertptr = 0;
+    arena.indices.reserve( arena.indices.size() + numWallVerts );
+
+    unsigned vertptr = first;
     bool     tex_repeats_y = wallSkin && wallSkin->isTiled() == true;
 
     bool flatten =
         _style.has<ExtrusionSymbol>() &&
         _style.get<ExtrusionSymbol>()->flatten() == true;
 
+    float cosSmoothThresh = cos( osg::DegreesToRadians(_wallAngleThresh_deg) );
+
     for(Elevations::const_iterator elev = structure.elevations.begin(); elev != structure.elevations.end(); ++elev)
     {
-        osg::DrawElements* de = 
-            numWallVerts > 0xFFFF ? (osg::DrawElements*) new osg::DrawElementsUInt  ( GL_TRIANGLES ) :
-            numWallVerts > 0xFF   ? (osg::DrawElements*) new osg::DrawElementsUShort( GL_TRIANGLES ) :
-                                    (osg::DrawElements*) new osg::DrawElementsUByte ( GL_TRIANGLES );
-
-        // pre-allocate for speed
-        de->reserveElements( numWallVerts );
-
-        walls->addPrimitiveSet( de );
+        unsigned elevptr = vertptr;
 
         for(Faces::const_iterator f = elev->faces.begin(); f != elev->faces.end(); ++f, vertptr+=6)
         {
             // set the 6 wall verts.
-            (*verts)[vertptr+0] = f->left.roof;
-            (*verts)[vertptr+1] = f->left.base;
-            (*verts)[vertptr+2] = f->right.base;
-            (*verts)[vertptr+3] = f->right.base;
-            (*verts)[vertptr+4] = f->right.roof;
-            (*verts)[vertptr+5] = f->left.roof;
+            verts[vertptr+0] = f->left.roof;
+            verts[vertptr+1] = f->left.base;
+            verts[vertptr+2] = f->right.base;
+            verts[vertptr+3] = f->right.base;
+            verts[vertptr+4] = f->right.roof;
+            verts[vertptr+5] = f->left.roof;
             
             if ( anchors )
             {
@@ -680,12 +766,91 @@ ExtrudeGeometryFilter::buildWallGeometry(const Structure&     structure,
                 (*tex)[vertptr+5].set( texRoofL.x(), texRoofL.y(), layer );
             }
 
+            if ( normals )
+            {
+                osg::Vec3 n = (f->left.base - f->left.roof) ^ (f->right.base - f->left.roof);
+                n.normalize();
+                for(int i=0; i<6; ++i)
+                    (*normals)[vertptr+i] = n;
+            }
+
             for(int i=0; i<6; ++i)
             {
-                de->addElement( vertptr+i );
+                arena.indices.push_back( vertptr+i );
+            }
+        }
+
+        // Faces are stored separately, so the corners are not shared. Smooth the
+        // normals across each corner whose angle is below the wall threshold
+        // (the same rule the SmoothingVisitor applies to the serial walls).
+        // Face i's right edge (verts 2,3,4) meets face i+1's left edge (verts 0,1,5).
+        if ( normals && vertptr > elevptr )
+        {
+            unsigned numFaces = (vertptr - elevptr) / 6;
+            unsigned numCorners = structure.isPolygon ? numFaces : numFaces-1;
+
+            // copy the flat normals so that each corner sees the unsmoothed neighbors
+            std::vector<osg::Vec3> flat(numFaces);
+            for(unsigned i=0; i<numFaces; ++i)
+                flat[i] = (*normals)[elevptr + i*6];
+
+            for(unsigned i=0; i<numCorners; ++i)
+            {
+                unsigned j = (i+1) % numFaces;
+                const osg::Vec3& a = flat[i];
+                const osg::Vec3& b = flat[j];
+                if ( a*b >= cosSmoothThresh )
+                {
+                    osg::Vec3 n = a + b;
+                    n.normalize();
+                    unsigned r = elevptr + i*6, l = elevptr + j*6;
+                    (*normals)[r+2] = (*normals)[r+3] = (*normals)[r+4] = n;
+                    (*normals)[l+0] = (*normals)[l+1] = (*normals)[l+5] = n;
+                }
             }
         }
     }
+}
+
+
+bool
+ExtrudeGeometryFilter::buildWallGeometry(const Structure&     structure,
+                                         osg::Geometry*       walls,
+                                         const osg::Vec4&     wallColor,
+                                         const osg::Vec4&     wallBaseColor,
+                                         const SkinResource*  wallSkin)
+{
+    Arena arena;
+    appendWallGeometry(structure, arena, wallColor, wallBaseColor, wallSkin, false);
+
+    walls->setVertexArray( arena.verts.valid() ? arena.verts.get() : new osg::Vec3Array() );
+
+    if ( arena.texcoords.valid() )
+        walls->setTexCoordArray( 0, arena.texcoords.get() );
+
+    if ( arena.colors.valid() )
+        walls->setColorArray( arena.colors.get() );
+
+    if ( arena.anchors.valid() )
+        walls->setVertexAttribArray( Clamping::AnchorAttrLocation, arena.anchors.get() );
+
+    if ( !arena.indices.empty() )
+    {
+        unsigned numWallVerts = arena.size();
+
+        osg::DrawElements* de = 
+            numWallVerts > 0xFFFF ? (osg::DrawElements*) new osg::DrawElementsUInt  ( GL_TRIANGLES ) :
+            numWallVerts > 0xFF   ? (osg::DrawElements*) new osg::DrawElementsUShort( GL_TRIANGLES ) :
+                                    (osg::DrawElements*) new osg::DrawElementsUByte ( GL_TRIANGLES );
+
+        // pre-allocate for speed
+        de->reserveElements( arena.indices.size() );
+
+        for(std::vector<GLuint>::const_iterator i = arena.indices.begin(); i != arena.indices.end(); ++i)
+            de->addElement( *i );
+
+        walls->addPrimitiveSet( de );
+    }
     
     // generate per-vertex normals, altering the geometry as necessary to avoid
     // smoothing around sharp corners
@@ -696,7 +861,7 @@ ExtrudeGeometryFilter::buildWallGeometry(const Structure&     structure,
         *walls,
         osg::DegreesToRadians(_wallAngleThresh_deg) );
 
-    return madeGeom;
+    return true;
 }
 
 
@@ -996,7 +1161,19 @@ ExtrudeGeometryFilter::addDrawable(osg::Drawable*       drawable,
 bool
 ExtrudeGeometryFilter::process( FeatureList& features, FilterContext& context )
 {
-    for( FeatureList::iterator f = features.begin(); f != features.end(); ++f )
+    // When nothing can change the attributes or resolve variables per-feature
+    // (scripts), evaluate the height expression for all features at once.
+    std::vector<double> heights;
+    bool batchHeights =
+        !_heightCallback.valid() &&
+        _heightExpr.isSet() &&
+        !(_polySymbol.valid() && _polySymbol->script().isSet()) &&
+        !_extrusionSymbol->script().isSet() &&
+        !(context.getSession() && context.getSession()->getScriptEngine()) &&
+        Feature::evalBatch(_heightExpr.get(), features, heights);
+
+    unsigned featureIndex = 0;
+    for( FeatureList::iterator f = features.begin(); f != features.end(); ++f, ++featureIndex )
     {
         Feature* input = f->get();
 
@@ -1057,6 +1234,10 @@ ExtrudeGeometryFilter::process( FeatureList& features, FilterContext& context )
             {
                 height = _heightCallback->operator()(input, context);
             }
+            else if ( batchHeights )
+            {
+                height = heights[featureIndex];
+            }
             else if ( _heightExpr.isSet() )
             {
                 height = input->eval( _heightExpr.mutable_value(), &context );
@@ -1214,6 +1395,356 @@ ExtrudeGeometryFilter::process( FeatureList& features, FilterContext& context )
     return true;
 }
 
+void
+ExtrudeGeometryFilter::appendRoofGeometry(osg::Geometry* roof,
+                                          Arena&         arena)
+{
+    Arena temp;
+    temp.verts     = dynamic_cast<osg::Vec3Array*>( roof->getVertexArray() );
+    temp.normals   = dynamic_cast<osg::Vec3Array*>( roof->getNormalArray() );
+    temp.texcoords = dynamic_cast<osg::Vec3Array*>( roof->getTexCoordArray(0) );
+    temp.colors    = dynamic_cast<osg::Vec4Array*>( roof->getColorArray() );
+    temp.anchors   = dynamic_cast<osg::Vec4Array*>( roof->getVertexAttribArray(Clamping::AnchorAttrLocation) );
+
+    if ( temp.size() == 0 )
+        return;
+
+    // the tessellator may produce any kind of triangle primitive.
+    osg::TriangleIndexFunctor<CollectTriangles> collect;
+    collect._indices = &temp.indices;
+    roof->accept( collect );
+
+    arena.append( temp );
+}
+
+osg::Geometry*
+ExtrudeGeometryFilter::createGeometry(const Arena& arena) const
+{
+    osg::Geometry* geom = new osg::Geometry();
+    geom->setUseVertexBufferObjects(true);
+
+    geom->setVertexArray( arena.verts.get() );
+
+    if ( arena.normals.valid() )
+        geom->setNormalArray( arena.normals.get() );
+
+    if ( arena.texcoords.valid() )
+        geom->setTexCoordArray( 0, arena.texcoords.get() );
+
+    if ( arena.colors.valid() )
+        geom->setColorArray( arena.colors.get() );
+
+    if ( arena.anchors.valid() )
+        geom->setVertexAttribArray( Clamping::AnchorAttrLocation, arena.anchors.get() );
+
+    if ( arena.size() > 0xFFFF )
+    {
+        geom->addPrimitiveSet( new osg::DrawElementsUInt(GL_TRIANGLES, arena.indices.begin(), arena.indices.end()) );
+    }
+    else
+    {
+        osg::DrawElementsUShort* de = new osg::DrawElementsUShort(GL_TRIANGLES);
+        de->reserve( arena.indices.size() );
+        for(std::vector<GLuint>::const_iterator i = arena.indices.begin(); i != arena.indices.end(); ++i)
+            de->push_back( (GLushort)*i );
+        geom->addPrimitiveSet( de );
+    }
+
+    return geom;
+}
+
+bool
+ExtrudeGeometryFilter::canProcessInParallel(const FilterContext& context) const
+{
+    // Anything that needs a separate drawable per feature, or that runs
+    // scripts (which are not thread-safe), uses the serial path.
+    return
+        _numThreads > 0u &&
+        context.featureIndex() == 0L &&
+        _featureNameExpr.empty() &&
+        !_outlineSymbol.valid() &&
+        !_makeStencilVolume &&
+        !(_polySymbol.valid() && _polySymbol->script().isSet()) &&
+        !_extrusionSymbol->script().isSet() &&
+        !(context.getSession() && context.getSession()->getScriptEngine());
+}
+
+bool
+ExtrudeGeometryFilter::processInParallel( FeatureList& features, FilterContext& context )
+{
+    // A batch is all the geometry sharing one skin and state set;
+    // each one ends up in as few drawables as the vertex limit allows.
+    struct Batch
+    {
+        bool                        isRoof;
+        const SkinResource*         skin;
+        osg::ref_ptr<osg::StateSet> stateSet;
+    };
+
+    // One footprint to extrude.
+    struct Job
+    {
+        Geometry*           part;
+        float               height;
+        float               verticalOffset;
+        const SkinResource* wallSkin;
+        const SkinResource* roofSkin;
+        unsigned            wallBatch;
+        int                 roofBatch;
+        unsigned            numVerts;   // estimate
+    };
+
+    std::vector<Batch> batches;
+    std::vector<Job>   jobs;
+
+    std::vector<double> heights;
+    bool batchHeights =
+        !_heightCallback.valid() &&
+        _heightExpr.isSet() &&
+        Feature::evalBatch(_heightExpr.get(), features, heights);
+
+    // Serial pass: everything that touches shared state (expressions,
+    // resource libraries, the resource cache) happens here.
+    unsigned featureIndex = 0;
+    for( FeatureList::iterator f = features.begin(); f != features.end(); ++f, ++featureIndex )
+    {
+        Feature* input = f->get();
+        if ( input->getGeometry() == 0L )
+            continue;
+
+        float height;
+        if ( _heightCallback.valid() )
+            height = _heightCallback->operator()(input, context);
+        else if ( batchHeights )
+            height = heights[featureIndex];
+        else if ( _heightExpr.isSet() )
+            height = input->eval( _heightExpr.mutable_value(), &context );
+        else
+            height = *_extrusionSymbol->height();
+
+        SkinResource* wallSkin = 0L;
+        if ( _wallSkinSymbol.valid() && _wallResLib.valid() )
+        {
+            unsigned int wallRand = input->getFID() + *_wallSkinSymbol->randomSeed();
+            SkinSymbol querySymbol( *_wallSkinSymbol.get() );
+            querySymbol.objectHeight() = fabs(height);
+            wallSkin = _wallResLib->getSkin( &querySymbol, wallRand, context.getDBOptions() );
+        }
+
+        SkinResource* roofSkin = 0L;
+        if ( _roofSkinSymbol.valid() && _roofResLib.valid() )
+        {
+            unsigned int roofRand = input->getFID() + *_roofSkinSymbol->randomSeed();
+            SkinSymbol querySymbol( *_roofSkinSymbol.get() );
+            roofSkin = _roofResLib->getSkin( &querySymbol, roofRand, context.getDBOptions() );
+        }
+
+        float verticalOffset = (float)input->getDouble("__oe_verticalOffset", 0.0);
+
+        GeometryIterator iter( input->getGeometry(), false );
+        while( iter.hasMore() )
+        {
+            Geometry* part = iter.next();
+
+            Job job;
+            job.part           = part;
+            job.height         = height;
+            job.verticalOffset = verticalOffset;
+            job.wallSkin       = wallSkin;
+            job.roofSkin       = roofSkin;
+            job.roofBatch      = -1;
+            job.numVerts       = part->size() * 6;
+
+            bool isPolygon = part->getType() == Geometry::TYPE_POLYGON;
+            if ( isPolygon )
+            {
+                part->rewind(osgEarth::Geometry::ORIENTATION_CCW);
+                static_cast<Polygon*>(part)->open();
+                job.numVerts += part->size();
+            }
+
+            // find or create the batches for this job's skins:
+            for(int r = 0; r < (isPolygon ? 2 : 1); ++r)
+            {
+                bool isRoof = (r == 1);
+                const SkinResource* skin = isRoof ? roofSkin : wallSkin;
+
+                unsigned b;
+                for(b = 0; b < batches.size(); ++b)
+                {
+                    if ( batches[b].isRoof == isRoof && batches[b].skin == skin )
+                        break;
+                }
+
+                if ( b == batches.size() )
+                {
+                    Batch batch;
+                    batch.isRoof = isRoof;
+                    batch.skin   = skin;
+                    if ( skin )
+                    {
+                        context.resourceCache()->getOrCreateStateSet(const_cast<SkinResource*>(skin), batch.stateSet, context.getDBOptions());
+                    }
+                    batches.push_back( batch );
+                }
+
+                if ( isRoof )
+                    job.roofBatch = (int)b;
+                else
+                    job.wallBatch = b;
+            }
+
+            jobs.push_back( job );
+        }
+    }
+
+    if ( jobs.empty() )
+        return true;
+
+    osg::Vec4f wallColor(1,1,1,1), wallBaseColor(1,1,1,1), roofColor(1,1,1,1);
+
+    if ( _wallPolygonSymbol.valid() )
+        wallColor = _wallPolygonSymbol->fill()->color();
+
+    if ( _extrusionSymbol->wallGradientPercentage().isSet() )
+        wallBaseColor = Color(wallColor).brightness( 1.0 - *_extrusionSymbol->wallGradientPercentage() );
+    else
+        wallBaseColor = wallColor;
+
+    if ( _roofPolygonSymbol.valid() )
+        roofColor = _roofPolygonSymbol->fill()->color();
+
+    bool flatten = _extrusionSymbol->flatten().get();
+
+    unsigned maxVerts = Registry::instance()->getMaxNumberOfVertsPerDrawable();
+
+    // Partition the jobs into contiguous ranges of roughly equal vertex counts.
+    unsigned numPartitions = osg::minimum( _numThreads, (unsigned)jobs.size() );
+
+    double totalVerts = 0.0;
+    for(std::vector<Job>::const_iterator j = jobs.begin(); j != jobs.end(); ++j)
+        totalVerts += j->numVerts;
+
+    std::vector<unsigned> partitionStart( numPartitions+1, (unsigned)jobs.size() );
+    partitionStart[0] = 0;
+    {
+        double sum = 0.0;
+        unsigned p = 1;
+        for(unsigned j = 0; j < jobs.size() && p < numPartitions; ++j)
+        {
+            sum += jobs[j].numVerts;
+            if ( sum >= totalVerts * (double)p / (double)numPartitions )
+                partitionStart[p++] = j+1;
+        }
+        for( ; p < numPartitions; ++p)
+            partitionStart[p] = (unsigned)jobs.size();
+    }
+
+    // Per-partition output: for each batch, a list of arenas, each below the vertex limit.
+    typedef std::vector<Arena> Arenas;
+    std::vector< std::vector<Arenas> > output( numPartitions, std::vector<Arenas>(batches.size()) );
+
+    auto extrudeRange = [&](unsigned p)
+    {
+        std::vector<Arenas>& arenas = output[p];
+
+        // estimated number of vertices left per batch, for pre-sizing.
+        std::vector<unsigned> remaining( batches.size(), 0u );
+        for(unsigned j = partitionStart[p]; j < partitionStart[p+1]; ++j)
+        {
+            remaining[jobs[j].wallBatch] += jobs[j].part->size() * 6;
+            if ( jobs[j].roofBatch >= 0 )
+                remaining[jobs[j].roofBatch] += jobs[j].part->size();
+        }
+
+        auto getArena = [&](unsigned b, unsigned numVerts) -> Arena&
+        {
+            Arenas& list = arenas[b];
+            if ( list.empty() || (list.back().size() > 0 && list.back().size() + numVerts > maxVerts) )
+            {
+                list.push_back( Arena() );
+                Arena& arena = list.back();
+                unsigned reserve = osg::minimum( osg::maximum(remaining[b], numVerts), maxVerts );
+                arena.verts = new osg::Vec3Array();
+                arena.verts->reserve( reserve );
+                arena.normals = new osg::Vec3Array( osg::Array::BIND_PER_VERTEX );
+                arena.normals->reserve( reserve );
+                arena.indices.reserve( reserve );
+            }
+            remaining[b] -= osg::minimum( remaining[b], numVerts );
+            return list.back();
+        };
+
+        for(unsigned j = partitionStart[p]; j < partitionStart[p+1]; ++j)
+        {
+            const Job& job = jobs[j];
+
+            Structure structure;
+            buildStructure(
+                job.part,
+                job.height,
+                flatten,
+                job.verticalOffset,
+                job.wallSkin,
+                job.roofSkin,
+                structure,
+                context);
+
+            appendWallGeometry(
+                structure,
+                getArena(job.wallBatch, structure.getNumPoints()),
+                wallColor, wallBaseColor, job.wallSkin,
+                true);
+
+            if ( job.roofBatch >= 0 )
+            {
+                osg::ref_ptr<osg::Geometry> roof = new osg::Geometry();
+                buildRoofGeometry(structure, roof.get(), roofColor, job.roofSkin);
+                unsigned numRoofVerts = roof->getVertexArray() ? roof->getVertexArray()->getNumElements() : 0u;
+                appendRoofGeometry(roof.get(), getArena(job.roofBatch, numRoofVerts));
+            }
+        }
+    };
+
+    // One partition per thread, in the shared compute pool.
+    parallelFor( numPartitions, extrudeRange, numPartitions );
+
+    // Concatenate the arenas, in job order, into large shared-state geometries.
+    for(unsigned b = 0; b < batches.size(); ++b)
+    {
+        Arena merged;
+        for(unsigned p = 0; p < numPartitions; ++p)
+        {
+            Arenas& list = output[p][b];
+            for(Arenas::iterator a = list.begin(); a != list.end(); ++a)
+            {
+                if ( a->size() == 0 )
+                    continue;
+
+                if ( merged.size() > 0 && merged.size() + a->size() > maxVerts )
+                {
+                    addDrawable( createGeometry(merged), batches[b].stateSet.get(), "", 0L, 0L );
+                    merged = Arena();
+                }
+
+                if ( merged.size() == 0 )
+                    merged = *a;
+                else
+                    merged.append( *a );
+
+                *a = Arena();
+            }
+        }
+
+        if ( merged.size() > 0 )
+        {
+            addDrawable( createGeometry(merged), batches[b].stateSet.get(), "", 0L, 0L );
+        }
+    }
+
+    return true;
+}
+
 osg::Node*
 ExtrudeGeometryFilter::push( FeatureList& input, FilterContext& context )
 {
@@ -1262,7 +1793,9 @@ ExtrudeGeometryFilter::push( FeatureList& input, FilterContext& context )
     computeLocalizers( context );
 
     // push all the features through the extruder.
-    bool ok = process( input, context );
+    bool ok = canProcessInParallel( context ) ?
+        processInParallel( input, context ) :
+        process( input, context );
 
     // parent geometry with a delocalizer (if necessary)
     osg::Group* group = createDelocalizeGroup();
@@ -427,6 +427,42 @@ Feature::eval( NumericExpression& expr, FilterContext const* context ) const
     return expr.eval();
 }
 
+bool
+Feature::evalBatch(const NumericExpression& expr, const FeatureList& features, std::vector<double>& output)
+{
+    CompiledNumericExpression program;
+    if (!program.compile(expr))
+        return false;
+
+    const std::vector<std::string>& columns = program.getColumns();
+    unsigned count = features.size();
+
+    output.resize(count);
+    if (count == 0)
+        return true;
+
+    // gather each referenced attribute into its own column:
+    std::vector<std::vector<double> > values(columns.size(), std::vector<double>(count, 0.0));
+    unsigned row = 0;
+    for (FeatureList::const_iterator f = features.begin(); f != features.end(); ++f, ++row)
+    {
+        const AttributeTable& attrs = f->get()->getAttrs();
+        for (unsigned c = 0; c < columns.size(); ++c)
+        {
+            AttributeTable::const_iterator a = attrs.find(columns[c]);
+            if (a != attrs.end())
+                values[c][row] = a->second.getDouble(0.0);
+        }
+    }
+
+    std::vector<const double*> pointers(columns.size());
+    for (unsigned c = 0; c < columns.size(); ++c)
+        pointers[c] = &values[c][0];
+
+    program.eval(pointers.empty() ? 0L : &pointers[0], count, &output[0]);
+    return true;
+}
+
 double
 Feature::eval(NumericExpression& expr, Session* session) const
 {
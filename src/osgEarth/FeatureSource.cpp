@@ -18,6 +18,10 @@
  */
 #include <osgEarth/FeatureSource>
 #include <osgEarth/Filter>
+#include <osgEarth/FeatureTileCache>
+#include <osgEarth/Cache>
+#include <osgEarth/CacheBin>
+#include <osgEarth/CachePolicy>
 
 #define LC "[FeatureSource] " << getName() << ": "
 
@@ -37,6 +41,7 @@ FeatureSource::Options::getConfig() const
     conf.set( "geo_interpolation", "rhumb_line",   geoInterp(), GEOINTERP_RHUMB_LINE );
     conf.set( "fid_attribute", fidAttribute() );
     conf.set( "rewind_polygons", rewindPolygons());
+    conf.set( "tile_cache", tileCache() );
 
     if (!filters().empty())
     {
@@ -55,6 +60,7 @@ void
 FeatureSource::Options::fromConfig(const Config& conf)
 {
     _rewindPolygons.init(true);
+    _tileCache.init(false);
 
     conf.get( "open_write",   openWrite() );
     conf.get( "profile",      profile() );
@@ -62,6 +68,7 @@ FeatureSource::Options::fromConfig(const Config& conf)
     conf.get( "geo_interpolation", "rhumb_line",   geoInterp(), GEOINTERP_RHUMB_LINE );
     conf.get( "fid_attribute", fidAttribute() );
     conf.get( "rewind_polygons", rewindPolygons());
+    conf.get( "tile_cache", tileCache() );
 
     const Config& filtersConf = conf.child("filters");
     for(ConfigSet::const_iterator i = filtersConf.children().begin(); i != filtersConf.children().end(); ++i)
@@ -89,6 +96,7 @@ OE_LAYER_PROPERTY_IMPL(FeatureSource, bool, OpenWrite, openWrite);
 OE_LAYER_PROPERTY_IMPL(FeatureSource, GeoInterpolation, GeoInterpolation, geoInterp);
 OE_LAYER_PROPERTY_IMPL(FeatureSource, std::string, FIDAttribute, fidAttribute);
 OE_LAYER_PROPERTY_IMPL(FeatureSource, bool, RewindPolygons, rewindPolygons);
+OE_LAYER_PROPERTY_IMPL(FeatureSource, bool, TileCache, tileCache);
 
 void
 FeatureSource::init()
@@ -114,6 +122,13 @@ FeatureSource::openImplementation()
     return Status::NoError;
 }
 
+Status
+FeatureSource::closeImplementation()
+{
+    FeatureTileCache::instance()->remove(getUID());
+    return Layer::closeImplementation();
+}
+
 const Status&
 FeatureSource::create(
     const FeatureProfile* profile,
@@ -161,6 +176,9 @@ FeatureSource::removeFromBlacklist( FeatureID fid )
 {
     Threading::ScopedWriteLock exclusive( _blacklistMutex );
     _blacklist.erase( fid );
+
+    // cached tiles may be missing the features that were blacklisted
+    FeatureTileCache::instance()->remove(getUID());
 }
 
 void
@@ -168,6 +186,9 @@ FeatureSource::clearBlacklist()
 {
     Threading::ScopedWriteLock exclusive( _blacklistMutex );
     _blacklist.clear();
+
+    // cached tiles may be missing the features that were blacklisted
+    FeatureTileCache::instance()->remove(getUID());
 }
 
 bool
@@ -243,6 +264,119 @@ FeatureSource::createFeatureCursor(const TileKey& key, ProgressCallback* progres
 
 FeatureCursor*
 FeatureSource::createFeatureCursor(const TileKey& key, const Distance& buffer, ProgressCallback* progress)
+{
+    // Writable sources can change underneath the cache, so don't use it.
+    if (options().tileCache() == false || isWritable() || !key.valid())
+    {
+        return createTileFeatureCursor(key, buffer, progress);
+    }
+
+    // The cache bin belongs to this layer and outlives the process, so its
+    // key leaves out the UID; the memory cache is shared by all sources.
+    const std::string cacheKey = FeatureTileCache::makeKey(
+        key,
+        hashString(Stringify() << buffer.as(Units::METERS)));
+
+    const std::string memoryKey = Stringify() << getUID() << "/" << cacheKey;
+
+    FeatureList features;
+
+    // first the memory cache, then the cache bin, and finally the driver.
+    bool cached = FeatureTileCache::instance()->get(memoryKey, features);
+
+    if (!cached && readTileFromCacheBin(cacheKey, features))
+    {
+        FeatureTileCache::instance()->insert(memoryKey, getUID(), features);
+        cached = true;
+    }
+
+    if (!cached)
+    {
+        if (getCacheSettings() && getCacheSettings()->cachePolicy()->isCacheOnly())
+            return NULL;
+
+        osg::ref_ptr<FeatureCursor> cursor = createTileFeatureCursor(key, buffer, progress);
+        if (!cursor.valid())
+            return NULL;
+
+        cursor->fill(features);
+
+        // don't cache a partial result
+        if (progress && progress->isCanceled())
+            return new FeatureListCursor(features);
+
+        FeatureTileCache::instance()->insert(memoryKey, getUID(), features);
+        writeTileToCacheBin(cacheKey, features);
+    }
+
+    // The cached features are shared, so hand out copies, leaving out
+    // any features blacklisted since the tile was cached.
+    bool checkBlacklist;
+    {
+        Threading::ScopedReadLock shared(_blacklistMutex);
+        checkBlacklist = !_blacklist.empty();
+    }
+
+    FeatureList output;
+    for (FeatureList::const_iterator f = features.begin(); f != features.end(); ++f)
+    {
+        if (checkBlacklist && isBlacklisted(f->get()->getFID()))
+            continue;
+        output.push_back(osg::clone(f->get(), osg::CopyOp::DEEP_COPY_ALL));
+    }
+
+    return new FeatureListCursor(output);
+}
+
+bool
+FeatureSource::readTileFromCacheBin(const std::string& cacheKey, FeatureList& output)
+{
+    CacheSettings* cacheSettings = getCacheSettings();
+    if (!cacheSettings || !cacheSettings->isCacheEnabled() || !cacheSettings->cachePolicy()->isCacheReadable())
+        return false;
+
+    CacheBin* bin = cacheSettings->getCacheBin();
+    if (!bin)
+        return false;
+
+    ReadResult rr = bin->readString("features/" + cacheKey, getReadOptions());
+    if (rr.failed())
+        return false;
+
+    if (cacheSettings->cachePolicy()->isExpired(rr.lastModifiedTime()) &&
+        !cacheSettings->cachePolicy()->isCacheOnly())
+    {
+        return false;
+    }
+
+    return FeatureTileCache::decode(
+        rr.getString(),
+        _featureProfile.valid() ? _featureProfile->getSRS() : 0L,
+        _featureProfile.valid() ? _featureProfile->geoInterp() : optional<GeoInterpolation>(),
+        output);
+}
+
+void
+FeatureSource::writeTileToCacheBin(const std::string& cacheKey, const FeatureList& features)
+{
+    CacheSettings* cacheSettings = getCacheSettings();
+    if (!cacheSettings || !cacheSettings->isCacheEnabled() || !cacheSettings->cachePolicy()->isCacheWriteable())
+        return;
+
+    CacheBin* bin = cacheSettings->getCacheBin();
+    if (!bin)
+        return;
+
+    std::string buffer;
+    if (FeatureTileCache::encode(features, buffer))
+    {
+        osg::ref_ptr<StringObject> temp = new StringObject(buffer);
+        bin->write("features/" + cacheKey, temp.get(), getReadOptions());
+    }
+}
+
+FeatureCursor*
+FeatureSource::createTileFeatureCursor(const TileKey& key, const Distance& buffer, ProgressCallback* progress)
 {
     if (_featureProfile.valid())
     {
@@ -0,0 +1,548 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+ * Copyright 2020 Pelican Mapping
+ * http://osgearth.org
+ *
+ * osgEarth is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+#include <osgEarth/FeatureTileCache>
+#include <osgEarth/StringUtils>
+#include <cstring>
+#include <cstdlib>
+
+#define LC "[FeatureTileCache] "
+
+using namespace osgEarth;
+
+//...................................................................
+
+namespace
+{
+    // "OEFT" + format version
+    const char     MAGIC[4] = { 'O', 'E', 'F', 'T' };
+    const unsigned VERSION  = 1u;
+
+    // Rough per-object overheads used for the memory estimate
+    const size_t FEATURE_OVERHEAD   = 128u;
+    const size_t GEOMETRY_OVERHEAD  = 64u;
+    const size_t ATTRIBUTE_OVERHEAD = 96u;
+
+    size_t getGeometrySize(const Geometry* geom)
+    {
+        if (!geom)
+            return 0u;
+
+        size_t bytes = GEOMETRY_OVERHEAD + geom->capacity() * sizeof(osg::Vec3d);
+
+        if (geom->getType() == Geometry::TYPE_POLYGON)
+        {
+            const RingCollection& holes = static_cast<const Polygon*>(geom)->getHoles();
+            for (RingCollection::const_iterator i = holes.begin(); i != holes.end(); ++i)
+                bytes += getGeometrySize(i->get());
+        }
+        else if (geom->getType() == Geometry::TYPE_MULTI)
+        {
+            const GeometryCollection& parts = static_cast<const MultiGeometry*>(geom)->getComponents();
+            for (GeometryCollection::const_iterator i = parts.begin(); i != parts.end(); ++i)
+                bytes += getGeometrySize(i->get());
+        }
+        return bytes;
+    }
+
+    // Appends native-endian binary data to a string. The disk cache is
+    // specific to the machine that wrote it, so no byte swapping is needed.
+    struct Writer
+    {
+        std::string& _buf;
+        Writer(std::string& buf) : _buf(buf) { }
+
+        template<typename T> void write(const T& value)
+        {
+            _buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void writeString(const std::string& value)
+        {
+            write((unsigned)value.size());
+            _buf.append(value);
+        }
+
+        void writeGeometry(const Geometry* geom)
+        {
+            write((unsigned char)geom->getType());
+
+            write((unsigned)geom->size());
+            if (!geom->empty())
+                _buf.append(reinterpret_cast<const char*>(&geom->front()), geom->size() * sizeof(osg::Vec3d));
+
+            if (geom->getType() == Geometry::TYPE_POLYGON)
+            {
+                const RingCollection& holes = static_cast<const Polygon*>(geom)->getHoles();
+                write((unsigned)holes.size());
+                for (RingCollection::const_iterator i = holes.begin(); i != holes.end(); ++i)
+                    writeGeometry(i->get());
+            }
+            else if (geom->getType() == Geometry::TYPE_MULTI)
+            {
+                const GeometryCollection& parts = static_cast<const MultiGeometry*>(geom)->getComponents();
+                write((unsigned)parts.size());
+                for (GeometryCollection::const_iterator i = parts.begin(); i != parts.end(); ++i)
+                    writeGeometry(i->get());
+            }
+        }
+    };
+
+    // Reads the data written by Writer, checking bounds on every read.
+    struct Reader
+    {
+        const char* _ptr;
+        const char* _end;
+        bool        _ok;
+        Reader(const std::string& buf) : _ptr(buf.data()), _end(buf.data() + buf.size()), _ok(true) { }
+
+        bool has(size_t bytes)
+        {
+            if (_ok && (size_t)(_end - _ptr) < bytes)
+                _ok = false;
+            return _ok;
+        }
+
+        template<typename T> T read()
+        {
+            T value = T();
+            if (has(sizeof(T)))
+            {
+                ::memcpy(&value, _ptr, sizeof(T));
+                _ptr += sizeof(T);
+            }
+            return value;
+        }
+
+        std::string readString()
+        {
+            unsigned len = read<unsigned>();
+            if (!has(len))
+                return std::string();
+            std::string value(_ptr, len);
+            _ptr += len;
+            return value;
+        }
+
+        Geometry* readGeometry(unsigned depth =0u)
+        {
+            Geometry::Type type = (Geometry::Type)read<unsigned char>();
+            unsigned numPoints = read<unsigned>();
+            if (!has((size_t)numPoints * sizeof(osg::Vec3d)) || depth > 8u)
+            {
+                _ok = false;
+                return 0L;
+            }
+
+            osg::ref_ptr<Geometry> geom;
+            switch (type)
+            {
+            case Geometry::TYPE_POINT:      geom = new Point(); break;
+            case Geometry::TYPE_POINTSET:   geom = new PointSet(); break;
+            case Geometry::TYPE_LINESTRING: geom = new LineString(); break;
+            case Geometry::TYPE_RING:       geom = new Ring(); break;
+            case Geometry::TYPE_POLYGON:    geom = new Polygon(); break;
+            case Geometry::TYPE_MULTI:      geom = new MultiGeometry(); break;
+            default:
+                _ok = false;
+                return 0L;
+            }
+
+            if (numPoints > 0)
+            {
+                geom->resize(numPoints);
+                ::memcpy(&geom->front(), _ptr, numPoints * sizeof(osg::Vec3d));
+                _ptr += numPoints * sizeof(osg::Vec3d);
+            }
+
+            if (type == Geometry::TYPE_POLYGON)
+            {
+                Polygon* poly = static_cast<Polygon*>(geom.get());
+                unsigned numHoles = read<unsigned>();
+                for (unsigned i = 0; i < numHoles && _ok; ++i)
+                {
+                    osg::ref_ptr<Geometry> hole = readGeometry(depth + 1);
+                    Ring* ring = dynamic_cast<Ring*>(hole.get());
+                    if (ring)
+                        poly->getHoles().push_back(ring);
+                    else
+                        _ok = false;
+                }
+            }
+            else if (type == Geometry::TYPE_MULTI)
+            {
+                MultiGeometry* multi = static_cast<MultiGeometry*>(geom.get());
+                unsigned numParts = read<unsigned>();
+                for (unsigned i = 0; i < numParts && _ok; ++i)
+                {
+                    Geometry* part = readGeometry(depth + 1);
+                    if (part)
+                        multi->add(part);
+                }
+            }
+
+            return _ok ? geom.release() : 0L;
+        }
+    };
+}
+
+//...................................................................
+
+FeatureTileCache*
+FeatureTileCache::instance()
+{
+    static Threading::Mutex s_mutex;
+    static osg::ref_ptr<FeatureTileCache> s_instance;
+
+    Threading::ScopedMutexLock lock(s_mutex);
+    if (!s_instance.valid())
+    {
+        size_t maxBytes = 64u * 1024u * 1024u;
+
+        const char* value = ::getenv("OSGEARTH_FEATURE_TILE_CACHE_MB");
+        if (value)
+        {
+            maxBytes = (size_t)as<unsigned>(value, 64u) * 1024u * 1024u;
+            OE_INFO << LC << "Memory cache size set to " << (maxBytes / 1048576u) << "MB" << std::endl;
+        }
+
+        s_instance = new FeatureTileCache(maxBytes);
+    }
+    return s_instance.get();
+}
+
+FeatureTileCache::FeatureTileCache(size_t maxBytes) :
+_mutex("FeatureTileCache(OE)"),
+_bytes(0u),
+_maxBytes(maxBytes),
+_queries(0u),
+_hits(0u),
+_evictions(0u)
+{
+    //nop
+}
+
+void
+FeatureTileCache::setMaxBytes(size_t value)
+{
+    Threading::ScopedMutexLock lock(_mutex);
+    _maxBytes = value;
+    evict();
+}
+
+std::string
+FeatureTileCache::makeKey(const TileKey& key, unsigned queryHash)
+{
+    return Stringify()
+        << key.str() << "/"
+        << hashString(key.getProfile()->getHorizSignature()) << "/" << queryHash;
+}
+
+bool
+FeatureTileCache::get(const std::string& key, FeatureList& output)
+{
+    Threading::ScopedMutexLock lock(_mutex);
+
+    ++_queries;
+
+    std::unordered_map<std::string, LRU::iterator>::iterator i = _map.find(key);
+    if (i == _map.end())
+        return false;
+
+    ++_hits;
+
+    // move to the front of the LRU:
+    _lru.splice(_lru.begin(), _lru, i->second);
+
+    output.insert(output.end(), i->second->_features.begin(), i->second->_features.end());
+    return true;
+}
+
+void
+FeatureTileCache::insert(const std::string& key, UID source, const FeatureList& features)
+{
+    size_t bytes = key.size() + sizeof(Entry);
+    for (FeatureList::const_iterator f = features.begin(); f != features.end(); ++f)
+        bytes += getSizeInBytes(f->get());
+
+    Threading::ScopedMutexLock lock(_mutex);
+
+    std::unordered_map<std::string, LRU::iterator>::iterator i = _map.find(key);
+    if (i != _map.end())
+    {
+        erase(i->second);
+    }
+
+    // never let one tile flush the whole cache.
+    if (bytes > _maxBytes / 2u)
+        return;
+
+    _lru.push_front(Entry());
+    Entry& entry = _lru.front();
+    entry._key = key;
+    entry._source = source;
+    entry._features = features;
+    entry._bytes = bytes;
+
+    _map[key] = _lru.begin();
+    _bytes += bytes;
+
+    evict();
+}
+
+void
+FeatureTileCache::remove(UID source)
+{
+    Threading::ScopedMutexLock lock(_mutex);
+
+    for (LRU::iterator i = _lru.begin(); i != _lru.end(); )
+    {
+        LRU::iterator next = i;
+        ++next;
+        if (i->_source == source)
+            erase(i);
+        i = next;
+    }
+}
+
+void
+FeatureTileCache::clear()
+{
+    Threading::ScopedMutexLock lock(_mutex);
+    _lru.clear();
+    _map.clear();
+    _bytes = 0u;
+}
+
+FeatureTileCache::Stats
+FeatureTileCache::getStats() const
+{
+    Threading::ScopedMutexLock lock(_mutex);
+    Stats stats;
+    stats._entries = _map.size();
+    stats._bytes = _bytes;
+    stats._maxBytes = _maxBytes;
+    stats._queries = _queries;
+    stats._hits = _hits;
+    stats._evictions = _evictions;
+    return stats;
+}
+
+void
+FeatureTileCache::erase(LRU::iterator i)
+{
+    _bytes -= i->_bytes;
+    _map.erase(i->_key);
+    _lru.erase(i);
+}
+
+void
+FeatureTileCache::evict()
+{
+    while (_bytes > _maxBytes && !_lru.empty())
+    {
+        LRU::iterator last = _lru.end();
+        --last;
+        erase(last);
+        ++_evictions;
+    }
+}
+
+//...................................................................
+
+size_t
+FeatureTileCache::getSizeInBytes(const Feature* feature)
+{
+    if (!feature)
+        return 0u;
+
+    size_t bytes = FEATURE_OVERHEAD + getGeometrySize(feature->getGeometry());
+
+    const AttributeTable& attrs = feature->getAttrs();
+    for (AttributeTable::const_iterator a = attrs.begin(); a != attrs.end(); ++a)
+    {
+        bytes +=
+            ATTRIBUTE_OVERHEAD +
+            a->first.capacity() +
+            a->second.second.stringValue.capacity() +
+            a->second.second.doubleArrayValue.capacity() * sizeof(double);
+    }
+
+    return bytes;
+}
+
+bool
+FeatureTileCache::encode(const FeatureList& features, std::string& output)
+{
+    output.clear();
+    Writer out(output);
+
+    output.append(MAGIC, 4);
+    out.write(VERSION);
+    out.write((unsigned)features.size());
+
+    for (FeatureList::const_iterator f = features.begin(); f != features.end(); ++f)
+    {
+        const Feature* feature = f->get();
+
+        // embedded styles are not serializable here.
+        if (feature->style().isSet())
+            return false;
+
+        out.write(feature->getFID());
+
+        const AttributeTable& attrs = feature->getAttrs();
+        out.write((unsigned)attrs.size());
+        for (AttributeTable::const_iterator a = attrs.begin(); a != attrs.end(); ++a)
+        {
+            const AttributeValueUnion& value = a->second.second;
+
+            out.writeString(a->first);
+            out.write((unsigned char)a->second.first);
+            out.write((unsigned char)(value.set ? 1 : 0));
+
+            if (!value.set)
+                continue;
+
+            switch (a->second.first)
+            {
+            case ATTRTYPE_STRING:
+                out.writeString(value.stringValue);
+                break;
+            case ATTRTYPE_INT:
+                out.write(value.intValue);
+                break;
+            case ATTRTYPE_DOUBLE:
+                out.write(value.doubleValue);
+                break;
+            case ATTRTYPE_BOOL:
+                out.write((unsigned char)(value.boolValue ? 1 : 0));
+                break;
+            case ATTRTYPE_DOUBLEARRAY:
+                out.write((unsigned)value.doubleArrayValue.size());
+                if (!value.doubleArrayValue.empty())
+                    output.append(
+                        reinterpret_cast<const char*>(&value.doubleArrayValue.front()),
+                        value.doubleArrayValue.size() * sizeof(double));
+                break;
+            default:
+                break;
+            }
+        }
+
+        const Geometry* geom = feature->getGeometry();
+        out.write((unsigned char)(geom ? 1 : 0));
+        if (geom)
+            out.writeGeometry(geom);
+    }
+
+    return true;
+}
+
+bool
+FeatureTileCache::decode(const std::string& input,
+                         const SpatialReference* srs,
+                         const optional<GeoInterpolation>& geoInterp,
+                         FeatureList& output)
+{
+    if (input.size() < 12u || ::memcmp(input.data(), MAGIC, 4) != 0)
+        return false;
+
+    Reader in(input);
+    in._ptr += 4;
+
+    if (in.read<unsigned>() != VERSION)
+        return false;
+
+    unsigned count = in.read<unsigned>();
+
+    FeatureList features;
+    for (unsigned i = 0; i < count && in._ok; ++i)
+    {
+        FeatureID fid = in.read<FeatureID>();
+
+        osg::ref_ptr<Feature> feature = new Feature(0L, srs, Style(), fid);
+
+        unsigned numAttrs = in.read<unsigned>();
+        for (unsigned a = 0; a < numAttrs && in._ok; ++a)
+        {
+            std::string name = in.readString();
+            AttributeType type = (AttributeType)in.read<unsigned char>();
+            bool isSet = in.read<unsigned char>() != 0;
+
+            if (!isSet)
+            {
+                feature->setNull(name, type);
+                continue;
+            }
+
+            switch (type)
+            {
+            case ATTRTYPE_STRING:
+                feature->set(name, in.readString());
+                break;
+            case ATTRTYPE_INT:
+                feature->set(name, in.read<long long>());
+                break;
+            case ATTRTYPE_DOUBLE:
+                feature->set(name, in.read<double>());
+                break;
+            case ATTRTYPE_BOOL:
+                feature->set(name, in.read<unsigned char>() != 0);
+                break;
+            case ATTRTYPE_DOUBLEARRAY:
+            {
+                unsigned n = in.read<unsigned>();
+                std::vector<double> values;
+                if (in.has((size_t)n * sizeof(double)))
+                {
+                    values.resize(n);
+                    if (n > 0)
+                        ::memcpy(&values.front(), in._ptr, n * sizeof(double));
+                    in._ptr += n * sizeof(double);
+                }
+                feature->set(name, values);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        if (in.read<unsigned char>() != 0)
+        {
+            Geometry* geom = in.readGeometry();
+            if (geom)
+                feature->setGeometry(geom);
+        }
+
+        if (geoInterp.isSet())
+            feature->geoInterp() = geoInterp.get();
+
+        features.push_back(feature.get());
+    }
+
+    if (!in._ok)
+    {
+        OE_DEBUG << LC << "Invalid feature tile record" << std::endl;
+        return false;
+    }
+
+    output.insert(output.end(), features.begin(), features.end());
+    return true;
+}
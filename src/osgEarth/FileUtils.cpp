@@ -107,6 +107,8 @@
     #include <unistd.h>
     #include <sys/types.h>
     #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <fcntl.h>
 #endif
 
     // set up _S_ISDIR()
@@ -501,3 +503,98 @@ void CollectFilesVisitor::handleFile( const std::string& filename )
 	filenames.push_back( filename );        
 }
 
+/**************************************************/
+MemoryMappedFile::MemoryMappedFile() :
+    _data(0L),
+    _size(0u),
+    _handle(0L)
+{
+}
+
+MemoryMappedFile::MemoryMappedFile(const std::string& filename) :
+    _data(0L),
+    _size(0u),
+    _handle(0L)
+{
+    open(filename);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    close();
+}
+
+bool MemoryMappedFile::open(const std::string& filename)
+{
+    close();
+
+#if defined(WIN32) && !defined(__CYGWIN__)
+
+    HANDLE file = ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        ::CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = ::CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    ::CloseHandle(file);
+    if (mapping == NULL)
+        return false;
+
+    void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL)
+    {
+        ::CloseHandle(mapping);
+        return false;
+    }
+
+    _data = static_cast<const char*>(view);
+    _size = (std::size_t)size.QuadPart;
+    _handle = mapping;
+
+#else
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat buf;
+    if (::fstat(fd, &buf) != 0 || buf.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = ::mmap(NULL, (size_t)buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+        return false;
+
+    _data = static_cast<const char*>(view);
+    _size = (std::size_t)buf.st_size;
+
+#endif
+
+    return true;
+}
+
+void MemoryMappedFile::close()
+{
+    if (_data)
+    {
+#if defined(WIN32) && !defined(__CYGWIN__)
+        ::UnmapViewOfFile(_data);
+        ::CloseHandle((HANDLE)_handle);
+#else
+        ::munmap(const_cast<char*>(_data), _size);
+#endif
+    }
+    _data = 0L;
+    _size = 0u;
+    _handle = 0L;
+}
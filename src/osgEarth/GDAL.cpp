@@ -35,6 +35,8 @@
 #include <osgDB/ImageOptions>
 
 #include <sstream>
+#include <thread>
+#include <atomic>
 #include <stdlib.h>
 #include <memory.h>
 
@@ -380,6 +382,15 @@ namespace osgEarth { namespace GDAL
         }
     }
 
+#if GDAL_VERSION_2_0_OR_NEWER
+    // GDAL progress function that aborts a read when its task is canceled
+    int CPL_STDCALL rasterIOProgress(double, const char*, void* data)
+    {
+        ProgressCallback* progress = static_cast<ProgressCallback*>(data);
+        return progress->isCanceled() ? FALSE : TRUE;
+    }
+#endif
+
     // GDALRasterBand::RasterIO helper method
     bool rasterIO(GDALRasterBand *band,
         GDALRWFlag eRWFlag,
@@ -393,15 +404,40 @@ namespace osgEarth { namespace GDAL
         GDALDataType eBufType,
         GSpacing nPixelSpace,
         GSpacing nLineSpace,
-        RasterInterpolation interpolation = INTERP_NEAREST
+        RasterInterpolation interpolation = INTERP_NEAREST,
+        const double* floatWindow = 0L,
+        ProgressCallback* progress = 0L
         )
     {
+        if (progress && progress->isCanceled())
+        {
+            return false;
+        }
+
 #if GDAL_VERSION_2_0_OR_NEWER
         GDALRasterIOExtraArg psExtraArg;
 
         // defaults to GRIORA_NearestNeighbour
         INIT_RASTERIO_EXTRA_ARG(psExtraArg);
 
+        // lets GDAL abandon a long read (e.g. from a remote or warped
+        // dataset) partway through once the task is canceled
+        if (progress)
+        {
+            psExtraArg.pfnProgress = rasterIOProgress;
+            psExtraArg.pProgressData = progress;
+        }
+
+        // sub-pixel read window (xoff, yoff, xsize, ysize), e.g. when reading an overview
+        if (floatWindow)
+        {
+            psExtraArg.bFloatingPointWindowValidity = TRUE;
+            psExtraArg.dfXOff = floatWindow[0];
+            psExtraArg.dfYOff = floatWindow[1];
+            psExtraArg.dfXSize = floatWindow[2];
+            psExtraArg.dfYSize = floatWindow[3];
+        }
+
         switch(interpolation)
         {
             case INTERP_AVERAGE:
@@ -1021,6 +1057,201 @@ GDAL::Driver::getInterpolatedValue(GDALRasterBand* band, double x, double y, boo
     return result;
 }
 
+//...................................................................
+
+struct GDAL::OverviewCache::Level
+{
+    std::atomic_bool building;
+    std::atomic_bool built;
+    bool nearest;
+    int decimation;
+    int width, height;
+    std::vector<float> data;
+
+    Level(bool nearest_) : building(false), built(false), nearest(nearest_), decimation(1), width(0), height(0) { }
+
+    // Resamples a window (in full-resolution pixels) into a buffer, using
+    // the same sampling the level was built with
+    void read(int xOff, int yOff, int xSize, int ySize,
+              void* out, int bufXSize, int bufYSize,
+              GDALDataType bufType, GSpacing lineSpace) const
+    {
+        int typeSize = GDALGetDataTypeSize(bufType) / 8;
+        if (lineSpace == 0)
+            lineSpace = (GSpacing)bufXSize * typeSize;
+
+        double sx = (double)xSize / (double)bufXSize / (double)decimation;
+        double sy = (double)ySize / (double)bufYSize / (double)decimation;
+        double x0 = (double)xOff / (double)decimation;
+        double y0 = (double)yOff / (double)decimation;
+
+        for (int j = 0; j < bufYSize; ++j)
+        {
+            unsigned char* row = (unsigned char*)out + j * lineSpace;
+            double v = y0 + ((double)j + 0.5) * sy - 0.5;
+
+            for (int i = 0; i < bufXSize; ++i)
+            {
+                double u = x0 + ((double)i + 0.5) * sx - 0.5;
+                float value;
+
+                if (nearest)
+                {
+                    int c = osg::clampBetween((int)floor(u + 0.5), 0, width - 1);
+                    int r = osg::clampBetween((int)floor(v + 0.5), 0, height - 1);
+                    value = data[r * width + c];
+                }
+                else
+                {
+                    double cu = osg::clampBetween(u, 0.0, (double)(width - 1));
+                    double cv = osg::clampBetween(v, 0.0, (double)(height - 1));
+                    int c0 = (int)cu, r0 = (int)cv;
+                    int c1 = osg::minimum(c0 + 1, width - 1), r1 = osg::minimum(r0 + 1, height - 1);
+                    float fu = (float)(cu - c0), fv = (float)(cv - r0);
+                    float top = data[r0 * width + c0] * (1.0f - fu) + data[r0 * width + c1] * fu;
+                    float bottom = data[r1 * width + c0] * (1.0f - fu) + data[r1 * width + c1] * fu;
+                    value = top * (1.0f - fv) + bottom * fv;
+                    if (bufType != GDT_Float32 && bufType != GDT_Float64)
+                        value = floor(value + 0.5f);
+                }
+
+                GDALCopyWords(&value, GDT_Float32, 0, row + i * typeSize, bufType, 0, 1);
+            }
+        }
+    }
+};
+
+GDAL::OverviewCache::OverviewCache(unsigned maxSize) :
+    _maxSize(osg::maximum(maxSize, 16u)),
+    _mutex("OE.GDAL.OverviewCache")
+{
+    //nop
+}
+
+std::shared_ptr<const GDAL::OverviewCache::Level>
+GDAL::OverviewCache::get(GDALRasterBand* band, RasterInterpolation interpolation)
+{
+    int width = band->GetXSize();
+    int height = band->GetYSize();
+
+    // the smallest power-of-two reduction that fits; not worth it below 4x
+    int decimation = 1;
+    while (osg::maximum(width, height) / decimation > (int)_maxSize)
+        decimation *= 2;
+    if (decimation < 4)
+        return nullptr;
+
+    // nodata and coverage values must not be blended
+    int hasNoData = 0;
+    band->GetNoDataValue(&hasNoData);
+    bool nearest = interpolation == INTERP_NEAREST || hasNoData != 0;
+
+    std::shared_ptr<Level> level;
+    {
+        Threading::ScopedMutexLock lock(_mutex);
+        std::shared_ptr<Level>& entry = _levels[std::make_pair(band->GetBand(), nearest)];
+        if (!entry)
+            entry = std::make_shared<Level>(nearest);
+        level = entry;
+    }
+
+    // the first reader builds the level; the others read the source
+    // directly until it is ready instead of waiting on the full-band read
+    if (!level->built)
+    {
+        bool expected = false;
+        if (!level->building.compare_exchange_strong(expected, true))
+            return nullptr;
+
+        OE_PROFILING_ZONE_NAMED("GDAL in-memory overview");
+
+        level->decimation = decimation;
+        level->width = (width + decimation - 1) / decimation;
+        level->height = (height + decimation - 1) / decimation;
+        level->data.resize(level->width * level->height);
+
+        if (!rasterIO(band, GF_Read, 0, 0, width, height, &level->data[0], level->width, level->height, GDT_Float32, 0, 0,
+            nearest ? INTERP_NEAREST : INTERP_BILINEAR))
+        {
+            level->data.clear();
+        }
+        level->built = true;
+
+        OE_DEBUG << LC << "Built " << level->width << "x" << level->height << " in-memory overview of band " << band->GetBand() << std::endl;
+    }
+
+    return level->data.empty() ? nullptr : level;
+}
+
+bool
+GDAL::Driver::readBand(GDALRasterBand* band,
+                       int xOff, int yOff, int xSize, int ySize,
+                       void* data, int bufXSize, int bufYSize,
+                       int bufType, long long lineSpace,
+                       RasterInterpolation interpolation,
+                       ProgressCallback* progress)
+{
+    GDALDataType type = (GDALDataType)bufType;
+
+    // only downsampling reads can use a coarser level
+    if (_gdalOptions.useOverviews() == false || bufXSize >= xSize || bufYSize >= ySize)
+    {
+        return rasterIO(band, GF_Read, xOff, yOff, xSize, ySize, data, bufXSize, bufYSize, type, 0, lineSpace, interpolation, 0L, progress);
+    }
+
+    double factor = osg::minimum((double)xSize / (double)bufXSize, (double)ySize / (double)bufYSize);
+
+    // the coarsest overview that still has at least one pixel per buffer pixel
+    GDALRasterBand* best = band;
+    double bestDecimation = 1.0;
+    for (int i = 0; i < band->GetOverviewCount(); ++i)
+    {
+        GDALRasterBand* overview = band->GetOverview(i);
+        if (!overview || overview->GetXSize() <= 0)
+            continue;
+
+        double decimation = (double)band->GetXSize() / (double)overview->GetXSize();
+        if (decimation <= factor * 1.001 && decimation > bestDecimation)
+        {
+            best = overview;
+            bestDecimation = decimation;
+        }
+    }
+
+    // large source without a useful overview: use (or build) one in memory
+    if (_overviewCache.valid() && factor >= 4.0)
+    {
+        std::shared_ptr<const OverviewCache::Level> level = _overviewCache->get(band, interpolation);
+        if (level && (double)level->decimation <= factor && (double)level->decimation > bestDecimation)
+        {
+            level->read(xOff, yOff, xSize, ySize, data, bufXSize, bufYSize, type, lineSpace);
+            return true;
+        }
+    }
+
+    if (best == band)
+    {
+        return rasterIO(band, GF_Read, xOff, yOff, xSize, ySize, data, bufXSize, bufYSize, type, 0, lineSpace, interpolation, 0L, progress);
+    }
+
+    // map the window into the overview's pixels
+    double sx = (double)best->GetXSize() / (double)band->GetXSize();
+    double sy = (double)best->GetYSize() / (double)band->GetYSize();
+    double window[4] = { xOff * sx, yOff * sy, xSize * sx, ySize * sy };
+
+    int ox0 = osg::clampBetween((int)floor(window[0]), 0, best->GetXSize() - 1);
+    int oy0 = osg::clampBetween((int)floor(window[1]), 0, best->GetYSize() - 1);
+    int ox1 = osg::clampBetween((int)ceil(window[0] + window[2]), ox0 + 1, best->GetXSize());
+    int oy1 = osg::clampBetween((int)ceil(window[1] + window[3]), oy0 + 1, best->GetYSize());
+
+    window[0] = osg::clampBetween(window[0], (double)ox0, (double)ox1);
+    window[1] = osg::clampBetween(window[1], (double)oy0, (double)oy1);
+    window[2] = osg::minimum(window[2], (double)ox1 - window[0]);
+    window[3] = osg::minimum(window[3], (double)oy1 - window[1]);
+
+    return rasterIO(best, GF_Read, ox0, oy0, ox1 - ox0, oy1 - oy0, data, bufXSize, bufYSize, type, 0, lineSpace, interpolation, window, progress);
+}
+
 bool
 GDAL::Driver::intersects(const TileKey& key)
 {
@@ -1044,6 +1275,7 @@ GDAL::Driver::createImage(const TileKey& key,
 
     if (progress && progress->isCanceled())
     {
+        progress->recordCancelation("gdal");
         return NULL;
     }
 
@@ -1204,13 +1436,13 @@ GDAL::Driver::createImage(const TileKey& key,
         image->allocateImage(tileSize, tileSize, 1, pixelFormat, GL_UNSIGNED_BYTE);
         memset(image->data(), 0, image->getImageSizeInBytes());
 
-        rasterIO(bandRed, GF_Read, off_x, off_y, width, height, red, target_width, target_height, GDT_Byte, 0, 0, gdalOptions().interpolation().get());
-        rasterIO(bandGreen, GF_Read, off_x, off_y, width, height, green, target_width, target_height, GDT_Byte, 0, 0, gdalOptions().interpolation().get());
-        rasterIO(bandBlue, GF_Read, off_x, off_y, width, height, blue, target_width, target_height, GDT_Byte, 0, 0, gdalOptions().interpolation().get());
+        readBand(bandRed, off_x, off_y, width, height, red, target_width, target_height, GDT_Byte, 0, gdalOptions().interpolation().get(), progress);
+        readBand(bandGreen, off_x, off_y, width, height, green, target_width, target_height, GDT_Byte, 0, gdalOptions().interpolation().get(), progress);
+        readBand(bandBlue, off_x, off_y, width, height, blue, target_width, target_height, GDT_Byte, 0, gdalOptions().interpolation().get(), progress);
 
         if (bandAlpha)
         {
-            rasterIO(bandAlpha, GF_Read, off_x, off_y, width, height, alpha, target_width, target_height, GDT_Byte, 0, 0, gdalOptions().interpolation().get());
+            readBand(bandAlpha, off_x, off_y, width, height, alpha, target_width, target_height, GDT_Byte, 0, gdalOptions().interpolation().get(), progress);
         }
 
         for (int src_row = 0, dst_row = tile_offset_top;
@@ -1275,7 +1507,7 @@ GDAL::Driver::createImage(const TileKey& key,
             if (!success)
                 nodata = NO_DATA_VALUE; //getNoDataValue(); //getOptions().noDataValue().get();
 
-            if (rasterIO(bandGray, GF_Read, off_x, off_y, width, height, data, target_width, target_height, gdalDataType, 0, 0, INTERP_NEAREST))
+            if (readBand(bandGray, off_x, off_y, width, height, data, target_width, target_height, gdalDataType, 0, INTERP_NEAREST, progress))
             {
                 // copy from data to image.
                 for (int src_row = 0, dst_row = tile_offset_top; src_row < target_height; src_row++, dst_row++)
@@ -1321,11 +1553,11 @@ GDAL::Driver::createImage(const TileKey& key,
             memset(image->data(), 0, image->getImageSizeInBytes());
 
 
-            rasterIO(bandGray, GF_Read, off_x, off_y, width, height, gray, target_width, target_height, GDT_Byte, 0, 0, gdalOptions().interpolation().get());
+            readBand(bandGray, off_x, off_y, width, height, gray, target_width, target_height, GDT_Byte, 0, gdalOptions().interpolation().get(), progress);
 
             if (bandAlpha)
             {
-                rasterIO(bandAlpha, GF_Read, off_x, off_y, width, height, alpha, target_width, target_height, GDT_Byte, 0, 0, gdalOptions().interpolation().get());
+                readBand(bandAlpha, off_x, off_y, width, height, alpha, target_width, target_height, GDT_Byte, 0, gdalOptions().interpolation().get(), progress);
             }
 
             for (int src_row = 0, dst_row = tile_offset_top;
@@ -1378,7 +1610,7 @@ GDAL::Driver::createImage(const TileKey& key,
             memset(image->data(), 0, image->getImageSizeInBytes());
         }
 
-        rasterIO(bandPalette, GF_Read, off_x, off_y, width, height, palette, target_width, target_height, GDT_Byte, 0, 0, INTERP_NEAREST);
+        readBand(bandPalette, off_x, off_y, width, height, palette, target_width, target_height, GDT_Byte, 0, INTERP_NEAREST, progress);
 
         ImageUtils::PixelWriter write(image.get());
 
@@ -1450,6 +1682,13 @@ GDAL::Driver::createImage(const TileKey& key,
         return NULL;
     }
 
+    // a read interrupted by cancelation leaves the image incomplete
+    if (progress && progress->isCanceled())
+    {
+        progress->recordCancelation("gdal");
+        return NULL;
+    }
+
     return image.release();
 }
 
@@ -1516,7 +1755,7 @@ GDAL::Driver::createHeightField(const TileKey& key,
             int startOffset = iBufRowMin * tileSize + iBufColMin;
             int lineSpace = tileSize * sizeof(float);
 
-            rasterIO(band, GF_Read, iWinColMin, iWinRowMin, iNumWinCols, iNumWinRows, &buffer[startOffset], iNumBufCols, iNumBufRows, GDT_Float32, 0, lineSpace);
+            readBand(band, iWinColMin, iWinRowMin, iNumWinCols, iNumWinRows, &buffer[startOffset], iNumBufCols, iNumBufRows, GDT_Float32, lineSpace, INTERP_NEAREST, progress);
 
             for (unsigned r = 0, ir = tileSize - 1; r < tileSize; ++r, --ir)
             {
@@ -1547,6 +1786,14 @@ GDAL::Driver::createHeightField(const TileKey& key,
         std::vector<float>& heightList = hf->getHeightList();
         std::fill(heightList.begin(), heightList.end(), NO_DATA_VALUE);
     }
+
+    // a read interrupted by cancelation leaves the heightfield incomplete
+    if (progress && progress->isCanceled())
+    {
+        progress->recordCancelation("gdal");
+        return NULL;
+    }
+
     return hf.release();
 }
 
@@ -1648,7 +1895,7 @@ GDAL::Driver::createHeightFieldWithVRT(const TileKey& key,
             heights[i] = NO_DATA_VALUE;
         }
         GDALRasterBand* band = static_cast<GDALRasterBand*>(GDALGetRasterBand(tileDS, 1));
-        band->RasterIO(GF_Read, 0, 0, tileSize, tileSize, heights, tileSize, tileSize, GDT_Float32, 0, 0);
+        rasterIO(band, GF_Read, 0, 0, tileSize, tileSize, heights, tileSize, tileSize, GDT_Float32, 0, 0, INTERP_NEAREST, 0L, progress);
 
         hf = new osg::HeightField();
         hf->allocate(tileSize, tileSize);
@@ -1682,6 +1929,13 @@ GDAL::Driver::createHeightFieldWithVRT(const TileKey& key,
 
         // Note:  The transformer is closed in the warped dataset so we don't need to free it ourselves.
     }
+
+    if (progress && progress->isCanceled())
+    {
+        progress->recordCancelation("gdal");
+        return NULL;
+    }
+
     return hf.release();
 }
 //...................................................................
@@ -1698,6 +1952,8 @@ GDAL::Options::readFrom(const Config& conf)
     _useVRT.init(false);
     coverageUsesPaletteIndex().setDefault(true);
     singleThreaded().setDefault(false);
+    useOverviews().setDefault(true);
+    inMemoryOverviewSize().setDefault(0u);
 
     conf.get("url", _url);
     conf.get("connection", _connection);
@@ -1711,6 +1967,8 @@ GDAL::Options::readFrom(const Config& conf)
     conf.get("interpolation", "cubicspline", _interpolation, osgEarth::INTERP_CUBICSPLINE);
     conf.get("coverage_uses_palette_index", coverageUsesPaletteIndex());
     conf.get("single_threaded", singleThreaded());
+    conf.get("use_overviews", useOverviews());
+    conf.get("in_memory_overview_size", inMemoryOverviewSize());
 }
 
 void
@@ -1728,6 +1986,56 @@ GDAL::Options::writeTo(Config& conf) const
     conf.set("interpolation", "cubicspline", _interpolation, osgEarth::INTERP_CUBICSPLINE);
     conf.set("coverage_uses_palette_index", coverageUsesPaletteIndex());
     conf.set("single_threaded", singleThreaded());
+    conf.set("use_overviews", useOverviews());
+    conf.set("in_memory_overview_size", inMemoryOverviewSize());
+}
+
+//......................................................................
+
+GDAL::DriverPool::DriverPool() :
+    _mutex("OE.GDAL.DriverPool")
+{
+    //nop
+}
+
+osg::ref_ptr<GDAL::Driver>
+GDAL::DriverPool::acquire()
+{
+    Threading::ScopedMutexLock lock(_mutex);
+    if (_idle.empty())
+        return nullptr;
+
+    osg::ref_ptr<Driver> driver = _idle.back();
+    _idle.pop_back();
+    return driver;
+}
+
+void
+GDAL::DriverPool::release(Driver* driver)
+{
+    if (driver)
+    {
+        Threading::ScopedMutexLock lock(_mutex);
+        _idle.push_back(driver);
+    }
+}
+
+void
+GDAL::DriverPool::clear()
+{
+    std::vector< osg::ref_ptr<Driver> > idle;
+    {
+        Threading::ScopedMutexLock lock(_mutex);
+        idle.swap(_idle);
+    }
+    // drivers close their datasets outside the lock
+}
+
+unsigned
+GDAL::DriverPool::getNumIdle() const
+{
+    Threading::ScopedMutexLock lock(_mutex);
+    return _idle.size();
 }
 
 //......................................................................
@@ -1735,7 +2043,7 @@ GDAL::Options::writeTo(Config& conf) const
 namespace
 {
     template<typename T>
-    Status openOnThisThread(
+    Status openDriver(
         const T* layer,
         osg::ref_ptr<GDAL::Driver>& driver, 
         osg::ref_ptr<const Profile>* out_profile,
@@ -1765,6 +2073,8 @@ namespace
             driver->setOverrideProfile(layer->overrideProfile().get());
         }
 
+        driver->setOverviewCache(layer->overviewCache().get());
+
         Status status = driver->open(
             layer->getName(),
             layer->options(),
@@ -1773,7 +2083,10 @@ namespace
             layer->getReadOptions());
 
         if (status.isError())
+        {
+            driver = nullptr;
             return status;
+        }
 
         if (driver->getProfile() && out_profile)
         {
@@ -1782,6 +2095,53 @@ namespace
 
         return Status::NoError;
     }
+
+    /**
+     * Checks a driver out of a layer's pool for the duration of one read,
+     * opening a new one if none is idle. Holds the layer's reader count so
+     * that closing the layer waits for the read to finish.
+     */
+    template<typename T>
+    struct DriverLease
+    {
+        GDAL::DriverPool& _pool;
+        std::atomic_int& _readers;
+        osg::ref_ptr<GDAL::Driver> _driver;
+
+        DriverLease(const T* layer, GDAL::DriverPool& pool, std::atomic_int& readers, const std::atomic<bool>& closing) :
+            _pool(pool),
+            _readers(readers)
+        {
+            ++_readers;
+            if (closing)
+                return;
+
+            _driver = _pool.acquire();
+            if (!_driver.valid())
+            {
+                // calling openDriver with NULL params limits the setup
+                // since we already called this during openImplementation
+                openDriver(layer, _driver, nullptr, nullptr, nullptr);
+            }
+        }
+
+        ~DriverLease()
+        {
+            if (_driver.valid())
+                _pool.release(_driver.get());
+            --_readers;
+        }
+    };
+
+    //! Stops new reads and waits for the ones in progress to return their drivers
+    void drainReaders(std::atomic<bool>& closing, std::atomic_int& readers)
+    {
+        closing = true;
+        while (readers > 0)
+        {
+            std::this_thread::yield();
+        }
+    }
 }
 
 //......................................................................
@@ -1819,7 +2179,6 @@ GDALImageLayer::init()
 {
     // Initialize the image layer (always first)
     ImageLayer::init();
-    _driverPerThread.setName("OE.GDALImageLayer");
 }
 
 Status
@@ -1829,25 +2188,21 @@ GDALImageLayer::openImplementation()
     if (parent.isError())
         return parent;
 
-    osg::ref_ptr<GDAL::Driver>* driver;
+    _closing = false;
 
-    if (getSingleThreaded())
-    {
-        driver = &_sharedDriver;
-    }
-    else
-    {
-        // GDAL thread-safety requirement: each thread requires a separate GDALDataSet.
-        // So we just encapsulate the entire setup once per thread.
-        // https://trac.osgeo.org/gdal/wiki/FAQMiscellaneous#IstheGDALlibrarythread-safe
-        driver = &_driverPerThread.get();
-    }
+    if (options().useOverviews() == true && options().inMemoryOverviewSize().get() > 0u)
+        _overviewCache = new GDAL::OverviewCache(options().inMemoryOverviewSize().get());
 
+    // GDAL thread-safety requirement: each thread requires a separate GDALDataSet.
+    // So each concurrent read checks a driver out of the pool; the first one is
+    // opened here to discover the profile and data extents.
+    // https://trac.osgeo.org/gdal/wiki/FAQMiscellaneous#IstheGDALlibrarythread-safe
+    osg::ref_ptr<GDAL::Driver> driver;
     osg::ref_ptr<const Profile> profile;
 
-    Status s = openOnThisThread(
+    Status s = openDriver(
         this,
-        *driver,
+        driver,
         &profile,
         &_overrideProfile,
         &dataExtents());
@@ -1855,6 +2210,11 @@ GDALImageLayer::openImplementation()
     if (s.isError())
         return s;
 
+    if (getSingleThreaded())
+        _sharedDriver = driver;
+    else
+        _driverPool.release(driver.get());
+
     if (profile.valid())
         setProfile(profile.get());
 
@@ -1866,14 +2226,16 @@ GDALImageLayer::closeImplementation()
 {
     if (_sharedDriver.valid())
     {
+        Threading::ScopedMutexLock lock(_singleThreadedMutex);
         _sharedDriver = nullptr;
     }
     else
     {
-        // safely shut down all per-thread handles.
-        Threading::ScopedWriteLock exclusive(_workers);
-        _driverPerThread.clear();
+        // safely shut down all pooled handles.
+        drainReaders(_closing, _readers);
+        _driverPool.clear();
     }
+    _overviewCache = nullptr;
     dataExtents().clear();
     setProfile(NULL); // must do this to support override profiles
     return ImageLayer::closeImplementation();
@@ -1885,59 +2247,35 @@ GDALImageLayer::createImageImplementation(const TileKey& key, ProgressCallback*
     if (getStatus().isError())
         return GeoImage::INVALID;
 
-    osg::ref_ptr<GDAL::Driver>* driver = nullptr;
+    OE_PROFILING_ZONE;
+
+    osg::ref_ptr<osg::Image> image;
+
     if (getSingleThreaded())
     {
-        driver = &_sharedDriver;
-        _singleThreadedMutex.lock();
-        if (isClosing())
-        {
-            _singleThreadedMutex.unlock();
+        Threading::ScopedMutexLock lock(_singleThreadedMutex);
+        if (isClosing() || !_sharedDriver.valid())
             return GeoImage::INVALID;
-        }
+
+        image = _sharedDriver->createImage(
+            key,
+            options().tileSize().get(),
+            options().coverage() == true,
+            progress);
     }
     else
     {
-        driver = &_driverPerThread.get();
-        _workers.read_lock();
-        if (isClosing())
-        {
-            _workers.read_unlock();
+        DriverLease<GDALImageLayer> lease(this, _driverPool, _readers, _closing);
+        if (!lease._driver.valid())
             return GeoImage::INVALID;
-        }
-        if (!driver->valid())
-        {
-            // calling openImpl with NULL params limits the setup
-            // since we already called this during openImplementation
-            openOnThisThread(
-                this, 
-                *driver, 
-                nullptr, 
-                nullptr,
-                nullptr);
-        }
-    }
-
-    if (!driver->get())
-        return GeoImage::INVALID;
-
-    OE_PROFILING_ZONE;
 
-    osg::ref_ptr<osg::Image> image;
-    if (driver->valid())
-    {
-        image = driver->get()->createImage(
+        image = lease._driver->createImage(
             key,
             options().tileSize().get(),
             options().coverage() == true,
             progress);
     }
 
-    if (getSingleThreaded())
-        _singleThreadedMutex.unlock();
-    else
-        _workers.read_unlock();
-
     return GeoImage(image.get(), key.getExtent());
 }
 
@@ -1982,7 +2320,6 @@ void
 GDALElevationLayer::init()
 {
     ElevationLayer::init();
-    _driverPerThread.setName("OE.GDALElevationLayer");
 }
 
 Status
@@ -1992,25 +2329,21 @@ GDALElevationLayer::openImplementation()
     if (parent.isError())
         return parent;
 
-    osg::ref_ptr<GDAL::Driver>* driver;
+    _closing = false;
 
-    if (getSingleThreaded())
-    {
-        driver = &_sharedDriver;
-    }
-    else
-    {
-        // GDAL thread-safety requirement: each thread requires a separate GDALDataSet.
-        // So we just encapsulate the entire setup once per thread.
-        // https://trac.osgeo.org/gdal/wiki/FAQMiscellaneous#IstheGDALlibrarythread-safe
-        driver = &_driverPerThread.get();
-    }
+    if (options().useOverviews() == true && options().inMemoryOverviewSize().get() > 0u)
+        _overviewCache = new GDAL::OverviewCache(options().inMemoryOverviewSize().get());
 
+    // GDAL thread-safety requirement: each thread requires a separate GDALDataSet.
+    // So each concurrent read checks a driver out of the pool; the first one is
+    // opened here to discover the profile and data extents.
+    // https://trac.osgeo.org/gdal/wiki/FAQMiscellaneous#IstheGDALlibrarythread-safe
+    osg::ref_ptr<GDAL::Driver> driver;
     osg::ref_ptr<const Profile> profile;
 
-    Status s = openOnThisThread(
+    Status s = openDriver(
         this,
-        *driver,
+        driver,
         &profile,
         &_overrideProfile,
         &dataExtents());
@@ -2018,6 +2351,11 @@ GDALElevationLayer::openImplementation()
     if (s.isError())
         return s;
 
+    if (getSingleThreaded())
+        _sharedDriver = driver;
+    else
+        _driverPool.release(driver.get());
+
     if (profile.valid())
         setProfile(profile.get());
 
@@ -2029,14 +2367,16 @@ GDALElevationLayer::closeImplementation()
 {
     if (_sharedDriver.valid())
     {
+        Threading::ScopedMutexLock lock(_singleThreadedMutex);
         _sharedDriver = nullptr;
     }
     else
     {
-        // safely shut down all per-thread handles.
-        Threading::ScopedWriteLock exclusive(_workers);
-        _driverPerThread.clear();
+        // safely shut down all pooled handles.
+        drainReaders(_closing, _readers);
+        _driverPool.clear();
     }
+    _overviewCache = nullptr;
     dataExtents().clear();
     setProfile(NULL); // must do this to support override profiles
 
@@ -2049,63 +2389,33 @@ GDALElevationLayer::createHeightFieldImplementation(const TileKey& key, Progress
     if (getStatus().isError())
         return GeoHeightField::INVALID;
 
-    osg::ref_ptr<GDAL::Driver>* driver = nullptr;
+    auto read = [&](GDAL::Driver* driver) -> osg::HeightField*
+    {
+        if (*_options->useVRT())
+            return driver->createHeightFieldWithVRT(key, options().tileSize().get(), progress);
+        else
+            return driver->createHeightField(key, options().tileSize().get(), progress);
+    };
+
+    osg::ref_ptr<osg::HeightField> heightfield;
+
     if (getSingleThreaded())
     {
-        driver = &_sharedDriver;
-        _singleThreadedMutex.lock();
-        if (isClosing())
-        {
-            _singleThreadedMutex.unlock();
+        Threading::ScopedMutexLock lock(_singleThreadedMutex);
+        if (isClosing() || !_sharedDriver.valid())
             return GeoHeightField::INVALID;
-        }
+
+        heightfield = read(_sharedDriver.get());
     }
     else
     {
-        driver = &_driverPerThread.get();
-        _workers.read_lock();
-        if (isClosing())
-        {
-            _workers.read_unlock();
+        DriverLease<GDALElevationLayer> lease(this, _driverPool, _readers, _closing);
+        if (!lease._driver.valid())
             return GeoHeightField::INVALID;
-        }
-        if (!driver->valid())
-        {
-            // calling openImpl with NULL params limits the setup
-            // since we already called this during openImplementation
-            openOnThisThread(
-                this, 
-                *driver, 
-                nullptr, 
-                nullptr,
-                nullptr);
-        }
-    }
 
-    osg::ref_ptr<osg::HeightField> heightfield;
-    if (driver)
-    {
-        if (*_options->useVRT())
-        {
-            heightfield = driver->get()->createHeightFieldWithVRT(
-                key,
-                options().tileSize().get(),
-                progress);
-        }
-        else
-        {
-            heightfield = driver->get()->createHeightField(
-                key,
-                options().tileSize().get(),
-                progress);
-        }
+        heightfield = read(lease._driver.get());
     }
 
-    if (getSingleThreaded())
-        _singleThreadedMutex.unlock();
-    else
-        _workers.read_unlock();
-
     return GeoHeightField(heightfield.get(), key.getExtent());
 }
 
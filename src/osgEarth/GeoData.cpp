@@ -20,6 +20,7 @@
 #include <osgEarth/GeoData>
 #include <osgEarth/GeoMath>
 #include <osgEarth/HeightFieldUtils>
+#include <osgEarth/ImagePool>
 #include <osgEarth/Registry>
 #include <osgEarth/Terrain>
 #include <osgEarth/GDAL>
@@ -1871,7 +1872,7 @@ namespace
             height = osg::minimum(image->s(), image->t());
         }
 
-        osg::Image *result = new osg::Image();
+        osg::Image *result = new Util::PooledImage();
         //result->allocateImage(width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE);
         result->allocateImage(width, height, image->r(), image->getPixelFormat(), image->getDataType()); //GL_UNSIGNED_BYTE);
         result->setInternalTextureFormat(image->getInternalTextureFormat());
@@ -0,0 +1,1074 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+* Copyright 2020 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#include <osgEarth/GeoJSONReader>
+#include <osgEarth/Geometry>
+#include <osgEarth/StringUtils>
+#include <osgEarth/Metrics>
+
+#include <rapidjson/reader.h>
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/istreamwrapper.h>
+#include <rapidjson/error/en.h>
+
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <map>
+
+#define LC "[GeoJSONReader] "
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+namespace
+{
+    // size of the read-ahead buffer between the stream and the parser
+    const size_t STREAM_BUFFER_SIZE = 64 * 1024;
+
+    // how often (in tokens) to poll the progress callback
+    const unsigned CANCEL_CHECK_INTERVAL = 4096;
+
+    bool intersects(const Bounds& a, const Bounds& b)
+    {
+        return
+            a.xMin() <= b.xMax() && a.xMax() >= b.xMin() &&
+            a.yMin() <= b.yMax() && a.yMax() >= b.yMin();
+    }
+
+    AttributeValue makeNull()
+    {
+        AttributeValue v;
+        v.first = ATTRTYPE_UNSPECIFIED;
+        v.second.doubleValue = 0.0;
+        v.second.intValue = 0;
+        v.second.boolValue = false;
+        v.second.set = false;
+        return v;
+    }
+
+    /**
+     * Reads GeoJSON "coordinates" that were recorded as a flat token
+     * stream ('[' and ']' for arrays, 'n' for numbers). We have to record
+     * them because the geometry "type" member may follow the coordinates.
+     */
+    struct CoordinateReader
+    {
+        const std::vector<char>& _ops;
+        const std::vector<double>& _nums;
+        size_t _op, _num;
+        bool _ok;
+
+        CoordinateReader(const std::vector<char>& ops, const std::vector<double>& nums) :
+            _ops(ops), _nums(nums), _op(0), _num(0), _ok(true) { }
+
+        bool begin()
+        {
+            if (_ok && _op < _ops.size() && _ops[_op] == '[') { ++_op; return true; }
+            _ok = false;
+            return false;
+        }
+
+        bool atEnd() const
+        {
+            return !_ok || _op >= _ops.size() || _ops[_op] == ']';
+        }
+
+        void end()
+        {
+            if (_op < _ops.size() && _ops[_op] == ']') ++_op;
+            else _ok = false;
+        }
+
+        bool position(osg::Vec3d& p)
+        {
+            if (!begin())
+                return false;
+            double v[3] = { 0.0, 0.0, 0.0 };
+            unsigned n = 0;
+            while (_op < _ops.size() && _ops[_op] == 'n')
+            {
+                if (n < 3) v[n] = _nums[_num];
+                ++n, ++_op, ++_num;
+            }
+            end();
+            if (n < 2) _ok = false;
+            p.set(v[0], v[1], v[2]);
+            return _ok;
+        }
+
+        // reads an array of positions, removing consecutive duplicates
+        // (same as OgrUtils::populate)
+        void positions(Geometry* target)
+        {
+            if (!begin())
+                return;
+            osg::Vec3d p;
+            while (!atEnd())
+            {
+                if (position(p) && (target->empty() || p != target->back()))
+                    target->push_back(p);
+            }
+            end();
+        }
+
+        Polygon* polygon(bool rewind)
+        {
+            if (!begin())
+                return 0L;
+            osg::ref_ptr<Polygon> poly;
+            while (!atEnd())
+            {
+                if (!poly.valid())
+                {
+                    poly = new Polygon();
+                    positions(poly.get());
+                    if (rewind)
+                    {
+                        poly->open();
+                        poly->rewind(Ring::ORIENTATION_CCW);
+                    }
+                }
+                else
+                {
+                    osg::ref_ptr<Ring> hole = new Ring();
+                    positions(hole.get());
+                    if (rewind)
+                    {
+                        hole->open();
+                        hole->rewind(Ring::ORIENTATION_CW);
+                    }
+                    poly->getHoles().push_back(hole.get());
+                }
+            }
+            end();
+            return _ok && poly.valid() && !poly->empty() ? poly.release() : 0L;
+        }
+    };
+}
+
+//........................................................................
+
+/**
+ * SAX handler and token pump. Holds the state of exactly one feature at
+ * a time; completed features are handed out through nextRecord().
+ */
+struct GeoJSONReader::Parser
+{
+    enum Role
+    {
+        ROLE_FEATURE,       // a Feature object (or the root object)
+        ROLE_FEATURES,      // the "features" array of a FeatureCollection
+        ROLE_PROPERTIES,    // a feature's "properties" object
+        ROLE_NESTED,        // object/array value inside "properties"
+        ROLE_GEOMETRY,      // a geometry object
+        ROLE_GEOMETRIES,    // a GeometryCollection's "geometries" array
+        ROLE_COORDINATES,   // (nested) "coordinates" arrays
+        ROLE_SKIP           // anything we do not care about
+    };
+
+    struct GeometryState
+    {
+        std::string type;
+        std::vector<char> ops;
+        std::vector<double> nums;
+        std::vector<osg::ref_ptr<Geometry> > parts;
+
+        void reset()
+        {
+            type.clear();
+            ops.clear();
+            nums.clear();
+            parts.clear();
+        }
+    };
+
+    struct Record
+    {
+        std::string type;
+        FeatureID fid;
+        bool hasFID;
+        osg::ref_ptr<Geometry> geometry;
+        bool rejected;
+        std::vector<std::pair<std::string, AttributeValue> > attrs;
+
+        void reset()
+        {
+            type.clear();
+            fid = 0;
+            hasFID = false;
+            geometry = 0L;
+            rejected = false;
+            attrs.clear();
+        }
+    };
+
+    GeoJSONReader& _owner;
+    rapidjson::Reader _json;
+    std::vector<char> _buffer;
+    std::unique_ptr<rapidjson::IStreamWrapper> _stream;
+    std::vector<Role> _stack;
+    std::vector<GeometryState> _geoms;
+    unsigned _geomDepth;
+    std::string _key;
+    std::string _rootType;
+    Record _record;
+    bool _recordReady;
+    bool _done;
+    bool _canceled;
+    FeatureID _featureIndex;
+    unsigned _tokens;
+    std::string _nestedName;
+    rapidjson::StringBuffer _nestedBuffer;
+    rapidjson::Writer<rapidjson::StringBuffer> _nestedWriter;
+
+    Parser(GeoJSONReader& owner) :
+        _owner(owner),
+        _buffer(STREAM_BUFFER_SIZE),
+        _geomDepth(0u),
+        _recordReady(false),
+        _done(true),
+        _canceled(false),
+        _featureIndex(0),
+        _tokens(0u),
+        _nestedWriter(_nestedBuffer)
+    {
+        //nop
+    }
+
+    void begin(std::istream& in)
+    {
+        _stream.reset(new rapidjson::IStreamWrapper(in, &_buffer[0], _buffer.size()));
+        _json.IterativeParseInit();
+        _stack.clear();
+        _geomDepth = 0u;
+        _key.clear();
+        _rootType.clear();
+        _record.reset();
+        _recordReady = false;
+        _done = false;
+        _canceled = false;
+        _featureIndex = 0;
+        _tokens = 0u;
+    }
+
+    //! Advances the parser until the next accepted feature is complete.
+    bool nextRecord()
+    {
+        _recordReady = false;
+
+        while (!_done)
+        {
+            if (_json.IterativeParseComplete())
+            {
+                _done = true;
+                break;
+            }
+
+            if (!_json.IterativeParseNext<rapidjson::kParseDefaultFlags>(*_stream, *this))
+            {
+                _done = true;
+                if (!_canceled)
+                {
+                    _owner._error = Stringify()
+                        << rapidjson::GetParseError_En(_json.GetParseErrorCode())
+                        << " (at offset " << _json.GetErrorOffset() << ")";
+                }
+                break;
+            }
+
+            if (_recordReady)
+                return true;
+        }
+
+        _stream.reset();
+        return false;
+    }
+
+    bool checkCancel()
+    {
+        if (++_tokens % CANCEL_CHECK_INTERVAL == 0 &&
+            _owner._progress.valid() &&
+            _owner._progress->isCanceled())
+        {
+            _canceled = true;
+            return false;
+        }
+        return true;
+    }
+
+    Role top() const
+    {
+        return _stack.empty() ? ROLE_SKIP : _stack.back();
+    }
+
+    GeometryState& currentGeometry()
+    {
+        return _geoms[_geomDepth - 1];
+    }
+
+    void beginFeature()
+    {
+        _record.reset();
+        _stack.push_back(ROLE_FEATURE);
+    }
+
+    void beginGeometry()
+    {
+        if (_geoms.size() <= _geomDepth)
+            _geoms.resize(_geomDepth + 1);
+        _geoms[_geomDepth++].reset();
+        _stack.push_back(ROLE_GEOMETRY);
+    }
+
+    void beginNested(const std::string& name)
+    {
+        _nestedName = name;
+        _nestedBuffer.Clear();
+        _nestedWriter.Reset(_nestedBuffer);
+    }
+
+    void addAttribute(const std::string& name, const AttributeValue& value)
+    {
+        if (!_record.rejected)
+        {
+            _record.attrs.push_back(std::make_pair(toLower(name), value));
+        }
+    }
+
+    template<typename T>
+    void addNumber(T value, bool isInteger)
+    {
+        AttributeValue v = makeNull();
+        v.first = isInteger ? ATTRTYPE_INT : ATTRTYPE_DOUBLE;
+        v.second.doubleValue = (double)value;
+        if (isInteger)
+            v.second.intValue = (long long)value;
+        v.second.set = true;
+        addAttribute(_key, v);
+    }
+
+    template<typename T>
+    bool number(T value, bool isInteger)
+    {
+        switch (top())
+        {
+        case ROLE_COORDINATES:
+            currentGeometry().ops.push_back('n');
+            currentGeometry().nums.push_back((double)value);
+            break;
+        case ROLE_PROPERTIES:
+            addNumber(value, isInteger);
+            break;
+        case ROLE_FEATURE:
+            if (_key == "id" && isInteger)
+            {
+                _record.fid = (FeatureID)value;
+                _record.hasFID = true;
+            }
+            break;
+        default:
+            break;
+        }
+        return checkCancel();
+    }
+
+    //! Builds the geometry for the current geometry state.
+    Geometry* buildGeometry(GeometryState& g)
+    {
+        bool rewind = _owner._rewindPolygons;
+        CoordinateReader c(g.ops, g.nums);
+        osg::ref_ptr<Geometry> output;
+
+        if (g.type == "Point")
+        {
+            osg::Vec3d p;
+            if (c.position(p))
+            {
+                output = new Point();
+                output->push_back(p);
+            }
+        }
+        else if (g.type == "MultiPoint")
+        {
+            output = new PointSet();
+            c.positions(output.get());
+        }
+        else if (g.type == "LineString")
+        {
+            output = new LineString();
+            c.positions(output.get());
+        }
+        else if (g.type == "Polygon")
+        {
+            output = c.polygon(rewind);
+        }
+        else if (g.type == "MultiLineString" || g.type == "MultiPolygon")
+        {
+            MultiGeometry* multi = new MultiGeometry();
+            output = multi;
+            if (c.begin())
+            {
+                while (!c.atEnd())
+                {
+                    if (g.type == "MultiPolygon")
+                    {
+                        Polygon* poly = c.polygon(rewind);
+                        if (poly) multi->add(poly);
+                    }
+                    else
+                    {
+                        osg::ref_ptr<LineString> line = new LineString();
+                        c.positions(line.get());
+                        if (!line->empty()) multi->add(line.get());
+                    }
+                }
+                c.end();
+            }
+        }
+        else if (g.type == "GeometryCollection")
+        {
+            MultiGeometry* multi = new MultiGeometry();
+            output = multi;
+            for (unsigned i = 0; i < g.parts.size(); ++i)
+                multi->add(g.parts[i].get());
+        }
+
+        if (!c._ok || !output.valid() || !output->isValid())
+            return 0L;
+
+        return output.release();
+    }
+
+    void endGeometry()
+    {
+        GeometryState& g = currentGeometry();
+        osg::ref_ptr<Geometry> geom = buildGeometry(g);
+        g.reset();
+        --_geomDepth;
+
+        if (_geomDepth > 0)
+        {
+            // part of a GeometryCollection
+            if (geom.valid())
+                currentGeometry().parts.push_back(geom.get());
+        }
+        else if (top() == ROLE_FEATURE)
+        {
+            _record.geometry = geom.get();
+
+            // bounds pushdown: reject as early as possible so we never
+            // bother collecting the attributes of a filtered-out feature
+            const Bounds& bounds = _owner._bounds;
+            if (bounds.isValid() && (!geom.valid() || !intersects(geom->getBounds(), bounds)))
+            {
+                _record.rejected = true;
+                _record.attrs.clear();
+            }
+        }
+    }
+
+    void endFeature()
+    {
+        bool isRoot = _stack.empty();
+        bool isFeature = isRoot ?
+            (_rootType == "Feature") :
+            (_record.type.empty() || _record.type == "Feature");
+
+        if (!isFeature)
+            return;
+
+        FeatureID index = _featureIndex++;
+
+        if (_owner._bounds.isValid() && (_record.rejected || !_record.geometry.valid()))
+        {
+            _owner._numSkipped++;
+            return;
+        }
+
+        if (!_record.hasFID)
+            _record.fid = index;
+
+        _recordReady = true;
+    }
+
+    //! Called when an object or array value inside "properties" is done.
+    void endNested()
+    {
+        if (top() == ROLE_PROPERTIES)
+        {
+            AttributeValue v = makeNull();
+            v.first = ATTRTYPE_STRING;
+            v.second.stringValue.assign(_nestedBuffer.GetString(), _nestedBuffer.GetSize());
+            v.second.set = true;
+            addAttribute(_nestedName, v);
+        }
+    }
+
+    // ---- rapidjson handler interface ----
+
+    bool Null()
+    {
+        if (top() == ROLE_PROPERTIES)
+            addAttribute(_key, makeNull());
+        else if (top() == ROLE_NESTED)
+            _nestedWriter.Null();
+        return checkCancel();
+    }
+
+    bool Bool(bool b)
+    {
+        if (top() == ROLE_PROPERTIES)
+        {
+            AttributeValue v = makeNull();
+            v.first = ATTRTYPE_BOOL;
+            v.second.boolValue = b;
+            v.second.set = true;
+            addAttribute(_key, v);
+        }
+        else if (top() == ROLE_NESTED)
+        {
+            _nestedWriter.Bool(b);
+        }
+        return checkCancel();
+    }
+
+    bool Int(int i)
+    {
+        if (top() == ROLE_NESTED) _nestedWriter.Int(i);
+        return number(i, true);
+    }
+
+    bool Uint(unsigned u)
+    {
+        if (top() == ROLE_NESTED) _nestedWriter.Uint(u);
+        return number(u, true);
+    }
+
+    bool Int64(int64_t i)
+    {
+        if (top() == ROLE_NESTED) _nestedWriter.Int64(i);
+        return number(i, true);
+    }
+
+    bool Uint64(uint64_t u)
+    {
+        if (top() == ROLE_NESTED) _nestedWriter.Uint64(u);
+        bool fits = u <= (uint64_t)std::numeric_limits<long long>::max();
+        return fits ? number((long long)u, true) : number((double)u, false);
+    }
+
+    bool Double(double d)
+    {
+        if (top() == ROLE_NESTED) _nestedWriter.Double(d);
+        return number(d, false);
+    }
+
+    bool RawNumber(const char* str, rapidjson::SizeType len, bool copy)
+    {
+        // only called with kParseNumbersAsStringsFlag, which we do not use
+        return true;
+    }
+
+    bool String(const char* str, rapidjson::SizeType len, bool copy)
+    {
+        switch (top())
+        {
+        case ROLE_FEATURE:
+            if (_key == "type")
+            {
+                _record.type.assign(str, len);
+                if (_stack.size() == 1)
+                    _rootType = _record.type;
+            }
+            else if (_key == "id")
+            {
+                // OGR uses a string id as the FID when it is an integer,
+                // and keeps it as an attribute otherwise
+                std::string id(str, len);
+                char* end = 0L;
+                long long fid = strtoll(id.c_str(), &end, 10);
+                if (!id.empty() && end && *end == '\0')
+                {
+                    _record.fid = fid;
+                    _record.hasFID = true;
+                }
+                else
+                {
+                    AttributeValue v = makeNull();
+                    v.first = ATTRTYPE_STRING;
+                    v.second.stringValue = id;
+                    v.second.set = true;
+                    addAttribute("id", v);
+                }
+            }
+            break;
+        case ROLE_GEOMETRY:
+            if (_key == "type")
+                currentGeometry().type.assign(str, len);
+            break;
+        case ROLE_PROPERTIES:
+        {
+            AttributeValue v = makeNull();
+            v.first = ATTRTYPE_STRING;
+            v.second.stringValue.assign(str, len);
+            v.second.set = true;
+            addAttribute(_key, v);
+            break;
+        }
+        case ROLE_NESTED:
+            _nestedWriter.String(str, len, copy);
+            break;
+        default:
+            break;
+        }
+        return checkCancel();
+    }
+
+    bool Key(const char* str, rapidjson::SizeType len, bool copy)
+    {
+        if (top() == ROLE_NESTED)
+            _nestedWriter.Key(str, len, copy);
+        else
+            _key.assign(str, len);
+        return true;
+    }
+
+    bool StartObject()
+    {
+        if (_stack.empty())
+        {
+            beginFeature();
+            return true;
+        }
+
+        switch (top())
+        {
+        case ROLE_FEATURES:
+            beginFeature();
+            break;
+        case ROLE_FEATURE:
+            if (_key == "properties" && !_record.rejected)
+                _stack.push_back(ROLE_PROPERTIES);
+            else if (_key == "geometry")
+                beginGeometry();
+            else
+                _stack.push_back(ROLE_SKIP);
+            break;
+        case ROLE_GEOMETRIES:
+            beginGeometry();
+            break;
+        case ROLE_PROPERTIES:
+            beginNested(_key);
+            _nestedWriter.StartObject();
+            _stack.push_back(ROLE_NESTED);
+            break;
+        case ROLE_NESTED:
+            _nestedWriter.StartObject();
+            _stack.push_back(ROLE_NESTED);
+            break;
+        default:
+            _stack.push_back(ROLE_SKIP);
+            break;
+        }
+        return checkCancel();
+    }
+
+    bool EndObject(rapidjson::SizeType memberCount)
+    {
+        Role role = top();
+        _stack.pop_back();
+
+        switch (role)
+        {
+        case ROLE_FEATURE:
+            endFeature();
+            break;
+        case ROLE_GEOMETRY:
+            endGeometry();
+            break;
+        case ROLE_NESTED:
+            _nestedWriter.EndObject(memberCount);
+            endNested();
+            break;
+        default:
+            break;
+        }
+        return checkCancel();
+    }
+
+    bool StartArray()
+    {
+        switch (top())
+        {
+        case ROLE_FEATURE:
+            if (_key == "features")
+                _stack.push_back(ROLE_FEATURES);
+            else
+                _stack.push_back(ROLE_SKIP);
+            break;
+        case ROLE_GEOMETRY:
+            if (_key == "coordinates")
+            {
+                currentGeometry().ops.push_back('[');
+                _stack.push_back(ROLE_COORDINATES);
+            }
+            else if (_key == "geometries")
+            {
+                _stack.push_back(ROLE_GEOMETRIES);
+            }
+            else
+            {
+                _stack.push_back(ROLE_SKIP);
+            }
+            break;
+        case ROLE_COORDINATES:
+            currentGeometry().ops.push_back('[');
+            _stack.push_back(ROLE_COORDINATES);
+            break;
+        case ROLE_PROPERTIES:
+            beginNested(_key);
+            _nestedWriter.StartArray();
+            _stack.push_back(ROLE_NESTED);
+            break;
+        case ROLE_NESTED:
+            _nestedWriter.StartArray();
+            _stack.push_back(ROLE_NESTED);
+            break;
+        default:
+            _stack.push_back(ROLE_SKIP);
+            break;
+        }
+        return checkCancel();
+    }
+
+    bool EndArray(rapidjson::SizeType elementCount)
+    {
+        Role role = top();
+        _stack.pop_back();
+
+        switch (role)
+        {
+        case ROLE_COORDINATES:
+            currentGeometry().ops.push_back(']');
+            break;
+        case ROLE_NESTED:
+            _nestedWriter.EndArray(elementCount);
+            endNested();
+            break;
+        default:
+            break;
+        }
+        return checkCancel();
+    }
+};
+
+//........................................................................
+
+int
+GeoJSONReader::FeatureBatch::getColumnIndex(const std::string& name) const
+{
+    for (unsigned i = 0; i < columns.size(); ++i)
+    {
+        if (columns[i] == name)
+            return (int)i;
+    }
+    return -1;
+}
+
+void
+GeoJSONReader::FeatureBatch::clear()
+{
+    fids.clear();
+    geometries.clear();
+    for (unsigned i = 0; i < values.size(); ++i)
+        values[i].clear();
+}
+
+//........................................................................
+
+GeoJSONReader::GeoJSONReader() :
+    _rewindPolygons(true),
+    _batchSize(1024u),
+    _numRead(0u),
+    _numSkipped(0u)
+{
+    //nop
+}
+
+GeoJSONReader::GeoJSONReader(const GeoJSONReader& rhs) :
+    _srs(rhs._srs),
+    _geoInterp(rhs._geoInterp),
+    _progress(rhs._progress),
+    _bounds(rhs._bounds),
+    _rewindPolygons(rhs._rewindPolygons),
+    _batchSize(rhs._batchSize),
+    _numRead(0u),
+    _numSkipped(0u)
+{
+    //nop
+}
+
+GeoJSONReader&
+GeoJSONReader::operator = (const GeoJSONReader& rhs)
+{
+    if (this != &rhs)
+    {
+        _srs = rhs._srs;
+        _geoInterp = rhs._geoInterp;
+        _progress = rhs._progress;
+        _bounds = rhs._bounds;
+        _rewindPolygons = rhs._rewindPolygons;
+        _batchSize = rhs._batchSize;
+        _error.clear();
+        _numRead = 0u;
+        _numSkipped = 0u;
+        _parser.reset();
+    }
+    return *this;
+}
+
+GeoJSONReader::~GeoJSONReader()
+{
+    //nop
+}
+
+void
+GeoJSONReader::setFeatureProfile(const FeatureProfile* value)
+{
+    _srs = value ? value->getSRS() : 0L;
+    _geoInterp.unset();
+    if (value && value->geoInterp().isSet())
+        _geoInterp = value->geoInterp().get();
+}
+
+void
+GeoJSONReader::setProgressCallback(ProgressCallback* value)
+{
+    _progress = value;
+}
+
+void
+GeoJSONReader::begin(std::istream& in)
+{
+    if (!_parser)
+        _parser.reset(new Parser(*this));
+
+    _error.clear();
+    _numRead = 0u;
+    _numSkipped = 0u;
+    _parser->begin(in);
+}
+
+Feature*
+GeoJSONReader::next()
+{
+    if (!_parser || !_parser->nextRecord())
+        return 0L;
+
+    Parser::Record& r = _parser->_record;
+
+    Feature* feature = new Feature(r.geometry.get(), _srs.get(), Style(), r.fid);
+    if (_geoInterp.isSet())
+        feature->geoInterp() = _geoInterp.get();
+
+    for (unsigned i = 0; i < r.attrs.size(); ++i)
+        feature->set(r.attrs[i].first, r.attrs[i].second);
+
+    _numRead++;
+    return feature;
+}
+
+bool
+GeoJSONReader::read(std::istream& in, const FeatureCallback& callback)
+{
+    OE_PROFILING_ZONE;
+
+    begin(in);
+
+    osg::ref_ptr<Feature> feature;
+    while ((feature = next()).valid())
+    {
+        if (!callback(feature.get()))
+            break;
+    }
+
+    if (hasError())
+    {
+        OE_WARN << LC << "Parse error: " << _error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool
+GeoJSONReader::read(const std::string& buffer, FeatureList& output)
+{
+    std::istringstream in(buffer);
+    return read(in, [&output](Feature* feature)
+    {
+        output.push_back(feature);
+        return true;
+    });
+}
+
+bool
+GeoJSONReader::readFile(const std::string& filename, const FeatureCallback& callback)
+{
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    if (!in.is_open())
+    {
+        _error = "Cannot open " + filename;
+        OE_WARN << LC << _error << std::endl;
+        return false;
+    }
+    return read(in, callback);
+}
+
+bool
+GeoJSONReader::readBatches(std::istream& in, const BatchCallback& callback)
+{
+    OE_PROFILING_ZONE;
+
+    begin(in);
+
+    FeatureBatch batch;
+    std::map<std::string, unsigned> columnIndex;
+    bool keepGoing = true;
+
+    while (keepGoing && _parser->nextRecord())
+    {
+        Parser::Record& r = _parser->_record;
+        unsigned row = batch.size();
+
+        batch.fids.push_back(r.fid);
+        batch.geometries.push_back(r.geometry.get());
+
+        for (unsigned i = 0; i < r.attrs.size(); ++i)
+        {
+            std::map<std::string, unsigned>::iterator c = columnIndex.find(r.attrs[i].first);
+            if (c == columnIndex.end())
+            {
+                // new column; back-fill the rows we already have with nulls
+                c = columnIndex.insert(std::make_pair(r.attrs[i].first, (unsigned)batch.columns.size())).first;
+                batch.columns.push_back(r.attrs[i].first);
+                batch.values.push_back(std::vector<AttributeValue>(row, makeNull()));
+            }
+
+            std::vector<AttributeValue>& column = batch.values[c->second];
+            if (column.size() == row)
+                column.push_back(r.attrs[i].second);
+            else
+                column.back() = r.attrs[i].second; // duplicate key; last one wins
+        }
+
+        // null-fill columns this feature did not have
+        for (unsigned i = 0; i < batch.values.size(); ++i)
+        {
+            if (batch.values[i].size() == row)
+                batch.values[i].push_back(makeNull());
+        }
+
+        _numRead++;
+
+        if (batch.size() >= _batchSize)
+        {
+            keepGoing = callback(batch);
+            batch.clear();
+        }
+    }
+
+    if (keepGoing && batch.size() > 0)
+    {
+        callback(batch);
+    }
+
+    if (hasError())
+    {
+        OE_WARN << LC << "Parse error: " << _error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//........................................................................
+
+GeoJSONFeatureCursor::GeoJSONFeatureCursor(std::istream* in,
+                                           const GeoJSONReader& config,
+                                           ProgressCallback* progress) :
+    FeatureCursor(progress),
+    _in(in),
+    _reader(config)
+{
+    if (progress)
+        _reader.setProgressCallback(progress);
+
+    if (_in)
+    {
+        _reader.begin(*_in);
+        fetch();
+    }
+}
+
+GeoJSONFeatureCursor*
+GeoJSONFeatureCursor::open(const std::string& filename,
+                           const GeoJSONReader& config,
+                           ProgressCallback* progress)
+{
+    std::ifstream* in = new std::ifstream(filename.c_str(), std::ios::binary);
+    if (!in->is_open())
+    {
+        OE_WARN << LC << "Cannot open " << filename << std::endl;
+        delete in;
+        return 0L;
+    }
+    return new GeoJSONFeatureCursor(in, config, progress);
+}
+
+GeoJSONFeatureCursor::~GeoJSONFeatureCursor()
+{
+    //nop
+}
+
+void
+GeoJSONFeatureCursor::fetch()
+{
+    _next = _reader.next();
+
+    if (!_next.valid() && _reader.hasError())
+    {
+        OE_WARN << LC << "Parse error: " << _reader.getErrorMessage() << std::endl;
+    }
+}
+
+bool
+GeoJSONFeatureCursor::hasMore() const
+{
+    return _next.valid();
+}
+
+Feature*
+GeoJSONFeatureCursor::nextFeature()
+{
+    // hold a reference to the returned feature until the next call,
+    // like the other cursors do
+    _last = _next.get();
+    fetch();
+    return _last.get();
+}
@@ -24,6 +24,38 @@
 
 using namespace osgEarth;
 
+namespace
+{
+    // The two posts and the weight of the second one along one axis of
+    // the geoid grid, for bilinear interpolation.
+    struct Tap
+    {
+        unsigned i0, i1;
+        float w;
+        bool valid;
+    };
+
+    inline Tap makeTap(double coord, double origin, double interval, unsigned count, double min, double max)
+    {
+        Tap tap;
+        tap.valid = coord >= min && coord <= max;
+        double p = osg::clampBetween((coord - origin) / interval, 0.0, (double)(count - 1));
+        tap.i0 = (unsigned)p;
+        tap.i1 = osg::minimum(tap.i0 + 1u, count - 1u);
+        tap.w = (float)(p - (double)tap.i0);
+        return tap;
+    }
+
+    inline float bilinear(const float* data, unsigned cols, const Tap& x, const Tap& y)
+    {
+        const float* row0 = data + y.i0 * cols;
+        const float* row1 = data + y.i1 * cols;
+        float a = row0[x.i0] + (row0[x.i1] - row0[x.i0]) * x.w;
+        float b = row1[x.i0] + (row1[x.i1] - row1[x.i0]) * x.w;
+        return a + (b - a) * y.w;
+    }
+}
+
 
 Geoid::Geoid() :
 _units( Units::METERS ),
@@ -91,6 +123,63 @@ Geoid::getHeight(double lat_deg, double lon_deg, const RasterInterpolation& inte
     return result;
 }
 
+void
+Geoid::getHeights(const std::vector<osg::Vec3d>& lonLat, std::vector<float>& out_heights) const
+{
+    out_heights.assign(lonLat.size(), 0.0f);
+    if (!_valid)
+        return;
+
+    const float* data = (const float*)_hf->getFloatArray()->getDataPointer();
+    unsigned cols = _hf->getNumColumns(), rows = _hf->getNumRows();
+    double x0 = _hf->getOrigin().x(), dx = _hf->getXInterval();
+    double y0 = _hf->getOrigin().y(), dy = _hf->getYInterval();
+
+    for (unsigned i = 0; i < lonLat.size(); ++i)
+    {
+        Tap x = makeTap(lonLat[i].x(), x0, dx, cols, _bounds.xMin(), _bounds.xMax());
+        Tap y = makeTap(lonLat[i].y(), y0, dy, rows, _bounds.yMin(), _bounds.yMax());
+        if (x.valid && y.valid)
+            out_heights[i] = bilinear(data, cols, x, y);
+    }
+}
+
+void
+Geoid::getHeights(double south, double west,
+                  double latInterval, double lonInterval,
+                  unsigned cols, unsigned rows,
+                  std::vector<float>& out_heights) const
+{
+    out_heights.assign(cols*rows, 0.0f);
+    if (!_valid)
+        return;
+
+    const float* data = (const float*)_hf->getFloatArray()->getDataPointer();
+    unsigned hfCols = _hf->getNumColumns(), hfRows = _hf->getNumRows();
+
+    std::vector<Tap> colTaps(cols);
+    for (unsigned c = 0; c < cols; ++c)
+    {
+        colTaps[c] = makeTap(west + lonInterval*(double)c,
+            _hf->getOrigin().x(), _hf->getXInterval(), hfCols, _bounds.xMin(), _bounds.xMax());
+    }
+
+    for (unsigned r = 0; r < rows; ++r)
+    {
+        Tap y = makeTap(south + latInterval*(double)r,
+            _hf->getOrigin().y(), _hf->getYInterval(), hfRows, _bounds.yMin(), _bounds.yMax());
+        if (!y.valid)
+            continue;
+
+        float* out = &out_heights[r*cols];
+        for (unsigned c = 0; c < cols; ++c)
+        {
+            if (colTaps[c].valid)
+                out[c] = bilinear(data, hfCols, colTaps[c], y);
+        }
+    }
+}
+
 bool
 Geoid::isEquivalentTo( const Geoid& rhs ) const
 {
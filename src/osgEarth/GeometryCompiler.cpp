@@ -76,7 +76,10 @@ _optimize              ( false ),
 _optimizeVertexOrdering( true ),
 _validate              ( false ),
 _maxPolyTilingAngle    ( 45.0f ),
-_useOSGTessellator     ( false )
+_useOSGTessellator     ( false ),
+_extrusionThreads      ( 0u ),
+_tessellationThreads   ( 0u ),
+_arenaAllocation       ( false )
 {
     //nop
 }
@@ -96,7 +99,10 @@ _optimize              ( s_defaults.optimize().value() ),
 _optimizeVertexOrdering( s_defaults.optimizeVertexOrdering().value() ),
 _validate              ( s_defaults.validate().value() ),
 _maxPolyTilingAngle    ( s_defaults.maxPolygonTilingAngle().value() ),
-_useOSGTessellator     (s_defaults.useOSGTessellator().value())
+_useOSGTessellator     (s_defaults.useOSGTessellator().value()),
+_extrusionThreads      ( s_defaults.extrusionThreads().value() ),
+_tessellationThreads   ( s_defaults.tessellationThreads().value() ),
+_arenaAllocation       ( s_defaults.arenaAllocation().value() )
 {
     fromConfig(conf.getConfig());
 }
@@ -118,6 +124,9 @@ GeometryCompilerOptions::fromConfig( const Config& conf )
     conf.get( "validate", _validate );
     conf.get( "max_polygon_tiling_angle", _maxPolyTilingAngle );
     conf.get( "use_osg_tessellator", _useOSGTessellator);
+    conf.get( "extrusion_threads", _extrusionThreads );
+    conf.get( "tessellation_threads", _tessellationThreads );
+    conf.get( "arena_allocation", _arenaAllocation );
 
     conf.get( "shader_policy", "disable",  _shaderPolicy, SHADERPOLICY_DISABLE );
     conf.get( "shader_policy", "inherit",  _shaderPolicy, SHADERPOLICY_INHERIT );
@@ -142,6 +151,9 @@ GeometryCompilerOptions::getConfig() const
     conf.set( "validate", _validate );
     conf.set( "max_polygon_tiling_angle", _maxPolyTilingAngle );
     conf.set( "use_osg_tessellator", _useOSGTessellator);
+    conf.set( "extrusion_threads", _extrusionThreads );
+    conf.set( "tessellation_threads", _tessellationThreads );
+    conf.set( "arena_allocation", _arenaAllocation );
 
     conf.set( "shader_policy", "disable",  _shaderPolicy, SHADERPOLICY_DISABLE );
     conf.set( "shader_policy", "inherit",  _shaderPolicy, SHADERPOLICY_INHERIT );
@@ -412,6 +424,13 @@ GeometryCompiler::compile(FeatureList&          workingSet,
         if ( _options.mergeGeometry().isSet() )
             extrude.setMergeGeometry( *_options.mergeGeometry() );
 
+        if ( _options.extrusionThreads().isSet() )
+            extrude.setNumThreads( *_options.extrusionThreads() );
+
+        // the parallel extruder builds into arenas; one thread runs it serially.
+        if ( _options.arenaAllocation() == true && extrude.getNumThreads() == 0u )
+            extrude.setNumThreads( 1u );
+
         osg::Node* node = extrude.push( workingSet, sharedCX );
         if ( node )
         {
@@ -439,6 +458,12 @@ GeometryCompiler::compile(FeatureList&          workingSet,
         filter.geoInterp()      = *_options.geoInterp();
         filter.useOSGTessellator() = *_options.useOSGTessellator();
 
+        if ( _options.tessellationThreads().isSet() )
+            filter.setNumThreads( *_options.tessellationThreads() );
+
+        if ( _options.arenaAllocation().isSet() )
+            filter.arenaAllocation() = *_options.arenaAllocation();
+
         if (_options.maxPolygonTilingAngle().isSet())
             filter.maxPolygonTilingAngle() = *_options.maxPolygonTilingAngle();
 
@@ -19,6 +19,8 @@
 #include <osgEarth/HTTPClient>
 #include <osgEarth/Progress>
 #include <osgEarth/Metrics>
+#include <osgEarth/MetricsRegistry>
+#include <osgEarth/TileTracer>
 #include <osgEarth/Version>
 #include <osgDB/ReadFile>
 #include <osgDB/FileNameUtils>
@@ -44,11 +46,11 @@ namespace osgEarth
 
     struct StreamObject
     {
-        StreamObject(std::ostream* stream) : _stream(stream) { }
+        StreamObject(ByteBuffer* buffer) : _buffer(buffer) { }
 
         void write(const char* ptr, size_t realsize)
         {
-            if (_stream) _stream->write(ptr, realsize);
+            if (_buffer) _buffer->append(ptr, realsize);
         }
 
         void writeHeader(const char* ptr, size_t realsize)
@@ -58,10 +60,21 @@ namespace osgEarth
             StringVector tized;
             tok.tokenize(header, tized);
             if ( tized.size() >= 2 )
+            {
                 _headers[tized[0]] = tized[1];
+
+                // size the buffer up front so the body lands in one
+                // allocation (within reason; the header is only a hint)
+                if (_buffer && ciEquals(tized[0], "Content-Length"))
+                {
+                    size_t length = as<size_t>(tized[1], 0u);
+                    if (length <= 64u * 1024u * 1024u)
+                        _buffer->reserve(length);
+                }
+            }
         }
 
-        std::ostream* _stream;
+        ByteBuffer* _buffer;
         Headers _headers;
         std::string     _resultMimeType;
     };
@@ -117,6 +130,8 @@ namespace osgEarth
         std::string line;
         char tempbuf[256];
 
+        input->_stream.rewind();
+
         // first thing in the stream should be the boundary.
         input->_stream.read( tempbuf, bstr.length() );
         tempbuf[bstr.length()] = 0;
@@ -181,12 +196,8 @@ namespace osgEarth
                     }
                     else
                     {
-                        for( unsigned int i=0; i<bstr_ptr; i++ )
-                        {
-                            next_part->_stream << bstr[i];
-                        }
-                        next_part->_stream << b;
-                        next_part->_size += bstr_ptr + 1;
+                        next_part->_buffer->append( bstr.data(), bstr_ptr );
+                        next_part->_buffer->append( &b, 1 );
                         bstr_ptr = 0;
                     }
                 }
@@ -343,7 +354,7 @@ HTTPResponse::getNumParts() const {
 
 unsigned int
 HTTPResponse::getPartSize( unsigned int n ) const {
-    return _parts[n]->_size;
+    return _parts[n]->_buffer->size();
 }
 
 const std::string&
@@ -353,6 +364,7 @@ HTTPResponse::getPartHeader( unsigned int n, const std::string& name ) const {
 
 std::istream&
 HTTPResponse::getPartStream( unsigned int n ) const {
+    _parts[n]->_stream.rewind();
     return _parts[n]->_stream;
 }
 
@@ -360,7 +372,7 @@ std::string
 HTTPResponse::getPartAsString( unsigned int n ) const {
     std::string streamStr;
     if (n < _parts.size())
-        streamStr = _parts[n]->_stream.str();
+        streamStr = _parts[n]->_buffer->toString();
     return streamStr;
 }
 
@@ -625,11 +637,14 @@ namespace
             curl_easy_setopt(_curl_handle, CURLOPT_HTTPHEADER, headers);
 
             osg::ref_ptr<HTTPResponse::Part> part = new HTTPResponse::Part();
-            StreamObject sp( &part->_stream );
+            StreamObject sp( part->_buffer.get() );
 
             //Take a temporary ref to the callback (why? dangerous.)
             //osg::ref_ptr<ProgressCallback> progressCallback = callback;
             curl_easy_setopt( _curl_handle, CURLOPT_URL, url.c_str() );
+
+            // libcurl calls the progress function at least once a second, even
+            // while a transfer is stalled, so a canceled request aborts promptly.
             if (progress)
             {
                 curl_easy_setopt(_curl_handle, CURLOPT_PROGRESSDATA, progress);
@@ -736,6 +751,9 @@ namespace
             {
                 //If we were aborted by a callback, then it was cancelled by a user
                 response.setCanceled(true);
+
+                if (progress)
+                    progress->recordCancelation("http");
             }
 
             else
@@ -1098,7 +1116,7 @@ namespace
                 DWORD numBytesRead = 0;
                 while( InternetReadFile(hRequest, buffer, 4096, &numBytesRead) && numBytesRead )
                 {
-                    part->_stream << std::string(buffer, numBytesRead);
+                    part->_buffer->append(buffer, numBytesRead);
                 }
 
                 response.getParts().push_back( part.get() );
@@ -1452,6 +1470,45 @@ HTTPClient::download(const std::string& uri,
     return getClient().doDownload( uri, localPath );
 }
 
+namespace
+{
+    // Reports a request in the oe_http_requests_total and
+    // oe_http_request_seconds metrics, by status class.
+    void recordMetrics(const HTTPResponse& response, double seconds)
+    {
+        struct Status
+        {
+            Util::MetricsRegistry::Counter* requests;
+            Util::MetricsRegistry::Histogram* latency;
+        };
+
+        static const char* names[] = { "canceled", "error", "1xx", "2xx", "3xx", "4xx", "5xx" };
+        static Status* statuses = []()
+        {
+            Status* s = new Status[7];
+            for (unsigned i = 0; i < 7; ++i)
+            {
+                Util::MetricsRegistry::Labels labels;
+                labels["status"] = names[i];
+                s[i].requests = Util::MetricsRegistry::instance().counter(
+                    "oe_http_requests_total", "HTTP requests by status class", labels);
+                s[i].latency = Util::MetricsRegistry::instance().histogram(
+                    "oe_http_request_seconds", "HTTP request latency by status class", labels);
+            }
+            return s;
+        }();
+
+        unsigned category = response.getCodeCategory();
+        unsigned i =
+            response.isCanceled() ? 0u :
+            category >= HTTPResponse::CATEGORY_INFORMATIONAL && category <= HTTPResponse::CATEGORY_SERVER_ERROR ? 2u + (category / 100u - 1u) :
+            1u;
+
+        statuses[i].requests->increment();
+        statuses[i].latency->record(seconds);
+    }
+}
+
 HTTPResponse
 HTTPClient::doGet(const HTTPRequest&    request,
                   const osgDB::Options* options,
@@ -1462,8 +1519,21 @@ HTTPClient::doGet(const HTTPRequest&    request,
 
     initialize();
 
+    // don't start a transfer for a task that is already obsolete
+    if (progress && progress->isCanceled())
+    {
+        HTTPResponse response;
+        response.setCanceled(true);
+        progress->recordCancelation("http");
+        return response;
+    }
+
+    Util::MetricsRegistry::ScopedTimer timer(0L);
+
     HTTPResponse response = _impl->doGet(request, options, progress);
 
+    recordMetrics(response, timer.elapsed());
+
     OE_PROFILING_ZONE_TEXT(Stringify() << "response_code " << response.getCode());
     if (response.isCanceled())
     {
@@ -1486,19 +1556,12 @@ HTTPClient::doDownload(const std::string& url, const std::string& filename)
             return false;
 
         unsigned int part_num = response.getNumParts() > 1? 1 : 0;
-        std::istream& input_stream = response.getPartStream( part_num );
+        const ByteBuffer* buffer = response.getParts()[part_num]->_buffer.get();
 
         std::ofstream fout;
         fout.open(filename.c_str(), std::ios::out | std::ios::binary);
-
-        input_stream.seekg (0, std::ios::end);
-        int length = input_stream.tellg();
-        input_stream.seekg (0, std::ios::beg);
-
-        char *buffer = new char[length];
-        input_stream.read(buffer, length);
-        fout.write(buffer, length);
-        delete[] buffer;
+        if (!buffer->empty())
+            fout.write(buffer->data(), buffer->size());
         fout.close();
         return true;
     }
@@ -1574,7 +1637,10 @@ HTTPClient::doReadImage(const HTTPRequest&    request,
             osgDB::ReaderWriter::ReadResult rr;
 
             if (response.getNumParts() > 0)
+            {
+                Util::TileTracer::Scope trace(Util::TileTracer::DECODE);
                 rr = reader->readImage(response.getPartStream(0), options);
+            }
 
             if ( rr.validImage() )
             {
@@ -528,16 +528,11 @@ HeightFieldUtils::createReferenceHeightField(const GeoExtent& ex,
         double latStart = latMin - latInterval*(double)border;
         double lonStart = lonMin - lonInterval*(double)border;
 
-        for( unsigned r=0; r<hf->getNumRows(); ++r )
-        {            
-            double lat = latStart + latInterval*(double)r;
-            for( unsigned c=0; c<hf->getNumColumns(); ++c )
-            {
-                double lon = lonStart + lonInterval*(double)c;
-                double offset = vdatum->msl2hae(lat, lon, 0.0);
-                hf->setHeight( c, r, offset );
-            }
-        }
+        // the geoid offset at each post is the HAE of zero MSL:
+        vdatum->getGeoidHeights(
+            latStart, lonStart, latInterval, lonInterval,
+            hf->getNumColumns(), hf->getNumRows(),
+            hf->getHeightList() );
     }
     else
     {
@@ -23,6 +23,7 @@
 #include <osgEarth/Capabilities>
 #include <osgEarth/Metrics>
 #include <osgEarth/NetworkMonitor>
+#include <osgEarth/TileTracer>
 #include <cinttypes>
 
 using namespace osgEarth;
@@ -385,6 +386,9 @@ ImageLayer::createImageInKeyProfile(
 
         CacheBin* bin = _memCache->getOrCreateDefaultBin();
         ReadResult result = bin->readObject(memCacheKey, 0L);
+        bin->recordRead(result.succeeded());
+        Util::TileTracer::instance().record(
+            result.succeeded() ? Util::TileTracer::CACHE_HIT : Util::TileTracer::CACHE_MISS, key, getName());
         if (result.succeeded())
         {
             return GeoImage(static_cast<osg::Image*>(result.releaseObject()), key.getExtent());
@@ -409,10 +413,13 @@ ImageLayer::createImageInKeyProfile(
     if ( cacheBin && policy.isCacheReadable() )
     {
         ReadResult r = cacheBin->readImage(cacheKey, 0L);
+        bool expired = r.succeeded() && policy.isExpired(r.lastModifiedTime());
+        cacheBin->recordRead(r.succeeded() && !expired);
+        Util::TileTracer::instance().record(
+            r.succeeded() && !expired ? Util::TileTracer::CACHE_HIT : Util::TileTracer::CACHE_MISS, key, getName());
         if ( r.succeeded() )
         {
             cachedImage = r.releaseImage();
-            bool expired = policy.isExpired(r.lastModifiedTime());
             if (!expired)
             {
                 OE_DEBUG << "Got cached image for " << key.str() << std::endl;
@@ -441,7 +448,10 @@ ImageLayer::createImageInKeyProfile(
 
     if (key.getProfile()->isHorizEquivalentTo(getProfile()))
     {
+        Util::TileTracer::Scope trace(Util::TileTracer::FETCH, key, getName());
+        Util::MetricsRegistry::ScopedTimer timer(0L);
         result = createImageImplementation(key, progress);
+        recordTileLoad(timer.elapsed(), result.valid(), progress && progress->isCanceled());
     }
     else
     {
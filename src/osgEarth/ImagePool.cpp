@@ -0,0 +1,428 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+ * Copyright 2020 Pelican Mapping
+ * http://osgearth.org
+ *
+ * osgEarth is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+#include <osgEarth/ImagePool>
+#include <osgEarth/MetricsRegistry>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+using namespace osgEarth::Util;
+
+namespace
+{
+    // Requests below MIN_POOLED bytes or above 2^MAX_BITS go straight to
+    // the heap. The rest are rounded up to one of four classes per power
+    // of two, the smallest being 2^MIN_BITS.
+    const std::size_t MIN_POOLED = 1024u;
+    const unsigned MIN_BITS = 12u;
+    const unsigned MAX_BITS = 25u;
+    const unsigned NUM_CLASSES = (MAX_BITS - MIN_BITS) * 4u + 1u;
+
+    // buffers each thread keeps to itself, per class and in total
+    const unsigned THREAD_BLOCKS_PER_CLASS = 4u;
+    const std::size_t THREAD_MAX_BYTES = 16u * 1024u * 1024u;
+
+    // Size class of a request and the size of its buffers;
+    // NUM_CLASSES for requests the pool does not handle.
+    unsigned getClass(std::size_t bytes, std::size_t& blockSize)
+    {
+        const std::size_t minBlock = (std::size_t)1u << MIN_BITS;
+
+        if (bytes < MIN_POOLED)
+        {
+            blockSize = bytes;
+            return NUM_CLASSES;
+        }
+        if (bytes <= minBlock)
+        {
+            blockSize = minBlock;
+            return 0u;
+        }
+
+        // find k such that 2^k < bytes <= 2^(k+1)
+        unsigned k = MIN_BITS;
+        while (((std::size_t)1u << (k + 1u)) < bytes)
+            ++k;
+
+        std::size_t base = (std::size_t)1u << k;
+        std::size_t step = base >> 2;
+        std::size_t sub = (bytes - 1u - base) / step + 1u; // 1..4
+        unsigned index = (k - MIN_BITS) * 4u + (unsigned)sub;
+
+        if (index >= NUM_CLASSES)
+        {
+            blockSize = bytes;
+            return NUM_CLASSES;
+        }
+
+        blockSize = base + sub * step;
+        return index;
+    }
+
+    // set once the calling thread's cache is gone, so buffers released
+    // during thread or process exit skip it
+    thread_local bool t_threadCacheDestroyed = false;
+}
+
+//........................................................................
+
+struct ImagePool::Impl
+{
+    struct SharedClass
+    {
+        std::mutex mutex;
+        std::vector<unsigned char*> blocks;
+    };
+
+    SharedClass shared[NUM_CLASSES];
+    std::atomic<std::size_t> cachedBytes;
+
+    MetricsRegistry::Counter* threadHits;
+    MetricsRegistry::Counter* sharedHits;
+    MetricsRegistry::Counter* heapAllocations;
+    MetricsRegistry::Counter* releases;
+    MetricsRegistry::Counter* allocatedBytes;
+    MetricsRegistry::Counter* releasedBytes;
+    MetricsRegistry::Gauge* cachedBytesGauge;
+
+    Impl() : cachedBytes(0u)
+    {
+        MetricsRegistry& metrics = MetricsRegistry::instance();
+        const std::string help = "Image buffers handed out, by where they came from";
+        MetricsRegistry::Labels labels;
+        labels["source"] = "thread";
+        threadHits = metrics.counter("oe_image_pool_allocations_total", help, labels);
+        labels["source"] = "shared";
+        sharedHits = metrics.counter("oe_image_pool_allocations_total", help, labels);
+        labels["source"] = "heap";
+        heapAllocations = metrics.counter("oe_image_pool_allocations_total", help, labels);
+        releases = metrics.counter("oe_image_pool_releases_total", "Image buffers given back");
+        allocatedBytes = metrics.counter("oe_image_pool_allocated_bytes_total", "Bytes of image buffers handed out");
+        releasedBytes = metrics.counter("oe_image_pool_released_bytes_total", "Bytes of image buffers given back");
+        cachedBytesGauge = metrics.gauge("oe_image_pool_cached_bytes", "Bytes held in the shared image buffer pool");
+    }
+
+    // false if the shared pool is full
+    bool push(unsigned index, unsigned char* block, std::size_t blockSize, std::size_t maxBytes)
+    {
+        if (cachedBytes.fetch_add(blockSize) + blockSize > maxBytes)
+        {
+            cachedBytes.fetch_sub(blockSize);
+            return false;
+        }
+
+        SharedClass& c = shared[index];
+        {
+            std::lock_guard<std::mutex> lock(c.mutex);
+            c.blocks.push_back(block);
+        }
+        cachedBytesGauge->set((double)cachedBytes.load());
+        return true;
+    }
+
+    unsigned char* pop(unsigned index, std::size_t blockSize)
+    {
+        SharedClass& c = shared[index];
+        unsigned char* block = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(c.mutex);
+            if (c.blocks.empty())
+                return nullptr;
+            block = c.blocks.back();
+            c.blocks.pop_back();
+        }
+        cachedBytes.fetch_sub(blockSize);
+        cachedBytesGauge->set((double)cachedBytes.load());
+        return block;
+    }
+};
+
+struct ImagePool::ThreadCache
+{
+    std::vector<unsigned char*> blocks[NUM_CLASSES];
+    std::size_t bytes;
+
+    ThreadCache() : bytes(0u) { }
+
+    ~ThreadCache()
+    {
+        t_threadCacheDestroyed = true;
+
+        // hand everything to the shared pool, which outlives all threads
+        ImagePool& pool = ImagePool::instance();
+        for (unsigned i = 0; i < NUM_CLASSES; ++i)
+        {
+            std::size_t blockSize = classSize(i);
+            for (unsigned char* block : blocks[i])
+            {
+                if (!pool._impl->push(i, block, blockSize, pool.getMaxCachedBytes()))
+                    ::operator delete(block);
+            }
+        }
+    }
+
+    static std::size_t classSize(unsigned index)
+    {
+        if (index == 0u)
+            return (std::size_t)1u << MIN_BITS;
+        unsigned k = MIN_BITS + (index - 1u) / 4u;
+        std::size_t sub = (index - 1u) % 4u + 1u;
+        return ((std::size_t)1u << k) + sub * (((std::size_t)1u << k) >> 2);
+    }
+
+    // the calling thread's cache, or nullptr during thread exit
+    static ThreadCache* get()
+    {
+        if (t_threadCacheDestroyed)
+            return nullptr;
+        static thread_local ThreadCache s_cache;
+        return &s_cache;
+    }
+};
+
+//........................................................................
+
+ImagePool&
+ImagePool::instance()
+{
+    // never destroyed, so images may be released during static destruction
+    static ImagePool* s_instance = new ImagePool();
+    return *s_instance;
+}
+
+ImagePool::ImagePool() :
+    _impl(new Impl()),
+    _enabled(true),
+    _maxCachedBytes(256u * 1024u * 1024u)
+{
+    const char* mb = ::getenv("OSGEARTH_IMAGE_POOL_MB");
+    if (mb)
+    {
+        double value = ::atof(mb);
+        if (value > 0.0)
+            setMaxCachedBytes((std::size_t)(value * 1024.0 * 1024.0));
+        else
+            setEnabled(false);
+    }
+}
+
+ImagePool::~ImagePool()
+{
+    delete _impl;
+}
+
+std::size_t
+ImagePool::getBlockSize(std::size_t bytes)
+{
+    std::size_t blockSize;
+    getClass(bytes, blockSize);
+    return blockSize;
+}
+
+unsigned char*
+ImagePool::allocate(std::size_t bytes)
+{
+    std::size_t blockSize;
+    unsigned index = getClass(bytes, blockSize);
+
+    _impl->allocatedBytes->add(blockSize);
+
+    if (index < NUM_CLASSES && isEnabled())
+    {
+        ThreadCache* cache = ThreadCache::get();
+        if (cache && !cache->blocks[index].empty())
+        {
+            unsigned char* block = cache->blocks[index].back();
+            cache->blocks[index].pop_back();
+            cache->bytes -= blockSize;
+            _impl->threadHits->increment();
+            return block;
+        }
+
+        unsigned char* block = _impl->pop(index, blockSize);
+        if (block)
+        {
+            _impl->sharedHits->increment();
+            return block;
+        }
+    }
+
+    _impl->heapAllocations->increment();
+    return static_cast<unsigned char*>(::operator new(blockSize));
+}
+
+void
+ImagePool::release(unsigned char* block, std::size_t bytes)
+{
+    if (block == nullptr)
+        return;
+
+    std::size_t blockSize;
+    unsigned index = getClass(bytes, blockSize);
+
+    _impl->releases->increment();
+    _impl->releasedBytes->add(blockSize);
+
+    if (index < NUM_CLASSES && isEnabled())
+    {
+        ThreadCache* cache = ThreadCache::get();
+        if (cache &&
+            cache->blocks[index].size() < THREAD_BLOCKS_PER_CLASS &&
+            cache->bytes + blockSize <= THREAD_MAX_BYTES)
+        {
+            cache->blocks[index].push_back(block);
+            cache->bytes += blockSize;
+            return;
+        }
+
+        if (_impl->push(index, block, blockSize, getMaxCachedBytes()))
+            return;
+    }
+
+    ::operator delete(block);
+}
+
+void
+ImagePool::trim()
+{
+    ThreadCache* cache = ThreadCache::get();
+    if (cache)
+    {
+        for (unsigned i = 0; i < NUM_CLASSES; ++i)
+        {
+            for (unsigned char* block : cache->blocks[i])
+                ::operator delete(block);
+            cache->blocks[i].clear();
+        }
+        cache->bytes = 0u;
+    }
+
+    for (unsigned i = 0; i < NUM_CLASSES; ++i)
+    {
+        std::vector<unsigned char*> blocks;
+        {
+            std::lock_guard<std::mutex> lock(_impl->shared[i].mutex);
+            blocks.swap(_impl->shared[i].blocks);
+        }
+        for (unsigned char* block : blocks)
+            ::operator delete(block);
+        _impl->cachedBytes.fetch_sub(blocks.size() * ThreadCache::classSize(i));
+    }
+    _impl->cachedBytesGauge->set((double)_impl->cachedBytes.load());
+}
+
+ImagePool::Stats
+ImagePool::getStats() const
+{
+    Stats stats;
+    stats.threadHits = _impl->threadHits->value();
+    stats.sharedHits = _impl->sharedHits->value();
+    stats.heapAllocations = _impl->heapAllocations->value();
+    stats.allocations = stats.threadHits + stats.sharedHits + stats.heapAllocations;
+    stats.releases = _impl->releases->value();
+
+    // read released first, so a concurrent release cannot make this negative
+    std::uint64_t released = _impl->releasedBytes->value();
+    std::uint64_t allocated = _impl->allocatedBytes->value();
+    stats.bytesInUse = allocated > released ? allocated - released : 0u;
+    stats.bytesCached = _impl->cachedBytes.load();
+    return stats;
+}
+
+//........................................................................
+
+PooledImage::PooledImage() :
+    osg::Image(),
+    _block(nullptr),
+    _blockBytes(0u)
+{
+    //nop
+}
+
+PooledImage::~PooledImage()
+{
+    // osg::Image holds the buffer as NO_DELETE, so it is ours to give back
+    if (_block)
+        ImagePool::instance().release(_block, _blockBytes);
+}
+
+void
+PooledImage::releaseUnusedBlock()
+{
+    if (_block && _block != data())
+    {
+        ImagePool::instance().release(_block, _blockBytes);
+        _block = nullptr;
+        _blockBytes = 0u;
+    }
+}
+
+void
+PooledImage::allocateImage(int s, int t, int r, GLenum pixelFormat, GLenum type, int packing)
+{
+    std::size_t bytes = (std::size_t)computeRowWidthInBytes(s, pixelFormat, type, packing) * t * r;
+
+    if (bytes == 0u || !ImagePool::instance().isEnabled())
+    {
+        osg::Image::allocateImage(s, t, r, pixelFormat, type, packing);
+        releaseUnusedBlock();
+        return;
+    }
+
+    // like osg::Image, keep an internal format that is already set
+    GLint internalFormat = getInternalTextureFormat() != 0 ? getInternalTextureFormat() : (GLint)pixelFormat;
+    allocateBuffer(s, t, r, internalFormat, pixelFormat, type, bytes, packing);
+}
+
+void
+PooledImage::setImage(int s, int t, int r,
+                      GLint internalTextureFormat, GLenum pixelFormat, GLenum type,
+                      unsigned char* data, AllocationMode mode,
+                      int packing, int rowLength)
+{
+    osg::Image::setImage(s, t, r, internalTextureFormat, pixelFormat, type, data, mode, packing, rowLength);
+    releaseUnusedBlock();
+}
+
+unsigned char*
+PooledImage::allocateBuffer(int s, int t, int r,
+                            GLint internalTextureFormat, GLenum pixelFormat, GLenum type,
+                            std::size_t totalBytes, int packing, int rowLength)
+{
+    // reuse the current buffer when it is big enough
+    if (_block && _block == data() && ImagePool::getBlockSize(_blockBytes) >= totalBytes)
+    {
+        osg::Image::setImage(s, t, r, internalTextureFormat, pixelFormat, type,
+            _block, NO_DELETE, packing, rowLength);
+        return _block;
+    }
+
+    unsigned char* block = ImagePool::instance().allocate(totalBytes);
+
+    osg::Image::setImage(s, t, r, internalTextureFormat, pixelFormat, type,
+        block, NO_DELETE, packing, rowLength);
+
+    if (_block)
+        ImagePool::instance().release(_block, _blockBytes);
+
+    _block = block;
+    _blockBytes = totalBytes;
+    return block;
+}
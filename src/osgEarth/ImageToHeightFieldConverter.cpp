@@ -22,6 +22,7 @@
 
 #include <osgEarth/ImageToHeightFieldConverter>
 #include <osgEarth/GeoCommon>
+#include <osgEarth/ImagePool>
 
 // not needed for GL Core. Only for GL_R32F
 #include <osg/Texture>
@@ -171,7 +172,7 @@ osg::Image* ImageToHeightFieldConverter::convert16(const osg::HeightField* hf )
     return NULL;
   }
 
-  osg::Image* image = new osg::Image();
+  osg::Image* image = new PooledImage();
   image->allocateImage(hf->getNumColumns(), hf->getNumRows(), 1, GL_LUMINANCE, GL_SHORT);
 
   const osg::FloatArray* floats = hf->getFloatArray();
@@ -195,7 +196,7 @@ osg::Image* ImageToHeightFieldConverter::convertToR32F(const osg::HeightField* h
         return NULL;
     }
 
-    osg::Image* image = new osg::Image();
+    osg::Image* image = new PooledImage();
     image->allocateImage(hf->getNumColumns(), hf->getNumRows(), 1, GL_RED, GL_FLOAT);
     image->setInternalTextureFormat(GL_R32F);
     memcpy(image->data(), &hf->getFloatArray()->front(), sizeof(float) * hf->getFloatArray()->size());
@@ -209,7 +210,7 @@ osg::Image* ImageToHeightFieldConverter::convertToR16F(const osg::HeightField* h
         return NULL;
     }
 
-    osg::Image* image = new osg::Image();
+    osg::Image* image = new PooledImage();
     image->allocateImage(hf->getNumColumns(), hf->getNumRows(), 1, GL_RED, GL_FLOAT);
     image->setInternalTextureFormat(GL_R16F);
     memcpy(image->data(), &hf->getFloatArray()->front(), sizeof(float) * hf->getFloatArray()->size());
@@ -222,7 +223,7 @@ osg::Image* ImageToHeightFieldConverter::convert32(const osg::HeightField* hf) c
     return NULL;
   }
 
-  osg::Image* image = new osg::Image();
+  osg::Image* image = new PooledImage();
   image->allocateImage(hf->getNumColumns(), hf->getNumRows(), 1, GL_LUMINANCE, GL_FLOAT );
   memcpy( image->data(), &hf->getFloatArray()->front(), sizeof(float) * hf->getFloatArray()->size() );
 
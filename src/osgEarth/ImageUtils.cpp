@@ -20,7 +20,9 @@
 #include <osgEarth/ImageUtils>
 #include <osgEarth/Registry>
 #include <osgEarth/Capabilities>
+#include <osgEarth/ImagePool>
 #include <osgEarth/Metrics>
+#include <osgEarth/TexturePipeline>
 
 #include <osg/GLU>
 #include <osgDB/Registry>
@@ -189,7 +191,7 @@ ImageUtils::resizeImage(const osg::Image* input,
 
     if ( !output.valid() )
     {
-        output = new osg::Image();
+        output = new PooledImage();
 
         if ( PixelWriter::supports(input) )
         {
@@ -483,6 +485,15 @@ ImageUtils::mipmapImage(const osg::Image* input)
         return input;
     }
 
+    // 8-bit images go through the (SIMD, multi-threaded) texture pipeline
+    if (TexturePipeline::canProcess(input))
+    {
+        TexturePipeline pipeline;
+        osg::Image* output = pipeline.mipmap(input);
+        output->setName(input->getName());
+        return output;
+    }
+
     // first, build the image that will hold all the mipmap levels.
     int numLevels = osg::Image::computeNumberOfMipmapLevels(input->s(), input->t(), input->r());
     int imageSizeBytes = input->getTotalSizeInBytes();
@@ -499,23 +510,21 @@ ImageUtils::mipmapImage(const osg::Image* input)
         totalSizeBytes += (imageSizeBytes >> i);
     }
 
-    osg::Image* output = new osg::Image();
+    PooledImage* output = new PooledImage();
     output->setName(input->getName());
 
     // allocate space for the new data and copy over level 0 of the old data
-    unsigned char* newData = new unsigned char[totalSizeBytes];
-    ::memcpy(newData, input->data(), input->getTotalSizeInBytes());
-
-    output->setImage(
+    unsigned char* newData = output->allocateBuffer(
         input->s(), input->t(), input->r(),
         input->getInternalTextureFormat(),
         input->getPixelFormat(),
         input->getDataType(),
-        newData,
-        osg::Image::USE_NEW_DELETE,
+        totalSizeBytes,
         input->getPacking(),
         input->getRowLength());
 
+    ::memcpy(newData, input->data(), input->getTotalSizeInBytes());
+
     output->setMipmapLevels(mipOffsets);
 
     // now, populate the image levels.
@@ -646,6 +655,19 @@ ImageUtils::compressImage(
     if (method == "gpu")
         return input;
 
+    // BCn methods (bc1, bc3, bc7, ...) compress and mipmap in one pass
+    TexturePipeline pipeline;
+    if (pipeline.setMethod(method))
+    {
+        osg::Image* compressed = pipeline.process(input);
+        if (compressed)
+        {
+            compressed->setName(input->getName());
+            return compressed;
+        }
+        return input;
+    }
+
     // return the input if nothing works
     osg::Image* output = const_cast<osg::Image*>(input);
 
@@ -701,6 +723,14 @@ ImageUtils::compressImageInPlace(
     if (method.empty() || method == "none")
         return;
 
+    // BCn methods (bc1, bc3, bc7, ...) compress and mipmap in one pass
+    TexturePipeline pipeline;
+    if (pipeline.setMethod(method))
+    {
+        pipeline.processInPlace(input);
+        return;
+    }
+
     // RGB uses DXT1
     osg::Texture::InternalFormatMode mode;
 
@@ -941,7 +971,7 @@ ImageUtils::cropImage(const osg::Image* image,
     //OE_NOTICE << "Copying from " << windowX << ", " << windowY << ", " << windowWidth << ", " << windowHeight << std::endl;
 
     //Allocate the croppped image
-    osg::Image* cropped = new osg::Image;
+    osg::Image* cropped = new PooledImage();
     cropped->allocateImage(windowWidth, windowHeight, image->r(), image->getPixelFormat(), image->getDataType());
     cropped->setInternalTextureFormat( image->getInternalTextureFormat() );
 
@@ -1024,7 +1054,7 @@ ImageUtils::createEmptyImage()
 osg::Image*
 ImageUtils::createEmptyImage(unsigned int s, unsigned int t, unsigned int r)
 {
-    osg::Image* empty = new osg::Image;
+    osg::Image* empty = new PooledImage();
     empty->allocateImage(s,t, r, GL_RGBA, GL_UNSIGNED_BYTE);
     empty->setInternalTextureFormat( GL_RGB8A_INTERNAL );
     unsigned char *data = empty->data(0,0);
@@ -1237,7 +1267,7 @@ ImageUtils::convert(const osg::Image* image, GLenum pixelFormat, GLenum dataType
     if ( dataType == GL_UNSIGNED_BYTE && pixelFormat == GL_RGBA && image->getDataType() == GL_UNSIGNED_BYTE && image->getPixelFormat() == GL_RGB)
     {
         // Do fast conversion
-        osg::Image* result = new osg::Image();
+        osg::Image* result = new PooledImage();
         result->allocateImage(image->s(), image->t(), image->r(), GL_RGBA, GL_UNSIGNED_BYTE);
         result->setInternalTextureFormat(GL_RGBA8);
 
@@ -1270,7 +1300,7 @@ ImageUtils::convert(const osg::Image* image, GLenum pixelFormat, GLenum dataType
         return 0L;
 
     // Generic conversion : use PixelVisitor
-    osg::Image* result = new osg::Image();
+    osg::Image* result = new PooledImage();
     result->allocateImage(image->s(), image->t(), image->r(), pixelFormat, dataType);
     memset(result->data(), 0, result->getTotalSizeInBytes());
 
@@ -1438,6 +1468,7 @@ ImageUtils::isCompressed(const osg::Image *image)
         case(GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG):
         case(GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG):
         case(GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG):
+        case(GL_COMPRESSED_RGBA_BPTC_UNORM_ARB):
             return true;
         default:
             return false;
@@ -17,7 +17,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>
  */
 #include <osgEarth/MBTiles>
+#include <osgEarth/ByteBuffer>
 #include <osgEarth/Registry>
+#include <osgEarth/Progress>
 #include <osgEarth/FileUtils>
 #include <osgEarth/XmlUtils>
 #include <osgEarth/StringUtils>
@@ -593,6 +595,14 @@ MBTiles::Driver::read(
 {
     Threading::ScopedMutexLock exclusiveLock(_mutex);
 
+    // Readers queue up on the database lock, so the task may well have
+    // been canceled by the time this one gets it
+    if (progress && progress->isCanceled())
+    {
+        progress->recordCancelation("mbtiles");
+        return ReadResult::RESULT_CANCELED;
+    }
+
     int z = key.getLevelOfDetail();
     int x = key.getTileX();
     int y = key.getTileY();
@@ -638,12 +648,15 @@ MBTiles::Driver::read(
         const char* data = (const char*)sqlite3_column_blob( select, 0 );
         int dataLen = sqlite3_column_bytes( select, 0 );
 
-        std::string dataBuffer( data, dataLen );
+        // one copy out of sqlite into a pooled buffer; the decoders
+        // read it in place from there
+        osg::ref_ptr<Util::ByteBuffer> dataBuffer = Util::ByteBuffer::create( dataLen );
+        dataBuffer->append( data, dataLen );
 
         // decompress if necessary:
         if ( _compressor.valid() )
         {
-            std::istringstream inputStream(dataBuffer);
+            Util::ByteBufferStream inputStream(dataBuffer.get());
             std::string value;
             if ( !_compressor->decompress(inputStream, value) )
             {
@@ -652,14 +665,23 @@ MBTiles::Driver::read(
             }
             else
             {
-                dataBuffer = value;
+                dataBuffer->clear();
+                dataBuffer->append( value.data(), value.size() );
             }
         }
 
+        // skip the decode if the task was canceled during the query
+        if ( valid && progress && progress->isCanceled() )
+        {
+            progress->recordCancelation("mbtiles");
+            sqlite3_finalize( select );
+            return ReadResult::RESULT_CANCELED;
+        }
+
         // decode the raw image data:
         if ( valid )
         {
-            std::istringstream inputStream(dataBuffer);
+            Util::ByteBufferStream inputStream(dataBuffer.get());
             result = ImageUtils::readStream(inputStream, _dbOptions.get());
         }
     }
@@ -0,0 +1,504 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+ * Copyright 2020 Pelican Mapping
+ * http://osgearth.org
+ *
+ * osgEarth is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+#include <osgEarth/MetricsRegistry>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+using namespace osgEarth::Util;
+
+namespace
+{
+    // Slot for the calling thread; threads are dealt out round-robin.
+    unsigned getThreadSlot(unsigned numSlots)
+    {
+        static std::atomic<unsigned> s_nextSlot(0u);
+        static thread_local unsigned s_slot = s_nextSlot++;
+        return s_slot % numSlots;
+    }
+
+    // Position of the highest set bit (v > 0)
+    unsigned highestBit(std::uint64_t v)
+    {
+        unsigned b = 0u;
+        if (v >= (1ull << 32)) { v >>= 32; b += 32; }
+        if (v >= (1ull << 16)) { v >>= 16; b += 16; }
+        if (v >= (1ull << 8))  { v >>= 8;  b += 8; }
+        if (v >= (1ull << 4))  { v >>= 4;  b += 4; }
+        if (v >= (1ull << 2))  { v >>= 2;  b += 2; }
+        if (v >= (1ull << 1))  { b += 1; }
+        return b;
+    }
+
+    // Key that orders metrics by name, then labels
+    std::string makeKey(const std::string& name, const MetricsRegistry::Labels& labels)
+    {
+        std::string key = name;
+        for (MetricsRegistry::Labels::const_iterator i = labels.begin(); i != labels.end(); ++i)
+        {
+            key += '\0';
+            key += i->first;
+            key += '\0';
+            key += i->second;
+        }
+        return key;
+    }
+
+    void writeNumber(std::ostream& out, double value, bool json)
+    {
+        if (std::isnan(value))
+            out << (json ? "null" : "NaN");
+        else if (std::isinf(value))
+            out << (json ? "null" : (value > 0.0 ? "+Inf" : "-Inf"));
+        else if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0)
+            out << (long long)value;
+        else
+            out << std::setprecision(9) << value;
+    }
+
+    void writeEscaped(std::ostream& out, const std::string& value, bool json)
+    {
+        for (std::string::const_iterator c = value.begin(); c != value.end(); ++c)
+        {
+            if (*c == '\\') out << "\\\\";
+            else if (*c == '"') out << "\\\"";
+            else if (*c == '\n') out << "\\n";
+            else if (json && (unsigned char)*c < 0x20)
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)*c << std::dec << std::setfill(' ');
+            else out << *c;
+        }
+    }
+
+    void writePrometheusLabels(std::ostream& out, const MetricsRegistry::Labels& labels, const char* extraName =0L, double extraValue =0.0)
+    {
+        if (labels.empty() && !extraName)
+            return;
+
+        out << '{';
+        bool first = true;
+        for (MetricsRegistry::Labels::const_iterator i = labels.begin(); i != labels.end(); ++i)
+        {
+            if (!first) out << ',';
+            out << i->first << "=\"";
+            writeEscaped(out, i->second, false);
+            out << '"';
+            first = false;
+        }
+        if (extraName)
+        {
+            if (!first) out << ',';
+            out << extraName << "=\"";
+            writeNumber(out, extraValue, false);
+            out << '"';
+        }
+        out << '}';
+    }
+
+    const char* typeName(MetricsRegistry::Type type)
+    {
+        return
+            type == MetricsRegistry::TYPE_COUNTER ? "counter" :
+            type == MetricsRegistry::TYPE_GAUGE ? "gauge" :
+            "histogram";
+    }
+}
+
+//...................................................................
+
+MetricsRegistry::Counter::Counter()
+{
+    for (unsigned i = 0; i < NUM_SLOTS; ++i)
+        _slots[i].value.store(0u, std::memory_order_relaxed);
+}
+
+void
+MetricsRegistry::Counter::add(std::uint64_t n)
+{
+    _slots[getThreadSlot(NUM_SLOTS)].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+std::uint64_t
+MetricsRegistry::Counter::value() const
+{
+    std::uint64_t sum = 0u;
+    for (unsigned i = 0; i < NUM_SLOTS; ++i)
+        sum += _slots[i].value.load(std::memory_order_relaxed);
+    return sum;
+}
+
+//...................................................................
+
+MetricsRegistry::Gauge::Gauge() :
+    _value(0.0)
+{
+    //nop
+}
+
+void
+MetricsRegistry::Gauge::add(double delta)
+{
+    double current = _value.load(std::memory_order_relaxed);
+    while (!_value.compare_exchange_weak(current, current + delta, std::memory_order_relaxed));
+}
+
+//...................................................................
+
+MetricsRegistry::Histogram::Histogram(double resolution) :
+    _resolution(resolution > 0.0 ? resolution : 1e-6),
+    _count(0u),
+    _sum(0u),
+    _max(0u)
+{
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i)
+        _buckets[i].store(0u, std::memory_order_relaxed);
+}
+
+void
+MetricsRegistry::Histogram::record(double value)
+{
+    const std::uint64_t limit = (1ull << MAX_BITS) - 1u;
+
+    double scaled = value > 0.0 ? value / _resolution + 0.5 : 0.0;
+    std::uint64_t v = scaled >= (double)limit ? limit : (std::uint64_t)scaled;
+
+    // The first SUB_BUCKETS values get a bucket each; above that, each power
+    // of two is split into SUB_BUCKETS equal buckets.
+    unsigned index;
+    if (v < SUB_BUCKETS)
+    {
+        index = (unsigned)v;
+    }
+    else
+    {
+        unsigned shift = highestBit(v) - SUB_BITS;
+        index = SUB_BUCKETS * (shift + 1) + (unsigned)((v >> shift) - SUB_BUCKETS);
+    }
+
+    _buckets[index].fetch_add(1u, std::memory_order_relaxed);
+    _count.fetch_add(1u, std::memory_order_relaxed);
+    _sum.fetch_add(v, std::memory_order_relaxed);
+
+    std::uint64_t max = _max.load(std::memory_order_relaxed);
+    while (v > max && !_max.compare_exchange_weak(max, v, std::memory_order_relaxed));
+}
+
+double
+MetricsRegistry::Histogram::getSum() const
+{
+    return (double)_sum.load(std::memory_order_relaxed) * _resolution;
+}
+
+double
+MetricsRegistry::Histogram::getMax() const
+{
+    return (double)_max.load(std::memory_order_relaxed) * _resolution;
+}
+
+double
+MetricsRegistry::Histogram::getQuantile(double q) const
+{
+    std::uint64_t count = getCount();
+    if (count == 0u)
+        return 0.0;
+
+    q = std::min(std::max(q, 0.0), 1.0);
+    std::uint64_t rank = std::max((std::uint64_t)1u, (std::uint64_t)std::ceil(q * (double)count));
+
+    std::uint64_t seen = 0u;
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i)
+    {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            // report the middle of the bucket, but never more than the max
+            double low, width;
+            if (i < SUB_BUCKETS)
+            {
+                low = (double)i;
+                width = 1.0;
+            }
+            else
+            {
+                unsigned shift = i / SUB_BUCKETS - 1u;
+                low = (double)((std::uint64_t)(SUB_BUCKETS + i % SUB_BUCKETS) << shift);
+                width = (double)(1ull << shift);
+            }
+            double mid = low + 0.5 * (width - 1.0);
+            return std::min(mid * _resolution, getMax());
+        }
+    }
+    return getMax();
+}
+
+//...................................................................
+
+const MetricsRegistry::Sample*
+MetricsRegistry::Snapshot::find(const std::string& name, const Labels& labels) const
+{
+    for (std::vector<Sample>::const_iterator s = samples.begin(); s != samples.end(); ++s)
+    {
+        if (s->name == name && s->labels == labels)
+            return &(*s);
+    }
+    return nullptr;
+}
+
+std::string
+MetricsRegistry::Snapshot::toJSON() const
+{
+    std::ostringstream out;
+    out << "{\"metrics\":[";
+    for (std::vector<Sample>::const_iterator s = samples.begin(); s != samples.end(); ++s)
+    {
+        if (s != samples.begin())
+            out << ',';
+
+        out << "{\"name\":\"";
+        writeEscaped(out, s->name, true);
+        out << "\",\"type\":\"" << typeName(s->type) << "\",\"help\":\"";
+        writeEscaped(out, s->help, true);
+        out << "\",\"labels\":{";
+        for (Labels::const_iterator i = s->labels.begin(); i != s->labels.end(); ++i)
+        {
+            if (i != s->labels.begin())
+                out << ',';
+            out << '"';
+            writeEscaped(out, i->first, true);
+            out << "\":\"";
+            writeEscaped(out, i->second, true);
+            out << '"';
+        }
+        out << '}';
+
+        if (s->type == TYPE_HISTOGRAM)
+        {
+            out << ",\"count\":" << s->count << ",\"sum\":";
+            writeNumber(out, s->sum, true);
+            out << ",\"max\":";
+            writeNumber(out, s->max, true);
+            out << ",\"quantiles\":{";
+            for (unsigned i = 0; i < s->quantiles.size(); ++i)
+            {
+                if (i > 0)
+                    out << ',';
+                out << '"';
+                writeNumber(out, s->quantiles[i].first, true);
+                out << "\":";
+                writeNumber(out, s->quantiles[i].second, true);
+            }
+            out << '}';
+        }
+        else
+        {
+            out << ",\"value\":";
+            writeNumber(out, s->value, true);
+        }
+        out << '}';
+    }
+    out << "]}";
+    return out.str();
+}
+
+std::string
+MetricsRegistry::Snapshot::toPrometheus() const
+{
+    std::ostringstream out;
+    const std::string* lastName = 0L;
+
+    for (std::vector<Sample>::const_iterator s = samples.begin(); s != samples.end(); ++s)
+    {
+        // HELP and TYPE once per metric family
+        if (!lastName || *lastName != s->name)
+        {
+            if (!s->help.empty())
+            {
+                out << "# HELP " << s->name << ' ';
+                writeEscaped(out, s->help, false);
+                out << '\n';
+            }
+            out << "# TYPE " << s->name << ' ' << (s->type == TYPE_HISTOGRAM ? "summary" : typeName(s->type)) << '\n';
+            lastName = &s->name;
+        }
+
+        if (s->type == TYPE_HISTOGRAM)
+        {
+            for (unsigned i = 0; i < s->quantiles.size(); ++i)
+            {
+                out << s->name;
+                writePrometheusLabels(out, s->labels, "quantile", s->quantiles[i].first);
+                out << ' ';
+                writeNumber(out, s->quantiles[i].second, false);
+                out << '\n';
+            }
+            out << s->name << "_sum";
+            writePrometheusLabels(out, s->labels);
+            out << ' ';
+            writeNumber(out, s->sum, false);
+            out << '\n';
+            out << s->name << "_count";
+            writePrometheusLabels(out, s->labels);
+            out << ' ' << s->count << '\n';
+        }
+        else
+        {
+            out << s->name;
+            writePrometheusLabels(out, s->labels);
+            out << ' ';
+            writeNumber(out, s->value, false);
+            out << '\n';
+        }
+    }
+    return out.str();
+}
+
+//...................................................................
+
+struct MetricsRegistry::Impl
+{
+    struct Entry
+    {
+        std::string name;
+        std::string help;
+        Labels labels;
+        Type type;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    std::mutex mutex;
+    std::map<std::string, Entry> entries;
+
+    Entry& get(const std::string& name, const std::string& help, const Labels& labels, Type type)
+    {
+        // different types never share an entry, even under the same name
+        std::string key = makeKey(name, labels);
+        key += '\0';
+        key += (char)('0' + (int)type);
+
+        Entry& entry = entries[key];
+        if (entry.name.empty())
+        {
+            entry.name = name;
+            entry.help = help;
+            entry.labels = labels;
+            entry.type = type;
+        }
+        return entry;
+    }
+};
+
+MetricsRegistry&
+MetricsRegistry::instance()
+{
+    // never destroyed, so metrics stay valid during static destruction
+    static MetricsRegistry* s_instance = new MetricsRegistry();
+    return *s_instance;
+}
+
+MetricsRegistry::MetricsRegistry() :
+    _impl(new Impl())
+{
+    //nop
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    delete _impl;
+}
+
+MetricsRegistry::Counter*
+MetricsRegistry::counter(const std::string& name, const std::string& help, const Labels& labels)
+{
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    Impl::Entry& entry = _impl->get(name, help, labels, TYPE_COUNTER);
+    if (!entry.counter)
+        entry.counter.reset(new Counter());
+    return entry.counter.get();
+}
+
+MetricsRegistry::Gauge*
+MetricsRegistry::gauge(const std::string& name, const std::string& help, const Labels& labels)
+{
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    Impl::Entry& entry = _impl->get(name, help, labels, TYPE_GAUGE);
+    if (!entry.gauge)
+        entry.gauge.reset(new Gauge());
+    return entry.gauge.get();
+}
+
+MetricsRegistry::Histogram*
+MetricsRegistry::histogram(const std::string& name, const std::string& help, const Labels& labels, double resolution)
+{
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    Impl::Entry& entry = _impl->get(name, help, labels, TYPE_HISTOGRAM);
+    if (!entry.histogram)
+        entry.histogram.reset(new Histogram(resolution));
+    return entry.histogram.get();
+}
+
+MetricsRegistry::Snapshot
+MetricsRegistry::snapshot() const
+{
+    static const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+    Snapshot result;
+
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    result.samples.reserve(_impl->entries.size());
+
+    for (std::map<std::string, Impl::Entry>::const_iterator i = _impl->entries.begin(); i != _impl->entries.end(); ++i)
+    {
+        const Impl::Entry& entry = i->second;
+
+        Sample sample;
+        sample.name = entry.name;
+        sample.help = entry.help;
+        sample.labels = entry.labels;
+        sample.type = entry.type;
+        sample.value = 0.0;
+        sample.count = 0u;
+        sample.sum = 0.0;
+        sample.max = 0.0;
+
+        if (entry.counter)
+        {
+            sample.value = (double)entry.counter->value();
+        }
+        else if (entry.gauge)
+        {
+            sample.value = entry.gauge->value();
+        }
+        else if (entry.histogram)
+        {
+            sample.count = entry.histogram->getCount();
+            sample.sum = entry.histogram->getSum();
+            sample.max = entry.histogram->getMax();
+            for (unsigned q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); ++q)
+                sample.quantiles.push_back(std::make_pair(quantiles[q], entry.histogram->getQuantile(quantiles[q])));
+        }
+
+        result.samples.push_back(sample);
+    }
+
+    return result;
+}
@@ -21,9 +21,12 @@
 #include <osgEarth/GeometryUtils>
 #include <osgEarth/FeatureCursor>
 #include <osgEarth/Filter>
+#include <osgEarth/GeoJSONReader>
 
 #include <osgEarth/Registry>
 #include <osgEarth/StringUtils>
+#include <osgDB/FileNameUtils>
+#include <osgDB/FileUtils>
 #include <list>
 #include <cpl_error.h>
 #include <ogr_api.h>
@@ -80,6 +83,101 @@ namespace osgEarth { namespace OGR
         }
         return true;
     }
+
+    /**
+     * Cursor that streams features from a local GeoJSON file with the
+     * GeoJSONReader instead of OGR, so the driver never has to load the
+     * whole document. Applies the same blacklist, validation and filter
+     * chain as OGRFeatureCursor, one chunk at a time.
+     */
+    class GeoJSONFileCursor : public FeatureCursor
+    {
+    public:
+        GeoJSONFileCursor(
+            GeoJSONFeatureCursor*     input,
+            const FeatureSource*      source,
+            const FeatureProfile*     profile,
+            const Query&              query,
+            const FeatureFilterChain* filters,
+            ProgressCallback*         progress) :
+            FeatureCursor(progress),
+            _input(input),
+            _source(source),
+            _profile(profile),
+            _query(query),
+            _filters(filters),
+            _chunkSize(500)
+        {
+            readChunk();
+        }
+
+        bool hasMore() const
+        {
+            return !_queue.empty();
+        }
+
+        Feature* nextFeature()
+        {
+            if (!hasMore())
+                return 0L;
+
+            _lastFeatureReturned = _queue.front();
+            _queue.pop();
+
+            if (_queue.empty())
+                readChunk();
+
+            return _lastFeatureReturned.get();
+        }
+
+    private:
+        void readChunk()
+        {
+            FeatureList filterList;
+            while (filterList.empty() && _input->hasMore())
+            {
+                while (filterList.size() < _chunkSize && _input->hasMore())
+                {
+                    osg::ref_ptr<Feature> feature = _input->nextFeature();
+                    if (feature.valid() &&
+                        !_source->isBlacklisted(feature->getFID()) &&
+                        validateGeometry(feature->getGeometry()))
+                    {
+                        filterList.push_back(feature.get());
+                    }
+                }
+
+                if (_filters.valid() && !_filters->empty() && !filterList.empty())
+                {
+                    FilterContext cx;
+                    cx.setProfile(_profile.get());
+                    if (_query.bounds().isSet())
+                        cx.extent() = GeoExtent(_profile->getSRS(), _query.bounds().get());
+                    else
+                        cx.extent() = _profile->getExtent();
+
+                    for (FeatureFilterChain::const_iterator i = _filters->begin(); i != _filters->end(); ++i)
+                    {
+                        cx = i->get()->push(filterList, cx);
+                    }
+                }
+            }
+
+            for (FeatureList::const_iterator i = filterList.begin(); i != filterList.end(); ++i)
+            {
+                _queue.push(i->get());
+            }
+        }
+
+        osg::ref_ptr<GeoJSONFeatureCursor> _input;
+        osg::ref_ptr<const FeatureSource> _source;
+        osg::ref_ptr<const FeatureProfile> _profile;
+        Query _query;
+        osg::ref_ptr<const FeatureFilterChain> _filters;
+        unsigned _chunkSize;
+        std::queue< osg::ref_ptr<Feature> > _queue;
+        osg::ref_ptr<Feature> _lastFeatureReturned;
+    };
 } }
 
 //........................................................................
@@ -187,6 +285,14 @@ _rewindPolygons   (rewindPolygons)
 
 
     OE_DEBUG << LC << "SQL: " << expr << std::endl;
+
+    // don't run the query at all for a task that is already obsolete
+    if (_progress.valid() && _progress->isCanceled())
+    {
+        _progress->recordCancelation("features");
+        return;
+    }
+
     _resultSetHandle = OGR_DS_ExecuteSQL(_dsHandle, expr.c_str(), _spatialFilter, 0L);
 
     if (_resultSetHandle)
@@ -265,6 +371,14 @@ OGR::OGRFeatureCursor::readChunk()
     
     while( _queue.size() < _chunkSize && !_resultSetEndReached )
     {
+        // once the task is canceled the cursor just runs dry
+        if (_progress.valid() && _progress->isCanceled())
+        {
+            _progress->recordCancelation("features");
+            _resultSetEndReached = true;
+            break;
+        }
+
         FeatureList filterList;
         while( filterList.size() < _chunkSize && !_resultSetEndReached )
         {
@@ -395,6 +509,7 @@ OGRFeatureSource::init()
     _needsSync = false;
     _writable = false;
     _geometryType = Geometry::TYPE_UNKNOWN;
+    _streamGeoJSON = false;
 }
 
 Status
@@ -475,6 +590,20 @@ OGRFeatureSource::openImplementation()
     // Try to open the datasource and establish a feature profile.        
     FeatureProfile* featureProfile = 0L;
 
+    // Read-only local GeoJSON files are streamed with the GeoJSONReader
+    // instead of being opened by the OGR driver, which parses the whole
+    // document up front. OGR is only used for SQL expression queries.
+    if (!_source.empty() && !_geometry.valid())
+    {
+        std::string ext = osgDB::getLowerCaseFileExtension(_source);
+        std::string driverName = options().ogrDriver().value();
+        _streamGeoJSON =
+            !(options().openWrite().isSet() && options().openWrite().value()) &&
+            (ext == "geojson" || ext == "json") &&
+            (driverName.empty() || driverName == "GeoJSON") &&
+            osgDB::fileExists(_source);
+    }
+
     // see if we have a custom profile.
     if (options().profile().isSet() && !_profile.valid())
     {
@@ -500,6 +629,36 @@ OGRFeatureSource::openImplementation()
         featureProfile = new FeatureProfile(ex);
     }
 
+    else if (_streamGeoJSON)
+    {
+        _ogrDriverHandle = OGRGetDriverByName("GeoJSON");
+
+        // GeoJSON is always WGS84, so only the extent needs the data. Without
+        // a user profile that takes one streaming pass over the file.
+        Bounds bounds;
+        if (!initStreamedSchema(_profile.valid() ? 0L : &bounds))
+        {
+            return Status(Status::ResourceUnavailable, Stringify() << "Failed to read \"" << _source << "\"");
+        }
+
+        if (_profile.valid())
+        {
+            featureProfile = new FeatureProfile(_profile->getExtent());
+        }
+        else
+        {
+            const SpatialReference* srs = SpatialReference::get("wgs84");
+            GeoExtent extent = bounds.isValid() ?
+                GeoExtent(srs, bounds) :
+                osgEarth::Registry::instance()->getGlobalGeodeticProfile()->getExtent();
+
+            featureProfile = new FeatureProfile(extent);
+        }
+
+        // counting the features exactly would mean another full pass
+        _featureCount = -1;
+    }
+
     else if (!_source.empty())
     {
         // otherwise, assume we're loading from the URL/connection:
@@ -795,6 +954,40 @@ OGRFeatureSource::createFeatureCursorImplementation(const Query& query, Progress
     }
     else
     {
+        Query newQuery(query);
+        if (options().query().isSet())
+        {
+            newQuery = options().query()->combineWith(query);
+        }
+
+        // SQL expressions and ordering still require the OGR driver.
+        if (_streamGeoJSON && !newQuery.expression().isSet() && !newQuery.orderby().isSet())
+        {
+            if (newQuery.tileKey().isSet() && !newQuery.bounds().isSet())
+            {
+                GeoExtent localEx = newQuery.tileKey()->getExtent().transform(getFeatureProfile()->getSRS());
+                newQuery.bounds() = localEx.bounds();
+            }
+
+            GeoJSONReader reader;
+            reader.setFeatureProfile(getFeatureProfile());
+            reader.setRewindPolygons(*_options->rewindPolygons());
+            if (newQuery.bounds().isSet())
+                reader.setBounds(newQuery.bounds().get());
+
+            GeoJSONFeatureCursor* input = GeoJSONFeatureCursor::open(_source, reader, progress);
+            if (!input)
+                return 0L;
+
+            return new OGR::GeoJSONFileCursor(
+                input,
+                this,
+                getFeatureProfile(),
+                newQuery,
+                getFilters(),
+                progress);
+        }
+
         OGRDataSourceH dsHandle = 0L;
         OGRLayerH layerHandle = 0L;
 
@@ -809,12 +1002,6 @@ OGRFeatureSource::createFeatureCursorImplementation(const Query& query, Progress
 
         if (dsHandle && layerHandle)
         {
-            Query newQuery(query);
-            if (options().query().isSet())
-            {
-                newQuery = options().query()->combineWith(query);
-            }
-
             OE_DEBUG << newQuery.getConfig().toJSON(true) << std::endl;
 
             // cursor is responsible for the OGR handles.
@@ -864,7 +1051,8 @@ OGRFeatureSource::getFeatureCount() const
 bool
 OGRFeatureSource::supportsGetFeature() const
 {
-    return true;
+    // a streamed GeoJSON file has no random access
+    return !_streamGeoJSON;
 }
 
 Feature*
@@ -1006,3 +1194,53 @@ OGRFeatureSource::initSchema()
         _schema[name] = OgrUtils::getAttributeType(ogrType);
     }
 }
+
+bool
+OGRFeatureSource::initStreamedSchema(Bounds* out_extent)
+{
+    // number of leading features to sample for the schema
+    const unsigned maxSchemaFeatures = 1000u;
+
+    unsigned numFeatures = 0u;
+    bool firstGeometry = true;
+
+    GeoJSONReader reader;
+    reader.setSRS(SpatialReference::get("wgs84"));
+    reader.setRewindPolygons(false);
+
+    bool ok = reader.readFile(_source, [&](Feature* feature)
+    {
+        if (numFeatures < maxSchemaFeatures)
+        {
+            const AttributeTable& attrs = feature->getAttrs();
+            for (AttributeTable::const_iterator a = attrs.begin(); a != attrs.end(); ++a)
+            {
+                AttributeType type = a->second.first;
+                FeatureSchema::iterator s = _schema.find(a->first);
+                if (s == _schema.end() || s->second == ATTRTYPE_UNSPECIFIED)
+                    _schema[a->first] = type;
+                else if (s->second != type && type != ATTRTYPE_UNSPECIFIED)
+                    s->second = (s->second == ATTRTYPE_INT && type == ATTRTYPE_DOUBLE) || (s->second == ATTRTYPE_DOUBLE && type == ATTRTYPE_INT) ?
+                        ATTRTYPE_DOUBLE : ATTRTYPE_STRING;
+            }
+
+            // a layer of mixed geometry types has no single type
+            if (feature->getGeometry())
+            {
+                Geometry::Type type = feature->getGeometry()->getType();
+                _geometryType = firstGeometry || _geometryType == type ? type : Geometry::TYPE_UNKNOWN;
+                firstGeometry = false;
+            }
+        }
+
+        if (out_extent && feature->getGeometry())
+        {
+            out_extent->expandBy(feature->getGeometry()->getBounds());
+        }
+
+        ++numFeatures;
+        return out_extent != 0L || numFeatures < maxSchemaFeatures;
+    });
+
+    return ok;
+}
@@ -60,9 +60,15 @@ namespace
 }
 
 ObjectIndex::ObjectIndex() :
-_idGen( STARTING_OBJECT_ID ),
-_mutex("ObjectIndex(OE)")
+_nextSlot( STARTING_OBJECT_ID ),
+_freeHead( NO_SLOT ),
+_retired ( 0L ),
+_readers ( 0 ),
+_size    ( 0u )
 {
+    for(unsigned p=0; p<MAX_PAGES; ++p)
+        _pages[p].store( 0L );
+
     _attribName     = "oe_index_objectid_attr";
     _attribLocation = osg::Drawable::SECONDARY_COLORS;
     _oidUniformName = "oe_index_objectid_uniform";
@@ -71,6 +77,33 @@ _mutex("ObjectIndex(OE)")
     _shaders.add( "ObjectIndex.vert.glsl", indexVertexInit );
 }
 
+ObjectIndex::~ObjectIndex()
+{
+    for(unsigned p=0; p<MAX_PAGES; ++p)
+    {
+        Slot* page = _pages[p].load();
+        if ( page )
+        {
+            for(unsigned i=0; i<PAGE_SIZE; ++i)
+            {
+                osg::ObserverSet* observers = page[i]._observers.load();
+                if ( observers )
+                    observers->unref();
+            }
+            delete [] page;
+        }
+    }
+
+    Retired* r = _retired.exchange( 0L );
+    while( r )
+    {
+        Retired* next = r->_next;
+        r->_observers->unref();
+        delete r;
+        r = next;
+    }
+}
+
 bool
 ObjectIndex::loadShaders(VirtualProgram* vp) const
 {
@@ -85,7 +118,7 @@ ObjectIndex::loadShaders(VirtualProgram* vp) const
 void
 ObjectIndex::setObjectIDAtrribLocation(int value)
 {
-    if ( _index.size() == 0 )
+    if ( size() == 0 )
     {
         _attribLocation = value;
     } 
@@ -95,51 +128,316 @@ ObjectIndex::setObjectIDAtrribLocation(int value)
     }
 }
 
+ObjectIndex::Slot*
+ObjectIndex::getSlot(unsigned slot) const
+{
+    Slot* page = _pages[slot >> PAGE_BITS].load();
+    return page ? &page[slot & (PAGE_SIZE-1u)] : 0L;
+}
+
+ObjectIndex::Slot*
+ObjectIndex::getOrCreateSlot(unsigned slot)
+{
+    std::atomic<Slot*>& pagePtr = _pages[slot >> PAGE_BITS];
+    Slot* page = pagePtr.load();
+    if ( !page )
+    {
+        // another thread may be allocating the same page; first one wins.
+        Slot* newPage = new Slot[PAGE_SIZE];
+        if ( pagePtr.compare_exchange_strong(page, newPage) )
+            page = newPage;
+        else
+            delete [] newPage;
+    }
+    return &page[slot & (PAGE_SIZE-1u)];
+}
+
+unsigned
+ObjectIndex::popFree()
+{
+    unsigned long long head = _freeHead.load();
+    for(;;)
+    {
+        unsigned slot = (unsigned)(head & 0xFFFFFFFFull);
+        if ( slot == NO_SLOT )
+        {
+            // free list is empty; take a never-used slot.
+            slot = _nextSlot.fetch_add(1u);
+            if ( slot > SLOT_MASK )
+            {
+                _nextSlot.store( SLOT_MASK+1u );
+                return NO_SLOT;
+            }
+            return slot;
+        }
+
+        // the tag in the high bits defeats ABA when the head is popped and pushed back.
+        unsigned next = getSlot(slot)->_nextFree.load();
+        unsigned long long newHead = ((head >> 32) + 1ull) << 32 | (unsigned long long)next;
+        if ( _freeHead.compare_exchange_weak(head, newHead) )
+            return slot;
+    }
+}
+
+void
+ObjectIndex::popFree(unsigned count, std::vector<unsigned>& output)
+{
+    // takes up to "count" slots off the free list in one operation, and
+    // the rest from the never-used slots.
+    std::vector<unsigned> chain;
+    chain.reserve( count );
+
+    unsigned long long head = _freeHead.load();
+    for(;;)
+    {
+        chain.clear();
+        unsigned next = (unsigned)(head & 0xFFFFFFFFull);
+        while( next != NO_SLOT && chain.size() < count )
+        {
+            chain.push_back( next );
+            next = getSlot(next)->_nextFree.load();
+        }
+
+        if ( chain.empty() )
+            break;
+
+        // the tag changes on every push and pop, so a successful exchange
+        // means the chain we walked did not change underneath us.
+        unsigned long long newHead = ((head >> 32) + 1ull) << 32 | (unsigned long long)next;
+        if ( _freeHead.compare_exchange_weak(head, newHead) )
+            break;
+    }
+
+    output.insert( output.end(), chain.begin(), chain.end() );
+
+    unsigned remaining = count - (unsigned)chain.size();
+    if ( remaining > 0u )
+    {
+        unsigned first = _nextSlot.fetch_add( remaining );
+        for(unsigned s = first; s < first + remaining && s <= SLOT_MASK; ++s)
+            output.push_back( s );
+
+        if ( first + remaining > SLOT_MASK + 1u )
+            _nextSlot.store( SLOT_MASK+1u );
+    }
+}
+
+void
+ObjectIndex::pushFree(unsigned head, unsigned tail, unsigned count)
+{
+    // pushes a pre-linked chain of slots (head..tail) in one operation.
+    if ( head != NO_SLOT )
+    {
+        Slot* tailSlot = getSlot(tail);
+        unsigned long long oldHead = _freeHead.load();
+        for(;;)
+        {
+            tailSlot->_nextFree.store( (unsigned)(oldHead & 0xFFFFFFFFull) );
+            unsigned long long newHead = ((oldHead >> 32) + 1ull) << 32 | (unsigned long long)head;
+            if ( _freeHead.compare_exchange_weak(oldHead, newHead) )
+                break;
+        }
+    }
+
+    if ( count > 0u )
+    {
+        _size -= count;
+        reclaim();
+    }
+}
+
 ObjectID
 ObjectIndex::insert(osg::Referenced* object)
 {
-    Threading::ScopedMutexLock excl( _mutex );
-    return insertImpl( object );
+    unsigned s = popFree();
+    if ( s == NO_SLOT )
+    {
+        OE_WARN << LC << "Index is full; cannot insert another object\n";
+        return OSGEARTH_OBJECTID_EMPTY;
+    }
+
+    ObjectID id = insertImpl( s, object );
+    ++_size;
+
+    OE_DEBUG << LC << "Insert " << id << "; size = " << size() << "\n";
+    return id;
+}
+
+void
+ObjectIndex::insert(const std::vector<osg::Referenced*>& objects, std::vector<ObjectID>& output)
+{
+    if ( objects.empty() )
+        return;
+
+    std::vector<unsigned> slots;
+    slots.reserve( objects.size() );
+    popFree( (unsigned)objects.size(), slots );
+    if ( slots.size() < objects.size() )
+    {
+        OE_WARN << LC << "Index is full; cannot insert " << (objects.size() - slots.size()) << " objects\n";
+    }
+
+    output.reserve( output.size() + objects.size() );
+    for(unsigned i = 0; i < objects.size(); ++i)
+    {
+        output.push_back( i < slots.size() ? insertImpl(slots[i], objects[i]) : OSGEARTH_OBJECTID_EMPTY );
+    }
+
+    _size += (unsigned)slots.size();
 }
 
 ObjectID
-ObjectIndex::insertImpl(osg::Referenced* object)
+ObjectIndex::insertImpl(unsigned s, osg::Referenced* object)
 {
-    // internal: assume mutex is locked
-    ObjectID id = ++_idGen;
-    _index[id] = object;
-    OE_DEBUG << LC << "Insert " << id << "; size = " << _index.size() << "\n";
+    // internal: fills a slot taken with popFree().
+    Slot* slot = getOrCreateSlot( s );
+
+    osg::ObserverSet* observers = object ? object->getOrCreateObserverSet() : 0L;
+    if ( observers )
+        observers->ref();
+    slot->_observers.store( observers );
+
+    // never wraps: a slot is retired once its generation reaches GEN_MASK.
+    unsigned gen = slot->_gen.load() + 1u;
+    slot->_gen.store( gen );
+
+    ObjectID id = (gen << SLOT_BITS) | s;
+
+    // publish; readers can resolve the ID from here on.
+    slot->_id.store( id );
+
     return id;
 }
 
-osg::Referenced*
+osg::ref_ptr<osg::Referenced>
 ObjectIndex::getImpl(ObjectID id) const
 {
-    // assume the mutex is locked
-    IndexMap::const_iterator i = _index.find(id);
-    return i != _index.end() ? i->second.get() : 0L;
+    osg::ref_ptr<osg::Referenced> result;
+
+    if ( id == OSGEARTH_OBJECTID_EMPTY )
+        return result;
+
+    Slot* slot = getSlot( id & SLOT_MASK );
+    if ( !slot )
+        return result;
+
+    // While registered as a reader, no observer set we can see will be released.
+    ++_readers;
+
+    if ( slot->_id.load() == id )
+    {
+        osg::ObserverSet* observers = slot->_observers.load();
+
+        // make sure the slot wasn't recycled while we read it.
+        if ( observers && slot->_id.load() == id )
+        {
+            osg::Referenced* object = observers->addRefLock();
+            if ( object )
+            {
+                result = object;
+                object->unref();
+            }
+        }
+    }
+
+    --_readers;
+
+    return result;
 }
 
 void
 ObjectIndex::remove(ObjectID id)
 {
-    Threading::ScopedMutexLock excl(_mutex);
-    removeImpl(id);
+    unsigned head = NO_SLOT, tail = NO_SLOT, count = 0u;
+    removeImpl( id, head, tail, count );
+    pushFree( head, tail, count );
 }
 
 void
-ObjectIndex::removeImpl(ObjectID id)
+ObjectIndex::removeImpl(ObjectID id, unsigned& head, unsigned& tail, unsigned& count)
 {
-    // internal - assume mutex is locked
-    _index.erase( id );
-    OE_DEBUG << "Remove " << id << "; size = " << _index.size() << "\n";
+    // internal: unlinks the object and chains its slot onto head..tail
+    // for a later pushFree().
+    if ( id == OSGEARTH_OBJECTID_EMPTY )
+        return;
+
+    unsigned s = id & SLOT_MASK;
+    Slot* slot = getSlot( s );
+    if ( !slot )
+        return;
+
+    // only the thread that clears the ID owns the removal.
+    ObjectID expected = id;
+    if ( !slot->_id.compare_exchange_strong(expected, OSGEARTH_OBJECTID_EMPTY) )
+        return;
+
+    retire( slot->_observers.exchange(0L) );
+    ++count;
+
+    // A slot that has used up its generations is never reused, so an old
+    // ID cannot come back around and resolve to an unrelated object.
+    if ( slot->_gen.load() >= GEN_MASK )
+    {
+        OE_DEBUG << LC << "Retiring slot " << s << "\n";
+        return;
+    }
 
+    slot->_nextFree.store( head );
+    head = s;
+    if ( tail == NO_SLOT )
+        tail = s;
+
+    OE_DEBUG << LC << "Remove " << id << "\n";
+}
+
+void
+ObjectIndex::retire(osg::ObserverSet* observers)
+{
+    if ( !observers )
+        return;
+
+    Retired* r = new Retired();
+    r->_observers = observers;
+    r->_next = _retired.load();
+    while( !_retired.compare_exchange_weak(r->_next, r) );
+}
+
+void
+ObjectIndex::reclaim()
+{
+    if ( _readers.load() != 0 || _retired.load() == 0L )
+        return;
+
+    Retired* list = _retired.exchange( 0L );
+
+    // A reader still active now may have loaded one of these before it was
+    // removed; any reader that starts later cannot see them. So if there are
+    // no readers at this point, the list is safe to release.
+    if ( _readers.load() == 0 )
+    {
+        while( list )
+        {
+            Retired* next = list->_next;
+            list->_observers->unref();
+            delete list;
+            list = next;
+        }
+    }
+    else
+    {
+        while( list )
+        {
+            Retired* next = list->_next;
+            list->_next = _retired.load();
+            while( !_retired.compare_exchange_weak(list->_next, list) );
+            list = next;
+        }
+    }
 }
 
 ObjectID
 ObjectIndex::tagDrawable(osg::Drawable* drawable, osg::Referenced* object)
 {
-    Threading::ScopedMutexLock lock(_mutex);
     ObjectID oid = insertImpl(object);
     tagDrawable(drawable, oid);
     return oid;
@@ -191,7 +489,6 @@ namespace
 ObjectID
 ObjectIndex::tagAllDrawables(osg::Node* node, osg::Referenced* object)
 {
-    Threading::ScopedMutexLock lock(_mutex);
     ObjectID oid = insertImpl(object);
     tagAllDrawables(node, oid);
     return oid;
@@ -210,7 +507,6 @@ ObjectIndex::tagAllDrawables(osg::Node* node, ObjectID id) const
 ObjectID
 ObjectIndex::tagNode(osg::Node* node, osg::Referenced* object)
 {
-    Threading::ScopedMutexLock lock(_mutex);
     ObjectID oid = insertImpl(object);
     tagNode(node, oid);
     return oid;
@@ -274,18 +570,29 @@ ObjectIndex::updateObjectIDs(osg::Drawable* drawable,
     if ( !oids ) return false;
     if (oids->empty()) return false;
     
-    for (ObjectIDArray::iterator i = oids->begin(); i != oids->end(); ++i)
+    // register all the new IDs in the drawable at once
+    std::vector<ObjectID> oldoids;
+    for (ObjectIDArray::const_iterator i = oids->begin(); i != oids->end(); ++i)
     {
-        ObjectID newoid;
-        std::map<ObjectID, ObjectID>::iterator k = oldNewMap.find(*i);
-        if (k != oldNewMap.end()) {
-            newoid = k->second;
-        }
-        else {
-            newoid = insert(object);
-            oldNewMap[*i] = newoid;
+        if (oldNewMap.find(*i) == oldNewMap.end())
+        {
+            oldNewMap[*i] = OSGEARTH_OBJECTID_EMPTY;
+            oldoids.push_back(*i);
         }
-        *i = newoid;
+    }
+
+    if (!oldoids.empty())
+    {
+        std::vector<osg::Referenced*> objects(oldoids.size(), object);
+        std::vector<ObjectID> newoids;
+        insert(objects, newoids);
+        for (unsigned i = 0; i < oldoids.size(); ++i)
+            oldNewMap[oldoids[i]] = newoids[i];
+    }
+
+    for (ObjectIDArray::iterator i = oids->begin(); i != oids->end(); ++i)
+    {
+        *i = oldNewMap[*i];
     }
 
     oids->dirty();
@@ -18,38 +18,95 @@
  */
 
 #include <osgEarth/Progress>
+#include <osgEarth/MetricsRegistry>
 #include <osgDB/DatabasePager>
+#include <vector>
 
 using namespace osgEarth;
 
+namespace
+{
+    // Latency histogram for a stage. Metrics live for the life of the
+    // process, so each thread looks a stage up in the registry once and
+    // keeps the pointer; there are only a handful of stages.
+    Util::MetricsRegistry::Histogram* getCancelLatency(const std::string& stage)
+    {
+        typedef std::pair<std::string, Util::MetricsRegistry::Histogram*> Entry;
+        static thread_local std::vector<Entry> s_histograms;
+
+        for (std::vector<Entry>::const_iterator i = s_histograms.begin(); i != s_histograms.end(); ++i)
+        {
+            if (i->first == stage)
+                return i->second;
+        }
+
+        Util::MetricsRegistry::Labels labels;
+        labels["stage"] = stage;
+        Util::MetricsRegistry::Histogram* histogram = Util::MetricsRegistry::instance().histogram(
+            "oe_cancel_latency_seconds",
+            "Time from a task's cancelation to a stage abandoning it",
+            labels);
+
+        s_histograms.push_back(Entry(stage, histogram));
+        return histogram;
+    }
+}
+
 ProgressCallback::ProgressCallback() :
 osg::Referenced( true ),
 _canceled      ( false ),
+_cancelTick    ( 0u ),
 _retryDelay_s  ( 0.0f )
 {
     //NOP
 }
 
 void
-ProgressCallback::cancel()
+ProgressCallback::setCanceled() const
 {
+    // only the first cancelation starts the clock
+    osg::Timer_t expected = 0u;
+    _cancelTick.compare_exchange_strong(expected, osg::Timer::instance()->tick());
     _canceled = true;
 }
 
+void
+ProgressCallback::cancel()
+{
+    setCanceled();
+}
+
 void
 ProgressCallback::reset()
 {
     _canceled = false;
+    _cancelTick = 0u;
 }
 
 bool
 ProgressCallback::isCanceled() const
 {
     if (!_canceled && shouldCancel())
-        _canceled = true;
+        setCanceled();
     return _canceled;
 }
 
+double
+ProgressCallback::getTimeSinceCanceled() const
+{
+    osg::Timer_t tick = _cancelTick;
+    return tick == 0u ? 0.0 : osg::Timer::instance()->delta_s(tick, osg::Timer::instance()->tick());
+}
+
+void
+ProgressCallback::recordCancelation(const std::string& stage) const
+{
+    if (!isCanceled())
+        return;
+
+    getCancelLatency(stage)->record(getTimeSinceCanceled());
+}
+
 void ProgressCallback::reportError(const std::string& msg)
 {
     _message = msg;
@@ -1139,50 +1139,40 @@ SpatialReference::transformZ(std::vector<osg::Vec3d>& points,
     Units inUnits = _vdatum.valid() ? _vdatum->getUnits() : Units::METERS;
     Units outUnits = outVDatum ? outVDatum->getUnits() : inUnits;
 
-    if ( isGeographic() || pointsAreLatLong )
+    // copy the points and convert them to geographic coordinates (lat/long with the same Z)
+    // if necessary, and sample the geoids for all of them at once:
+    std::vector<osg::Vec3d> geopoints;
+    if ( !isGeographic() && !pointsAreLatLong )
     {
-        for( unsigned i=0; i<points.size(); ++i )
-        {
-            if ( _vdatum.valid() )
-            {
-                // to HAE:
-                points[i].z() = _vdatum->msl2hae( points[i].y(), points[i].x(), points[i].z() );
-            }
+        geopoints = points;
+        transform( geopoints, getGeographicSRS() );
+    }
+    const std::vector<osg::Vec3d>& lonLat = geopoints.empty() ? points : geopoints;
 
-            // do the units conversion:
-            points[i].z() = inUnits.convertTo(outUnits, points[i].z());
+    std::vector<float> inOffsets, outOffsets;
+    if ( _vdatum.valid() )
+        _vdatum->getGeoidHeights( lonLat, inOffsets );
+    if ( outVDatum )
+        outVDatum->getGeoidHeights( lonLat, outOffsets );
 
-            if ( outVDatum )
-            {
-                // to MSL:
-                points[i].z() = outVDatum->hae2msl( points[i].y(), points[i].x(), points[i].z() );
-            }
-        }
-    }
+    double scale = inUnits.convertTo(outUnits, 1.0);
 
-    else // need to xform input points
+    for( unsigned i=0; i<points.size(); ++i )
     {
-        // copy the points and convert them to geographic coordinates (lat/long with the same Z):
-        std::vector<osg::Vec3d> geopoints(points);
-        transform( geopoints, getGeographicSRS() );
+        double z = points[i].z();
 
-        for( unsigned i=0; i<geopoints.size(); ++i )
-        {
-            if ( _vdatum.valid() )
-            {
-                // to HAE:
-                points[i].z() = _vdatum->msl2hae( geopoints[i].y(), geopoints[i].x(), points[i].z() );
-            }
+        // to HAE:
+        if ( _vdatum.valid() )
+            z += inOffsets[i];
 
-            // do the units conversion:
-            points[i].z() = inUnits.convertTo(outUnits, points[i].z());
+        // do the units conversion:
+        z *= scale;
 
-            if ( outVDatum )
-            {
-                // to MSL:
-                points[i].z() = outVDatum->hae2msl( geopoints[i].y(), geopoints[i].x(), points[i].z() );
-            }
-        }
+        // to MSL:
+        if ( outVDatum )
+            z -= outOffsets[i];
+
+        points[i].z() = z;
     }
 
     return true;
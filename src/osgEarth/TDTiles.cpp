@@ -30,6 +30,8 @@
 #include <osg/ShapeDrawable>
 #include <osg/PolygonMode>
 #include <osgEarth/LineDrawable>
+#include <algorithm>
+#include <set>
 
 using namespace osgEarth;
 using namespace osgEarth::Util;
@@ -113,6 +115,44 @@ namespace osgEarth { namespace Contrib { namespace ThreeDTiles
         }
     };
 
+    // Estimates the memory footprint of loaded tile content
+    struct ComputeContentSize : public TextureAndImageVisitor
+    {
+        ComputeContentSize() : _bytes(0) { }
+
+        using TextureAndImageVisitor::apply;
+
+        void apply(osg::Image& image)
+        {
+            if (_images.insert(&image).second)
+                _bytes += image.getTotalDataSize();
+        }
+
+        void apply(osg::Drawable& drawable)
+        {
+            if (drawable.getStateSet())
+                TextureAndImageVisitor::apply(*drawable.getStateSet());
+
+            osg::Geometry* geom = drawable.asGeometry();
+            if (geom)
+            {
+                for (unsigned i = 0; i < geom->getNumPrimitiveSets(); ++i)
+                    _bytes += geom->getPrimitiveSet(i)->getTotalDataSize();
+
+                osg::Geometry::ArrayList arrays;
+                geom->getArrayList(arrays);
+                for (unsigned i = 0; i < arrays.size(); ++i)
+                {
+                    if (arrays[i].valid())
+                        _bytes += arrays[i]->getTotalDataSize();
+                }
+            }
+        }
+
+        std::set<osg::Image*> _images;
+        unsigned int _bytes;
+    };
+
 } } }
 
 //........................................................................
@@ -624,6 +664,10 @@ ThreeDTileNode::ThreeDTileNode(ThreeDTilesetNode* tileset, Tile* tile, bool imme
     _tileset(tileset),
     _tile(tile),
     _requestedContent(false),
+    _requestDispatched(false),
+    _requestPriority(0.0),
+    _lastRequestFrameNumber(0),
+    _contentBytes(0),
     _immediateLoad(immediateLoad),
     _firstVisit(true),
     _options(options),
@@ -907,71 +951,118 @@ bool ThreeDTileNode::isContentReady()
 
 void ThreeDTileNode::resolveContent()
 {
-    // Resolve the future
-    if (!_content.valid() && _requestedContent && _contentFuture.isAvailable())
+    if (_content.valid())
+        return;
+
+    // Resolve the future. The request state is shared with the tileset's
+    // dispatchRequests(), which may run from another cull thread.
     {
+        ScopedMutexLock lock(_tileset->_requestMutex);
+        if (!_requestedContent || !_contentFuture.isAvailable())
+            return;
+
         _content = _contentFuture.release();
+        _requestDispatched = false;
+    }
 
-        if (_content.valid())
+    if (_content.valid())
+    {
+        // Assign the parent node if we just loaded a tileset
+        ThreeDTilesetContentNode* tilesetContentNode = dynamic_cast<ThreeDTilesetContentNode*>(_content.get());
+        if (tilesetContentNode)
         {
-            // Assign the parent node if we just loaded a tileset
-            ThreeDTilesetContentNode* tilesetContentNode = dynamic_cast<ThreeDTilesetContentNode*>(_content.get());
-            if (tilesetContentNode)
+            ThreeDTileNode* tileNode = tilesetContentNode->getTileNode();
+            if (tileNode)
             {
-                ThreeDTileNode* tileNode = tilesetContentNode->getTileNode();
-                if (tileNode)
-                {
-                    tileNode->setParentTile(this);
-                }
+                tileNode->setParentTile(this);
             }
+        }
 
-            _tileset->runPreMergeOperations(_content.get());
-            _tileset->runPostMergeOperations(_content.get());
+        // Account for the content in the tileset's residency budget
+        if (!_immediateLoad)
+        {
+            ComputeContentSize size;
+            _content->accept(size);
+            _contentBytes = size._bytes;
+            _tileset->addResidentBytes(_contentBytes);
         }
+
+        _tileset->runPreMergeOperations(_content.get());
+        _tileset->runPostMergeOperations(_content.get());
     }
 }
 
 
-void ThreeDTileNode::requestContent(osgUtil::IncrementalCompileOperation* ico)
+void ThreeDTileNode::requestContent(osgUtil::IncrementalCompileOperation* ico, double priority, unsigned int frameNumber)
 {
-    if (!_content.valid() && !_requestedContent && hasContent())
+    if (!_content.valid() && hasContent())
     {
-        // if there's an ICO, install it:
-        osg::ref_ptr<osgDB::Options> localOptions;
-        if (ico)
+        ScopedMutexLock lock(_tileset->_requestMutex);
+
+        if (!_requestedContent)
         {
-            localOptions = Registry::instance()->cloneOrCreateOptions(_options.get());
-            OptionsData<osgUtil::IncrementalCompileOperation>::set(localOptions.get(), "osg::ico", ico);
+            _requestICO = ico;
+            _requestPriority = priority;
+            _lastRequestFrameNumber = frameNumber;
+            _requestedContent = true;
+            _tileset->queueRequest(this);
         }
-        else
+        else if (frameNumber != _lastRequestFrameNumber || priority > _requestPriority)
         {
-            localOptions = _options.get();
+            // Keep the request alive and track the highest priority seen this frame.
+            _requestPriority = frameNumber != _lastRequestFrameNumber ? priority : osg::maximum(priority, _requestPriority);
+            _lastRequestFrameNumber = frameNumber;
         }
+    }
+}
 
-        URIContext context = _tile->content()->uri()->context();
-        if (!_tileset->getAuthorizationHeader().empty())
-        {
-            context.addHeader("authorization", _tileset->getAuthorizationHeader());
-        }
+void ThreeDTileNode::dispatchRequest()
+{
+    // if there's an ICO, install it:
+    osg::ref_ptr<osgDB::Options> localOptions;
+    osg::ref_ptr<osgUtil::IncrementalCompileOperation> ico;
+    if (_requestICO.lock(ico))
+    {
+        localOptions = Registry::instance()->cloneOrCreateOptions(_options.get());
+        OptionsData<osgUtil::IncrementalCompileOperation>::set(localOptions.get(), "osg::ico", ico.get());
+    }
+    else
+    {
+        localOptions = _options.get();
+    }
 
-        URI uri(_tile->content()->uri()->base(), context);
+    URIContext context = _tile->content()->uri()->context();
+    if (!_tileset->getAuthorizationHeader().empty())
+    {
+        context.addHeader("authorization", _tileset->getAuthorizationHeader());
+    }
 
-        NetworkMonitor::ScopedRequestLayer layerRequest(_tileset->getOwnerName());
+    URI uri(_tile->content()->uri()->base(), context);
 
-        if (osgEarth::Strings::endsWith(_tile->content()->uri()->base(), ".json"))
-        {
-            _contentFuture =
-                readTilesetAsync(_tileset, uri, localOptions.get());
-        }
-        else
-        {
-            _contentFuture = uri
-                .readNodeAsync(localOptions.get(), NULL)
-                .then(compressAndMipmapTextures);
-        }
+    NetworkMonitor::ScopedRequestLayer layerRequest(_tileset->getOwnerName());
 
-        _requestedContent = true;
+    if (osgEarth::Strings::endsWith(_tile->content()->uri()->base(), ".json"))
+    {
+        _contentFuture =
+            readTilesetAsync(_tileset, uri, localOptions.get());
     }
+    else
+    {
+        _contentFuture = uri
+            .readNodeAsync(localOptions.get(), NULL)
+            .then(compressAndMipmapTextures);
+    }
+
+    _requestDispatched = true;
+}
+
+void ThreeDTileNode::cancelRequest()
+{
+    // Dropping our Future abandons the Promise, so the load operation
+    // skips the read if it has not started yet.
+    _contentFuture = Future<osg::Node>();
+    _requestedContent = false;
+    _requestDispatched = false;
 }
 
 double ThreeDTileNode::getDistanceToTile(osgUtil::CullVisitor* cv)
@@ -1018,8 +1109,15 @@ bool ThreeDTileNode::unloadContent()
 
     _firstVisit = true;
     _content = 0;
-    _requestedContent = false;
-    _contentFuture = Future<osg::Node>();
+    {
+        ScopedMutexLock lock(_tileset->_requestMutex);
+        _requestedContent = false;
+        _requestDispatched = false;
+        _contentFuture = Future<osg::Node>();
+    }
+
+    _tileset->removeResidentBytes(_contentBytes);
+    _contentBytes = 0;
 
     return true;
 }
@@ -1106,13 +1204,15 @@ void ThreeDTileNode::traverse(osg::NodeVisitor& nv)
             ico = osgView->getDatabasePager()->getIncrementalCompileOperation();
         }
 
-        // This allows nodes to reload themselves
-        requestContent(ico);
-        resolveContent();
+        unsigned int frameNumber = cv->getFrameStamp()->getFrameNumber();
 
         // Compute the SSE
         double error = computeScreenSpaceError(cv);
 
+        // This allows nodes to reload themselves
+        requestContent(ico, error, frameNumber);
+        resolveContent();
+
         updateTracking(cv);
 
         bool areChildrenReady = true;
@@ -1128,7 +1228,7 @@ void ThreeDTileNode::traverse(osg::NodeVisitor& nv)
                     // Can we traverse the child?
                     if (childTile->hasContent() && !childTile->isContentReady())
                     {
-                        childTile->requestContent(ico);
+                        childTile->requestContent(ico, childTile->computeScreenSpaceError(cv), frameNumber);
                         areChildrenReady = false;
                     }
                 }
@@ -1234,6 +1334,11 @@ ThreeDTilesetNode::ThreeDTilesetNode(Tileset* tileset, const std::string& author
     _options(options),
     _maximumScreenSpaceError(15.0f),
     _maxTiles(50),
+    _maxConcurrentRequests(4),
+    _requestTimeoutFrames(10),
+    _lastDispatchFrame(~0u),
+    _residentBytes(0),
+    _maxResidentBytes(0),
     _showBoundingVolumes(false),
     _showColorPerTile(false),
     _maxAge(5.0f),
@@ -1255,6 +1360,26 @@ ThreeDTilesetNode::ThreeDTilesetNode(Tileset* tileset, const std::string& author
         setMaxAge((float)atof(c));
     }
 
+    c = ::getenv("OSGEARTH_3DTILES_CACHE_SIZE_MB");
+    if (c)
+    {
+        setMaxResidentBytes((unsigned long long)atoi(c) * 1024ull * 1024ull);
+    }
+
+    // Keep no more requests in flight than the pool has threads, so the
+    // rest wait here where they can be reprioritized or canceled.
+    osg::ref_ptr<ThreadPool> threadPool = ThreadPool::get(_options.get());
+    if (threadPool.valid())
+    {
+        setMaxConcurrentRequests(osg::maximum(threadPool->getNumThreads(), 1u));
+    }
+
+    c = ::getenv("OSGEARTH_3DTILES_MAX_REQUESTS");
+    if (c)
+    {
+        setMaxConcurrentRequests((unsigned)atoi(c));
+    }
+
     _tracker.push_back(0);
     // Pointer to last element
     _sentryItr = --_tracker.end();
@@ -1302,6 +1427,63 @@ void ThreeDTilesetNode::setMaxAge(float maxAge)
     _maxAge = maxAge;
 }
 
+unsigned long long ThreeDTilesetNode::getMaxResidentBytes() const
+{
+    return _maxResidentBytes;
+}
+
+void ThreeDTilesetNode::setMaxResidentBytes(unsigned long long maxResidentBytes)
+{
+    _maxResidentBytes = maxResidentBytes;
+}
+
+unsigned long long ThreeDTilesetNode::getResidentBytes() const
+{
+    return _residentBytes;
+}
+
+void ThreeDTilesetNode::addResidentBytes(unsigned int bytes)
+{
+    _residentBytes += bytes;
+}
+
+void ThreeDTilesetNode::removeResidentBytes(unsigned int bytes)
+{
+    _residentBytes -= bytes;
+}
+
+unsigned int ThreeDTilesetNode::getMaxConcurrentRequests() const
+{
+    return _maxConcurrentRequests;
+}
+
+void ThreeDTilesetNode::setMaxConcurrentRequests(unsigned int maxConcurrentRequests)
+{
+    _maxConcurrentRequests = maxConcurrentRequests;
+}
+
+unsigned int ThreeDTilesetNode::getRequestTimeoutFrames() const
+{
+    return _requestTimeoutFrames;
+}
+
+void ThreeDTilesetNode::setRequestTimeoutFrames(unsigned int frames)
+{
+    _requestTimeoutFrames = frames;
+}
+
+unsigned int ThreeDTilesetNode::getNumQueuedRequests() const
+{
+    ScopedMutexLock lock(_requestMutex);
+    return _queuedRequests.size();
+}
+
+unsigned int ThreeDTilesetNode::getNumActiveRequests() const
+{
+    ScopedMutexLock lock(_requestMutex);
+    return _activeRequests.size();
+}
+
 float ThreeDTilesetNode::getMaximumScreenSpaceError() const
 {
     return _maximumScreenSpaceError;
@@ -1389,6 +1571,77 @@ void ThreeDTilesetNode::touchTile(ThreeDTileNode* node)
     node->_trackerItr = --_tracker.end();
 }
 
+void ThreeDTilesetNode::queueRequest(ThreeDTileNode* node)
+{
+    // caller holds _requestMutex
+    _queuedRequests.push_back(node);
+}
+
+void ThreeDTilesetNode::dispatchRequests(unsigned int frameNumber)
+{
+    OE_PROFILING_ZONE;
+
+    ScopedMutexLock lock(_requestMutex);
+
+    // Only dispatch once per frame, even with multiple cameras.
+    if (frameNumber == _lastDispatchFrame)
+        return;
+    _lastDispatchFrame = frameNumber;
+
+    // Retire finished requests and cancel the ones nobody wants anymore.
+    unsigned int numActive = 0;
+    for (unsigned int i = 0; i < _activeRequests.size(); ++i)
+    {
+        ThreeDTileNode* node = _activeRequests[i].get();
+        if (!node->_requestDispatched || node->_contentFuture.isAvailable())
+            continue;
+
+        if (frameNumber - node->_lastRequestFrameNumber > _requestTimeoutFrames)
+        {
+            node->cancelRequest();
+            continue;
+        }
+
+        _activeRequests[numActive++] = node;
+    }
+    _activeRequests.resize(numActive);
+
+    // Drop queued requests that went stale before they were ever dispatched.
+    unsigned int numQueued = 0;
+    for (unsigned int i = 0; i < _queuedRequests.size(); ++i)
+    {
+        ThreeDTileNode* node = _queuedRequests[i].get();
+        if (!node->_requestedContent || node->_requestDispatched)
+            continue;
+
+        if (frameNumber - node->_lastRequestFrameNumber > _requestTimeoutFrames)
+        {
+            node->cancelRequest();
+            continue;
+        }
+
+        _queuedRequests[numQueued++] = node;
+    }
+    _queuedRequests.resize(numQueued);
+
+    // Dispatch the highest screen space error first, up to the concurrency limit.
+    std::sort(_queuedRequests.begin(), _queuedRequests.end(),
+        [](const osg::ref_ptr<ThreeDTileNode>& lhs, const osg::ref_ptr<ThreeDTileNode>& rhs)
+        {
+            return lhs->_requestPriority > rhs->_requestPriority;
+        });
+
+    unsigned int numDispatched = 0;
+    while (numDispatched < _queuedRequests.size() &&
+          (_maxConcurrentRequests == 0 || _activeRequests.size() < _maxConcurrentRequests))
+    {
+        ThreeDTileNode* node = _queuedRequests[numDispatched++].get();
+        node->dispatchRequest();
+        _activeRequests.push_back(node);
+    }
+    _queuedRequests.erase(_queuedRequests.begin(), _queuedRequests.begin() + numDispatched);
+}
+
 void ThreeDTilesetNode::expireTiles(const osg::NodeVisitor& nv)
 {
     OE_PROFILING_ZONE;
@@ -1408,7 +1661,7 @@ void ThreeDTilesetNode::expireTiles(const osg::NodeVisitor& nv)
 
     unsigned int numErased = 0;
     unsigned int numSkipped = 0;
-    while (_tracker.size() > _maxTiles && itr != _sentryItr)
+    while ((_tracker.size() > _maxTiles || (_maxResidentBytes > 0 && _residentBytes > _maxResidentBytes)) && itr != _sentryItr)
     {
         osg::ref_ptr< ThreeDTileNode > tile = dynamic_cast<ThreeDTileNode*>(itr->get());
         if (tile.valid())
@@ -1441,6 +1694,7 @@ void ThreeDTilesetNode::expireTiles(const osg::NodeVisitor& nv)
         OE_NOTICE << "Erased " << numErased << " and skipped " << numSkipped << " in " << osg::Timer::instance()->delta_m(startTime, endTime) << "ms" << std::endl;
     }
     OE_NOTICE << "Tiles in memory " << _tracker.size() << " max tiles=" << _maxTiles << std::endl;
+    OE_NOTICE << "Bytes in memory " << _residentBytes << " max bytes=" << _maxResidentBytes << std::endl;
 #endif
 
     // Erase the sentry and stick it at the end of the list
@@ -1469,6 +1723,12 @@ void ThreeDTilesetNode::traverse(osg::NodeVisitor& nv)
 		double fovy, ar, zn, zf;
 		proj.getPerspective(fovy, ar, zn, zf);
 		_sseDenominator = 2.0 * tan(0.5 * osg::DegreesToRadians(fovy));
+
+		osg::Group::traverse(nv);
+
+		// The cull traversal queued this frame's requests; start the most important ones.
+		dispatchRequests(nv.getFrameStamp()->getFrameNumber());
+		return;
 	}
 
     osg::Group::traverse(nv);
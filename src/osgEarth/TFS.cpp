@@ -28,6 +28,7 @@
 #include <osgEarth/ScaleFilter>
 #include <osgEarth/MVT>
 #include <osgEarth/OgrUtils>
+#include <osgEarth/GeoJSONReader>
 #include <osgEarth/FeatureCursor>
 
 #include <osg/Notify>
@@ -343,6 +344,21 @@ TFSFeatureSource::getFeatures(const std::string& buffer, const TileKey& key, con
         return false;
 #endif
     }
+    else if (isJSON(mimeType))
+    {
+        // stream the GeoJSON directly; no DOM and no OGR lock required
+        GeoJSONReader reader;
+        reader.setFeatureProfile(getFeatureProfile());
+        reader.setRewindPolygons(*_options->rewindPolygons());
+
+        std::istringstream in(buffer);
+        return reader.read(in, [&](Feature* f)
+        {
+            if (!isBlacklisted(f->getFID()))
+                features.push_back(f);
+            return true;
+        });
+    }
     else
     {
         // find the right driver for the given mime type
@@ -350,7 +366,6 @@ TFSFeatureSource::getFeatures(const std::string& buffer, const TileKey& key, con
 
         // find the right driver for the given mime type
         OGRSFDriverH ogrDriver =
-            isJSON(mimeType) ? OGRGetDriverByName("GeoJSON") :
             isGML(mimeType) ? OGRGetDriverByName("GML") :
             0L;
 
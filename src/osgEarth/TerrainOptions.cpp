@@ -64,6 +64,7 @@ TerrainOptions::getConfig() const
     conf.set( "merges_per_frame", mergesPerFrame() );
     conf.set( "priority_scale", priorityScale() );
     conf.set( "texture_compression", textureCompression());
+    conf.set( "layer_loading_threads", layerLoadingThreads());
 
     return conf;
 }
@@ -104,6 +105,7 @@ TerrainOptions::fromConfig(const Config& conf)
     mergesPerFrame().init(20u);
     priorityScale().init(1.0f);
     textureCompression().setDefault("");
+    layerLoadingThreads().init(0u);
 
     conf.get( "tile_size", _tileSize );
     conf.get( "vertical_scale", _verticalScale );
@@ -140,6 +142,7 @@ TerrainOptions::fromConfig(const Config& conf)
     conf.get( "merges_per_frame", mergesPerFrame() );
     conf.get( "priority_scale", priorityScale());
     conf.get( "texture_compression", textureCompression());
+    conf.get( "layer_loading_threads", layerLoadingThreads());
 }
 
 //...................................................................
@@ -183,6 +186,7 @@ OE_PROPERTY_IMPL(TerrainOptionsAPI, bool, MorphImagery, morphImagery);
 OE_PROPERTY_IMPL(TerrainOptionsAPI, unsigned, MergesPerFrame, mergesPerFrame);
 OE_PROPERTY_IMPL(TerrainOptionsAPI, float, PriorityScale, priorityScale);
 OE_PROPERTY_IMPL(TerrainOptionsAPI, std::string, TextureCompressionMethod, textureCompression);
+OE_PROPERTY_IMPL(TerrainOptionsAPI, unsigned, LayerLoadingThreads, layerLoadingThreads);
 
 void
 TerrainOptionsAPI::setDriver(const std::string& value)
@@ -22,6 +22,15 @@
 #include <osgEarth/TerrainProfile>
 #include <osgEarth/MapNode>
 #include <osgEarth/TerrainEngineNode>
+#include <osgEarth/ElevationPool>
+#include <osgEarth/GeoMath>
+#include <osgEarth/Map>
+#include <osgEarth/Metrics>
+#include <osgEarth/Progress>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
 
 using namespace osgEarth;
 using namespace osgEarth::Contrib;
@@ -234,3 +243,244 @@ void TerrainProfileCalculator::computeTerrainProfile( osgEarth::MapNode* mapNode
         profile.addElevation( slice.getDistanceHeightIntersections()[i].first, slice.getDistanceHeightIntersections()[i].second);
     }
 }
+
+/***************************************************/
+namespace
+{
+    // One sample of one path, located in map coordinates
+    struct PathSample
+    {
+        TileKey key;
+        osg::Vec3d map;
+        double resolution; // in map units, at the sample's latitude
+        unsigned path;
+        unsigned index;
+    };
+
+    // Groups samples by tile, and orders the samples within a tile by
+    // location so the batch is sampled the same way whatever the order
+    // of the paths.
+    bool lessByTile(const PathSample* lhs, const PathSample* rhs)
+    {
+        if (lhs->key < rhs->key) return true;
+        if (rhs->key < lhs->key) return false;
+        if (lhs->map.y() != rhs->map.y()) return lhs->map.y() < rhs->map.y();
+        if (lhs->map.x() != rhs->map.x()) return lhs->map.x() < rhs->map.x();
+        return lhs->path != rhs->path ? lhs->path < rhs->path : lhs->index < rhs->index;
+    }
+}
+
+void
+TerrainProfileSampler::Result::getProfile(TerrainProfile& out) const
+{
+    out.clear();
+    for (unsigned i = 0; i < distances.size(); ++i)
+        out.addElevation(distances[i], elevations[i]);
+}
+
+TerrainProfileSampler::TerrainProfileSampler(const Map* map) :
+_map( map ),
+_resolution( 30.0, Units::METERS ),
+_numThreads( osg::maximum(1u, std::thread::hardware_concurrency()) )
+{
+}
+
+bool
+TerrainProfileSampler::sample(const std::vector<GeoPoint>& path, Result& result, ProgressCallback* progress)
+{
+    if (path.empty() || !path.front().isValid())
+        return false;
+
+    const SpatialReference* srs = path.front().getSRS();
+
+    std::vector< std::vector<osg::Vec3d> > paths(1);
+    for (std::vector<GeoPoint>::const_iterator i = path.begin(); i != path.end(); ++i)
+    {
+        GeoPoint p = i->transform(srs);
+        if (!p.isValid())
+            return false;
+        paths[0].push_back(p.vec3d());
+    }
+
+    std::vector<Result> results;
+    if (!sample(paths, srs, results, progress))
+        return false;
+
+    result.points.swap(results[0].points);
+    result.distances.swap(results[0].distances);
+    result.elevations.swap(results[0].elevations);
+    result.slopes.swap(results[0].slopes);
+    return true;
+}
+
+bool
+TerrainProfileSampler::sample(
+    const std::vector< std::vector<osg::Vec3d> >& paths,
+    const SpatialReference* srs,
+    std::vector<Result>& results,
+    ProgressCallback* progress)
+{
+    OE_PROFILING_ZONE;
+
+    results.clear();
+    results.resize(paths.size());
+
+    osg::ref_ptr<const Map> map;
+    if (!srs || !_map.lock(map) || !map->getElevationPool() || !map->getProfile())
+        return false;
+
+    ElevationPool* pool = map->getElevationPool();
+    const osgEarth::Profile* profile = map->getProfile();
+    const SpatialReference* mapSRS = map->getSRS();
+    const SpatialReference* geoSRS = mapSRS->getGeographicSRS();
+    double spacing = osg::maximum(_resolution.as(Units::METERS), 0.01);
+
+    // Densify each path along great circles, and find the elevation tile
+    // of each sample at the level of detail that matches the resolution.
+    std::vector< std::vector<PathSample> > samples(paths.size());
+    std::atomic<bool> failed(false);
+
+    Threading::parallelFor(paths.size(), [&](unsigned p)
+    {
+        std::vector<osg::Vec3d> vertices = paths[p];
+        if (vertices.empty())
+            return;
+
+        if (!srs->transform(vertices, geoSRS))
+        {
+            failed = true;
+            return;
+        }
+
+        Result& result = results[p];
+        double distance = 0.0;
+
+        for (unsigned v = 0; v + 1 < vertices.size(); ++v)
+        {
+            double lat1 = osg::DegreesToRadians(vertices[v].y()), lon1 = osg::DegreesToRadians(vertices[v].x());
+            double lat2 = osg::DegreesToRadians(vertices[v+1].y()), lon2 = osg::DegreesToRadians(vertices[v+1].x());
+            double length = GeoMath::distance(lat1, lon1, lat2, lon2);
+            double bearing = GeoMath::bearing(lat1, lon1, lat2, lon2);
+            unsigned steps = osg::maximum(1u, (unsigned)ceil(length / spacing));
+
+            for (unsigned s = 0; s < steps; ++s)
+            {
+                double d = length * (double)s / (double)steps;
+                double lat = lat1, lon = lon1;
+                if (s > 0)
+                    GeoMath::destination(lat1, lon1, bearing, d, lat, lon);
+
+                result.points.push_back(osg::Vec3d(osg::RadiansToDegrees(lon), osg::RadiansToDegrees(lat), 0.0));
+                result.distances.push_back(distance + d);
+            }
+            distance += length;
+        }
+
+        result.points.push_back(osg::Vec3d(vertices.back().x(), vertices.back().y(), 0.0));
+        result.distances.push_back(distance);
+        result.elevations.assign(result.points.size(), NO_DATA_VALUE);
+
+        std::vector<osg::Vec3d> mapPoints = result.points;
+        if (!geoSRS->transform(mapPoints, mapSRS))
+        {
+            failed = true;
+            return;
+        }
+
+        std::vector<PathSample>& pathSamples = samples[p];
+        pathSamples.resize(mapPoints.size());
+        for (unsigned i = 0; i < mapPoints.size(); ++i)
+        {
+            double res = _resolution.asDistance(mapSRS->getUnits(), result.points[i].y());
+            unsigned lod = profile->getLevelOfDetailForHorizResolution(res, ELEVATION_TILE_SIZE);
+
+            PathSample& sample = pathSamples[i];
+            sample.map = mapPoints[i];
+            sample.key = profile->createTileKey(mapPoints[i].x(), mapPoints[i].y(), lod);
+            sample.resolution = res;
+            sample.path = p;
+            sample.index = i;
+        }
+    },
+    _numThreads);
+
+    if (failed)
+        return false;
+
+    // Group the samples of the whole batch by tile.
+    std::vector<const PathSample*> sorted;
+    for (unsigned p = 0; p < samples.size(); ++p)
+        for (unsigned i = 0; i < samples[p].size(); ++i)
+            sorted.push_back(&samples[p][i]);
+
+    std::sort(sorted.begin(), sorted.end(), lessByTile);
+
+    std::vector<unsigned> groups; // start of each tile's run in sorted
+    for (unsigned i = 0; i < sorted.size(); ++i)
+    {
+        if (i == 0 || sorted[i]->key != sorted[i-1]->key)
+            groups.push_back(i);
+    }
+    groups.push_back(sorted.size());
+
+    // Sample the tiles in parallel, in contiguous chunks so that each
+    // chunk reuses one working set for neighboring tiles.
+    unsigned numGroups = groups.size() - 1u;
+    unsigned numChunks = osg::minimum(numGroups, 4u * osg::maximum(1u, _numThreads));
+    
+    Threading::parallelFor(numChunks, [&](unsigned chunk)
+    {
+        ElevationPool::WorkingSet ws;
+        std::vector<osg::Vec4d> points;
+
+        unsigned first = (unsigned)((unsigned long long)numGroups * chunk / numChunks);
+        unsigned last = (unsigned)((unsigned long long)numGroups * (chunk + 1u) / numChunks);
+
+        for (unsigned g = first; g < last && !failed; ++g)
+        {
+            if (progress && progress->isCanceled())
+            {
+                failed = true;
+                return;
+            }
+
+            // pass each sample's resolution so the pool picks the same
+            // level of detail the samples were grouped by
+            points.clear();
+            for (unsigned i = groups[g]; i < groups[g+1]; ++i)
+                points.push_back(osg::Vec4d(sorted[i]->map, sorted[i]->resolution));
+
+            if (pool->sampleMapCoords(points, &ws, progress) < 0)
+            {
+                failed = true;
+                return;
+            }
+
+            for (unsigned i = groups[g]; i < groups[g+1]; ++i)
+            {
+                double z = points[i - groups[g]].z();
+                Result& result = results[sorted[i]->path];
+                result.elevations[sorted[i]->index] = z;
+                if (z != NO_DATA_VALUE)
+                    result.points[sorted[i]->index].z() = z;
+            }
+        }
+    },
+    _numThreads);
+
+    if (failed)
+        return false;
+
+    for (std::vector<Result>::iterator r = results.begin(); r != results.end(); ++r)
+    {
+        r->slopes.assign(r->elevations.empty() ? 0u : r->elevations.size() - 1u, 0.0);
+        for (unsigned i = 0; i < r->slopes.size(); ++i)
+        {
+            double run = r->distances[i+1] - r->distances[i];
+            if (run > 0.0 && r->elevations[i] != NO_DATA_VALUE && r->elevations[i+1] != NO_DATA_VALUE)
+                r->slopes[i] = (r->elevations[i+1] - r->elevations[i]) / run;
+        }
+    }
+
+    return true;
+}
@@ -26,7 +26,8 @@ using namespace osgEarth;
 //...................................................................
 
 TerrainTileLayerModel::TerrainTileLayerModel() :
-    _revision(-1)
+    _revision(-1),
+    _loadTime_ms(0.0)
 {
 }
 
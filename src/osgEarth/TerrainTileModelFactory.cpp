@@ -25,10 +25,12 @@
 
 #include <osg/Texture2D>
 #include <osg/Texture2DArray>
+#include <osg/Timer>
 
 #define LC "[TerrainTileModelFactory] "
 
 using namespace osgEarth;
+using namespace osgEarth::Threading;
 
 //.........................................................................
 
@@ -117,7 +119,8 @@ bool CreateTileManifest::includesLandCover() const
 //.........................................................................
 
 TerrainTileModelFactory::TerrainTileModelFactory(const TerrainOptions& options) :
-_options( options )
+_options( options ),
+_threadPoolMutex(OE_MUTEX_NAME)
 {
     // Create an empty texture that we can use as a placeholder
     _emptyColorTexture = new osg::Texture2D(ImageUtils::createEmptyImage());
@@ -139,6 +142,16 @@ TerrainTileModelFactory::createTileModel(
     ProgressCallback*                progress)
 {
     OE_PROFILING_ZONE;
+
+    // Fetch the layers in parallel if so configured:
+    if (_options.layerLoadingThreads() > 0u)
+    {
+        Future<TerrainTileModel> result = createTileModelAsync(
+            map, key, manifest, requirements, progress);
+
+        return result.release(progress);
+    }
+
     // Make a new model:
     osg::ref_ptr<TerrainTileModel> model = new TerrainTileModel(
         key,
@@ -160,6 +173,268 @@ TerrainTileModelFactory::createTileModel(
     return model.release();
 }
 
+namespace osgEarth { namespace Internal
+{
+    // Copy of the caller's requirements, since the caller's object need
+    // not outlive the asynchronous request.
+    class CopiedRequirements : public TerrainEngineRequirements
+    {
+    public:
+        CopiedRequirements() :
+            _elevationTextures(true), _normalTextures(false), _landCoverTextures(false),
+            _parentTextures(false), _elevationBorder(false), _fullDataAtFirstLod(false) { }
+
+        CopiedRequirements(const TerrainEngineRequirements& rhs) :
+            _elevationTextures(rhs.elevationTexturesRequired()),
+            _normalTextures(rhs.normalTexturesRequired()),
+            _landCoverTextures(rhs.landCoverTexturesRequired()),
+            _parentTextures(rhs.parentTexturesRequired()),
+            _elevationBorder(rhs.elevationBorderRequired()),
+            _fullDataAtFirstLod(rhs.fullDataAtFirstLodRequired()) { }
+
+        bool elevationTexturesRequired() const override { return _elevationTextures; }
+        bool normalTexturesRequired() const override { return _normalTextures; }
+        bool landCoverTexturesRequired() const override { return _landCoverTextures; }
+        bool parentTexturesRequired() const override { return _parentTextures; }
+        bool elevationBorderRequired() const override { return _elevationBorder; }
+        bool fullDataAtFirstLodRequired() const override { return _fullDataAtFirstLod; }
+
+    private:
+        bool _elevationTextures, _normalTextures, _landCoverTextures;
+        bool _parentTextures, _elevationBorder, _fullDataAtFirstLod;
+    };
+
+    // Shared state for one asynchronous tile model request.
+    // Each layer task writes into its own partial model (its "slot") so
+    // the tasks never touch each other's data. The last task to finish
+    // assembles the final model in the original layer order.
+    struct CreateTileModelJob : public osg::Referenced
+    {
+        osg::ref_ptr<TerrainTileModelFactory> _factory;
+        osg::ref_ptr<const Map> _map;
+        TileKey _key;
+        CreateTileManifest _manifest;
+        CopiedRequirements _requirementsCopy;
+        const TerrainEngineRequirements* _requirements; // null or &_requirementsCopy
+        osg::ref_ptr<ProgressCallback> _progress;
+        osg::ref_ptr<TerrainTileModel> _model;
+        std::vector< osg::ref_ptr<TerrainTileModel> > _parts;
+        std::atomic_int _remaining;
+        Promise<TerrainTileModel> _promise;
+
+        CreateTileModelJob() : _requirements(NULL), _remaining(0), _promise(OE_MUTEX_NAME) { }
+
+        bool isCanceled() const
+        {
+            return
+                _promise.isAbandoned() ||
+                (_progress.valid() && _progress->isCanceled());
+        }
+
+        void finish(unsigned slot, TerrainTileModel* part)
+        {
+            _parts[slot] = part;
+            if (--_remaining == 0)
+                assemble();
+        }
+
+        void assemble()
+        {
+            if (isCanceled())
+            {
+                _promise.resolve(NULL);
+                return;
+            }
+
+            for(auto& part : _parts)
+            {
+                if (!part.valid())
+                    continue;
+
+                for(auto& layerModel : part->colorLayers())
+                    _model->colorLayers().push_back(layerModel);
+
+                for(auto& layerModel : part->sharedLayers())
+                    _model->sharedLayers().push_back(layerModel);
+
+                if (part->elevationModel().valid())
+                    _model->elevationModel() = part->elevationModel();
+
+                if (part->landCoverModel().valid())
+                    _model->landCoverModel() = part->landCoverModel();
+
+                if (part->requiresUpdateTraverse())
+                    _model->setRequiresUpdateTraverse(true);
+            }
+
+            _promise.resolve(_model.get());
+        }
+    };
+
+    // Fetches the data for one slot of a tile model in the thread pool.
+    struct CreateLayerModelOp : public osg::Operation
+    {
+        typedef std::function<void(CreateTileModelJob&, TerrainTileModel*)> Function;
+
+        osg::ref_ptr<CreateTileModelJob> _job;
+        unsigned _slot;
+        std::string _layerName;
+        Function _func;
+
+        CreateLayerModelOp(CreateTileModelJob* job, unsigned slot, const std::string& layerName, const Function& func) :
+            _job(job), _slot(slot), _layerName(layerName), _func(func) { }
+
+        void operator()(osg::Object*)
+        {
+            OE_PROFILING_ZONE;
+            OE_PROFILING_ZONE_TEXT(_layerName);
+
+            osg::ref_ptr<TerrainTileModel> part;
+
+            // skip the fetch entirely if the tile no longer needs it
+            if (!_job->isCanceled())
+            {
+                part = new TerrainTileModel(_job->_key, _job->_model->getRevision());
+
+                osg::Timer_t start = osg::Timer::instance()->tick();
+
+                _func(*_job.get(), part.get());
+
+                double ms = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+                for(auto& layerModel : part->colorLayers())
+                    layerModel->setLoadTime(ms);
+                if (part->elevationModel().valid())
+                    part->elevationModel()->setLoadTime(ms);
+                if (part->landCoverModel().valid())
+                    part->landCoverModel()->setLoadTime(ms);
+
+                OE_DEBUG << LC << _job->_key.str() << " : " << _layerName << " took " << ms << " ms" << std::endl;
+            }
+
+            _job->finish(_slot, part.get());
+        }
+    };
+} }
+
+Future<TerrainTileModel>
+TerrainTileModelFactory::createTileModelAsync(
+    const Map*                       map,
+    const TileKey&                   key,
+    const CreateTileManifest&        manifest,
+    const TerrainEngineRequirements* requirements,
+    ProgressCallback*                progress)
+{
+    OE_PROFILING_ZONE;
+
+    osg::ref_ptr<Internal::CreateTileModelJob> job = new Internal::CreateTileModelJob();
+    job->_factory = this;
+    job->_map = map;
+    job->_key = key;
+    job->_manifest = manifest;
+    if (requirements)
+    {
+        job->_requirementsCopy = Internal::CopiedRequirements(*requirements);
+        job->_requirements = &job->_requirementsCopy;
+    }
+    job->_progress = progress;
+    job->_model = new TerrainTileModel(key, map->getDataModelRevision());
+
+    std::vector< osg::ref_ptr<Internal::CreateLayerModelOp> > ops;
+
+    // One task per image layer. Other surface layers have no data to 
+    // fetch, so they go directly into their slot.
+    LayerVector layers;
+    map->getLayers(layers);
+
+    for (LayerVector::const_iterator i = layers.begin(); i != layers.end(); ++i)
+    {
+        Layer* layer = i->get();
+
+        if (!layer->isOpen())
+            continue;
+
+        if (layer->getRenderType() != layer->RENDERTYPE_TERRAIN_SURFACE)
+            continue;
+
+        if (manifest.excludes(layer))
+            continue;
+
+        unsigned slot = job->_parts.size();
+        job->_parts.push_back(NULL);
+
+        osg::ref_ptr<ImageLayer> imageLayer = dynamic_cast<ImageLayer*>(layer);
+        if (imageLayer.valid())
+        {
+            ops.push_back(new Internal::CreateLayerModelOp(job.get(), slot, layer->getName(),
+                [imageLayer](Internal::CreateTileModelJob& job, TerrainTileModel* part)
+                {
+                    job._factory->addImageLayer(part, imageLayer.get(), job._key, job._requirements, job._progress.get());
+                }));
+        }
+        else
+        {
+            TerrainTileModel* part = new TerrainTileModel(key, job->_model->getRevision());
+            TerrainTileColorLayerModel* colorModel = new TerrainTileColorLayerModel();
+            colorModel->setLayer(layer);
+            colorModel->setRevision(layer->getRevision());
+            part->colorLayers().push_back(colorModel);
+            job->_parts[slot] = part;
+        }
+    }
+
+    if ( requirements == 0L || requirements->elevationTexturesRequired() )
+    {
+        unsigned border = (requirements && requirements->elevationBorderRequired()) ? 1u : 0u;
+
+        unsigned slot = job->_parts.size();
+        job->_parts.push_back(NULL);
+
+        ops.push_back(new Internal::CreateLayerModelOp(job.get(), slot, "Elevation",
+            [border](Internal::CreateTileModelJob& job, TerrainTileModel* part)
+            {
+                job._factory->addElevation(part, job._map.get(), job._key, job._manifest, border, job._progress.get());
+            }));
+    }
+
+    unsigned landCoverSlot = job->_parts.size();
+    job->_parts.push_back(NULL);
+
+    ops.push_back(new Internal::CreateLayerModelOp(job.get(), landCoverSlot, "LandCover",
+        [](Internal::CreateTileModelJob& job, TerrainTileModel* part)
+        {
+            job._factory->addLandCover(part, job._map.get(), job._key, job._requirements, job._manifest, job._progress.get());
+        }));
+
+    Future<TerrainTileModel> result = job->_promise.getFuture();
+
+    // the counter must be in place before any task can finish:
+    job->_remaining = ops.size();
+
+    ThreadPool* pool = getThreadPool();
+    for(auto& op : ops)
+    {
+        pool->run(op.get());
+    }
+
+    return result;
+}
+
+ThreadPool*
+TerrainTileModelFactory::getThreadPool()
+{
+    ScopedMutexLock lock(_threadPoolMutex);
+    if (!_threadPool.valid())
+    {
+        unsigned numThreads = _options.layerLoadingThreads() > 0u ?
+            _options.layerLoadingThreads().get() :
+            4u;
+
+        _threadPool = new ThreadPool("oe.TileModelFactory", numThreads);
+    }
+    return _threadPool.get();
+}
+
 TerrainTileModel*
 TerrainTileModelFactory::createStandaloneTileModel(
     const Map*                       map,
@@ -42,6 +42,20 @@ namespace mapbox {
                 return t.y();
             };
         };
+
+        template <>
+        struct nth<0, osg::Vec3> {
+            inline static float get(const osg::Vec3 &t) {
+                return t.x();
+            };
+        };
+
+        template <>
+        struct nth<1, osg::Vec3> {
+            inline static float get(const osg::Vec3 &t) {
+                return t.y();
+            };
+        };
     }
 }
 
@@ -505,4 +519,78 @@ Tessellator::isEar(const osg::Vec3Array &vertices, const std::vector<unsigned in
     tradEar = true;
 
         return circEar;
-}
\ No newline at end of file
+}
+
+/***************************************************/
+
+struct PolygonTriangulator::Impl
+{
+#ifdef USE_EARCUT
+    // One ring of the polygon, viewed in place in the vertex array
+    struct Ring
+    {
+        typedef osg::Vec3 value_type;
+        const osg::Vec3* _data;
+        std::size_t _size;
+        Ring(const osg::Vec3* data, std::size_t size) : _data(data), _size(size) { }
+        std::size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        const osg::Vec3& operator[](std::size_t i) const { return _data[i]; }
+    };
+
+    mapbox::detail::Earcut<GLuint> earcut;
+    std::vector<Ring> rings;
+#endif
+};
+
+PolygonTriangulator::PolygonTriangulator() :
+_impl(new Impl())
+{
+    //nop
+}
+
+PolygonTriangulator::~PolygonTriangulator()
+{
+    delete _impl;
+}
+
+bool
+PolygonTriangulator::triangulate(const osg::Vec3Array& verts,
+                                 unsigned first,
+                                 const std::vector<unsigned>& ringSizes,
+                                 std::vector<GLuint>& out_indices)
+{
+#ifdef USE_EARCUT
+    if (ringSizes.empty() || ringSizes[0] < 3)
+        return false;
+
+    _impl->rings.clear();
+    const osg::Vec3* data = verts.empty() ? 0L : &verts.front();
+    unsigned offset = first;
+    for (unsigned i = 0; i < ringSizes.size(); ++i)
+    {
+        if (offset + ringSizes[i] > verts.size())
+            return false;
+
+        // earcut numbers the vertices of all rings consecutively, so empty
+        // rings can stay in the list without throwing off the indices.
+        _impl->rings.push_back(Impl::Ring(data + offset, ringSizes[i]));
+        offset += ringSizes[i];
+    }
+
+    _impl->earcut(_impl->rings);
+
+    const std::vector<GLuint>& indices = _impl->earcut.indices;
+    if (indices.empty())
+        return false;
+
+    out_indices.reserve(out_indices.size() + indices.size());
+    for (std::vector<GLuint>::const_iterator i = indices.begin(); i != indices.end(); ++i)
+        out_indices.push_back(first + *i);
+
+    return true;
+#else
+    // no earcut; the caller falls back on its own tessellator
+    return false;
+#endif
+}
@@ -0,0 +1,1164 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+* Copyright 2020 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#include <osgEarth/TexturePipeline>
+#include <osgEarth/ImagePool>
+#include <osgEarth/ImageUtils>
+#include <osgEarth/StringUtils>
+#include <osgEarth/Threading>
+#include <osgEarth/Metrics>
+#include <osg/Texture>
+#include <atomic>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define OE_TEXTURE_PIPELINE_SSE2 1
+#endif
+
+#define LC "[TexturePipeline] "
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+using namespace osgEarth::Threading;
+
+namespace
+{
+    typedef unsigned char uint8;
+
+    //------------------------------------------------------------------
+    // Threading
+
+    // Calls func(begin, end) over [0, count) in chunks of "grain" items
+    // using the shared compute pool, and returns when all chunks are done.
+    void parallelChunks(unsigned count, unsigned grain, unsigned maxThreads, const std::function<void(unsigned, unsigned)>& func)
+    {
+        grain = osg::maximum(grain, 1u);
+        unsigned numChunks = (count + grain - 1) / grain;
+
+        parallelFor(numChunks, [&](unsigned c)
+        {
+            func(c*grain, osg::minimum(count, (c+1)*grain));
+        },
+        maxThreads);
+    }
+
+    //------------------------------------------------------------------
+    // Working surfaces
+
+    // Tightly packed 8-bit image with n interleaved channels.
+    struct Surface
+    {
+        int w, h, n;
+        std::vector<uint8> data;
+
+        Surface() : w(0), h(0), n(0) { }
+        Surface(int w_, int h_, int n_) : w(w_), h(h_), n(n_), data(w_*h_*n_) { }
+
+        uint8* row(int y) { return &data[y*w*n]; }
+        const uint8* row(int y) const { return &data[y*w*n]; }
+    };
+
+    int getNumComponents(GLenum pixelFormat)
+    {
+        switch(pixelFormat)
+        {
+        case GL_RED:
+        case GL_LUMINANCE:
+        case GL_ALPHA:
+            return 1;
+        case GL_RG:
+        case GL_LUMINANCE_ALPHA:
+            return 2;
+        case GL_RGB:
+        case GL_BGR:
+            return 3;
+        case GL_RGBA:
+        case GL_BGRA:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    // Copies the image into a surface with its native channel layout.
+    void copyToSurface(const osg::Image* image, Surface& out)
+    {
+        out = Surface(image->s(), image->t(), getNumComponents(image->getPixelFormat()));
+        unsigned rowBytes = out.w * out.n;
+        for(int y = 0; y < out.h; ++y)
+        {
+            ::memcpy(out.row(y), image->data(0, y), rowBytes);
+        }
+    }
+
+    // Expands the image into an RGBA surface for block encoding.
+    void expandToRGBA(const osg::Image* image, Surface& out)
+    {
+        out = Surface(image->s(), image->t(), 4);
+        GLenum pf = image->getPixelFormat();
+
+        for(int y = 0; y < out.h; ++y)
+        {
+            const uint8* in = image->data(0, y);
+            uint8* o = out.row(y);
+
+            for(int x = 0; x < out.w; ++x, o += 4)
+            {
+                switch(pf)
+                {
+                case GL_RGBA:
+                    o[0] = in[0]; o[1] = in[1]; o[2] = in[2]; o[3] = in[3]; in += 4; break;
+                case GL_BGRA:
+                    o[0] = in[2]; o[1] = in[1]; o[2] = in[0]; o[3] = in[3]; in += 4; break;
+                case GL_RGB:
+                    o[0] = in[0]; o[1] = in[1]; o[2] = in[2]; o[3] = 255; in += 3; break;
+                case GL_BGR:
+                    o[0] = in[2]; o[1] = in[1]; o[2] = in[0]; o[3] = 255; in += 3; break;
+                case GL_RG:
+                    o[0] = in[0]; o[1] = in[1]; o[2] = 0; o[3] = 255; in += 2; break;
+                case GL_LUMINANCE_ALPHA:
+                    o[0] = o[1] = o[2] = in[0]; o[3] = in[1]; in += 2; break;
+                case GL_ALPHA:
+                    o[0] = o[1] = o[2] = 255; o[3] = in[0]; in += 1; break;
+                default: // GL_RED, GL_LUMINANCE
+                    o[0] = o[1] = o[2] = in[0]; o[3] = 255; in += 1; break;
+                }
+            }
+        }
+    }
+
+    bool hasTranslucency(const Surface& s)
+    {
+        for(unsigned i = 3; i < s.data.size(); i += 4)
+            if ( s.data[i] < 255 )
+                return true;
+        return false;
+    }
+
+    //------------------------------------------------------------------
+    // Mipmap kernels
+
+    // 2x2 box filter for output rows [y0, y1). Odd edges are clamped.
+    void boxDownsample(const Surface& src, Surface& dst, int y0, int y1)
+    {
+        const int n = src.n;
+
+        for(int y = y0; y < y1; ++y)
+        {
+            const uint8* r0 = src.row(osg::minimum(2*y,   src.h-1));
+            const uint8* r1 = src.row(osg::minimum(2*y+1, src.h-1));
+            uint8* out = dst.row(y);
+            int x = 0;
+
+#ifdef OE_TEXTURE_PIPELINE_SSE2
+            if ( n == 4 )
+            {
+                // two output pixels (four input pixels per row) per iteration
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i round = _mm_set1_epi16(2);
+
+                for( ; x+2 <= dst.w && 2*x+4 <= src.w; x += 2)
+                {
+                    __m128i a = _mm_loadu_si128((const __m128i*)(r0 + 8*x));
+                    __m128i b = _mm_loadu_si128((const __m128i*)(r1 + 8*x));
+                    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                    __m128i s0 = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+                    __m128i s1 = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+                    __m128i s = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s0, s1), round), 2);
+                    _mm_storel_epi64((__m128i*)(out + 4*x), _mm_packus_epi16(s, s));
+                }
+            }
+#endif
+            for( ; x < dst.w; ++x)
+            {
+                int i0 = osg::minimum(2*x,   src.w-1) * n;
+                int i1 = osg::minimum(2*x+1, src.w-1) * n;
+                for(int c = 0; c < n; ++c)
+                {
+                    out[x*n+c] = (uint8)((r0[i0+c] + r0[i1+c] + r1[i0+c] + r1[i1+c] + 2) >> 2);
+                }
+            }
+        }
+    }
+
+    // Kaiser-windowed sinc weights for a 2:1 reduction, 8 taps.
+    // Tap k sits at a distance of (k - 3.5) source texels from the output center.
+    const float* getKaiserWeights()
+    {
+        struct Weights
+        {
+            float w[8];
+            Weights()
+            {
+                const double alpha = 4.0, radius = 4.0;
+                auto bessel0 = [](double x)
+                {
+                    double sum = 1.0, term = 1.0;
+                    for(int k = 1; k < 20; ++k)
+                    {
+                        term *= (x*0.5/k)*(x*0.5/k);
+                        sum += term;
+                    }
+                    return sum;
+                };
+
+                double total = 0.0;
+                for(int k = 0; k < 8; ++k)
+                {
+                    double d = (double)k - 3.5;
+                    double x = d * 0.5 * osg::PI;
+                    double sinc = std::sin(x) / x;
+                    double t = d / radius;
+                    double window = bessel0(alpha*std::sqrt(1.0 - t*t)) / bessel0(alpha);
+                    w[k] = (float)(sinc * window);
+                    total += w[k];
+                }
+                for(int k = 0; k < 8; ++k)
+                    w[k] = (float)(w[k] / total);
+            }
+        };
+        static Weights s_weights;
+        return s_weights.w;
+    }
+
+    // Horizontal Kaiser pass over source rows [y0, y1) into a float buffer
+    // that is dst.w wide and src.h tall.
+    void kaiserHorizontal(const Surface& src, std::vector<float>& tmp, int dw, int y0, int y1)
+    {
+        const float* wt = getKaiserWeights();
+        const int n = src.n;
+
+        for(int y = y0; y < y1; ++y)
+        {
+            const uint8* in = src.row(y);
+            float* out = &tmp[y*dw*n];
+
+            for(int x = 0; x < dw; ++x)
+            {
+                float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                for(int k = 0; k < 8; ++k)
+                {
+                    int sx = osg::clampBetween(2*x - 3 + k, 0, src.w-1) * n;
+                    for(int c = 0; c < n; ++c)
+                        acc[c] += wt[k] * (float)in[sx+c];
+                }
+                for(int c = 0; c < n; ++c)
+                    out[x*n+c] = acc[c];
+            }
+        }
+    }
+
+    // Vertical Kaiser pass for output rows [y0, y1).
+    void kaiserVertical(const std::vector<float>& tmp, int srcH, Surface& dst, int y0, int y1)
+    {
+        const float* wt = getKaiserWeights();
+        const int n = dst.n;
+        const int stride = dst.w * n;
+
+        for(int y = y0; y < y1; ++y)
+        {
+            const float* rows[8];
+            for(int k = 0; k < 8; ++k)
+                rows[k] = &tmp[osg::clampBetween(2*y - 3 + k, 0, srcH-1) * stride];
+
+            uint8* out = dst.row(y);
+            for(int i = 0; i < stride; ++i)
+            {
+                float acc = 0.0f;
+                for(int k = 0; k < 8; ++k)
+                    acc += wt[k] * rows[k][i];
+                out[i] = (uint8)osg::clampBetween((int)(acc + 0.5f), 0, 255);
+            }
+        }
+    }
+
+    // Builds levels 1..N from level 0.
+    void buildMipChain(std::vector<Surface>& levels, TexturePipeline::Filter filter, unsigned maxThreads)
+    {
+        int numLevels = osg::Image::computeNumberOfMipmapLevels(levels[0].w, levels[0].h, 1);
+        levels.reserve(numLevels);
+
+        for(int i = 1; i < numLevels; ++i)
+        {
+            const Surface& src = levels[i-1];
+            Surface dst(osg::maximum(1, src.w >> 1), osg::maximum(1, src.h >> 1), src.n);
+
+            if ( filter == TexturePipeline::FILTER_KAISER )
+            {
+                std::vector<float> tmp(dst.w * src.h * src.n);
+                unsigned grain = osg::maximum(1, 4096 / dst.w);
+
+                parallelChunks(src.h, grain, maxThreads, [&](unsigned y0, unsigned y1) {
+                    kaiserHorizontal(src, tmp, dst.w, y0, y1); });
+
+                parallelChunks(dst.h, grain, maxThreads, [&](unsigned y0, unsigned y1) {
+                    kaiserVertical(tmp, src.h, dst, y0, y1); });
+            }
+            else
+            {
+                unsigned grain = osg::maximum(1, 16384 / dst.w);
+
+                parallelChunks(dst.h, grain, maxThreads, [&](unsigned y0, unsigned y1) {
+                    boxDownsample(src, dst, y0, y1); });
+            }
+
+            levels.push_back(std::move(dst));
+        }
+    }
+
+    //------------------------------------------------------------------
+    // Block encoders
+
+    inline int sq(int x) { return x*x; }
+
+    // Reads a 4x4 RGBA block, clamping at the surface edges.
+    void fetchBlock(const Surface& s, int bx, int by, uint8 block[64])
+    {
+        for(int j = 0; j < 4; ++j)
+        {
+            const uint8* row = s.row(osg::minimum(by*4+j, s.h-1));
+            for(int i = 0; i < 4; ++i)
+            {
+                const uint8* p = row + osg::minimum(bx*4+i, s.w-1)*4;
+                uint8* o = block + (j*4+i)*4;
+                o[0] = p[0]; o[1] = p[1]; o[2] = p[2]; o[3] = p[3];
+            }
+        }
+    }
+
+    // Principal axis of a set of points in N dimensions by power iteration.
+    template<int N>
+    void principalAxis(const float* points, int count, const float* mean, float* axis, int iterations)
+    {
+        float cov[N][N];
+        for(int a = 0; a < N; ++a)
+            for(int b = 0; b < N; ++b)
+                cov[a][b] = 0.0f;
+
+        for(int i = 0; i < count; ++i)
+        {
+            float d[N];
+            for(int a = 0; a < N; ++a)
+                d[a] = points[i*N+a] - mean[a];
+            for(int a = 0; a < N; ++a)
+                for(int b = a; b < N; ++b)
+                    cov[a][b] += d[a]*d[b];
+        }
+        for(int a = 0; a < N; ++a)
+            for(int b = 0; b < a; ++b)
+                cov[a][b] = cov[b][a];
+
+        // start with the diagonal of largest variance
+        int best = 0;
+        for(int a = 1; a < N; ++a)
+            if ( cov[a][a] > cov[best][best] )
+                best = a;
+        for(int a = 0; a < N; ++a)
+            axis[a] = cov[best][a];
+
+        for(int it = 0; it < iterations; ++it)
+        {
+            float next[N];
+            float len = 0.0f;
+            for(int a = 0; a < N; ++a)
+            {
+                next[a] = 0.0f;
+                for(int b = 0; b < N; ++b)
+                    next[a] += cov[a][b] * axis[b];
+                len = osg::maximum(len, std::fabs(next[a]));
+            }
+            if ( len <= 0.0f )
+                break;
+            for(int a = 0; a < N; ++a)
+                axis[a] = next[a] / len;
+        }
+    }
+
+    // Endpoints of a block along its principal axis (or its bounding box).
+    template<int N>
+    void findEndpoints(const float* points, int count, TexturePipeline::Quality quality, float* e0, float* e1)
+    {
+        float mean[N], lo[N], hi[N];
+        for(int a = 0; a < N; ++a)
+        {
+            mean[a] = 0.0f;
+            lo[a] = 255.0f;
+            hi[a] = 0.0f;
+        }
+        for(int i = 0; i < count; ++i)
+        {
+            for(int a = 0; a < N; ++a)
+            {
+                float v = points[i*N+a];
+                mean[a] += v;
+                lo[a] = osg::minimum(lo[a], v);
+                hi[a] = osg::maximum(hi[a], v);
+            }
+        }
+        for(int a = 0; a < N; ++a)
+            mean[a] /= (float)count;
+
+        float axis[N];
+        principalAxis<N>(points, count, mean, axis, quality == TexturePipeline::QUALITY_FAST ? 1 : 4);
+
+        if ( quality == TexturePipeline::QUALITY_FAST )
+        {
+            // bounding box diagonal, oriented to match the principal axis and inset slightly
+            for(int a = 0; a < N; ++a)
+            {
+                float inset = (hi[a] - lo[a]) / 16.0f;
+                bool flip = axis[a] < 0.0f;
+                e0[a] = flip ? lo[a] + inset : hi[a] - inset;
+                e1[a] = flip ? hi[a] - inset : lo[a] + inset;
+            }
+            return;
+        }
+
+        // extreme projections onto the principal axis
+        float minDot = FLT_MAX, maxDot = -FLT_MAX;
+        int minIdx = 0, maxIdx = 0;
+        for(int i = 0; i < count; ++i)
+        {
+            float dot = 0.0f;
+            for(int a = 0; a < N; ++a)
+                dot += (points[i*N+a] - mean[a]) * axis[a];
+            if ( dot < minDot ) { minDot = dot; minIdx = i; }
+            if ( dot > maxDot ) { maxDot = dot; maxIdx = i; }
+        }
+        for(int a = 0; a < N; ++a)
+        {
+            e0[a] = points[maxIdx*N+a];
+            e1[a] = points[minIdx*N+a];
+        }
+    }
+
+    // Least-squares endpoints given per-point interpolation weights
+    // (weight of e1; e0 gets 1-w). Returns false if the system is singular.
+    template<int N>
+    bool refineEndpoints(const float* points, const float* weights, int count, float* e0, float* e1)
+    {
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[N], bx[N];
+        for(int a = 0; a < N; ++a)
+            ax[a] = bx[a] = 0.0f;
+
+        for(int i = 0; i < count; ++i)
+        {
+            float b = weights[i];
+            float a = 1.0f - b;
+            aa += a*a; ab += a*b; bb += b*b;
+            for(int c = 0; c < N; ++c)
+            {
+                ax[c] += a * points[i*N+c];
+                bx[c] += b * points[i*N+c];
+            }
+        }
+
+        float det = aa*bb - ab*ab;
+        if ( std::fabs(det) < 1e-6f )
+            return false;
+
+        float inv = 1.0f / det;
+        for(int c = 0; c < N; ++c)
+        {
+            e0[c] = osg::clampBetween((ax[c]*bb - bx[c]*ab) * inv, 0.0f, 255.0f);
+            e1[c] = osg::clampBetween((bx[c]*aa - ax[c]*ab) * inv, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    inline unsigned short packRGB565(const float* c)
+    {
+        int r = osg::clampBetween((int)(c[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+        int g = osg::clampBetween((int)(c[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+        int b = osg::clampBetween((int)(c[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+        return (unsigned short)((r << 11) | (g << 5) | b);
+    }
+
+    inline void unpackRGB565(unsigned short v, int* c)
+    {
+        int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+        c[0] = (r << 3) | (r >> 2);
+        c[1] = (g << 2) | (g >> 4);
+        c[2] = (b << 3) | (b >> 2);
+    }
+
+    // Chooses 2-bit indices against a 4-color BC1 palette; returns the total error.
+    int selectColorIndices(const uint8 block[64], unsigned short c0, unsigned short c1, unsigned& indices)
+    {
+        int pal[4][3];
+        unpackRGB565(c0, pal[0]);
+        unpackRGB565(c1, pal[1]);
+        for(int c = 0; c < 3; ++c)
+        {
+            pal[2][c] = (2*pal[0][c] + pal[1][c]) / 3;
+            pal[3][c] = (pal[0][c] + 2*pal[1][c]) / 3;
+        }
+
+        int error = 0;
+        indices = 0u;
+        for(int i = 0; i < 16; ++i)
+        {
+            const uint8* p = block + i*4;
+            int best = 0, bestErr = INT_MAX;
+            for(int k = 0; k < 4; ++k)
+            {
+                int e = sq(p[0]-pal[k][0]) + sq(p[1]-pal[k][1]) + sq(p[2]-pal[k][2]);
+                if ( e < bestErr ) { bestErr = e; best = k; }
+            }
+            indices |= (unsigned)best << (2*i);
+            error += bestErr;
+        }
+        return error;
+    }
+
+    // BC1 color block (always 4-color mode, so it is valid inside BC3 too).
+    void encodeColorBlock(const uint8 block[64], TexturePipeline::Quality quality, uint8* out)
+    {
+        float points[16*3];
+        bool solid = true;
+        for(int i = 0; i < 16; ++i)
+        {
+            for(int c = 0; c < 3; ++c)
+            {
+                points[i*3+c] = block[i*4+c];
+                if ( block[i*4+c] != block[c] )
+                    solid = false;
+            }
+        }
+
+        unsigned short c0, c1;
+        unsigned indices = 0u;
+
+        if ( solid )
+        {
+            c0 = c1 = packRGB565(points);
+        }
+        else
+        {
+            float e0[3], e1[3];
+            findEndpoints<3>(points, 16, quality, e0, e1);
+            c0 = packRGB565(e0);
+            c1 = packRGB565(e1);
+            int error = selectColorIndices(block, c0, c1, indices);
+
+            int iterations =
+                quality == TexturePipeline::QUALITY_BEST ? 3 :
+                quality == TexturePipeline::QUALITY_NORMAL ? 1 : 0;
+
+            static const float s_weight[4] = { 0.0f, 1.0f, 1.0f/3.0f, 2.0f/3.0f };
+
+            for(int it = 0; it < iterations && error > 0; ++it)
+            {
+                float weights[16];
+                for(int i = 0; i < 16; ++i)
+                    weights[i] = s_weight[(indices >> (2*i)) & 3];
+
+                if ( !refineEndpoints<3>(points, weights, 16, e0, e1) )
+                    break;
+
+                unsigned short r0 = packRGB565(e0), r1 = packRGB565(e1);
+                unsigned refined;
+                int refinedError = selectColorIndices(block, r0, r1, refined);
+                if ( refinedError >= error )
+                    break;
+
+                c0 = r0; c1 = r1; indices = refined; error = refinedError;
+            }
+        }
+
+        // 4-color mode requires c0 > c1.
+        if ( c0 < c1 )
+        {
+            std::swap(c0, c1);
+            indices ^= 0x55555555u; // 0<->1, 2<->3
+        }
+        else if ( c0 == c1 )
+        {
+            indices = 0u;
+        }
+
+        out[0] = c0 & 0xff; out[1] = c0 >> 8;
+        out[2] = c1 & 0xff; out[3] = c1 >> 8;
+        out[4] = indices & 0xff;
+        out[5] = (indices >> 8) & 0xff;
+        out[6] = (indices >> 16) & 0xff;
+        out[7] = (indices >> 24) & 0xff;
+    }
+
+    // Builds the palette of a BC4 block.
+    void makeAlphaPalette(int a0, int a1, int pal[8])
+    {
+        pal[0] = a0;
+        pal[1] = a1;
+        if ( a0 > a1 )
+        {
+            for(int k = 1; k < 7; ++k)
+                pal[k+1] = ((7-k)*a0 + k*a1 + 3) / 7;
+        }
+        else
+        {
+            for(int k = 1; k < 5; ++k)
+                pal[k+1] = ((5-k)*a0 + k*a1 + 2) / 5;
+            pal[6] = 0;
+            pal[7] = 255;
+        }
+    }
+
+    int selectAlphaIndices(const uint8 values[16], int a0, int a1, unsigned long long& indices)
+    {
+        int pal[8];
+        makeAlphaPalette(a0, a1, pal);
+
+        int error = 0;
+        indices = 0ull;
+        for(int i = 0; i < 16; ++i)
+        {
+            int best = 0, bestErr = INT_MAX;
+            for(int k = 0; k < 8; ++k)
+            {
+                int e = sq(values[i] - pal[k]);
+                if ( e < bestErr ) { bestErr = e; best = k; }
+            }
+            indices |= (unsigned long long)best << (3*i);
+            error += bestErr;
+        }
+        return error;
+    }
+
+    // Single-channel BC4 block (also the alpha half of BC3).
+    void encodeAlphaBlock(const uint8 values[16], TexturePipeline::Quality quality, uint8* out)
+    {
+        int lo = 255, hi = 0;
+        for(int i = 0; i < 16; ++i)
+        {
+            lo = osg::minimum(lo, (int)values[i]);
+            hi = osg::maximum(hi, (int)values[i]);
+        }
+
+        int a0 = hi, a1 = lo;
+        unsigned long long indices = 0ull;
+
+        if ( hi == lo )
+        {
+            // solid block; index 0 everywhere
+        }
+        else if ( quality == TexturePipeline::QUALITY_FAST )
+        {
+            // direct quantization along the ramp
+            int range = hi - lo;
+            for(int i = 0; i < 16; ++i)
+            {
+                int t = ((values[i] - lo) * 7 + range/2) / range;
+                int idx = t == 7 ? 0 : t == 0 ? 1 : 8 - t;
+                indices |= (unsigned long long)idx << (3*i);
+            }
+        }
+        else
+        {
+            int error = selectAlphaIndices(values, a0, a1, indices);
+
+            if ( quality == TexturePipeline::QUALITY_BEST && error > 0 )
+            {
+                // try the 6-value mode, which has exact 0 and 255 entries
+                int lo6 = 255, hi6 = 0;
+                for(int i = 0; i < 16; ++i)
+                {
+                    if ( values[i] != 0 && values[i] != 255 )
+                    {
+                        lo6 = osg::minimum(lo6, (int)values[i]);
+                        hi6 = osg::maximum(hi6, (int)values[i]);
+                    }
+                }
+                if ( lo6 > hi6 )
+                    lo6 = hi6 = 0;
+
+                unsigned long long indices6;
+                int error6 = selectAlphaIndices(values, lo6, hi6, indices6);
+                if ( error6 < error )
+                {
+                    a0 = lo6; a1 = hi6; indices = indices6;
+                }
+            }
+        }
+
+        out[0] = (uint8)a0;
+        out[1] = (uint8)a1;
+        for(int b = 0; b < 6; ++b)
+            out[2+b] = (uint8)((indices >> (8*b)) & 0xff);
+    }
+
+    // LSB-first bit packer for BC7 blocks.
+    struct BitWriter
+    {
+        uint8* _out;
+        unsigned _pos;
+        BitWriter(uint8* out) : _out(out), _pos(0u) { ::memset(out, 0, 16); }
+        void put(unsigned value, unsigned bits)
+        {
+            for(unsigned i = 0; i < bits; ++i, ++_pos)
+                if ( (value >> i) & 1u )
+                    _out[_pos >> 3] |= (uint8)(1u << (_pos & 7u));
+        }
+    };
+
+    static const int s_bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // Quantizes an RGBA endpoint to 7 bits per channel plus a shared p-bit.
+    inline void quantizeBC7Endpoint(const float* e, int pbit, int* q)
+    {
+        for(int c = 0; c < 4; ++c)
+            q[c] = osg::clampBetween((int)((e[c] - (float)pbit) * 0.5f + 0.5f), 0, 127);
+    }
+
+    int selectBC7Indices(const uint8 block[64], const int* q0, int p0, const int* q1, int p1, int* indices)
+    {
+        int e0[4], e1[4];
+        for(int c = 0; c < 4; ++c)
+        {
+            e0[c] = (q0[c] << 1) | p0;
+            e1[c] = (q1[c] << 1) | p1;
+        }
+
+        int pal[16][4];
+        for(int k = 0; k < 16; ++k)
+            for(int c = 0; c < 4; ++c)
+                pal[k][c] = ((64 - s_bc7Weights4[k])*e0[c] + s_bc7Weights4[k]*e1[c] + 32) >> 6;
+
+        int error = 0;
+        for(int i = 0; i < 16; ++i)
+        {
+            const uint8* p = block + i*4;
+            int best = 0, bestErr = INT_MAX;
+            for(int k = 0; k < 16; ++k)
+            {
+                int e = sq(p[0]-pal[k][0]) + sq(p[1]-pal[k][1]) + sq(p[2]-pal[k][2]) + sq(p[3]-pal[k][3]);
+                if ( e < bestErr ) { bestErr = e; best = k; }
+            }
+            indices[i] = best;
+            error += bestErr;
+        }
+        return error;
+    }
+
+    // Best p-bit for one endpoint on its own.
+    inline int chooseBC7PBit(const float* e)
+    {
+        int err[2];
+        for(int p = 0; p < 2; ++p)
+        {
+            int q[4];
+            quantizeBC7Endpoint(e, p, q);
+            err[p] = 0;
+            for(int c = 0; c < 4; ++c)
+                err[p] += sq(((q[c] << 1) | p) - (int)(e[c] + 0.5f));
+        }
+        return err[1] < err[0] ? 1 : 0;
+    }
+
+    // BC7 block using mode 6 (one subset, RGBA 7.7.7.7 endpoints with
+    // unique p-bits, 4-bit indices).
+    void encodeBC7Block(const uint8 block[64], TexturePipeline::Quality quality, uint8* out)
+    {
+        float points[16*4];
+        for(int i = 0; i < 64; ++i)
+            points[i] = block[i];
+
+        float e0[4], e1[4];
+        findEndpoints<4>(points, 16, quality, e0, e1);
+
+        int q0[4], q1[4], p0 = 0, p1 = 0;
+        int indices[16];
+        int error = INT_MAX;
+
+        auto evaluate = [&](const float* f0, const float* f1)
+        {
+            int candidates[4][2] = { { chooseBC7PBit(f0), chooseBC7PBit(f1) }, {0,0}, {0,1}, {1,0} };
+            int numCandidates = 1;
+            if ( quality == TexturePipeline::QUALITY_BEST )
+            {
+                candidates[1][0] = 1 - candidates[0][0]; candidates[1][1] = candidates[0][1];
+                candidates[2][0] = candidates[0][0];     candidates[2][1] = 1 - candidates[0][1];
+                candidates[3][0] = 1 - candidates[0][0]; candidates[3][1] = 1 - candidates[0][1];
+                numCandidates = 4;
+            }
+
+            bool improved = false;
+            for(int k = 0; k < numCandidates; ++k)
+            {
+                int t0[4], t1[4], ti[16];
+                quantizeBC7Endpoint(f0, candidates[k][0], t0);
+                quantizeBC7Endpoint(f1, candidates[k][1], t1);
+                int e = selectBC7Indices(block, t0, candidates[k][0], t1, candidates[k][1], ti);
+                if ( e < error )
+                {
+                    error = e;
+                    ::memcpy(q0, t0, sizeof(q0));
+                    ::memcpy(q1, t1, sizeof(q1));
+                    ::memcpy(indices, ti, sizeof(indices));
+                    p0 = candidates[k][0];
+                    p1 = candidates[k][1];
+                    improved = true;
+                }
+            }
+            return improved;
+        };
+
+        evaluate(e0, e1);
+
+        int iterations =
+            quality == TexturePipeline::QUALITY_BEST ? 2 :
+            quality == TexturePipeline::QUALITY_NORMAL ? 1 : 0;
+
+        for(int it = 0; it < iterations && error > 0; ++it)
+        {
+            float weights[16];
+            for(int i = 0; i < 16; ++i)
+                weights[i] = (float)s_bc7Weights4[indices[i]] / 64.0f;
+
+            if ( !refineEndpoints<4>(points, weights, 16, e0, e1) || !evaluate(e0, e1) )
+                break;
+        }
+
+        // the anchor (first) index stores only 3 bits, so its high bit must be zero
+        if ( indices[0] >= 8 )
+        {
+            for(int c = 0; c < 4; ++c)
+                std::swap(q0[c], q1[c]);
+            std::swap(p0, p1);
+            for(int i = 0; i < 16; ++i)
+                indices[i] = 15 - indices[i];
+        }
+
+        BitWriter bits(out);
+        bits.put(1u << 6, 7);  // mode 6
+        for(int c = 0; c < 4; ++c)
+        {
+            bits.put(q0[c], 7);
+            bits.put(q1[c], 7);
+        }
+        bits.put(p0, 1);
+        bits.put(p1, 1);
+        bits.put(indices[0], 3);
+        for(int i = 1; i < 16; ++i)
+            bits.put(indices[i], 4);
+    }
+
+    unsigned getBlockBytes(TexturePipeline::Format format)
+    {
+        return format == TexturePipeline::FORMAT_BC1 || format == TexturePipeline::FORMAT_BC4 ? 8u : 16u;
+    }
+
+    GLenum getGLFormat(TexturePipeline::Format format)
+    {
+        switch(format)
+        {
+        case TexturePipeline::FORMAT_BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TexturePipeline::FORMAT_BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case TexturePipeline::FORMAT_BC4: return GL_COMPRESSED_RED_RGTC1_EXT;
+        case TexturePipeline::FORMAT_BC5: return GL_COMPRESSED_RED_GREEN_RGTC2_EXT;
+        default:                          return GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+        }
+    }
+
+    void encodeBlock(const uint8 block[64], TexturePipeline::Format format, TexturePipeline::Quality quality, uint8* out)
+    {
+        uint8 channel[16];
+
+        switch(format)
+        {
+        case TexturePipeline::FORMAT_BC1:
+            encodeColorBlock(block, quality, out);
+            break;
+
+        case TexturePipeline::FORMAT_BC3:
+            for(int i = 0; i < 16; ++i) channel[i] = block[i*4+3];
+            encodeAlphaBlock(channel, quality, out);
+            encodeColorBlock(block, quality, out+8);
+            break;
+
+        case TexturePipeline::FORMAT_BC4:
+            for(int i = 0; i < 16; ++i) channel[i] = block[i*4];
+            encodeAlphaBlock(channel, quality, out);
+            break;
+
+        case TexturePipeline::FORMAT_BC5:
+            for(int i = 0; i < 16; ++i) channel[i] = block[i*4];
+            encodeAlphaBlock(channel, quality, out);
+            for(int i = 0; i < 16; ++i) channel[i] = block[i*4+1];
+            encodeAlphaBlock(channel, quality, out+8);
+            break;
+
+        default:
+            encodeBC7Block(block, quality, out);
+            break;
+        }
+    }
+
+    // Allocates a single buffer for all levels and sets it on a new image.
+    // A pooled buffer must stay with its PooledImage, so only images that
+    // are never handed over to another image can use one.
+    osg::Image* allocateImage(
+        const std::vector<Surface>& levels,
+        const std::vector<unsigned>& levelBytes,
+        GLint internalFormat,
+        GLenum pixelFormat,
+        bool pooled,
+        unsigned char*& data)
+    {
+        unsigned total = 0u;
+        osg::Image::MipmapDataType offsets;
+        for(unsigned i = 0; i < levelBytes.size(); ++i)
+        {
+            if ( i > 0 )
+                offsets.push_back(total);
+            total += levelBytes[i];
+        }
+
+        osg::Image* image;
+        if ( pooled )
+        {
+            PooledImage* pooledImage = new PooledImage();
+            data = pooledImage->allocateBuffer(
+                levels[0].w, levels[0].h, 1,
+                internalFormat,
+                pixelFormat,
+                GL_UNSIGNED_BYTE,
+                total,
+                1);
+            image = pooledImage;
+        }
+        else
+        {
+            data = new unsigned char[total];
+            image = new osg::Image();
+            image->setImage(
+                levels[0].w, levels[0].h, 1,
+                internalFormat,
+                pixelFormat,
+                GL_UNSIGNED_BYTE,
+                data,
+                osg::Image::USE_NEW_DELETE,
+                1);
+        }
+
+        if ( !offsets.empty() )
+            image->setMipmapLevels(offsets);
+
+        return image;
+    }
+}
+
+//........................................................................
+
+TexturePipeline::TexturePipeline() :
+_format    ( FORMAT_AUTO ),
+_filter    ( FILTER_BOX ),
+_quality   ( QUALITY_NORMAL ),
+_mipmaps   ( true ),
+_maxThreads( 0u )
+{
+    //nop
+}
+
+bool
+TexturePipeline::setMethod(const std::string& method)
+{
+    StringVector tokens;
+    StringTokenizer(toLower(method), tokens, ":", "", false, true);
+    if ( tokens.empty() )
+        return false;
+
+    Format format;
+    if      ( tokens[0] == "bc" )  format = FORMAT_AUTO;
+    else if ( tokens[0] == "bc1" ) format = FORMAT_BC1;
+    else if ( tokens[0] == "bc3" ) format = FORMAT_BC3;
+    else if ( tokens[0] == "bc4" ) format = FORMAT_BC4;
+    else if ( tokens[0] == "bc5" ) format = FORMAT_BC5;
+    else if ( tokens[0] == "bc7" ) format = FORMAT_BC7;
+    else return false;
+
+    Filter filter = _filter;
+    Quality quality = _quality;
+
+    for(unsigned i = 1; i < tokens.size(); ++i)
+    {
+        if      ( tokens[i] == "fast" )   quality = QUALITY_FAST;
+        else if ( tokens[i] == "normal" ) quality = QUALITY_NORMAL;
+        else if ( tokens[i] == "best" )   quality = QUALITY_BEST;
+        else if ( tokens[i] == "box" )    filter = FILTER_BOX;
+        else if ( tokens[i] == "kaiser" ) filter = FILTER_KAISER;
+        else return false;
+    }
+
+    _format = format;
+    _filter = filter;
+    _quality = quality;
+    return true;
+}
+
+bool
+TexturePipeline::isMethodSupported(const std::string& method)
+{
+    TexturePipeline temp;
+    return temp.setMethod(method);
+}
+
+bool
+TexturePipeline::canProcess(const osg::Image* image)
+{
+    return
+        image != nullptr &&
+        image->s() > 0 && image->t() > 0 && image->r() == 1 &&
+        image->getDataType() == GL_UNSIGNED_BYTE &&
+        !image->isCompressed() &&
+        !image->isMipmap() &&
+        getNumComponents(image->getPixelFormat()) > 0;
+}
+
+osg::Image*
+TexturePipeline::mipmap(const osg::Image* image) const
+{
+    OE_PROFILING_ZONE;
+
+    if ( !canProcess(image) )
+        return nullptr;
+
+    std::vector<Surface> levels(1);
+    copyToSurface(image, levels[0]);
+    buildMipChain(levels, _filter, _maxThreads);
+
+    std::vector<unsigned> levelBytes;
+    for(auto& level : levels)
+        levelBytes.push_back(level.data.size());
+
+    unsigned char* data;
+    osg::Image* output = allocateImage(levels, levelBytes, image->getInternalTextureFormat(), image->getPixelFormat(), true, data);
+
+    for(auto& level : levels)
+    {
+        ::memcpy(data, level.data.data(), level.data.size());
+        data += level.data.size();
+    }
+
+    return output;
+}
+
+osg::Image*
+TexturePipeline::process(const osg::Image* image) const
+{
+    OE_PROFILING_ZONE;
+
+    if ( !canProcess(image) )
+        return nullptr;
+
+    std::vector<Surface> levels(1);
+    expandToRGBA(image, levels[0]);
+
+    Format format = _format;
+    if ( format == FORMAT_AUTO )
+        format = hasTranslucency(levels[0]) ? FORMAT_BC3 : FORMAT_BC1;
+
+    if ( _mipmaps )
+        buildMipChain(levels, _filter, _maxThreads);
+
+    // one work item per block row across all levels:
+    const unsigned blockBytes = getBlockBytes(format);
+    std::vector<unsigned> levelBytes, firstRow;
+    unsigned totalRows = 0u;
+    for(auto& level : levels)
+    {
+        unsigned bw = (level.w + 3) / 4, bh = (level.h + 3) / 4;
+        levelBytes.push_back(bw * bh * blockBytes);
+        firstRow.push_back(totalRows);
+        totalRows += bh;
+    }
+
+    GLenum glFormat = getGLFormat(format);
+    unsigned char* data;
+    osg::Image* output = allocateImage(levels, levelBytes, glFormat, glFormat, false, data);
+
+    std::vector<unsigned char*> levelData;
+    for(unsigned i = 0; i < levels.size(); ++i)
+    {
+        levelData.push_back(data);
+        data += levelBytes[i];
+    }
+
+    const Quality quality = _quality;
+    unsigned grain = osg::maximum(1u, 256u / osg::maximum(1u, (unsigned)(levels[0].w + 3) / 4u));
+
+    parallelChunks(totalRows, grain, _maxThreads, [&](unsigned row0, unsigned row1)
+    {
+        uint8 block[64];
+        unsigned level = 0u;
+
+        for(unsigned row = row0; row < row1; ++row)
+        {
+            while ( level+1 < firstRow.size() && row >= firstRow[level+1] )
+                ++level;
+
+            const Surface& s = levels[level];
+            int by = row - firstRow[level];
+            int bw = (s.w + 3) / 4;
+            uint8* out = levelData[level] + by * bw * blockBytes;
+
+            for(int bx = 0; bx < bw; ++bx, out += blockBytes)
+            {
+                fetchBlock(s, bx, by, block);
+                encodeBlock(block, format, quality, out);
+            }
+        }
+    });
+
+    return output;
+}
+
+bool
+TexturePipeline::processInPlace(osg::Image* image) const
+{
+    osg::ref_ptr<osg::Image> output = process(image);
+    if ( !output.valid() )
+        return false;
+
+    // hand the new buffer over to the input image (process() does not
+    // pool its output, so the buffer is ours to give away)
+    osg::Image::MipmapDataType offsets = output->getMipmapLevels();
+    output->setAllocationMode(osg::Image::NO_DELETE);
+
+    image->setImage(
+        output->s(), output->t(), 1,
+        output->getInternalTextureFormat(),
+        output->getPixelFormat(),
+        GL_UNSIGNED_BYTE,
+        output->data(),
+        osg::Image::USE_NEW_DELETE,
+        1);
+
+    if ( !offsets.empty() )
+        image->setMipmapLevels(offsets);
+
+    return true;
+}
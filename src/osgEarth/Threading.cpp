@@ -386,6 +386,7 @@ ThreadPool::ThreadPool(unsigned numThreads) :
     _done(false),
     _queueMutex("ThreadPool")
 {
+    initMetrics();
     startThreads();
 }
 
@@ -395,6 +396,7 @@ ThreadPool::ThreadPool(const std::string& name, unsigned numThreads) :
     _done(false),
     _queueMutex("ThreadPool")
 {
+    initMetrics();
     startThreads();
 }
 
@@ -403,12 +405,25 @@ ThreadPool::~ThreadPool()
     stopThreads();
 }
 
+void ThreadPool::initMetrics()
+{
+    MetricsRegistry::Labels labels;
+    labels["pool"] = _name;
+
+    _queueDepth = MetricsRegistry::instance().gauge(
+        "oe_threadpool_queue_depth", "Operations waiting in a thread pool", labels);
+
+    _operationsRun = MetricsRegistry::instance().counter(
+        "oe_threadpool_operations_total", "Operations run by a thread pool", labels);
+}
+
 void ThreadPool::run(osg::Operation* op)
 {
     if (op)
     {
         Threading::ScopedMutexLock lock(_queueMutex);
         _queue.push(op);
+        _queueDepth->add(1.0);
         _block.notify_all();
     }
 }
@@ -444,6 +459,7 @@ void ThreadPool::startThreads()
                     {
                         op = _queue.front();
                         _queue.pop();
+                        _queueDepth->add(-1.0);
                     }
                 }
 
@@ -451,12 +467,14 @@ void ThreadPool::startThreads()
                 {
                     // run the op:
                     (*op.get())(nullptr);
+                    _operationsRun->increment();
 
                     // if it's a keeper, requeue it
                     if (op->getKeep())
                     {
                         Threading::ScopedMutexLock lock(_queueMutex);
                         _queue.push(op);
+                        _queueDepth->add(1.0);
                     }
                     op = nullptr;
                 }
@@ -484,6 +502,7 @@ void ThreadPool::stopThreads()
     // Clear out the queue
     {
         Threading::ScopedMutexLock lock(_queueMutex);
+        _queueDepth->add(-(double)_queue.size());
         Queue emptyQueue;
         _queue.swap(emptyQueue);
     }
@@ -505,6 +524,86 @@ ThreadPool::get(const osgDB::Options* options)
     return OptionsData<ThreadPool>::get(options, "osgEarth::ThreadPool");
 }
 
+namespace
+{
+    // State shared by the calling thread and the pool operations of one
+    // parallelFor. Operations that start after all the iterations are
+    // claimed return without touching the caller's function.
+    struct ParallelForState : public osg::Referenced
+    {
+        ParallelForState(unsigned count, const std::function<void(unsigned)>& func) :
+            _count(count), _func(func), _next(0u), _finished(0u) { }
+
+        void work()
+        {
+            for (unsigned i = _next++; i < _count; i = _next++)
+            {
+                _func(i);
+                if (++_finished == _count)
+                    _done.set();
+            }
+        }
+
+        const unsigned _count;
+        const std::function<void(unsigned)>& _func;
+        std::atomic<unsigned> _next;
+        std::atomic<unsigned> _finished;
+        Event _done;
+    };
+
+    struct ParallelForOperation : public osg::Operation
+    {
+        osg::ref_ptr<ParallelForState> _state;
+        ParallelForOperation(ParallelForState* state) : osg::Operation("oe.ParallelFor", false), _state(state) { }
+        void operator()(osg::Object*) { _state->work(); }
+    };
+}
+
+ThreadPool*
+osgEarth::Threading::getComputeThreadPool()
+{
+    static Mutex s_poolMutex;
+    static osg::ref_ptr<ThreadPool> s_pool;
+
+    ScopedMutexLock lock(s_poolMutex);
+    if (!s_pool.valid())
+    {
+        unsigned hw = std::thread::hardware_concurrency();
+        s_pool = new ThreadPool("oe.Compute", hw > 1u ? hw - 1u : 1u);
+    }
+    return s_pool.get();
+}
+
+void
+osgEarth::Threading::parallelFor(unsigned count,
+                                 const std::function<void(unsigned)>& func,
+                                 unsigned maxThreads)
+{
+    if (count == 0u)
+        return;
+
+    unsigned hw = osg::maximum(1u, std::thread::hardware_concurrency());
+    unsigned numThreads = maxThreads > 0u ? osg::minimum(maxThreads, hw) : hw;
+    numThreads = osg::minimum(numThreads, count);
+
+    if (numThreads <= 1u)
+    {
+        for (unsigned i = 0; i < count; ++i)
+            func(i);
+        return;
+    }
+
+    osg::ref_ptr<ParallelForState> state = new ParallelForState(count, func);
+    ThreadPool* pool = getComputeThreadPool();
+    for (unsigned t = 1; t < numThreads; ++t)
+    {
+        pool->run(new ParallelForOperation(state.get()));
+    }
+
+    state->work();
+    state->_done.wait();
+}
+
 void
 osgEarth::Threading::setThreadName(const std::string& name)
 {
@@ -38,6 +38,7 @@ ThreeDTilesLayer::Options::getConfig() const
     Config conf = VisibleLayer::Options::getConfig();
     conf.set("url", _url);
     conf.set("max_sse", _maximumScreenSpaceError);
+    conf.set("max_resident_mb", _maxResidentMB);
     return conf;
 }
 
@@ -47,6 +48,7 @@ ThreeDTilesLayer::Options::fromConfig( const Config& conf )
     _maximumScreenSpaceError.init(15.0f);
     conf.get("url", _url);
     conf.get("max_sse", _maximumScreenSpaceError);
+    conf.get("max_resident_mb", _maxResidentMB);
 }
 
 //........................................................................
@@ -102,6 +104,10 @@ ThreeDTilesLayer::openImplementation()
     _tilesetNode = new ThreeDTilesetNode(tileset, "", getSceneGraphCallbacks(), readOptions.get());
     _tilesetNode->setMaximumScreenSpaceError(*options().maximumScreenSpaceError());
     _tilesetNode->setOwnerName(getName());
+    if (options().maxResidentMB().isSet())
+    {
+        _tilesetNode->setMaxResidentBytes((unsigned long long)options().maxResidentMB().get() * 1024ull * 1024ull);
+    }
 
     return STATUS_OK;
 }
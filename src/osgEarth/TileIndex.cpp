@@ -29,13 +29,421 @@
 #include <osgEarth/OGRFeatureSource>
 
 #include <osgDB/FileUtils>
+#include <osgDB/FileNameUtils>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 
 using namespace osgEarth;
+using namespace osgEarth::Util;
 using namespace osgEarth::Contrib;
 using namespace std;
 
+#define LC "[TileIndex] "
+
 #define OGR_SCOPED_LOCK GDAL_SCOPED_LOCK
 
+namespace
+{
+    // Native index file layout (little-endian):
+    //
+    //   FileHeader
+    //   NodeBox[numNodes]  - packed R-tree, root level first, leaves last
+    //   Record[numItems]   - one per file, in Hilbert order (same order as the leaves)
+    //   char[stringsSize]  - filenames and the SRS definition
+    //
+    // A leaf's index is its record; an interior node's index is the offset
+    // of its first child. Every node but the last in a level has NODE_SIZE children.
+
+    const char MAGIC[8] = { 'O', 'E', 'T', 'I', 'D', 'X', '0', '1' };
+    const uint32_t VERSION = 1u;
+    const uint32_t NODE_SIZE = 16u;
+
+    // Entries added one at a time are scanned linearly until there are this
+    // many of them; then the tree is repacked.
+    const unsigned MAX_PENDING = 1024u;
+
+    // Position of (x,y) along the Hilbert curve that fills a 65536x65536 grid
+    uint64_t hilbert(uint32_t x, uint32_t y)
+    {
+        const uint32_t n = 1u << 16;
+        uint64_t d = 0u;
+        for (uint32_t s = n / 2; s > 0; s /= 2)
+        {
+            uint32_t rx = (x & s) > 0 ? 1u : 0u;
+            uint32_t ry = (y & s) > 0 ? 1u : 0u;
+            d += (uint64_t)s * s * ((3u * rx) ^ ry);
+            if (ry == 0)
+            {
+                if (rx == 1)
+                {
+                    x = n - 1 - x;
+                    y = n - 1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return d;
+    }
+
+    // Number of nodes in each level of a packed tree, leaves first
+    void getLevelCounts(uint64_t numItems, std::vector<uint64_t>& counts)
+    {
+        counts.clear();
+        uint64_t n = numItems;
+        counts.push_back(n);
+        while (n > 1)
+        {
+            n = (n + NODE_SIZE - 1) / NODE_SIZE;
+            counts.push_back(n);
+        }
+    }
+}
+
+/**
+ * Immutable packed R-tree, either memory-mapped from an index file or
+ * held in memory after a build.
+ */
+struct TileIndex::Tree
+{
+    struct FileHeader
+    {
+        char     magic[8];
+        uint32_t version;
+        uint32_t nodeSize;
+        uint64_t numItems;
+        uint64_t numNodes;
+        uint64_t nodesOffset;
+        uint64_t recordsOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+        uint32_t srsOffset;
+        uint32_t srsLength;
+    };
+
+    struct NodeBox
+    {
+        double   xMin, yMin, xMax, yMax;
+        uint64_t index;
+    };
+
+    struct Record
+    {
+        double   xMin, yMin, xMax, yMax;
+        double   resolution;
+        double   noDataValue;
+        uint64_t nameOffset;
+        uint32_t nameLength;
+        uint32_t flags;     // bit 0: has nodata
+        uint64_t order;     // insertion order
+    };
+
+    enum { FLAG_HAS_NODATA = 1u };
+
+    static bool intersects(const NodeBox& a, double xMin, double yMin, double xMax, double yMax)
+    {
+        return a.xMin <= xMax && a.xMax >= xMin && a.yMin <= yMax && a.yMax >= yMin;
+    }
+
+    MemoryMappedFile _file;
+    std::vector<uint64_t> _buffer;
+
+    const FileHeader* _header;
+    const NodeBox* _nodes;
+    const Record* _records;
+    const char* _strings;
+
+    std::vector<uint64_t> _levelOffsets;
+    std::vector<uint64_t> _levelEnds;
+
+    Tree() : _header(0L), _nodes(0L), _records(0L), _strings(0L) { }
+
+    uint64_t size() const { return _header->numItems; }
+
+    std::string getSRS() const
+    {
+        return std::string(_strings + _header->srsOffset, _header->srsLength);
+    }
+
+    bool attach(const char* data, std::size_t size)
+    {
+        if (size < sizeof(FileHeader))
+            return false;
+
+        const FileHeader* header = reinterpret_cast<const FileHeader*>(data);
+        if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            header->version != VERSION ||
+            header->nodeSize != NODE_SIZE)
+        {
+            return false;
+        }
+
+        if (header->nodesOffset + header->numNodes * sizeof(NodeBox) > size ||
+            header->recordsOffset + header->numItems * sizeof(Record) > size ||
+            header->stringsOffset + header->stringsSize > size ||
+            (uint64_t)header->srsOffset + header->srsLength > header->stringsSize)
+        {
+            return false;
+        }
+
+        std::vector<uint64_t> counts;
+        getLevelCounts(header->numItems, counts);
+
+        uint64_t total = 0u;
+        for (unsigned i = 0; i < counts.size(); ++i)
+            total += counts[i];
+        if (header->numItems > 0u && total != header->numNodes)
+            return false;
+
+        // levels are stored root first, so each level starts after all the ones above it
+        _levelOffsets.resize(counts.size());
+        _levelEnds.resize(counts.size());
+        uint64_t offset = header->numNodes;
+        for (unsigned i = 0; i < counts.size(); ++i)
+        {
+            offset -= std::min(offset, counts[i]);
+            _levelOffsets[i] = offset;
+            _levelEnds[i] = offset + counts[i];
+        }
+
+        _header = header;
+        _nodes = reinterpret_cast<const NodeBox*>(data + header->nodesOffset);
+        _records = reinterpret_cast<const Record*>(data + header->recordsOffset);
+        _strings = data + header->stringsOffset;
+        return true;
+    }
+
+    //! Appends the record numbers of the files intersecting a box
+    void query(double xMin, double yMin, double xMax, double yMax, std::vector<uint64_t>& results) const
+    {
+        if (_header->numItems == 0u)
+            return;
+
+        std::vector< std::pair<uint64_t, unsigned> > stack;
+        stack.reserve(64);
+        unsigned top = _levelOffsets.size() - 1;
+        stack.push_back(std::make_pair(_levelOffsets[top], top));
+
+        while (!stack.empty())
+        {
+            uint64_t start = stack.back().first;
+            unsigned level = stack.back().second;
+            stack.pop_back();
+
+            uint64_t end = std::min(start + NODE_SIZE, _levelEnds[level]);
+            for (uint64_t pos = start; pos < end; ++pos)
+            {
+                const NodeBox& node = _nodes[pos];
+                if (!intersects(node, xMin, yMin, xMax, yMax))
+                    continue;
+
+                if (level == 0)
+                    results.push_back(node.index);
+                else
+                    stack.push_back(std::make_pair(node.index, level - 1));
+            }
+        }
+    }
+
+    void getEntry(uint64_t i, Entry& entry) const
+    {
+        const Record& r = _records[i];
+        entry.filename.assign(_strings + r.nameOffset, r.nameLength);
+        entry.xMin = r.xMin;
+        entry.yMin = r.yMin;
+        entry.xMax = r.xMax;
+        entry.yMax = r.yMax;
+        entry.resolution = r.resolution;
+        entry.noDataValue = r.noDataValue;
+        entry.hasNoData = (r.flags & FLAG_HAS_NODATA) != 0;
+    }
+
+    //! All entries, in insertion order
+    void getEntries(std::vector<Entry>& entries) const
+    {
+        uint64_t n = _header->numItems;
+        uint64_t base = entries.size();
+        entries.resize(base + n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            getEntry(i, entries[base + _records[i].order]);
+        }
+    }
+
+    //! Packs entries (in insertion order) into a new tree
+    static std::shared_ptr<const Tree> build(const std::vector<Entry>& entries, const std::string& srs)
+    {
+        uint64_t n = entries.size();
+
+        double xMin = DBL_MAX, yMin = DBL_MAX, xMax = -DBL_MAX, yMax = -DBL_MAX;
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            xMin = std::min(xMin, entries[i].xMin);
+            yMin = std::min(yMin, entries[i].yMin);
+            xMax = std::max(xMax, entries[i].xMax);
+            yMax = std::max(yMax, entries[i].yMax);
+        }
+
+        // sort along the Hilbert curve through the centers of the entries
+        double width = xMax > xMin ? xMax - xMin : 1.0;
+        double height = yMax > yMin ? yMax - yMin : 1.0;
+        std::vector< std::pair<uint64_t, uint64_t> > sorted(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            const Entry& e = entries[i];
+            uint32_t hx = (uint32_t)(65535.0 * (0.5*(e.xMin + e.xMax) - xMin) / width);
+            uint32_t hy = (uint32_t)(65535.0 * (0.5*(e.yMin + e.yMax) - yMin) / height);
+            sorted[i] = std::make_pair(hilbert(std::min(hx, 65535u), std::min(hy, 65535u)), i);
+        }
+        std::sort(sorted.begin(), sorted.end());
+
+        std::vector<uint64_t> counts;
+        getLevelCounts(n, counts);
+        uint64_t numNodes = 0u;
+        if (n > 0u)
+        {
+            for (unsigned i = 0; i < counts.size(); ++i)
+                numNodes += counts[i];
+        }
+
+        uint64_t stringsSize = srs.size();
+        for (uint64_t i = 0; i < n; ++i)
+            stringsSize += entries[i].filename.size();
+
+        FileHeader header;
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.nodeSize = NODE_SIZE;
+        header.numItems = n;
+        header.numNodes = numNodes;
+        header.nodesOffset = sizeof(FileHeader);
+        header.recordsOffset = header.nodesOffset + numNodes * sizeof(NodeBox);
+        header.stringsOffset = header.recordsOffset + n * sizeof(Record);
+        header.stringsSize = stringsSize;
+        header.srsOffset = 0u;
+        header.srsLength = srs.size();
+
+        std::shared_ptr<Tree> tree = std::make_shared<Tree>();
+        uint64_t totalSize = header.stringsOffset + stringsSize;
+        tree->_buffer.resize((totalSize + 7u) / 8u);
+        char* data = reinterpret_cast<char*>(tree->_buffer.data());
+
+        memcpy(data, &header, sizeof(FileHeader));
+        char* strings = data + header.stringsOffset;
+        memcpy(strings, srs.data(), srs.size());
+        uint64_t stringPos = srs.size();
+
+        Record* records = reinterpret_cast<Record*>(data + header.recordsOffset);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            const Entry& e = entries[sorted[i].second];
+            Record& r = records[i];
+            r.xMin = e.xMin;
+            r.yMin = e.yMin;
+            r.xMax = e.xMax;
+            r.yMax = e.yMax;
+            r.resolution = e.resolution;
+            r.noDataValue = e.noDataValue;
+            r.nameOffset = stringPos;
+            r.nameLength = e.filename.size();
+            r.flags = e.hasNoData ? FLAG_HAS_NODATA : 0u;
+            r.order = sorted[i].second;
+            memcpy(strings + stringPos, e.filename.data(), e.filename.size());
+            stringPos += e.filename.size();
+        }
+
+        if (!tree->attach(data, totalSize))
+            return nullptr;
+
+        // leaves, then each level above from the one below it
+        NodeBox* nodes = reinterpret_cast<NodeBox*>(data + header.nodesOffset);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            NodeBox& node = nodes[tree->_levelOffsets[0] + i];
+            node.xMin = records[i].xMin;
+            node.yMin = records[i].yMin;
+            node.xMax = records[i].xMax;
+            node.yMax = records[i].yMax;
+            node.index = i;
+        }
+
+        for (unsigned level = 1; n > 0u && level < counts.size(); ++level)
+        {
+            for (uint64_t j = 0; j < counts[level]; ++j)
+            {
+                NodeBox& node = nodes[tree->_levelOffsets[level] + j];
+                uint64_t start = tree->_levelOffsets[level - 1] + j * NODE_SIZE;
+                uint64_t end = std::min(start + NODE_SIZE, tree->_levelEnds[level - 1]);
+                node.xMin = DBL_MAX;
+                node.yMin = DBL_MAX;
+                node.xMax = -DBL_MAX;
+                node.yMax = -DBL_MAX;
+                node.index = start;
+                for (uint64_t c = start; c < end; ++c)
+                {
+                    node.xMin = std::min(node.xMin, nodes[c].xMin);
+                    node.yMin = std::min(node.yMin, nodes[c].yMin);
+                    node.xMax = std::max(node.xMax, nodes[c].xMax);
+                    node.yMax = std::max(node.yMax, nodes[c].yMax);
+                }
+            }
+        }
+
+        return tree;
+    }
+
+    //! Maps an index file
+    static std::shared_ptr<const Tree> map(const std::string& filename)
+    {
+        std::shared_ptr<Tree> tree = std::make_shared<Tree>();
+        if (!tree->_file.open(filename) || !tree->attach(tree->_file.data(), tree->_file.size()))
+            return nullptr;
+        return tree;
+    }
+
+    bool write(const std::string& filename) const
+    {
+        // Write a new file and move it into place, so that readers still
+        // mapping the old one are not pulled out from under.
+        std::string temp = filename + ".tmp";
+        {
+            std::ofstream out(temp.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+                return false;
+
+            const char* data = reinterpret_cast<const char*>(_header);
+            out.write(data, _header->stringsOffset + _header->stringsSize);
+            if (out.fail())
+                return false;
+        }
+
+        if (::rename(temp.c_str(), filename.c_str()) != 0)
+        {
+            ::remove(filename.c_str());
+            if (::rename(temp.c_str(), filename.c_str()) != 0)
+                return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * State of a native index: the packed tree plus the entries added since
+ * it was packed. Readers take a reference to the current snapshot and
+ * never block; writers publish a new one.
+ */
+struct TileIndex::Snapshot
+{
+    std::shared_ptr<const Tree> tree;
+    std::vector<Entry> pending;
+
+    uint64_t size() const { return (tree ? tree->size() : 0u) + pending.size(); }
+};
+
 TileIndex::TileIndex()
 {
 }
@@ -45,6 +453,24 @@ TileIndex::~TileIndex()
 
 }
 
+bool
+TileIndex::isNative(const std::string& filename)
+{
+    return osgDB::getLowerCaseFileExtension(filename) == "oeidx";
+}
+
+std::shared_ptr<const TileIndex::Snapshot>
+TileIndex::getSnapshot() const
+{
+    return std::atomic_load(&_snapshot);
+}
+
+void
+TileIndex::publish(std::shared_ptr<const Snapshot> snapshot)
+{
+    std::atomic_store(&_snapshot, snapshot);
+}
+
 TileIndex*
 TileIndex::load(const std::string& filename)
 {        
@@ -53,6 +479,25 @@ TileIndex::load(const std::string& filename)
         return 0;
     }
 
+    if (isNative(filename))
+    {
+        std::shared_ptr<const Tree> tree = Tree::map(filename);
+        if (!tree)
+        {
+            OE_WARN << LC << "Can't load " << filename << std::endl;
+            return 0;
+        }
+
+        std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+        snapshot->tree = tree;
+
+        TileIndex* index = new TileIndex();
+        index->_filename = filename;
+        index->_srs = SpatialReference::get(tree->getSRS());
+        index->publish(snapshot);
+        return index;
+    }
+
     //Load up an index file
     osg::ref_ptr<OGRFeatureSource> features = new OGRFeatureSource();
     features->setURL(filename);
@@ -68,12 +513,35 @@ TileIndex::load(const std::string& filename)
     TileIndex* index = new TileIndex();
     index->_features = features.get();
     index->_filename = filename;
+    if (features->getFeatureProfile())
+        index->_srs = features->getFeatureProfile()->getSRS();
     return index;
 }
 
 TileIndex*
 TileIndex::create( const std::string& filename, const osgEarth::SpatialReference* srs )
 {
+    if (isNative(filename))
+    {
+        if (!srs)
+            return 0;
+
+        std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+        snapshot->tree = Tree::build(std::vector<Entry>(), srs->getHorizInitString());
+
+        osg::ref_ptr<TileIndex> index = new TileIndex();
+        index->_filename = filename;
+        index->_srs = srs;
+        index->publish(snapshot);
+
+        if (!index->save())
+        {
+            OE_WARN << LC << "failed to create " << filename << std::endl;
+            return 0;
+        }
+        return index.release();
+    }
+
     // Make sure the registry is loaded since that is where the OGR/GDAL registration happens
     osgEarth::Registry::instance();
 
@@ -106,6 +574,19 @@ void
 TileIndex::getFiles(const osgEarth::GeoExtent& extent, std::vector< std::string >& files)
 {            
     files.clear();
+
+    std::shared_ptr<const Snapshot> snapshot = getSnapshot();
+    if (snapshot)
+    {
+        std::vector<Entry> entries;
+        getEntries(extent, entries);
+        for (unsigned i = 0; i < entries.size(); ++i)
+        {
+            files.push_back( entries[i].filename );
+        }
+        return;
+    }
+
     osgEarth::Query query;    
 
     GeoExtent transformed = extent.transform( _features->getFeatureProfile()->getSRS() );
@@ -123,8 +604,189 @@ TileIndex::getFiles(const osgEarth::GeoExtent& extent, std::vector< std::string
     }    
 }
 
+void
+TileIndex::getEntries(const osgEarth::GeoExtent& extent, std::vector< Entry >& entries)
+{
+    entries.clear();
+
+    std::shared_ptr<const Snapshot> snapshot = getSnapshot();
+    if (!snapshot)
+    {
+        // shapefile index: no metadata beyond the extent
+        osgEarth::Query query;
+        GeoExtent transformed = extent.transform( _features->getFeatureProfile()->getSRS() );
+        query.bounds() = transformed.bounds();
+        osg::ref_ptr< osgEarth::FeatureCursor> cursor = _features->createFeatureCursor( query, 0L );
+        while (cursor->hasMore())
+        {
+            osg::ref_ptr< osgEarth::Feature> feature = cursor->nextFeature();
+            if (feature.valid())
+            {
+                Entry entry;
+                entry.filename = getFullPath(_filename, feature->getString("location"));
+                const GeoExtent& fe = feature->getExtent();
+                entry.xMin = fe.xMin();
+                entry.yMin = fe.yMin();
+                entry.xMax = fe.xMax();
+                entry.yMax = fe.yMax();
+                entries.push_back( entry );
+            }
+        }
+        return;
+    }
+
+    GeoExtent transformed = extent.transform( _srs.get() );
+    if (!transformed.isValid())
+        return;
+
+    const Bounds& b = transformed.bounds();
+
+    // (insertion order, entry) so results come back in the order files were added
+    std::vector< std::pair<uint64_t, Entry> > found;
+
+    if (snapshot->tree)
+    {
+        std::vector<uint64_t> records;
+        snapshot->tree->query(b.xMin(), b.yMin(), b.xMax(), b.yMax(), records);
+        for (unsigned i = 0; i < records.size(); ++i)
+        {
+            found.push_back(std::make_pair(0u, Entry()));
+            snapshot->tree->getEntry(records[i], found.back().second);
+            found.back().first = snapshot->tree->_records[records[i]].order;
+        }
+    }
+
+    uint64_t base = snapshot->tree ? snapshot->tree->size() : 0u;
+    for (unsigned i = 0; i < snapshot->pending.size(); ++i)
+    {
+        const Entry& e = snapshot->pending[i];
+        if (e.xMin <= b.xMax() && e.xMax >= b.xMin() && e.yMin <= b.yMax() && e.yMax >= b.yMin())
+        {
+            found.push_back(std::make_pair(base + i, e));
+        }
+    }
+
+    std::sort(found.begin(), found.end(),
+        [](const std::pair<uint64_t, Entry>& lhs, const std::pair<uint64_t, Entry>& rhs) { return lhs.first < rhs.first; });
+
+    entries.reserve(found.size());
+    for (unsigned i = 0; i < found.size(); ++i)
+    {
+        entries.push_back( found[i].second );
+        entries.back().filename = getFullPath(_filename, entries.back().filename);
+    }
+}
+
+bool TileIndex::add( const Entry& entry )
+{
+    return addEntries(&entry, 1u);
+}
+
+bool TileIndex::add( const std::vector< Entry >& entries )
+{
+    return entries.empty() || addEntries(&entries[0], entries.size());
+}
+
+bool TileIndex::addEntries( const Entry* entries, unsigned count )
+{
+    if (!getSnapshot())
+    {
+        bool ok = true;
+        for (unsigned i = 0; i < count; ++i)
+        {
+            GeoExtent extent(_srs.get(), entries[i].xMin, entries[i].yMin, entries[i].xMax, entries[i].yMax);
+            ok = add(entries[i].filename, extent) && ok;
+        }
+        return ok;
+    }
+
+    Threading::ScopedMutexLock lock(_writeMutex);
+
+    std::shared_ptr<const Snapshot> current = getSnapshot();
+    std::shared_ptr<Snapshot> next = std::make_shared<Snapshot>();
+    next->tree = current->tree;
+
+    if (current->pending.size() + count < MAX_PENDING)
+    {
+        next->pending.reserve(current->pending.size() + count);
+        next->pending = current->pending;
+        next->pending.insert(next->pending.end(), entries, entries + count);
+    }
+    else
+    {
+        // repack everything into a new tree
+        std::vector<Entry> all;
+        all.reserve(current->size() + count);
+        if (current->tree)
+            current->tree->getEntries(all);
+        all.insert(all.end(), current->pending.begin(), current->pending.end());
+        all.insert(all.end(), entries, entries + count);
+
+        next->tree = Tree::build(all, _srs->getHorizInitString());
+        if (!next->tree)
+            return false;
+    }
+
+    publish(next);
+    return true;
+}
+
+bool TileIndex::save()
+{
+    if (!getSnapshot())
+        return true;
+
+    Threading::ScopedMutexLock lock(_writeMutex);
+
+    std::shared_ptr<const Snapshot> current = getSnapshot();
+    if (!current->pending.empty() || !current->tree)
+    {
+        std::vector<Entry> all;
+        all.reserve(current->size());
+        if (current->tree)
+            current->tree->getEntries(all);
+        all.insert(all.end(), current->pending.begin(), current->pending.end());
+
+        std::shared_ptr<Snapshot> next = std::make_shared<Snapshot>();
+        next->tree = Tree::build(all, _srs->getHorizInitString());
+        if (!next->tree)
+            return false;
+
+        publish(next);
+        current = next;
+    }
+
+    return current->tree->write(_filename);
+}
+
+unsigned TileIndex::getNumEntries() const
+{
+    std::shared_ptr<const Snapshot> snapshot = getSnapshot();
+    return snapshot ? snapshot->size() : 0u;
+}
+
+const SpatialReference* TileIndex::getSRS() const
+{
+    return _srs.get();
+}
+
 bool TileIndex::add( const std::string& filename, const GeoExtent& extent )
 {       
+    if (getSnapshot())
+    {
+        GeoExtent transformed = extent.transform(_srs.get());
+        if (!transformed.isValid())
+            return false;
+
+        Entry entry;
+        entry.filename = filename;
+        entry.xMin = transformed.xMin();
+        entry.yMin = transformed.yMin();
+        entry.xMax = transformed.xMax();
+        entry.yMax = transformed.yMax();
+        return add(entry);
+    }
+
     osg::ref_ptr< Polygon > polygon = new Polygon();
     polygon->push_back( osg::Vec3d(extent.bounds().xMin(), extent.bounds().yMin(), 0) );
     polygon->push_back( osg::Vec3d(extent.bounds().xMax(), extent.bounds().yMin(), 0) );
@@ -24,13 +24,72 @@
 #include <osgEarth/FileUtils>
 #include <osgEarth/Progress>
 #include <osgEarth/GDAL>
+#include <osgEarth/Registry>
+#include <osgEarth/Threading>
 #include <osgDB/FileUtils>
+#include <gdal.h>
+#include <atomic>
+#include <functional>
+#include <sstream>
+#include <thread>
 
 using namespace osgDB;
 using namespace osgEarth;
 using namespace osgEarth::Contrib;
 
-TileIndexBuilder::TileIndexBuilder()
+namespace
+{
+    // Reads the extent, resolution and nodata value of a raster. Each call
+    // opens its own dataset handle, so calls can run concurrently.
+    bool readEntry(const std::string& filename, const SpatialReference* srs, TileIndex::Entry& entry)
+    {
+        GDALDatasetH ds = GDALOpen(filename.c_str(), GA_ReadOnly);
+        if (!ds)
+            return false;
+
+        bool ok = false;
+        double geotransform[6];
+        int width = GDALGetRasterXSize(ds);
+        int height = GDALGetRasterYSize(ds);
+        const char* wkt = GDALGetProjectionRef(ds);
+
+        if (GDALGetGeoTransform(ds, geotransform) == CE_None &&
+            GDALGetRasterCount(ds) > 0 && width > 0 && height > 0 &&
+            wkt && *wkt)
+        {
+            osg::ref_ptr<const SpatialReference> source = SpatialReference::create(wkt);
+            if (source.valid())
+            {
+                double x0 = geotransform[0];
+                double y0 = geotransform[3];
+                double x1 = geotransform[0] + width * geotransform[1] + height * geotransform[2];
+                double y1 = geotransform[3] + width * geotransform[4] + height * geotransform[5];
+
+                GeoExtent extent(source.get(), osg::minimum(x0, x1), osg::minimum(y0, y1), osg::maximum(x0, x1), osg::maximum(y0, y1));
+                GeoExtent transformed = extent.transform(srs);
+                if (transformed.isValid())
+                {
+                    entry.xMin = transformed.xMin();
+                    entry.yMin = transformed.yMin();
+                    entry.xMax = transformed.xMax();
+                    entry.yMax = transformed.yMax();
+                    entry.resolution = osg::minimum(transformed.width() / (double)width, transformed.height() / (double)height);
+
+                    int hasNoData = 0;
+                    entry.noDataValue = GDALGetRasterNoDataValue(GDALGetRasterBand(ds, 1), &hasNoData);
+                    entry.hasNoData = hasNoData != 0;
+                    ok = true;
+                }
+            }
+        }
+
+        GDALClose(ds);
+        return ok;
+    }
+}
+
+TileIndexBuilder::TileIndexBuilder() :
+_numThreads(osg::maximum(1u, std::thread::hardware_concurrency()))
 {
 }
 
@@ -52,6 +111,15 @@ void TileIndexBuilder::build(const std::string& indexFilename, const SpatialRefe
 
     _indexFilename = indexFilename;
     std::string indexDir = getFilePath( _indexFilename );
+
+    if (TileIndex::isNative(indexFilename))
+    {
+        if (index.valid())
+        {
+            buildNative(index.get());
+        }
+        return;
+    }
     
     unsigned int total = _expandedFilenames.size();
 
@@ -96,6 +164,60 @@ void TileIndexBuilder::build(const std::string& indexFilename, const SpatialRefe
     osg::Timer_t end = osg::Timer::instance()->tick();    
 }
 
+void TileIndexBuilder::buildNative(TileIndex* index)
+{
+    // Registers the GDAL drivers
+    osgEarth::Registry::instance();
+
+    std::string indexDir = getFilePath( _indexFilename );
+    unsigned int total = _expandedFilenames.size();
+
+    std::vector< TileIndex::Entry > entries(total);
+    std::vector< char > ok(total, 0);
+    std::atomic<unsigned> processed(0u);
+    Threading::Mutex progressMutex;
+
+    // Read the files in the shared compute pool.
+    Threading::parallelFor(total, [&](unsigned i)
+    {
+        if (_progress.valid() && _progress->isCanceled())
+            return;
+
+        const std::string& filename = _expandedFilenames[i];
+        if (readEntry(filename, index->getSRS(), entries[i]))
+        {
+            // We want the filename as it is relative to the index file
+            entries[i].filename = getPathRelative(indexDir, filename);
+            ok[i] = 1;
+        }
+
+        unsigned count = ++processed;
+        if (_progress.valid())
+        {
+            std::stringstream buf;
+            buf << (ok[i] ? "Processed " : "Skipped ") << filename;
+            Threading::ScopedMutexLock lock(progressMutex);
+            _progress->reportProgress( (double)count, (double)total, buf.str() );
+        }
+    },
+    _numThreads);
+
+    // Add everything in input order in one pass, which packs the tree once.
+    std::vector< TileIndex::Entry > valid;
+    valid.reserve(total);
+    for (unsigned i = 0; i < total; ++i)
+    {
+        if (ok[i])
+            valid.push_back(entries[i]);
+    }
+
+    index->add(valid);
+    if (!index->save())
+    {
+        OE_WARN << "Failed to write " << _indexFilename << std::endl;
+    }
+}
+
 void TileIndexBuilder::expandFilenames()
 {
     // Expand the filenames since they might contain directories    
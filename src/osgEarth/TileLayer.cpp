@@ -304,6 +304,8 @@ TileLayer::init()
     _writingRequested = false;
     _profileMatchesMapProfile = true;
 
+    initTileMetrics();
+
     // If the user asked for a custom profile, install it now
     if (options().profile().isSet())
     {
@@ -382,9 +384,46 @@ TileLayer::openImplementation()
     if (_memCache.valid())
         _memCache->clear();
 
+    // the name may have changed since init
+    initTileMetrics();
+
     return getStatus();
 }
 
+void
+TileLayer::initTileMetrics()
+{
+    Util::MetricsRegistry& registry = Util::MetricsRegistry::instance();
+
+    Util::MetricsRegistry::Labels labels;
+    labels["layer"] = getName();
+
+    _tileLoadLatency = registry.histogram(
+        "oe_tile_load_seconds", "Time to create a tile from a layer's source", labels);
+
+    const char* results[3] = { "ok", "failed", "canceled" };
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        labels["result"] = results[i];
+        _tileLoads[i] = registry.counter(
+            "oe_tile_loads_total", "Tiles created from a layer's source, by result", labels);
+    }
+}
+
+void
+TileLayer::recordTileLoad(double seconds, bool succeeded, bool canceled)
+{
+    if (canceled)
+    {
+        _tileLoads[2]->increment();
+    }
+    else
+    {
+        _tileLoads[succeeded ? 0 : 1]->increment();
+        _tileLoadLatency->record(seconds);
+    }
+}
+
 
 const Status&
 TileLayer::openForWriting()
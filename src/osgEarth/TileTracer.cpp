@@ -0,0 +1,392 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+ * Copyright 2020 Pelican Mapping
+ * http://osgearth.org
+ *
+ * osgEarth is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+#include <osgEarth/TileTracer>
+#include <osgEarth/TileKey>
+#include <osgEarth/Threading>
+#include <osgEarth/Notify>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+using namespace osgEarth::Util;
+
+#define LC "[TileTracer] "
+
+namespace
+{
+    const unsigned NO_KEY = ~0u;
+
+    // minimum time between two slow-frame dumps (10s, in microseconds),
+    // so a long stall does not flood the disk
+    const std::uint64_t DUMP_INTERVAL = 10000000u;
+
+    const char* typeName(unsigned type)
+    {
+        static const char* names[] = {
+            "queued", "load", "fetch", "cache_hit", "cache_miss",
+            "decode", "merge", "unload", "frame" };
+        return type < sizeof(names)/sizeof(names[0]) ? names[type] : "unknown";
+    }
+
+    // OS thread ID of the calling thread, looked up once per thread
+    unsigned getThreadID()
+    {
+        static thread_local unsigned s_id = osgEarth::Threading::getCurrentThreadId();
+        return s_id;
+    }
+
+    void copyName(char* dest, std::size_t size, const std::string& name)
+    {
+        std::size_t len = std::min(name.size(), size - 1);
+        std::memcpy(dest, name.c_str(), len);
+        dest[len] = 0;
+    }
+
+    void writeEscaped(std::ostream& out, const char* s)
+    {
+        for (; *s; ++s)
+        {
+            if (*s == '"' || *s == '\\')
+                out << '\\' << *s;
+            else if ((unsigned char)*s < 0x20)
+                out << ' ';
+            else
+                out << *s;
+        }
+    }
+
+    // innermost active scope on this thread, for attributing keyless scopes
+    thread_local const TileTracer::Scope* s_currentScope = nullptr;
+}
+
+//........................................................................
+
+TileTracer::Scope::Scope(Type type, const TileKey& key, const std::string& layer) :
+    _type(type),
+    _active(TileTracer::instance().isEnabled()),
+    _start(0u),
+    _parent(nullptr)
+{
+    if (_active)
+    {
+        _start = TileTracer::now();
+        _lod = key.getLOD();
+        _x = key.getTileX();
+        _y = key.getTileY();
+        copyName(_layer, sizeof(_layer), layer);
+        _parent = s_currentScope;
+        s_currentScope = this;
+    }
+}
+
+TileTracer::Scope::Scope(Type type) :
+    _type(type),
+    _active(TileTracer::instance().isEnabled()),
+    _start(0u),
+    _parent(nullptr)
+{
+    if (_active)
+    {
+        _start = TileTracer::now();
+        _parent = s_currentScope;
+        if (_parent)
+        {
+            _lod = _parent->_lod, _x = _parent->_x, _y = _parent->_y;
+            std::memcpy(_layer, _parent->_layer, sizeof(_layer));
+        }
+        else
+        {
+            _lod = NO_KEY, _x = 0u, _y = 0u;
+            _layer[0] = 0;
+        }
+        s_currentScope = this;
+    }
+}
+
+TileTracer::Scope::~Scope()
+{
+    if (_active)
+    {
+        s_currentScope = _parent;
+
+        Event e;
+        e.start = _start;
+        e.duration = std::max(TileTracer::now() - _start, (std::uint64_t)1u);
+        e.thread = getThreadID();
+        e.type = (unsigned char)_type;
+        e.span = true;
+        e.lod = _lod, e.x = _x, e.y = _y;
+        std::memcpy(e.layer, _layer, sizeof(e.layer));
+        TileTracer::instance().write(e);
+    }
+}
+
+//........................................................................
+
+TileTracer&
+TileTracer::instance()
+{
+    // never destroyed, so threads may record during static destruction
+    static TileTracer* s_instance = new TileTracer();
+    return *s_instance;
+}
+
+TileTracer::TileTracer() :
+    _enabled(false),
+    _head(0u),
+    _slots(nullptr),
+    _slowFrameThreshold(0.0),
+    _dumpPrefix("osgearth-tiles"),
+    _lastFrameNumber(0u),
+    _lastFrameStart(0u),
+    _lastDump(0u)
+{
+    const char* slow = ::getenv("OSGEARTH_TILE_TRACE_SLOW_FRAME");
+    if (slow)
+    {
+        _slowFrameThreshold = std::max(::atof(slow), 0.0) * 0.001;
+    }
+
+    if (::getenv("OSGEARTH_TILE_TRACE"))
+    {
+        setEnabled(true);
+    }
+}
+
+TileTracer::~TileTracer()
+{
+    delete [] _slots;
+}
+
+std::uint64_t
+TileTracer::now()
+{
+    static const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - s_epoch).count();
+}
+
+void
+TileTracer::setEnabled(bool value)
+{
+    static std::mutex s_mutex;
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    // The buffer is allocated on first use and never released, so a writer
+    // that saw the recorder enabled can always finish its write.
+    if (value && _slots == nullptr)
+    {
+        _slots = new Slot[CAPACITY];
+        for (unsigned i = 0; i < CAPACITY; ++i)
+            _slots[i].sequence.store(0u, std::memory_order_relaxed);
+    }
+
+    _enabled.store(value, std::memory_order_release);
+}
+
+void
+TileTracer::record(Type type, const TileKey& key, const std::string& layer)
+{
+    if (!isEnabled())
+        return;
+
+    Event e;
+    e.start = now();
+    e.duration = 0u;
+    e.thread = getThreadID();
+    e.type = (unsigned char)type;
+    e.span = false;
+    e.lod = key.getLOD(), e.x = key.getTileX(), e.y = key.getTileY();
+    copyName(e.layer, sizeof(e.layer), layer);
+    write(e);
+}
+
+void
+TileTracer::write(const Event& event)
+{
+    // Each slot carries a sequence number: odd while its event is being
+    // written, 2(i+1) once it holds event i. Readers copy the event and
+    // keep it only if the sequence was the same before and after the copy.
+    std::uint64_t i = _head.fetch_add(1u, std::memory_order_relaxed);
+    Slot& slot = _slots[i & (CAPACITY - 1)];
+    slot.sequence.store(2u*i + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = event;
+    slot.sequence.store(2u*i + 2u, std::memory_order_release);
+}
+
+void
+TileTracer::collect(std::vector<Event>& output) const
+{
+    if (_slots == nullptr)
+        return;
+
+    std::uint64_t head = _head.load(std::memory_order_acquire);
+    std::uint64_t first = head > CAPACITY ? head - CAPACITY : 0u;
+
+    output.reserve(output.size() + (std::size_t)(head - first));
+
+    for (std::uint64_t i = first; i < head; ++i)
+    {
+        const Slot& slot = _slots[i & (CAPACITY - 1)];
+        std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2u*i + 2u)
+            continue; // still being written, overwritten, or cleared
+
+        Event e = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before)
+            output.push_back(e);
+    }
+
+    // spans are written when they end, so restore start order,
+    // with enclosing spans ahead of the ones they contain
+    std::stable_sort(output.begin(), output.end(),
+        [](const Event& a, const Event& b) {
+            return a.start < b.start || (a.start == b.start && a.duration > b.duration); });
+}
+
+void
+TileTracer::clear()
+{
+    if (_slots == nullptr)
+        return;
+
+    for (unsigned i = 0; i < CAPACITY; ++i)
+        _slots[i].sequence.store(0u, std::memory_order_relaxed);
+}
+
+void
+TileTracer::writeChromeTrace(std::ostream& out) const
+{
+    std::vector<Event> events;
+    collect(events);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (std::size_t i = 0; i < events.size(); ++i)
+    {
+        const Event& e = events[i];
+        const char* name = typeName(e.type);
+
+        out << (i > 0 ? ",\n" : "\n") << "{\"name\":\"" << name;
+        if (e.type == FRAME)
+            out << " " << e.lod;
+        else if (e.lod != NO_KEY)
+            out << " " << e.lod << "/" << e.x << "/" << e.y;
+
+        out << "\",\"cat\":\"" << (e.type == FRAME ? "frame" : "tile") << "\"";
+
+        if (e.span)
+            out << ",\"ph\":\"X\",\"ts\":" << e.start << ",\"dur\":" << e.duration;
+        else
+            out << ",\"ph\":\"i\",\"s\":\"t\",\"ts\":" << e.start;
+
+        out << ",\"pid\":1,\"tid\":" << e.thread << ",\"args\":{";
+
+        if (e.type == FRAME)
+        {
+            out << "\"frame\":" << e.lod;
+        }
+        else if (e.lod != NO_KEY)
+        {
+            out << "\"key\":\"" << e.lod << "/" << e.x << "/" << e.y << "\"";
+            if (e.layer[0])
+            {
+                out << ",\"layer\":\"";
+                writeEscaped(out, e.layer);
+                out << "\"";
+            }
+        }
+        out << "}}";
+    }
+
+    out << "\n]}\n";
+}
+
+bool
+TileTracer::writeChromeTrace(const std::string& filename) const
+{
+    std::ofstream out(filename.c_str());
+    if (!out.is_open())
+        return false;
+
+    writeChromeTrace(out);
+    return out.good();
+}
+
+std::string
+TileTracer::toChromeTrace() const
+{
+    std::ostringstream buf;
+    writeChromeTrace(buf);
+    return buf.str();
+}
+
+void
+TileTracer::frame(unsigned frameNumber)
+{
+    if (!isEnabled())
+        return;
+
+    if (_lastFrameStart > 0u && frameNumber == _lastFrameNumber)
+        return;
+
+    std::uint64_t t = now();
+
+    if (_lastFrameStart > 0u)
+    {
+        Event e;
+        e.start = _lastFrameStart;
+        e.duration = std::max(t - _lastFrameStart, (std::uint64_t)1u);
+        e.thread = getThreadID();
+        e.type = (unsigned char)FRAME;
+        e.span = true;
+        e.lod = _lastFrameNumber, e.x = 0u, e.y = 0u;
+        e.layer[0] = 0;
+        write(e);
+
+        if (_slowFrameThreshold > 0.0 &&
+            (double)e.duration > _slowFrameThreshold * 1e6 &&
+            (_lastDump == 0u || t - _lastDump > DUMP_INTERVAL))
+        {
+            std::stringstream filename;
+            filename << _dumpPrefix << "-" << _lastFrameNumber << ".json";
+
+            if (writeChromeTrace(filename.str()))
+            {
+                OE_WARN << LC << "Frame " << _lastFrameNumber << " took "
+                    << (double)e.duration * 0.001 << " ms; wrote tile trace to "
+                    << filename.str() << std::endl;
+            }
+            else
+            {
+                OE_WARN << LC << "Failed to write tile trace to " << filename.str() << std::endl;
+            }
+            _lastDump = t;
+        }
+    }
+
+    _lastFrameNumber = frameNumber;
+    _lastFrameStart = std::max(t, (std::uint64_t)1u);
+}
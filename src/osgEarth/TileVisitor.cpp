@@ -20,6 +20,8 @@
 #include <osgEarth/CacheEstimator>
 #include <osgEarth/FileUtils>
 #include <thread>
+#include <algorithm>
+#include <cstdlib>
 
 #if OSG_VERSION_GREATER_OR_EQUAL(3,5,10)
 #include <osg/os_utils>
@@ -32,6 +34,7 @@ using namespace osgEarth;
 using namespace osgEarth::Util;
 
 TileVisitor::TileVisitor():
+_tileOrder(ORDER_QUADTREE),
 _total(0),
 _processed(0),
 _minLevel(0),
@@ -41,6 +44,7 @@ _maxLevel(99)
 
 
 TileVisitor::TileVisitor(TileHandler* handler):
+_tileOrder(ORDER_QUADTREE),
 _tileHandler( handler ),
 _total(0),
 _processed(0),
@@ -100,10 +104,102 @@ void TileVisitor::run( const Profile* mapProfile )
     std::vector<TileKey> keys;
     mapProfile->getRootKeys(keys);
 
+    if (_tileOrder == ORDER_QUADTREE)
+    {
+        for (unsigned int i = 0; i < keys.size(); ++i)
+        {
+            processKey( keys[i] );
+        }
+    }
+    else
+    {
+        // One level at a time, stopping at the first level with nothing to do.
+        for (unsigned int level = _minLevel; level <= _maxLevel; ++level)
+        {
+            unsigned int count = 0;
+            for (unsigned int i = 0; i < keys.size(); ++i)
+            {
+                count += processLevel( keys[i], level );
+            }
+
+            if (count == 0)
+                break;
+        }
+    }
+}
+
+unsigned long long TileVisitor::getCurveIndex(const TileKey& key, TileOrder order)
+{
+    // Position of the key's root tile, then its position within that root.
+    unsigned int lod = key.getLevelOfDetail();
+    unsigned int x = key.getTileX(), y = key.getTileY();
+    unsigned int mask = (1u << lod) - 1u;
+
+    unsigned int rootCols = 1, rootRows = 1;
+    if (key.getProfile())
+        key.getProfile()->getNumTiles(0, rootCols, rootRows);
+
+    unsigned long long root = (unsigned long long)(y >> lod) * rootCols + (x >> lod);
+    x &= mask;
+    y &= mask;
+
+    unsigned long long d = 0ull;
+
+    if (order == ORDER_HILBERT)
+    {
+        unsigned int n = 1u << lod;
+        for (unsigned int s = n/2; s > 0; s /= 2)
+        {
+            unsigned int rx = (x & s) > 0 ? 1u : 0u;
+            unsigned int ry = (y & s) > 0 ? 1u : 0u;
+            d += (unsigned long long)s * s * ((3u * rx) ^ ry);
+
+            // rotate the quadrant
+            if (ry == 0)
+            {
+                if (rx == 1)
+                {
+                    x = n-1 - x;
+                    y = n-1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+    }
+    else
+    {
+        // interleave the bits, x first (Morton/Z-order)
+        for (unsigned int b = 0; b < lod; ++b)
+        {
+            d |= (unsigned long long)((x >> b) & 1u) << (2*b);
+            d |= (unsigned long long)((y >> b) & 1u) << (2*b + 1);
+        }
+    }
+
+    return (root << (2*lod)) + d;
+}
+
+void TileVisitor::sortKeys(std::vector<TileKey>& keys, TileOrder order)
+{
+    if (order == ORDER_QUADTREE)
+        return;
+
+    std::vector< std::pair<std::pair<unsigned int, unsigned long long>, unsigned int> > index;
+    index.reserve(keys.size());
     for (unsigned int i = 0; i < keys.size(); ++i)
     {
-        processKey( keys[i] );
+        index.push_back(std::make_pair(std::make_pair(keys[i].getLevelOfDetail(), getCurveIndex(keys[i], order)), i));
+    }
+
+    std::sort(index.begin(), index.end());
+
+    std::vector<TileKey> sorted;
+    sorted.reserve(keys.size());
+    for (unsigned int i = 0; i < index.size(); ++i)
+    {
+        sorted.push_back(keys[index[i].second]);
     }
+    keys.swap(sorted);
 }
 
 void TileVisitor::estimate()
@@ -166,6 +262,52 @@ void TileVisitor::processKey( const TileKey& key )
     }       
 }
 
+unsigned TileVisitor::processLevel( const TileKey& key, unsigned level )
+{
+    if (_progress && _progress->isCanceled())
+    {
+        return 0;
+    }
+
+    if (_tileHandler && !_tileHandler->hasData(key))
+    {
+        return 0;
+    }
+
+    if (!intersects( key.getExtent() ))
+    {
+        return 0;
+    }
+
+    if (key.getLevelOfDetail() == level)
+    {
+        handleTile( key );
+        return 1;
+    }
+
+    // Visiting the children in curve order, depth first, emits the keys
+    // of the target level in curve order.
+    TileKey children[4];
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        children[i] = key.createChildKey(i);
+    }
+
+    if (_tileOrder == ORDER_HILBERT)
+    {
+        std::sort(children, children+4, [](const TileKey& lhs, const TileKey& rhs) {
+            return getCurveIndex(lhs, ORDER_HILBERT) < getCurveIndex(rhs, ORDER_HILBERT);
+        });
+    }
+
+    unsigned count = 0;
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        count += processLevel( children[i], level );
+    }
+    return count;
+}
+
 void TileVisitor::incrementProgress(unsigned int amount)
 {
     {
@@ -199,44 +341,73 @@ bool TileVisitor::handleTile( const TileKey& key )
 
 /*****************************************************************************************/
 
-namespace
+/**
+ * Runs a batch of keys through the TileHandler in a background thread
+ * and records the worker's locality statistics.
+ */
+struct MultithreadedTileVisitor::BatchTask : public osg::Operation
 {
-    /**
-     * A TaskRequest that runs a TileHandler in a background thread.
-     */
-    class HandleTileTask : public osg::Operation
+    BatchTask(MultithreadedTileVisitor* visitor, const std::vector<TileKey>& keys, ProgressCallback* progress) :
+        _visitor(visitor),
+        _keys(keys),
+        _progress(progress)
     {
-    public:
-        HandleTileTask(TileHandler* handler, TileVisitor* visitor, const TileKey& key, ProgressCallback* progress) :
-            _handler(handler),
-            _visitor(visitor),
-            _key(key),
-            _progress(progress)
-        {
+        //nop
+    }
 
-        }
+    virtual void operator()(osg::Object*)
+    {
+        unsigned int handled = 0;
 
-        virtual void operator()(osg::Object*)
+        for (unsigned int i = 0; i < _keys.size(); ++i)
         {
             if (_progress.valid() && _progress->isCanceled())
-                return;
+                break;
 
-            if (_handler.valid())
+            if (_visitor->_tileHandler.valid())
             {
-                _handler->handleTile(_key, *_visitor.get());
+                _visitor->_tileHandler->handleTile(_keys[i], *_visitor.get());
                 _visitor->incrementProgress(1);
             }
+            ++handled;
         }
 
-        osg::ref_ptr<TileHandler> _handler;
-        TileKey _key;
-        osg::ref_ptr<TileVisitor> _visitor;
-        osg::ref_ptr<ProgressCallback> _progress;
-    };
-}
+        {
+            Threading::ScopedMutexLock lock(_visitor->_workersMutex);
+            Worker& worker = _visitor->_workers[std::this_thread::get_id()];
+            worker.stats.numBatches++;
+
+            for (unsigned int i = 0; i < handled; ++i)
+            {
+                const TileKey& key = _keys[i];
+                const TileKey& last = worker.lastKey;
+                if (last.valid() && last.getLevelOfDetail() == key.getLevelOfDetail())
+                {
+                    int dx = std::abs((int)key.getTileX() - (int)last.getTileX());
+                    int dy = std::abs((int)key.getTileY() - (int)last.getTileY());
+                    int distance = osg::maximum(dx, dy);
+                    worker.stats.numSteps++;
+                    worker.stats.totalDistance += (double)distance;
+                    if (distance <= 1)
+                        worker.stats.numAdjacent++;
+                }
+                worker.lastKey = key;
+                worker.stats.numTiles++;
+            }
+        }
+
+        --_visitor->_pending;
+    }
+
+    osg::ref_ptr<MultithreadedTileVisitor> _visitor;
+    std::vector<TileKey> _keys;
+    osg::ref_ptr<ProgressCallback> _progress;
+};
 
 MultithreadedTileVisitor::MultithreadedTileVisitor():
-_numThreads( OpenThreads::GetNumberOfProcessors() )
+_numThreads( OpenThreads::GetNumberOfProcessors() ),
+_batchSize( 16u ),
+_pending( 0u )
 {
     // We must do this to avoid an error message in OpenSceneGraph b/c the findWrapper method doesn't appear to be threadsafe.
     // This really isn't a big deal b/c this only effects data that is already cached.
@@ -245,7 +416,9 @@ _numThreads( OpenThreads::GetNumberOfProcessors() )
 
 MultithreadedTileVisitor::MultithreadedTileVisitor( TileHandler* handler ):
 TileVisitor( handler ),
-    _numThreads( OpenThreads::GetNumberOfProcessors() )
+    _numThreads( OpenThreads::GetNumberOfProcessors() ),
+    _batchSize( 16u ),
+    _pending( 0u )
 {
 }
 
@@ -259,6 +432,27 @@ void MultithreadedTileVisitor::setNumThreads( unsigned int numThreads)
     _numThreads = numThreads; 
 }
 
+unsigned int MultithreadedTileVisitor::getBatchSize() const
+{
+    return _batchSize;
+}
+
+void MultithreadedTileVisitor::setBatchSize( unsigned int batchSize )
+{
+    _batchSize = osg::maximum(1u, batchSize);
+}
+
+std::vector<MultithreadedTileVisitor::WorkerStats> MultithreadedTileVisitor::getWorkerStats() const
+{
+    Threading::ScopedMutexLock lock(_workersMutex);
+    std::vector<WorkerStats> result;
+    for (std::map<std::thread::id, Worker>::const_iterator i = _workers.begin(); i != _workers.end(); ++i)
+    {
+        result.push_back(i->second.stats);
+    }
+    return result;
+}
+
 void MultithreadedTileVisitor::run(const Profile* mapProfile)
 {                   
     // Start up the task service
@@ -266,25 +460,45 @@ void MultithreadedTileVisitor::run(const Profile* mapProfile)
 
     _threadPool = new ThreadPool("osgEarth.TileVisitor", _numThreads);
 
+    {
+        Threading::ScopedMutexLock lock(_workersMutex);
+        _workers.clear();
+    }
+
     // Produce the tiles
     TileVisitor::run( mapProfile );
+    flushBatch();
 
     OE_INFO << _threadPool->getNumOperationsInQueue() << " tasks in the queue." << std::endl;
 
-    // Wait for everything to finish, checking for cancellation while we wait so we can kill all the existing tasks.
-    while(_threadPool->getNumOperationsInQueue() > 0)
+    // Wait for everything (including tasks already running) to finish.
+    while(_pending > 0u)
     {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 }
 
 bool MultithreadedTileVisitor::handleTile(const TileKey& key)
 {    
-    // Add the tile to the task queue.
-    _threadPool->run(new HandleTileTask(_tileHandler.get(), this, key, getProgressCallback()));
+    // Add the tile to the current batch; full batches go to the task queue.
+    _batch.push_back(key);
+    if (_batch.size() >= _batchSize)
+    {
+        flushBatch();
+    }
     return true;
 }
 
+void MultithreadedTileVisitor::flushBatch()
+{
+    if (_batch.empty())
+        return;
+
+    ++_pending;
+    _threadPool->run(new BatchTask(this, _batch, getProgressCallback()));
+    _batch.clear();
+}
+
 /*****************************************************************************************/
 
 TaskList::TaskList(const Profile* profile):
@@ -334,3 +548,8 @@ const TileKeyList& TaskList::getKeys() const
 {
     return _keys;
 }
+
+void TaskList::sort(TileVisitor::TileOrder order)
+{
+    TileVisitor::sortKeys(_keys, order);
+}
@@ -90,6 +90,10 @@ TiledFeatureModelGraph::createNode(const TileKey& key, ProgressCallback* progres
         FeatureList features;
         cursor->fill(features);
 
+        // a canceled cursor stops early, so the list may be incomplete
+        if (progress && progress->isCanceled())
+            return nullptr;
+
         if (_styleSheet->getSelectors().size() > 0)
         {
             osg::Group* group = new osg::Group;
@@ -132,8 +132,11 @@ _instream( 0L )
         HTTPResponse res = HTTPClient::get( uri.full() );
         if ( res.isOK() )
         {
-            std::string buf = res.getPartAsString(0);
-            _instream = new std::istringstream(buf);
+            // read the response body in place rather than copying it
+            if (res.getNumParts() > 0)
+                _instream = new Util::ByteBufferStream(res.getParts()[0]->_buffer.get());
+            else
+                _instream = new std::istringstream();
         }
     }
     else
@@ -642,6 +645,7 @@ namespace
                             expired = cp->isExpired(result.lastModifiedTime());
                             result.setIsFromCache(true);
                         }
+                        bin->recordRead( result.succeeded() && !expired );
                     }
 
                     // If it's not cached, or it is cached but is expired then try to hit the server.
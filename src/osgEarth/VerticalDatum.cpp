@@ -152,23 +152,77 @@ VerticalDatum::transform(const VerticalDatum* from,
         ystep = (ne.y()-sw.y()) / double(rows-1);
     }
 
-    for( unsigned c=0; c<cols; ++c)
+    // Sample the geoids once for the whole grid, then apply the offsets
+    // to every valid post in one pass.
+    std::vector<float> fromOffsets, toOffsets;
+    if ( from )
+        from->getGeoidHeights(sw.y(), sw.x(), ystep, xstep, cols, rows, fromOffsets);
+    if ( to )
+        to->getGeoidHeights(sw.y(), sw.x(), ystep, xstep, cols, rows, toOffsets);
+
+    Units fromUnits = from ? from->getUnits() : Units::METERS;
+    Units toUnits = to ? to->getUnits() : Units::METERS;
+    double scale = fromUnits.convertTo(toUnits, 1.0);
+
+    osg::HeightField::HeightList& heights = hf->getHeightList();
+    for( unsigned i=0; i<cols*rows; ++i )
     {
-        double lon = sw.x() + xstep*double(c);
-        for( unsigned r=0; r<rows; ++r)
+        if ( heights[i] != NO_DATA_VALUE )
         {
-            double lat = sw.y() + ystep*double(r);
-            float& h = hf->getHeight(c, r);
-            if (h != NO_DATA_VALUE)
-            {
-                VerticalDatum::transform( from, to, lat, lon, h );
-            }
+            double z = heights[i];
+            if ( from ) z += fromOffsets[i];
+            z *= scale;
+            if ( to ) z -= toOffsets[i];
+            heights[i] = float(z);
         }
     }
 
     return true;
 }
 
+bool
+VerticalDatum::transform(const VerticalDatum*     from,
+                         const VerticalDatum*     to,
+                         std::vector<osg::Vec3d>& points)
+{
+    return transform(from, to, points, points);
+}
+
+bool
+VerticalDatum::transform(const VerticalDatum*           from,
+                         const VerticalDatum*           to,
+                         const std::vector<osg::Vec3d>& lonLat,
+                         std::vector<osg::Vec3d>&       points)
+{
+    if ( from == to )
+        return true;
+
+    if ( lonLat.size() != points.size() )
+        return false;
+
+    // query the geoids before touching the points, since the arrays may alias
+    std::vector<float> fromOffsets, toOffsets;
+    if ( from )
+        from->getGeoidHeights(lonLat, fromOffsets);
+    if ( to )
+        to->getGeoidHeights(lonLat, toOffsets);
+
+    Units fromUnits = from ? from->getUnits() : Units::METERS;
+    Units toUnits = to ? to->getUnits() : Units::METERS;
+    double scale = fromUnits.convertTo(toUnits, 1.0);
+
+    for( unsigned i=0; i<points.size(); ++i )
+    {
+        double z = points[i].z();
+        if ( from ) z += fromOffsets[i];
+        z *= scale;
+        if ( to ) z -= toOffsets[i];
+        points[i].z() = z;
+    }
+
+    return true;
+}
+
 double 
 VerticalDatum::msl2hae( double lat_deg, double lon_deg, double msl ) const
 {
@@ -181,6 +235,31 @@ VerticalDatum::hae2msl( double lat_deg, double lon_deg, double hae ) const
     return _geoid.valid() ? hae - _geoid->getHeight(lat_deg, lon_deg, INTERP_BILINEAR) : hae;
 }
 
+void
+VerticalDatum::getGeoidHeights(const std::vector<osg::Vec3d>& lonLat,
+                               std::vector<float>&            out_heights) const
+{
+    if ( _geoid.valid() )
+        _geoid->getHeights(lonLat, out_heights);
+    else
+        out_heights.assign(lonLat.size(), 0.0f);
+}
+
+void
+VerticalDatum::getGeoidHeights(double              south,
+                               double              west,
+                               double              latInterval,
+                               double              lonInterval,
+                               unsigned            cols,
+                               unsigned            rows,
+                               std::vector<float>& out_heights) const
+{
+    if ( _geoid.valid() )
+        _geoid->getHeights(south, west, latInterval, lonInterval, cols, rows, out_heights);
+    else
+        out_heights.assign(cols*rows, 0.0f);
+}
+
 bool 
 VerticalDatum::isEquivalentTo( const VerticalDatum* rhs ) const
 {
@@ -0,0 +1,496 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+ * Copyright 2020 Pelican Mapping
+ * http://osgearth.org
+ *
+ * osgEarth is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+#include <osgEarth/Viewshed>
+#include <osgEarth/ElevationPool>
+#include <osgEarth/FeatureCursor>
+#include <osgEarth/Map>
+#include <osgEarth/Progress>
+#include <osgEarth/StringUtils>
+#include <osgEarth/Metrics>
+#include <atomic>
+#include <cfloat>
+#include <iomanip>
+#include <map>
+#include <thread>
+
+#define LC "[Viewshed] "
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+namespace
+{
+    // mean radius of the earth, used for the curvature correction
+    const double EARTH_RADIUS = 6371008.8;
+}
+
+//........................................................................
+
+Viewshed::Viewshed() :
+    _observerHeight(2.0),
+    _targetHeight(0.0),
+    _radius(10.0, Units::KILOMETERS),
+    _gridSize(513u),
+    _curvature(true),
+    _refraction(0.13),
+    _numThreads(osg::maximum(1u, std::thread::hardware_concurrency())),
+    _size(0u),
+    _cellSize(0.0),
+    _numVisible(0u)
+{
+    //nop
+}
+
+const SpatialReference*
+Viewshed::createSRS(const GeoPoint& observer)
+{
+    if (!observer.isValid())
+        return nullptr;
+
+    GeoPoint geo = observer.transform(observer.getSRS()->getGeographicSRS());
+    if (!geo.isValid())
+        return nullptr;
+
+    return SpatialReference::create(Stringify()
+        << std::setprecision(12)
+        << "+proj=aeqd +lat_0=" << geo.y() << " +lon_0=" << geo.x()
+        << " +datum=WGS84 +units=m +no_defs");
+}
+
+bool
+Viewshed::run(const Map* map, ProgressCallback* progress)
+{
+    OE_PROFILING_ZONE;
+
+    if (!map || !map->getElevationPool())
+        return false;
+
+    _srs = createSRS(_observer);
+    if (!_srs.valid())
+    {
+        OE_WARN << LC << "Unable to place the observer" << std::endl;
+        return false;
+    }
+
+    _size = osg::maximum(3u, _gridSize | 1u);
+    unsigned half = _size / 2u;
+    _cellSize = _radius.as(Units::METERS) / (double)half;
+    _heights.assign(_size*_size, 0.0f);
+
+    ElevationPool* pool = map->getElevationPool();
+    const SpatialReference* mapSRS = map->getSRS();
+    Distance resolution(_cellSize, Units::METERS);
+
+    // Sample in bands of rows, each with its own working set so the
+    // bands do not contend for the same tile cache.
+    const unsigned rowsPerBand = osg::maximum(1u, _size / (4u * osg::maximum(1u, _numThreads)));
+    const unsigned numBands = (_size + rowsPerBand - 1u) / rowsPerBand;
+    std::atomic<bool> failed(false);
+
+    Threading::parallelFor(numBands, [&](unsigned band)
+    {
+        if (failed || (progress && progress->isCanceled()))
+        {
+            failed = true;
+            return;
+        }
+
+        unsigned rowStart = band * rowsPerBand;
+        unsigned rowEnd = osg::minimum(rowStart + rowsPerBand, _size);
+
+        std::vector<osg::Vec3d> points;
+        points.reserve((rowEnd - rowStart) * _size);
+        for (unsigned r = rowStart; r < rowEnd; ++r)
+        {
+            double y = ((double)r - (double)half) * _cellSize;
+            for (unsigned c = 0; c < _size; ++c)
+            {
+                points.push_back(osg::Vec3d(((double)c - (double)half) * _cellSize, y, 0.0));
+            }
+        }
+
+        ElevationPool::WorkingSet ws;
+        if (!_srs->transform(points, mapSRS) ||
+            pool->sampleMapCoords(points, resolution, &ws, progress) < 0)
+        {
+            failed = true;
+            return;
+        }
+
+        float* out = &_heights[rowStart * _size];
+        for (unsigned i = 0; i < points.size(); ++i)
+        {
+            out[i] = points[i].z() == NO_DATA_VALUE ? 0.0f : (float)points[i].z();
+        }
+    },
+    _numThreads);
+
+    if (failed)
+        return false;
+
+    return compute();
+}
+
+bool
+Viewshed::run(const std::vector<float>& heights, unsigned size, double cellSize)
+{
+    OE_PROFILING_ZONE;
+
+    if (size < 3u || (size & 1u) == 0u || heights.size() != size*size || cellSize <= 0.0)
+        return false;
+
+    _srs = nullptr;
+    _size = size;
+    _cellSize = cellSize;
+    _heights = heights;
+
+    return compute();
+}
+
+bool
+Viewshed::compute()
+{
+    unsigned half = _size / 2u;
+    _visibility.assign(_size*_size, (unsigned char)OUT_OF_RANGE);
+    _visibility[half*_size + half] = VISIBLE;
+
+    double eye = (double)_heights[half*_size + half] + _observerHeight;
+
+    // Lowering of the terrain per squared cell of distance from the observer
+    double drop = _curvature ?
+        (1.0 - _refraction) * _cellSize * _cellSize / (2.0 * EARTH_RADIUS) :
+        0.0;
+
+    Threading::parallelFor(8u, [&](unsigned octant)
+    {
+        sweep(octant, eye, drop);
+    },
+    _numThreads);
+
+    _numVisible = 0u;
+    for (unsigned i = 0; i < _visibility.size(); ++i)
+    {
+        if (_visibility[i] == VISIBLE)
+            ++_numVisible;
+    }
+
+    return true;
+}
+
+void
+Viewshed::sweep(unsigned octant, double eye, double drop)
+{
+    // Each octant is walked in local coordinates (u, v) with u >= 1 the
+    // ring index and 0 <= v <= u. The bits of the octant index flip the
+    // signs of the axes and swap them.
+    const int sx = (octant & 1u) ? -1 : 1;
+    const int sy = (octant & 2u) ? -1 : 1;
+    const bool swap = (octant & 4u) != 0u;
+
+    // Cells on an octant boundary are computed by both neighbors (with the
+    // same result), but only one of them writes it.
+    const bool ownsAxis = swap ? (sx > 0) : (sy > 0);
+    const bool ownsDiagonal = !swap;
+
+    const int half = (int)(_size / 2u);
+    const int center = half;
+    const long long range2 = (long long)half * (long long)half;
+
+    // line of sight heights of the previous and current rings
+    std::vector<double> prev(half + 1), curr(half + 1);
+
+    for (int u = 1; u <= half; ++u)
+    {
+        for (int v = 0; v <= u; ++v)
+        {
+            int x = swap ? center + sx * v : center + sx * u;
+            int y = swap ? center + sy * u : center + sy * v;
+            unsigned index = (unsigned)y * _size + (unsigned)x;
+
+            long long d2 = (long long)u * u + (long long)v * v;
+            double z = (double)_heights[index] - drop * (double)d2;
+
+            // Height the cell must reach to be seen: the sight line through
+            // the previous ring, extended out to this ring.
+            double required = -DBL_MAX;
+            if (u > 1)
+            {
+                double vp = (double)v * (double)(u - 1) / (double)u;
+                int v0 = (int)vp;
+                double t = vp - (double)v0;
+                double h = v0 >= u - 1 ? prev[u - 1] : prev[v0] * (1.0 - t) + prev[v0 + 1] * t;
+                required = eye + (h - eye) * (double)u / (double)(u - 1);
+            }
+
+            curr[v] = osg::maximum(z, required);
+
+            if ((v > 0 || ownsAxis) && (v < u || ownsDiagonal))
+            {
+                _visibility[index] =
+                    d2 > range2 ? OUT_OF_RANGE :
+                    z + _targetHeight >= required ? VISIBLE :
+                    HIDDEN;
+            }
+        }
+        prev.swap(curr);
+    }
+}
+
+GeoExtent
+Viewshed::getExtent() const
+{
+    if (!_srs.valid() || _size == 0u)
+        return GeoExtent::INVALID;
+
+    double h = ((double)(_size / 2u) + 0.5) * _cellSize;
+    return GeoExtent(_srs.get(), -h, -h, h, h);
+}
+
+GeoImage
+Viewshed::createImage(const osg::Vec4f& visibleColor, const osg::Vec4f& hiddenColor) const
+{
+    if (_visibility.empty() || !_srs.valid())
+        return GeoImage::INVALID;
+
+    unsigned char colors[3][4];
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        colors[OUT_OF_RANGE][i] = 0;
+        colors[HIDDEN][i] = (unsigned char)(osg::clampBetween(hiddenColor[i], 0.0f, 1.0f) * 255.0f);
+        colors[VISIBLE][i] = (unsigned char)(osg::clampBetween(visibleColor[i], 0.0f, 1.0f) * 255.0f);
+    }
+
+    osg::ref_ptr<osg::Image> image = new osg::Image();
+    image->allocateImage(_size, _size, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+
+    unsigned char* ptr = image->data();
+    for (unsigned i = 0; i < _visibility.size(); ++i, ptr += 4)
+    {
+        const unsigned char* color = colors[_visibility[i]];
+        ptr[0] = color[0], ptr[1] = color[1], ptr[2] = color[2], ptr[3] = color[3];
+    }
+
+    return GeoImage(image.get(), getExtent());
+}
+
+void
+Viewshed::createFeatures(FeatureList& output) const
+{
+    if (_visibility.empty() || !_srs.valid())
+        return;
+
+    // Merge runs of visible cells in each row, then merge runs that span
+    // the same columns in consecutive rows.
+    struct Rect { unsigned c0, c1, r0, r1; };
+    std::vector<Rect> rects;
+    std::map<unsigned, unsigned> prevRow, currRow; // c0 => rect index
+
+    for (unsigned r = 0; r < _size; ++r)
+    {
+        currRow.clear();
+        const unsigned char* row = &_visibility[r * _size];
+        for (unsigned c = 0; c < _size; )
+        {
+            if (row[c] != VISIBLE)
+            {
+                ++c;
+                continue;
+            }
+
+            unsigned c0 = c;
+            while (c < _size && row[c] == VISIBLE)
+                ++c;
+
+            std::map<unsigned, unsigned>::const_iterator i = prevRow.find(c0);
+            if (i != prevRow.end() && rects[i->second].c1 == c)
+            {
+                rects[i->second].r1 = r + 1u;
+                currRow[c0] = i->second;
+            }
+            else
+            {
+                Rect rect = { c0, c, r, r + 1u };
+                currRow[c0] = rects.size();
+                rects.push_back(rect);
+            }
+        }
+        prevRow.swap(currRow);
+    }
+
+    if (rects.empty())
+        return;
+
+    double origin = -((double)(_size / 2u) + 0.5) * _cellSize;
+
+    MultiGeometry* multi = new MultiGeometry();
+    for (std::vector<Rect>::const_iterator i = rects.begin(); i != rects.end(); ++i)
+    {
+        double xMin = origin + (double)i->c0 * _cellSize, xMax = origin + (double)i->c1 * _cellSize;
+        double yMin = origin + (double)i->r0 * _cellSize, yMax = origin + (double)i->r1 * _cellSize;
+
+        Polygon* poly = new Polygon();
+        poly->push_back(xMin, yMin);
+        poly->push_back(xMax, yMin);
+        poly->push_back(xMax, yMax);
+        poly->push_back(xMin, yMax);
+        multi->add(poly);
+    }
+
+    output.push_back(new Feature(multi, _srs.get()));
+}
+
+//........................................................................
+
+namespace osgEarth {
+    namespace Features {
+        REGISTER_OSGEARTH_LAYER(viewshed, ViewshedFeatureSource);
+    }
+}
+
+#undef LC
+#define LC "[ViewshedFeatureSource] " << getName() << ": "
+
+Config
+ViewshedFeatureSource::Options::getConfig() const
+{
+    Config conf = FeatureSource::Options::getConfig();
+    conf.set("observer", observer());
+    conf.set("observer_height", observerHeight());
+    conf.set("target_height", targetHeight());
+    conf.set("radius", radius());
+    conf.set("grid_size", gridSize());
+    conf.set("curvature", curvature());
+    conf.set("refraction", refraction());
+    return conf;
+}
+
+void
+ViewshedFeatureSource::Options::fromConfig(const Config& conf)
+{
+    observerHeight().setDefault(2.0);
+    targetHeight().setDefault(0.0);
+    radius().setDefault(Distance(10.0, Units::KILOMETERS));
+    gridSize().setDefault(513u);
+    curvature().setDefault(true);
+    refraction().setDefault(0.13);
+
+    conf.get("observer", observer());
+    conf.get("observer_height", observerHeight());
+    conf.get("target_height", targetHeight());
+    conf.get("radius", radius());
+    conf.get("grid_size", gridSize());
+    conf.get("curvature", curvature());
+    conf.get("refraction", refraction());
+}
+
+//........................................................................
+
+OE_LAYER_PROPERTY_IMPL(ViewshedFeatureSource, GeoPoint, Observer, observer);
+OE_LAYER_PROPERTY_IMPL(ViewshedFeatureSource, double, ObserverHeight, observerHeight);
+OE_LAYER_PROPERTY_IMPL(ViewshedFeatureSource, double, TargetHeight, targetHeight);
+OE_LAYER_PROPERTY_IMPL(ViewshedFeatureSource, Distance, Radius, radius);
+OE_LAYER_PROPERTY_IMPL(ViewshedFeatureSource, unsigned, GridSize, gridSize);
+
+void
+ViewshedFeatureSource::init()
+{
+    FeatureSource::init();
+    _computed = false;
+}
+
+Status
+ViewshedFeatureSource::openImplementation()
+{
+    Status parent = FeatureSource::openImplementation();
+    if (parent.isError())
+        return parent;
+
+    osg::ref_ptr<const SpatialReference> srs = Viewshed::createSRS(options().observer().get());
+    if (!srs.valid())
+        return Status(Status::ConfigurationError, "Missing or invalid observer location");
+
+    double r = options().radius()->as(Units::METERS);
+    GeoExtent extent = GeoExtent(srs.get(), -r, -r, r, r).transform(SpatialReference::get("wgs84"));
+    setFeatureProfile(new FeatureProfile(extent));
+
+    Threading::ScopedMutexLock lock(_mutex);
+    _features.clear();
+    _computed = false;
+
+    return Status::NoError;
+}
+
+void
+ViewshedFeatureSource::addedToMap(const Map* map)
+{
+    _map = map;
+    FeatureSource::addedToMap(map);
+}
+
+void
+ViewshedFeatureSource::removedFromMap(const Map* map)
+{
+    FeatureSource::removedFromMap(map);
+    _map = nullptr;
+}
+
+FeatureCursor*
+ViewshedFeatureSource::createFeatureCursorImplementation(const Query& query, ProgressCallback* progress)
+{
+    Threading::ScopedMutexLock lock(_mutex);
+
+    if (!_computed)
+    {
+        osg::ref_ptr<const Map> map;
+        if (!_map.lock(map))
+            return nullptr;
+
+        Viewshed viewshed;
+        viewshed.setObserver(options().observer().get());
+        viewshed.setObserverHeight(options().observerHeight().get());
+        viewshed.setTargetHeight(options().targetHeight().get());
+        viewshed.setRadius(options().radius().get());
+        viewshed.setGridSize(options().gridSize().get());
+        viewshed.setCurvature(options().curvature().get());
+        viewshed.setRefraction(options().refraction().get());
+
+        if (!viewshed.run(map.get(), progress))
+        {
+            // leave it for the next request unless the analysis itself failed
+            if (!progress || !progress->isCanceled())
+                OE_WARN << LC << "Viewshed analysis failed" << std::endl;
+            return nullptr;
+        }
+
+        viewshed.createFeatures(_features);
+
+        const SpatialReference* srs = getFeatureProfile()->getSRS();
+        for (FeatureList::iterator i = _features.begin(); i != _features.end(); ++i)
+            i->get()->transform(srs);
+
+        _computed = true;
+    }
+
+    // callers are free to modify the features they get, so hand out copies
+    FeatureList copies;
+    for (FeatureList::const_iterator i = _features.begin(); i != _features.end(); ++i)
+        copies.push_back(new Feature(*i->get()));
+
+    return copies.empty() ? nullptr : new FeatureListCursor(copies);
+}
@@ -18,6 +18,7 @@
  */
 #include <osgEarth/XYZFeatureSource>
 #include <osgEarth/OgrUtils>
+#include <osgEarth/GeoJSONReader>
 #include <osgEarth/GeometryUtils>
 #include <osgEarth/FeatureCursor>
 #include <osgEarth/Filter>
@@ -27,7 +28,6 @@
 #define LC "[XYZFeatureSource] "
 
 using namespace osgEarth;
-#define OGR_SCOPED_LOCK GDAL_SCOPED_LOCK
 
 //........................................................................
 
@@ -210,14 +210,26 @@ XYZFeatureSource::getFeatures(const std::string& buffer, const TileKey& key, con
         return false;
 #endif
     }
-    else
+    else if (isJSON(mimeType))
     {
-        // find the right driver for the given mime type
-        OGR_SCOPED_LOCK;
+        // stream the GeoJSON directly; no DOM and no OGR lock required
+        GeoJSONReader reader;
+        reader.setFeatureProfile(getFeatureProfile());
+        reader.setRewindPolygons(*_options->rewindPolygons());
 
+        std::istringstream in(buffer);
+        return reader.read(in, [&](Feature* f)
+        {
+            if (!isBlacklisted(f->getFID()))
+                features.push_back(f);
+            return true;
+        });
+    }
+    else
+    {
+        // OGR datasources are not shared between threads, so no global lock is needed here.
         // find the right driver for the given mime type
         OGRSFDriverH ogrDriver =
-            isJSON(mimeType) ? OGRGetDriverByName("GeoJSON") :
             isGML(mimeType) ? OGRGetDriverByName("GML") :
             0L;
 
@@ -21,11 +21,13 @@
 #include <osgEarth/MapNode>
 #include <osgEarth/Registry>
 #include <osgEarth/XmlUtils>
+#include <osgEarth/FileUtils>
 #include <osgDB/FileNameUtils>
 #include <osgDB/FileUtils>
 #include <osgDB/Registry>
 #include <string>
 #include <sstream>
+#include <iterator>
 #include <osgEarth/Common>
 
 using namespace osgEarth_osgearth;
@@ -63,6 +65,12 @@ using namespace osgEarth;
 // cause the writer to try making absolute paths relative to the new save location.
 #define EARTH_REWRITE_ABSOLUTE_PATHS "RewriteAbsolutePaths"
 
+// By default the reader will load a precompiled binary earth file (.earthb)
+// that sits next to the requested .earth file, as long as the .earth file and
+// everything it includes are unchanged since it was compiled. This option
+// will disable that.
+#define EARTH_IGNORE_COMPILED        "IgnoreCompiled"
+
 
 namespace
 {
@@ -103,7 +111,9 @@ class ReaderWriterEarth : public osgDB::ReaderWriter
         
         virtual bool acceptsExtension(const std::string& extension) const
         {
-            return osgDB::equalCaseInsensitive( extension, "earth" );
+            return
+                osgDB::equalCaseInsensitive( extension, "earth" ) ||
+                osgDB::equalCaseInsensitive( extension, "earthb" );
         }
 
         virtual ReadResult readObject(const std::string& file_name, const osgDB::Options* options) const
@@ -121,19 +131,26 @@ class ReaderWriterEarth : public osgDB::ReaderWriter
             if ( !acceptsExtension( osgDB::getFileExtension(fileName) ) )
                 return WriteResult::FILE_NOT_HANDLED;
 
-            std::ofstream out( fileName.c_str());
+            bool compiled = osgDB::equalCaseInsensitive( osgDB::getFileExtension(fileName), "earthb" );
+
+            std::ofstream out( fileName.c_str(), compiled ? std::ios::out | std::ios::binary : std::ios::out );
             if ( out.is_open() )
             {
                 osg::ref_ptr<osgDB::Options> myOptions = Registry::instance()->cloneOrCreateOptions(options);
                 URIContext( fileName ).store( myOptions.get() );
 
-                return writeNode( node, out, myOptions.get() );
+                return writeMap( node, out, myOptions.get(), compiled );
             }
 
             return WriteResult::ERROR_IN_WRITING_FILE;            
         }
 
         virtual WriteResult writeNode(const osg::Node& node, std::ostream& out, const osgDB::Options* options ) const
+        {
+            return writeMap( node, out, options, false );
+        }
+
+        WriteResult writeMap(const osg::Node& node, std::ostream& out, const osgDB::Options* options, bool compiled) const
         {
             osg::Node* searchNode = const_cast<osg::Node*>( &node );
             MapNode* mapNode = MapNode::findMapNode( searchNode );
@@ -166,9 +183,20 @@ class ReaderWriterEarth : public osgDB::ReaderWriter
 
             Config conf = ser.serialize( mapNode, uriContext.referrer() );
 
-            // dump that Config out as XML.
-            osg::ref_ptr<XmlDocument> xml = new XmlDocument( conf );
-            xml->store( out );
+            if ( compiled )
+            {
+                // wrap it the way an XML document would, and dump it out as binary.
+                Config docConf;
+                docConf.add( conf );
+                if ( !docConf.toBinary( out ) )
+                    return WriteResult::ERROR_IN_WRITING_FILE;
+            }
+            else
+            {
+                // dump that Config out as XML.
+                osg::ref_ptr<XmlDocument> xml = new XmlDocument( conf );
+                xml->store( out );
+            }
 
             return WriteResult::FILE_SAVED;
         }
@@ -199,6 +227,37 @@ class ReaderWriterEarth : public osgDB::ReaderWriter
                 {
                     fullFileName = osgDB::findDataFile( fileName, readOptions );
                     if (fullFileName.empty()) return ReadResult::FILE_NOT_FOUND;
+
+                    // compiled earth files decode straight from a memory map:
+                    if ( osgDB::equalCaseInsensitive(ext, "earthb") )
+                    {
+                        Config docConf;
+                        if ( !docConf.fromBinaryFile(fullFileName) )
+                            return ReadResult::ERROR_IN_READING_FILE;
+                        return readCompiled( docConf, fullFileName, readOptions );
+                    }
+
+                    // use an up-to-date compiled version of the file if there is one:
+                    if ( !hasOption(readOptions, EARTH_IGNORE_COMPILED) )
+                    {
+                        std::string compiledFileName = osgDB::getNameLessExtension(fullFileName) + ".earthb";
+                        Config docConf;
+                        if ( osgDB::fileExists(compiledFileName) &&
+                             docConf.fromBinaryFile(compiledFileName, fullFileName) )
+                        {
+                            if ( isCompiledFileCurrent(docConf, fullFileName) )
+                            {
+                                OE_INFO << LC << "Loading compiled earth file " << compiledFileName << std::endl;
+                                ReadResult result = readCompiled( docConf, fullFileName, readOptions );
+                                if ( result.success() )
+                                    return result;
+                            }
+                            else
+                            {
+                                OE_INFO << LC << "Ignoring out-of-date compiled earth file " << compiledFileName << std::endl;
+                            }
+                        }
+                    }
                 }
 
                 osgEarth::ReadResult r = URI(fullFileName).readString( readOptions );
@@ -222,11 +281,77 @@ class ReaderWriterEarth : public osgDB::ReaderWriter
             // from an "anonymous" stream here)
             URIContext uriContext( readOptions ); 
 
-            osg::ref_ptr<XmlDocument> doc = XmlDocument::load( in, uriContext );
-            if ( !doc.valid() )
-                return ReadResult::ERROR_IN_READING_FILE;
+            Config docConf;
+
+            // the stream might hold a compiled earth file (which never starts
+            // with the same character as an XML document would):
+            if ( in.peek() == 'O' )
+            {
+                std::string buffer( (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>() );
+                if ( !docConf.fromBinary(buffer.data(), buffer.size(), uriContext.referrer()) )
+                    return ReadResult::ERROR_IN_READING_FILE;
+            }
+            else
+            {
+                osg::ref_ptr<XmlDocument> doc = XmlDocument::load( in, uriContext );
+                if ( !doc.valid() )
+                    return ReadResult::ERROR_IN_READING_FILE;
+
+                docConf = doc->getConfig();
+            }
 
-            Config docConf = doc->getConfig();
+            return readMap( docConf, readOptions );
+        }
+
+    private:
+
+        bool hasOption(const osgDB::Options* options, const std::string& name) const
+        {
+            return
+                options &&
+                osgEarth::toLower(options->getOptionString()).find(osgEarth::toLower(name)) != std::string::npos;
+        }
+
+        //! Whether the files a compiled earth file was built from (listed in
+        //! its "dependencies" block, relative to the earth file) are all
+        //! unchanged. A compiled file without the list is never current.
+        bool isCompiledFileCurrent(const Config& docConf, const std::string& earthFileName) const
+        {
+            if ( !docConf.hasChild("dependencies") )
+                return false;
+
+            const ConfigSet files = docConf.child("dependencies").children("file");
+            if ( files.empty() )
+                return false;
+
+            for(ConfigSet::const_iterator i = files.begin(); i != files.end(); ++i)
+            {
+                std::string path = osgEarth::getFullPath( earthFileName, i->value("path") );
+                if ( !osgDB::fileExists(path) )
+                    return false;
+
+                std::string modified = Stringify() << getLastModifiedTime(path);
+                if ( modified != i->value("modified") )
+                    return false;
+            }
+            return true;
+        }
+
+        //! Builds the map from a decoded compiled earth file. Relative paths
+        //! in the file resolve against the referrer.
+        ReadResult readCompiled(const Config& docConf, const std::string& referrer, const osgDB::Options* readOptions) const
+        {
+            osg::ref_ptr<osgDB::Options> myReadOptions = Registry::instance()->cloneOrCreateOptions(readOptions);
+            URIContext( referrer ).store( myReadOptions.get() );
+
+            return readMap( docConf, myReadOptions.get() );
+        }
+
+        //! Builds the map from the document-level Config, whether it came
+        //! from XML or from a compiled earth file.
+        ReadResult readMap(const Config& docConf, const osgDB::Options* readOptions) const
+        {
+            URIContext uriContext( readOptions );
 
             // support both "map" and "earth" tag names at the top level
             Config conf;
@@ -21,6 +21,8 @@
 #include <osgEarth/TerrainEngineNode>
 #include <osgEarth/Terrain>
 #include <osgEarth/Metrics>
+#include <osgEarth/MetricsRegistry>
+#include <osgEarth/TileTracer>
 #include <osg/NodeVisitor>
 
 using namespace osgEarth::REX;
@@ -66,6 +68,8 @@ LoadTileData::run(ProgressCallback* progress)
     if (!_map.lock(map))
         return false;
 
+    Util::TileTracer::Scope trace(Util::TileTracer::LOAD, _key, std::string());
+
     // if the operation was canceled, set the request to abandoned
     // so it can potentially retry later.
     if (progress && progress->isCanceled())
@@ -104,10 +108,24 @@ LoadTileData::run(ProgressCallback* progress)
 }
 
 
+namespace
+{
+    Util::MetricsRegistry::Counter* getMergeCounter(const char* result)
+    {
+        Util::MetricsRegistry::Labels labels;
+        labels["result"] = result;
+        return Util::MetricsRegistry::instance().counter(
+            "oe_rex_merges_total", "Terrain tile data merges, by result", labels);
+    }
+}
+
 // apply() runs in the update traversal and can safely alter the scene graph
 bool
 LoadTileData::merge()
 {
+    static Util::MetricsRegistry::Counter* s_merged = getMergeCounter("merged");
+    static Util::MetricsRegistry::Counter* s_requeued = getMergeCounter("requeued");
+
     // context went out of scope - bail
     osg::ref_ptr<EngineContext> context;
     if (!_context.lock(context))
@@ -132,6 +150,7 @@ LoadTileData::merge()
     }
 
     OE_PROFILING_ZONE;
+    Util::TileTracer::Scope trace(Util::TileTracer::MERGE, _key, std::string());
 
     // Check the map data revision and scan the manifest and see if any
     // revisions don't match the revisions in the original manifest.
@@ -144,11 +163,13 @@ LoadTileData::merge()
         _manifest.updateRevisions(map.get());
         _dataModel = 0L;
         OE_DEBUG << LC << "Request for tile " << _key.str() << " out of date and will be requeued" << std::endl;
+        s_requeued->increment();
         return false;
     }
 
     // Merge the new data into the tile.
     tilenode->merge(_dataModel.get(), this);
+    s_merged->increment();
 
     OE_DEBUG << LC << "apply " << _dataModel->getKey().str() << "\n";
 
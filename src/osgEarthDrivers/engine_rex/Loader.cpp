@@ -23,6 +23,7 @@
 #include <osgEarth/Utils>
 #include <osgEarth/NodeUtils>
 #include <osgEarth/Metrics>
+#include <osgEarth/TileTracer>
 
 #include <osgDB/FileNameUtils>
 #include <osgDB/FileUtils>
@@ -75,6 +76,15 @@ Loader::Request::setDelay(double seconds)
     //OE_WARN << _key.str() << "setDelay(" << osg::Timer::instance()->delta_s(now, _readyTick) << ")" << std::endl;
 }
 
+void
+Loader::Request::cancel()
+{
+    lock();
+    if (_progress.valid())
+        _progress->cancel();
+    unlock();
+}
+
 namespace osgEarth { namespace REX
 {
     /**
@@ -335,6 +345,12 @@ PagerLoader::load(Loader::Request* request, float priority, osg::NodeVisitor& nv
         }
         request->unlock();
 
+        if (addToRequestSet)
+        {
+            osgEarth::Util::TileTracer::instance().record(
+                osgEarth::Util::TileTracer::QUEUED, request->getTileKey(), std::string());
+        }
+
         // is this request eligible to run (based on a possible setDelay call)?
         if (now >= request->_readyTick)
         {
@@ -446,6 +462,7 @@ PagerLoader::traverse(osg::NodeVisitor& nv)
                     else if ( !req->isMerging() && frameDiff > 2 )
                     {
                         OE_DEBUG << LC << req->getName() << "(" << i->second->getUID() << ") was abandoned waiting to be serviced" << std::endl; 
+                        req->cancel();
                         req->setState(Request::IDLE);
                         if ( REPORT_ACTIVITY )
                             Registry::instance()->endActivity( req->getName() );
@@ -576,10 +593,23 @@ PagerLoader::runAndRelease(UID requestUID)
 
         osg::ref_ptr<ProgressCallback> prog = new RequestProgressCallback(request.get(), this);
 
+        // publish the callback so the update traversal can cancel the
+        // request directly when its tile is abandoned
+        request->lock();
+        request->_progress = prog.get();
+        request->unlock();
+
         if (request->run(prog.get()) == false)
         {
             request->setState(Request::IDLE);
         }
+
+        request->lock();
+        request->_progress = 0L;
+        request->unlock();
+
+        // how long the worker stayed busy after the request was canceled
+        prog->recordCancelation("rex");
     }
 
     else
@@ -32,6 +32,7 @@
 #include <osgEarth/Utils>
 #include <osgEarth/ObjectIndex>
 #include <osgEarth/Metrics>
+#include <osgEarth/TileTracer>
 #include <osgEarth/ElevationConstraintLayer>
 #include <osgEarth/Elevation>
 #include <osgEarth/LandCover>
@@ -788,6 +789,9 @@ RexTerrainEngineNode::update_traverse(osg::NodeVisitor& nv)
         // advance the frame clock for this new frame.
         _clock.update();
 
+        // mark the frame in the tile trace (and dump it if the last one was slow)
+        Util::TileTracer::instance().frame(osgFrame);
+
         if (_renderModelUpdateRequired)
         {
             PurgeOrphanedLayers visitor(getMap(), _renderBindings);
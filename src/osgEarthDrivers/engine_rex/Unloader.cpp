@@ -21,6 +21,8 @@
 #include "TileNodeRegistry"
 
 #include <osgEarth/Metrics>
+#include <osgEarth/MetricsRegistry>
+#include <osgEarth/TileTracer>
 #include <osgEarth/NodeUtils>
 
 #undef  LC
@@ -88,12 +90,22 @@ UnloaderGroup::traverse(osg::NodeVisitor& nv)
                     // GW: moved this check to the collectAbandonedTiles function where it belongs
                     if (parent)
                     {
+                        osgEarth::Util::TileTracer::instance().record(
+                            osgEarth::Util::TileTracer::UNLOAD, tile->getKey(), std::string());
                         parent->removeSubTiles();
                         ++count;
                     }
                 }
             }
 
+            static osgEarth::Util::MetricsRegistry::Counter* s_unloaded = osgEarth::Util::MetricsRegistry::instance().counter(
+                "oe_rex_tiles_unloaded_total", "Dormant terrain tiles unloaded");
+            static osgEarth::Util::MetricsRegistry::Gauge* s_active = osgEarth::Util::MetricsRegistry::instance().gauge(
+                "oe_rex_tiles_active", "Terrain tiles in the tile registry");
+
+            s_unloaded->add(count);
+            s_active->set((double)_tiles->size());
+
             if (_deadpool.empty() == false)
             {
                 OE_DEBUG << LC << "Unloaded " << count << " of " << _deadpool.size() << " dormant tiles; " << _tiles->size() << " remain active." << std::endl;
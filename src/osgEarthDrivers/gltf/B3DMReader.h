@@ -61,14 +61,6 @@ public:
         _texCache = cache;
     }
 
-    static std::string ExpandFilePath(const std::string &filepath, void * userData)
-    {
-        const std::string& referrer = *(const std::string*)userData;
-        std::string path = osgDB::getRealPath(osgDB::isAbsolutePath(filepath) ? filepath : osgDB::concatPaths(osgDB::getFilePath(referrer), filepath));
-        //OSG_NOTICE << "ExpandFilePath: expanded " << filepath << " to " << path << std::endl;
-        return tinygltf::ExpandFilePath(path, userData);
-    }
-
     //! Read a B3DM file and return a node
     //osg::Node* read(const std::string& location, const osgDB::Options* readOptions) const
     //{
@@ -102,12 +94,19 @@ public:
             }
         }
 
-        b3dmheader header;
-        unsigned bytesRead = 0;
+        // Work directly on the data block; the embedded glTF is
+        // handed to the GLTFReader in place, without copying it.
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data->data());
+        size_t size = data->size();
 
-        std::stringstream buf(*data);
-        buf.read(reinterpret_cast<char*>(&header), sizeof(b3dmheader));
-        bytesRead += sizeof(b3dmheader);
+        b3dmheader header;
+        if (size < sizeof(b3dmheader))
+        {
+            OE_WARN << LC << "Invalid b3dm" << std::endl;
+            return NULL;
+        }
+        memcpy(&header, bytes, sizeof(b3dmheader));
+        size_t bytesRead = sizeof(b3dmheader);
 
 #ifdef OE_IS_BIG_ENDIAN
         byteSwapInPlace(header.version);
@@ -118,15 +117,25 @@ public:
         byteSwapInPlace(header.batchTableBinaryByteLength);
 #endif
 
-        size_t sz = header.byteLength;
+        size_t sz = osg::minimum((size_t)header.byteLength, size);
+
+        size_t tablesLength =
+            (size_t)header.featureTableJSONByteLength +
+            (size_t)header.featureTableBinaryByteLength +
+            (size_t)header.batchTableJSONByteLength +
+            (size_t)header.batchTableBinaryByteLength;
+
+        if (bytesRead + tablesLength >= sz)
+        {
+            OE_WARN << LC << "Invalid b3dm" << std::endl;
+            return NULL;
+        }
 
         osg::Vec3d rtc_center;
 
         if (header.featureTableJSONByteLength > 0)
         {
-            std::string featureTableJson;
-            featureTableJson.resize(header.featureTableJSONByteLength);
-            buf.read(reinterpret_cast<char*>(&featureTableJson[0]), header.featureTableJSONByteLength);
+            std::string featureTableJson(reinterpret_cast<const char*>(bytes + bytesRead), header.featureTableJSONByteLength);
             OE_DEBUG << "Read featureTableJson " << featureTableJson << std::endl;
 
             osgEarth::Json::Reader reader;
@@ -141,82 +150,20 @@ public:
                     rtc_center.y() = (*i++).asDouble();
                     rtc_center.z() = (*i++).asDouble();
                 }
-            }          
-
-            /*
-            json ftJson = json::parse(featureTableJson);
-            if (ftJson.find("RTC_CENTER") != ftJson.end()) {
-                json RTC_CENTER = ftJson["RTC_CENTER"];
-                rtc_center.x() = RTC_CENTER[0];
-                rtc_center.y() = RTC_CENTER[1];
-                rtc_center.z() = RTC_CENTER[2];
             }
-            OE_DEBUG << LC << "Read rtc_center " << rtc_center.x() << ", " << rtc_center.y() << ", " << rtc_center.z() << std::endl;
-            */
-
-            bytesRead += header.featureTableJSONByteLength;
-        }
-
-        if (header.featureTableBinaryByteLength > 0)
-        {
-            std::string featureTableBinary;
-            featureTableBinary.resize(header.featureTableBinaryByteLength);
-            buf.read(reinterpret_cast<char*>(&featureTableBinary[0]), header.featureTableBinaryByteLength);
-            OE_DEBUG << "Read featureTableJson " << featureTableBinary << std::endl;
-            bytesRead += header.featureTableBinaryByteLength;
         }
 
-        if (header.batchTableJSONByteLength > 0)
-        {
-            std::string batchTableJSON;
-            batchTableJSON.resize(header.batchTableJSONByteLength);
-            buf.read(reinterpret_cast<char*>(&batchTableJSON[0]), header.batchTableJSONByteLength);
-            OE_DEBUG << "Read batchTableJSON " << batchTableJSON << std::endl;
-            bytesRead += header.batchTableJSONByteLength;
-        }
+        // The feature table binary and the batch table are not used.
+        bytesRead += tablesLength;
 
-        if (header.batchTableBinaryByteLength > 0)
+        GLTFReader gltfReader;
+        gltfReader.setTextureCache(_texCache);
+        osg::Node* modelNode = gltfReader.readBinary(location, bytes + bytesRead, sz - bytesRead, readOptions);
+        if (!modelNode)
         {
-            std::string batchTableBinary;
-            batchTableBinary.resize(header.batchTableBinaryByteLength);
-            buf.read(reinterpret_cast<char*>(&batchTableBinary[0]), header.batchTableBinaryByteLength);
-            OE_DEBUG << "Read batchTableJSON " << batchTableBinary << std::endl;
-            bytesRead += header.batchTableBinaryByteLength;
+            return NULL;
         }
 
-        std::string gltfData;
-        gltfData.resize(sz - bytesRead);
-        buf.read(reinterpret_cast<char *>(&gltfData[0]), static_cast<std::streamsize>(gltfData.size()));
-
-        tinygltf::Model model;
-        tinygltf::TinyGLTF loader;
-        std::string err;
-        std::string warn;
-
-        FsCallbacks fs;
-        fs.FileExists = &tinygltf::FileExists;
-        fs.ExpandFilePath = &B3DMReader::ExpandFilePath;
-        fs.ReadWholeFile = &tinygltf::ReadWholeFile;
-        fs.WriteWholeFile = &tinygltf::WriteWholeFile;
-        fs.user_data = (void*)&location;
-        loader.SetFsCallbacks(fs);
-
-        tinygltf::Options opt;
-        opt.skip_imagery = readOptions && readOptions->getOptionString().find("gltfSkipImagery") != std::string::npos;        
-
-        loader.LoadBinaryFromMemory(&model, &err, &warn, reinterpret_cast<unsigned char*>(&gltfData[0]), sz, "", REQUIRE_VERSION, &opt);
-
-        if (!err.empty())
-            OE_WARN << LC << "GLTF ERROR: " << err << std::endl;
-        if (!warn.empty())
-            OE_WARN << LC << "GLTF WARNING: " << warn << std::endl;
-
-        osg::MatrixTransform *mt = new osg::MatrixTransform;
-
-        GLTFReader gltfReader;
-        gltfReader.setTextureCache(_texCache);
-        GLTFReader::Env env(location, readOptions);
-        osg::Node* modelNode = gltfReader.makeNodeFromModel(model, env);
         if (rtc_center.x() == 0.0 && rtc_center.y() == 0.0 && rtc_center.z() == 0.0)
         {
             return modelNode;
@@ -39,6 +39,11 @@
 #include <osgEarth/Registry>
 #include <osgEarth/ShaderUtils>
 #include <osgEarth/InstanceBuilder>
+#include <osgEarth/Threading>
+#include <osgEarth/Endian>
+#include <fstream>
+#include <streambuf>
+#include <map>
 
 
 
@@ -62,13 +67,192 @@ public:
         return tinygltf::ExpandFilePath(path, userData);
     }
 
+    /**
+     * Decodes embedded images on a worker pool while the rest of the
+     * model is parsed and built. Install with TinyGLTF::SetImageLoader
+     * so tinygltf hands over the encoded bytes instead of decoding them.
+     */
+    class ImageDecoder
+    {
+    public:
+        ImageDecoder(const osgDB::Options* options) : _options(options) { }
+
+        //! tinygltf image loader callback
+        static bool deferImageData(tinygltf::Image* image, const int image_idx, std::string* err, std::string* warn,
+                                   int req_width, int req_height, const unsigned char* bytes, int size, void* user_data)
+        {
+            static_cast<ImageDecoder*>(user_data)->decode(image_idx, bytes, size);
+            return true;
+        }
+
+        //! Starts decoding an image asynchronously
+        void decode(int index, const unsigned char* bytes, int size)
+        {
+            osgEarth::Threading::Promise<osg::Image> promise;
+            _results[index] = promise.getFuture();
+            osg::ref_ptr<osg::Operation> op = new DecodeOperation(bytes, size, _options.get(), promise);
+            osgEarth::Threading::getComputeThreadPool()->run(op.get());
+        }
+
+        //! Whether the image at this index was handed to the decoder
+        bool has(int index) const
+        {
+            return _results.find(index) != _results.end();
+        }
+
+        //! Decoded image at this index; blocks until it is ready
+        osg::Image* get(int index)
+        {
+            std::map<int, osgEarth::Threading::Future<osg::Image> >::iterator i = _results.find(index);
+            return i != _results.end() ? i->second.get() : 0L;
+        }
+
+        //! Decodes encoded (PNG, JPEG, etc.) image data into an image with its first row at the top
+        static osg::Image* decodeImage(const std::string& data, const osgDB::Options* options)
+        {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data.data());
+
+            std::string ext;
+            if (data.size() >= 4 && bytes[0] == 0x89 && bytes[1] == 'P' && bytes[2] == 'N' && bytes[3] == 'G')
+                ext = "png";
+            else if (data.size() >= 2 && bytes[0] == 0xFF && bytes[1] == 0xD8)
+                ext = "jpg";
+
+            osg::ref_ptr<osg::Image> image;
+
+            // Prefer the OSG plugins, which decode straight into the osg::Image
+            osgDB::ReaderWriter* rw = ext.empty() ? 0L : osgDB::Registry::instance()->getReaderWriterForExtension(ext);
+            if (rw)
+            {
+                MemoryStreamBuf buf(data.data(), data.size());
+                std::istream in(&buf);
+                osgDB::ReaderWriter::ReadResult rr = rw->readImage(in, options);
+                if (rr.validImage())
+                {
+                    image = rr.takeImage();
+                    // OSG images start at the bottom row; glTF expects the top.
+                    image->flipVertical();
+                }
+            }
+
+            // Fall back on stb
+            if (!image.valid())
+            {
+                tinygltf::Image stbImage;
+                std::string err, warn;
+                if (tinygltf::LoadImageData(&stbImage, 0, &err, &warn, 0, 0, bytes, (int)data.size(), 0L) &&
+                    stbImage.image.size() > 0)
+                {
+                    GLenum format =
+                        stbImage.component == 1 ? GL_LUMINANCE :
+                        stbImage.component == 2 ? GL_LUMINANCE_ALPHA :
+                        stbImage.component == 4 ? GL_RGBA :
+                        GL_RGB;
+                    GLenum dataType = stbImage.bits == 16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+
+                    image = new osg::Image();
+                    unsigned char* imgData = new unsigned char[stbImage.image.size()];
+                    memcpy(imgData, &stbImage.image[0], stbImage.image.size());
+                    image->setImage(stbImage.width, stbImage.height, 1, format, format, dataType, imgData, osg::Image::USE_NEW_DELETE);
+                }
+            }
+
+            return image.release();
+        }
+
+    private:
+        // Read-only stream buffer over a block of memory, so the
+        // image plugins can read without another copy of the data.
+        struct MemoryStreamBuf : public std::streambuf
+        {
+            MemoryStreamBuf(const char* data, size_t size)
+            {
+                char* p = const_cast<char*>(data);
+                setg(p, p, p + size);
+            }
+
+            pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+            {
+                char* target =
+                    dir == std::ios_base::beg ? eback() + off :
+                    dir == std::ios_base::cur ? gptr() + off :
+                    egptr() + off;
+                if (target < eback() || target > egptr())
+                    return pos_type(off_type(-1));
+                setg(eback(), target, egptr());
+                return pos_type(target - eback());
+            }
+
+            pos_type seekpos(pos_type pos, std::ios_base::openmode which)
+            {
+                return seekoff(off_type(pos), std::ios_base::beg, which);
+            }
+        };
+
+        struct DecodeOperation : public osg::Operation
+        {
+            DecodeOperation(const unsigned char* bytes, int size, const osgDB::Options* options, osgEarth::Threading::Promise<osg::Image> promise) :
+                osg::Operation("gltf decode image", false),
+                _data(reinterpret_cast<const char*>(bytes), size),
+                _options(options),
+                _promise(promise) { }
+
+            void operator()(osg::Object*)
+            {
+                if (!_promise.isAbandoned())
+                {
+                    _promise.resolve(decodeImage(_data, _options.get()));
+                }
+            }
+
+            std::string _data;
+            osg::ref_ptr<const osgDB::Options> _options;
+            osgEarth::Threading::Promise<osg::Image> _promise;
+        };
+
+        osg::ref_ptr<const osgDB::Options> _options;
+        std::map<int, osgEarth::Threading::Future<osg::Image> > _results;
+    };
+
     struct Env
     {
-        Env(const std::string& loc, const osgDB::Options* opt) : referrer(loc), readOptions(opt) { }
+        Env(const std::string& loc, const osgDB::Options* opt) : referrer(loc), readOptions(opt), binData(0L), binSize(0), images(0L) { }
         const std::string referrer;
         const osgDB::Options* readOptions;
+
+        // Embedded GLB binary chunk, when tinygltf aliased it instead of copying it
+        const unsigned char* binData;
+        size_t binSize;
+
+        // Images being decoded in the background, if any
+        ImageDecoder* images;
     };
 
+    //! Locates the embedded binary (BIN) chunk in a GLB data block.
+    static bool getBinaryChunk(const unsigned char* bytes, size_t size, const unsigned char*& binData, size_t& binSize)
+    {
+        if (size < 20 || memcmp(bytes, "glTF", 4) != 0)
+            return false;
+
+        unsigned int jsonLength;
+        memcpy(&jsonLength, bytes + 12, 4);
+#ifdef OE_IS_BIG_ENDIAN
+        osgEarth::byteSwapInPlace(jsonLength);
+#endif
+        size_t chunk = 20 + (size_t)jsonLength;
+        if (chunk + 8 > size)
+            return false;
+
+        unsigned int chunkLength;
+        memcpy(&chunkLength, bytes + chunk, 4);
+#ifdef OE_IS_BIG_ENDIAN
+        osgEarth::byteSwapInPlace(chunkLength);
+#endif
+        binData = bytes + chunk + 8;
+        binSize = osg::minimum((size_t)chunkLength, size - (chunk + 8));
+        return true;
+    }
+
 public:
     mutable TextureCache* _texCache;
 
@@ -86,6 +270,36 @@ public:
                                          bool isBinary,
                                          const osgDB::Options* readOptions) const
     {
+        if (isBinary)
+        {
+            std::string mem;
+            if (osgDB::containsServerAddress(location))
+            {
+                osgEarth::ReadResult rr = osgEarth::URI(location).readString(readOptions);
+                if (rr.failed())
+                {
+                    return osgDB::ReaderWriter::ReadResult::FILE_NOT_FOUND;
+                }
+                mem = rr.getString();
+            }
+            else
+            {
+                std::ifstream in(location.c_str(), std::ios::binary);
+                if (!in.is_open())
+                {
+                    return osgDB::ReaderWriter::ReadResult::FILE_NOT_FOUND;
+                }
+                mem.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            }
+
+            osg::Node* node = readBinary(location, reinterpret_cast<const unsigned char*>(mem.data()), mem.size(), readOptions);
+            if (!node)
+            {
+                return osgDB::ReaderWriter::ReadResult::ERROR_IN_READING_FILE;
+            }
+            return node;
+        }
+
         std::string err, warn;
         tinygltf::Model model;
         tinygltf::TinyGLTF loader;
@@ -101,6 +315,14 @@ public:
         tinygltf::Options opt;
         opt.skip_imagery = readOptions && readOptions->getOptionString().find("gltfSkipImagery") != std::string::npos;
 
+        bool copyBuffers = readOptions && readOptions->getOptionString().find("gltfCopyBuffers") != std::string::npos;
+
+        ImageDecoder images(readOptions);
+        if (!copyBuffers)
+        {
+            loader.SetImageLoader(&ImageDecoder::deferImageData, &images);
+        }
+
         if (osgDB::containsServerAddress(location))
         {
             osgEarth::ReadResult rr = osgEarth::URI(location).readString(readOptions);
@@ -110,26 +332,11 @@ public:
             }
 
             std::string mem = rr.getString();
-
-            if (isBinary)
-            {
-                loader.LoadBinaryFromMemory(&model, &err, &warn, (const unsigned char*)mem.data(), mem.size(), location, REQUIRE_VERSION, &opt);
-            }
-            else
-            {
-                loader.LoadASCIIFromString(&model, &err, &warn, mem.data(), mem.size(), location, REQUIRE_VERSION, &opt);
-            }
+            loader.LoadASCIIFromString(&model, &err, &warn, mem.data(), mem.size(), location, REQUIRE_VERSION, &opt);
         }
         else
         {
-            if (isBinary)
-            {
-                loader.LoadBinaryFromFile(&model, &err, &warn, location, REQUIRE_VERSION, &opt);
-            }
-            else
-            {
-                loader.LoadASCIIFromFile(&model, &err, &warn, location, REQUIRE_VERSION, &opt);
-            }
+            loader.LoadASCIIFromFile(&model, &err, &warn, location, REQUIRE_VERSION, &opt);
         }
 
         if (!err.empty()) {
@@ -139,10 +346,36 @@ public:
         }
 
         Env env(location, readOptions);
+        if (!copyBuffers)
+        {
+            env.images = &images;
+        }
         return makeNodeFromModel(model, env);
     }
 
     osg::Node* read(const std::string& location, const std::string& inputStream, const osgDB::Options* readOptions) const
+    {
+        std::string decompressedData;
+        const std::string* data = &inputStream;
+
+        osg::ref_ptr<osgDB::BaseCompressor> compressor = osgDB::Registry::instance()->getObjectWrapperManager()->findCompressor("zlib");
+        if (compressor.valid())
+        {
+            std::stringstream in_data(inputStream);
+            if (compressor->decompress(in_data, decompressedData))
+            {
+                data = &decompressedData;
+            }
+        }
+
+        return readBinary(location, reinterpret_cast<const unsigned char*>(data->data()), data->size(), readOptions);
+    }
+
+    //! Reads a binary glTF (GLB) data block and returns a node.
+    //! Unless the "gltfCopyBuffers" option is set, accessors are read straight
+    //! out of the GLB binary chunk (copied once, into the OSG arrays) and embedded
+    //! images decode on a worker pool while the geometry is built.
+    osg::Node* readBinary(const std::string& location, const unsigned char* bytes, size_t size, const osgDB::Options* readOptions) const
     {
         std::string err, warn;
         tinygltf::Model model;
@@ -156,23 +389,21 @@ public:
         fs.user_data = (void*)&location;
         loader.SetFsCallbacks(fs);
 
+        bool copyBuffers = readOptions && readOptions->getOptionString().find("gltfCopyBuffers") != std::string::npos;
+
         tinygltf::Options opt;
         opt.skip_imagery = readOptions && readOptions->getOptionString().find("gltfSkipImagery") != std::string::npos;
+        // alias_binary_buffer is a local patch to the bundled tinygltf,
+        // which otherwise always copies the BIN chunk into Buffer::data.
+        opt.alias_binary_buffer = !copyBuffers;
 
-        std::string decompressedData;
-        const std::string* data = &inputStream;
-
-        osg::ref_ptr<osgDB::BaseCompressor> compressor = osgDB::Registry::instance()->getObjectWrapperManager()->findCompressor("zlib");
-        if (compressor.valid())
+        ImageDecoder images(readOptions);
+        if (!copyBuffers)
         {
-            std::stringstream in_data(inputStream);
-            if (compressor->decompress(in_data, decompressedData))
-            {
-                data = &decompressedData;
-            }
+            loader.SetImageLoader(&ImageDecoder::deferImageData, &images);
         }
 
-        loader.LoadBinaryFromMemory(&model, &err, &warn, reinterpret_cast<const unsigned char*>(data->c_str()), data->size(), "", REQUIRE_VERSION, &opt);
+        loader.LoadBinaryFromMemory(&model, &err, &warn, bytes, size, "", REQUIRE_VERSION, &opt);
 
         if (!err.empty()) {
             OE_WARN << LC << "gltf Error loading " << location << std::endl;
@@ -181,6 +412,11 @@ public:
         }
 
         Env env(location, readOptions);
+        if (!copyBuffers)
+        {
+            env.images = &images;
+            getBinaryChunk(bytes, size, env.binData, env.binSize);
+        }
         return makeNodeFromModel(model, env);
     }
 
@@ -283,9 +519,7 @@ public:
 
         {
             const tinygltf::Image& image = model.images[texture.source];
-            bool imageEmbedded =
-                tinygltf::IsDataURI(image.uri) ||
-                image.image.size() > 0;
+            bool imageEmbedded = isEmbedded(image);
 
             osgEarth::URI imageURI(image.uri, env.referrer);
 
@@ -296,7 +530,13 @@ public:
             // First load the image
             osg::ref_ptr<osg::Image> img;
 
-            if (image.image.size() > 0)
+            if (env.images && env.images->has(texture.source))
+            {
+                // decoded in the background while the model was parsed
+                img = env.images->get(texture.source);
+            }
+
+            else if (image.image.size() > 0)
             {
                 GLenum format = GL_RGB, texFormat = GL_RGB8;
                 if (image.component == 4) format = GL_RGBA, texFormat = GL_RGBA8;
@@ -356,6 +596,14 @@ public:
             return tex.release();
         }
 
+        static bool isEmbedded(const tinygltf::Image& image)
+        {
+            return
+                tinygltf::IsDataURI(image.uri) ||
+                image.bufferView >= 0 ||
+                image.image.size() > 0;
+        }
+
         osg::Group* makeMesh(const tinygltf::Mesh& mesh, bool prepInstancing) const
         {
             osg::Group *group = new osg::Group;
@@ -439,9 +687,7 @@ public:
                                 const tinygltf::Texture& texture = model.textures[index];
                                 const tinygltf::Image& image = model.images[texture.source];
                                 // don't cache embedded textures!
-                                bool imageEmbedded =
-                                    tinygltf::IsDataURI(image.uri) ||
-                                    image.image.size() > 0;
+                                bool imageEmbedded = isEmbedded(image);
                                 osgEarth::URI imageURI(image.uri, env.referrer);
                                 osg::ref_ptr<osg::Texture2D> tex;
                                 bool cachedTex = false;
@@ -534,7 +780,7 @@ public:
                 }
 
                 // If there is no color array just add one that has the base color factor in it.
-                if (!geom->getColorArray())
+                if (!geom->getColorArray() && geom->getVertexArray())
                 {
                     osg::Vec4Array* colors = new osg::Vec4Array();
                     osg::Vec3Array* verts = static_cast<osg::Vec3Array*>(geom->getVertexArray());
@@ -578,34 +824,11 @@ public:
                 }
                 else
                 {
-                    const tinygltf::Accessor &indexAccessor = model.accessors[primitive.indices];
-
-                    if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-                    {
-                        osg::UShortArray* indices = static_cast<osg::UShortArray*>(arrays[primitive.indices].get());
-                        osg::DrawElementsUShort* drawElements
-                            = new osg::DrawElementsUShort(mode, indices->begin(), indices->end());
-                        geom->addPrimitiveSet(drawElements);
-                    }
-                    else if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
-                    {
-                        osg::UIntArray* indices = static_cast<osg::UIntArray*>(arrays[primitive.indices].get());
-                        osg::DrawElementsUInt* drawElements
-                            = new osg::DrawElementsUInt(mode, indices->begin(), indices->end());
-                        geom->addPrimitiveSet(drawElements);
-                    }
-                    else if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
+                    osg::DrawElements* drawElements = makeDrawElements(mode, model.accessors[primitive.indices]);
+                    if (drawElements)
                     {
-                        osg::UByteArray* indices = static_cast<osg::UByteArray*>(arrays[primitive.indices].get());
-                        // Sigh, DrawElementsUByte doesn't have the constructor with iterator arguments.
-                        osg::DrawElementsUByte* drawElements = new osg::DrawElementsUByte(mode, indexAccessor.count);
-                        std::copy(indices->begin(), indices->end(), drawElements->begin());
                         geom->addPrimitiveSet(drawElements);
                     }
-                    else
-                    {
-                        OE_WARN << LC << "primitive indices are not unsigned.\n";
-                    }
                 }
 
                 if (!env.readOptions || env.readOptions->getOptionString().find("gltfSkipNormals") == std::string::npos)
@@ -636,53 +859,180 @@ public:
         class ArrayBuilder
         {
         public:
-            static OSGArray* makeArray(unsigned int size)
+            static void copyData(OSGArray* dest, const unsigned char* src, size_t byteStride, size_t count)
             {
-                return new OSGArray(size);
-            }
-            static void copyData(OSGArray* dest, const unsigned char* src, size_t viewOffset,
-                                 size_t byteStride,  size_t accessorOffset, size_t count)
-            {
-                int32_t componentSize = tinygltf::GetComponentSizeInBytes(ComponentType);
-                int32_t numComponents = tinygltf::GetNumComponentsInType(AccessorType);
-                if (byteStride == 0)
+                size_t elementSize =
+                    tinygltf::GetComponentSizeInBytes(ComponentType) *
+                    tinygltf::GetNumComponentsInType(AccessorType);
+
+                if (byteStride == 0 || byteStride == elementSize)
                 {
-                    memcpy(&(*dest)[0], src + accessorOffset + viewOffset, componentSize * numComponents * count);
+                    memcpy(&(*dest)[0], src, elementSize * count);
                 }
                 else
                 {
-                    const unsigned char* ptr = src + accessorOffset + viewOffset;
-                    for (int i = 0; i < count; ++i, ptr += byteStride)
+                    for (size_t i = 0; i < count; ++i, src += byteStride)
                     {
-                        memcpy(&(*dest)[i], ptr, componentSize * numComponents);
+                        memcpy(&(*dest)[i], src, elementSize);
                     }
                 }
             }
-            static void copyData(OSGArray* dest, const tinygltf::Buffer& buffer, const tinygltf::BufferView& bufferView,
-                                 const tinygltf::Accessor& accessor)
-            {
-                copyData(dest, &buffer.data.at(0), bufferView.byteOffset,
-                         bufferView.byteStride, accessor.byteOffset, accessor.count);
-            }
-            static OSGArray* makeArray(const tinygltf::Buffer& buffer, const tinygltf::BufferView& bufferView,
+
+            //! Makes a tightly packed array from an accessor into the buffer data
+            static OSGArray* makeArray(const unsigned char* data, const tinygltf::BufferView& bufferView,
                                        const tinygltf::Accessor& accessor)
             {
                 OSGArray* result = new OSGArray(accessor.count);
-                copyData(result, buffer, bufferView, accessor);
+                if (accessor.count > 0)
+                {
+                    copyData(result, data + bufferView.byteOffset + accessor.byteOffset, bufferView.byteStride, accessor.count);
+                }
                 return result;
             }
         };
 
+        //! Start of the buffer data that an accessor reads from: either the
+        //! tinygltf buffer or the aliased GLB binary chunk. Returns NULL if the
+        //! accessor has no buffer view or reaches past the end of its buffer.
+        const unsigned char* getBufferData(const tinygltf::Accessor& accessor) const
+        {
+            if (accessor.bufferView < 0 || accessor.bufferView >= (int)model.bufferViews.size())
+                return 0L;
+
+            const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+            if (bufferView.buffer < 0 || bufferView.buffer >= (int)model.buffers.size())
+                return 0L;
+
+            const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+
+            const unsigned char* data = 0L;
+            size_t size = 0;
+            if (buffer.data.empty() && buffer.uri.empty())
+            {
+                data = env.binData;
+                size = env.binSize;
+            }
+            else if (!buffer.data.empty())
+            {
+                data = &buffer.data[0];
+                size = buffer.data.size();
+            }
+
+            int componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+            int numComponents = tinygltf::GetNumComponentsInType(accessor.type);
+            if (data == 0L || componentSize <= 0 || numComponents <= 0)
+                return 0L;
+
+            size_t elementSize = (size_t)(componentSize * numComponents);
+            size_t stride = bufferView.byteStride > 0 ? bufferView.byteStride : elementSize;
+            size_t end = bufferView.byteOffset + accessor.byteOffset;
+            if (accessor.count > 0)
+                end += (accessor.count - 1) * stride + elementSize;
+
+            if (end > size)
+            {
+                OE_WARN << LC << "Accessor reaches past the end of its buffer" << std::endl;
+                return 0L;
+            }
+
+            return data;
+        }
+
+        template<typename T>
+        static void copyIndices(T* dest, const unsigned char* src, size_t byteStride, size_t count)
+        {
+            if (byteStride == 0 || byteStride == sizeof(T))
+            {
+                memcpy(dest, src, count * sizeof(T));
+            }
+            else
+            {
+                for (size_t i = 0; i < count; ++i, src += byteStride)
+                {
+                    memcpy(dest + i, src, sizeof(T));
+                }
+            }
+        }
+
+        //! Makes a primitive set directly from an index accessor
+        osg::DrawElements* makeDrawElements(int mode, const tinygltf::Accessor& accessor) const
+        {
+            const unsigned char* data = getBufferData(accessor);
+            if (data == 0L || accessor.count == 0)
+                return 0L;
+
+            const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+            const unsigned char* src = data + bufferView.byteOffset + accessor.byteOffset;
+
+            if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+            {
+                osg::DrawElementsUShort* drawElements = new osg::DrawElementsUShort(mode, accessor.count);
+                copyIndices(&(*drawElements)[0], src, bufferView.byteStride, accessor.count);
+                return drawElements;
+            }
+            else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
+            {
+                osg::DrawElementsUInt* drawElements = new osg::DrawElementsUInt(mode, accessor.count);
+                copyIndices(&(*drawElements)[0], src, bufferView.byteStride, accessor.count);
+                return drawElements;
+            }
+            else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
+            {
+                osg::DrawElementsUByte* drawElements = new osg::DrawElementsUByte(mode, accessor.count);
+                copyIndices(&(*drawElements)[0], src, bufferView.byteStride, accessor.count);
+                return drawElements;
+            }
+            else
+            {
+                OE_WARN << LC << "primitive indices are not unsigned.\n";
+                return 0L;
+            }
+        }
+
         // Take all of the accessors and turn them into arrays
         void extractArrays(std::vector<osg::ref_ptr<osg::Array>> &arrays) const
         {
+            // Accessors used only for primitive indices go straight into
+            // DrawElements (see makeDrawElements), so skip them here.
+            std::vector<bool> indicesOnly(model.accessors.size(), false);
+            for (unsigned int m = 0; m < model.meshes.size(); ++m)
+            {
+                for (unsigned int p = 0; p < model.meshes[m].primitives.size(); ++p)
+                {
+                    int indices = model.meshes[m].primitives[p].indices;
+                    if (indices >= 0 && indices < (int)indicesOnly.size())
+                        indicesOnly[indices] = true;
+                }
+            }
+            for (unsigned int m = 0; m < model.meshes.size(); ++m)
+            {
+                for (unsigned int p = 0; p < model.meshes[m].primitives.size(); ++p)
+                {
+                    const std::map<std::string, int>& attributes = model.meshes[m].primitives[p].attributes;
+                    for (std::map<std::string, int>::const_iterator a = attributes.begin(); a != attributes.end(); ++a)
+                    {
+                        if (a->second >= 0 && a->second < (int)indicesOnly.size())
+                            indicesOnly[a->second] = false;
+                    }
+                }
+            }
+
+            arrays.reserve(model.accessors.size());
+
             for (unsigned int i = 0; i < model.accessors.size(); i++)
             {
                 const tinygltf::Accessor& accessor = model.accessors[i];
-                const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
-                const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
                 osg::ref_ptr< osg::Array > osgArray;
 
+                const unsigned char* data = indicesOnly[i] ? 0L : getBufferData(accessor);
+                if (data == 0L)
+                {
+                    arrays.push_back(osgArray);
+                    continue;
+                }
+
+                const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+
                 switch (accessor.componentType)
                 {
                 case TINYGLTF_COMPONENT_TYPE_BYTE:
@@ -691,22 +1041,22 @@ public:
                     case TINYGLTF_TYPE_SCALAR:
                         osgArray = ArrayBuilder<osg::ByteArray,
                                                 TINYGLTF_COMPONENT_TYPE_BYTE,
-                                                TINYGLTF_TYPE_SCALAR>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_SCALAR>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC2:
                         osgArray = ArrayBuilder<osg::Vec2bArray,
                                                 TINYGLTF_COMPONENT_TYPE_BYTE,
-                                                TINYGLTF_TYPE_VEC2>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC2>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC3:
                         osgArray = ArrayBuilder<osg::Vec3bArray,
                                                 TINYGLTF_COMPONENT_TYPE_BYTE,
-                                                TINYGLTF_TYPE_VEC3>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC3>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC4:
                         osgArray = ArrayBuilder<osg::Vec4bArray,
                                                 TINYGLTF_COMPONENT_TYPE_BYTE,
-                                                TINYGLTF_TYPE_VEC4>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC4>::makeArray(data, bufferView, accessor);
                         break;
                     default:
                         break;
@@ -718,22 +1068,22 @@ public:
                     case TINYGLTF_TYPE_SCALAR:
                         osgArray = ArrayBuilder<osg::UByteArray,
                                                 TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE,
-                                                TINYGLTF_TYPE_SCALAR>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_SCALAR>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC2:
                         osgArray = ArrayBuilder<osg::Vec2ubArray,
                                                 TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE,
-                                                TINYGLTF_TYPE_VEC2>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC2>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC3:
                         osgArray = ArrayBuilder<osg::Vec3ubArray,
                                                 TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE,
-                                                TINYGLTF_TYPE_VEC3>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC3>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC4:
                         osgArray = ArrayBuilder<osg::Vec4ubArray,
                                                 TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE,
-                                                TINYGLTF_TYPE_VEC4>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC4>::makeArray(data, bufferView, accessor);
                         break;
                     default:
                         break;
@@ -745,22 +1095,22 @@ public:
                     case TINYGLTF_TYPE_SCALAR:
                         osgArray = ArrayBuilder<osg::ShortArray,
                                                 TINYGLTF_COMPONENT_TYPE_SHORT,
-                                                TINYGLTF_TYPE_SCALAR>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_SCALAR>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC2:
                         osgArray = ArrayBuilder<osg::Vec2sArray,
                                                 TINYGLTF_COMPONENT_TYPE_SHORT,
-                                                TINYGLTF_TYPE_VEC2>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC2>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC3:
                         osgArray = ArrayBuilder<osg::Vec3sArray,
                                                 TINYGLTF_COMPONENT_TYPE_SHORT,
-                                                TINYGLTF_TYPE_VEC3>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC3>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC4:
                         osgArray = ArrayBuilder<osg::Vec4sArray,
                                                 TINYGLTF_COMPONENT_TYPE_SHORT,
-                                                TINYGLTF_TYPE_VEC4>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC4>::makeArray(data, bufferView, accessor);
                         break;
                     default:
                         break;
@@ -772,22 +1122,22 @@ public:
                     case TINYGLTF_TYPE_SCALAR:
                         osgArray = ArrayBuilder<osg::UShortArray,
                                                 TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
-                                                TINYGLTF_TYPE_SCALAR>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_SCALAR>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC2:
                         osgArray = ArrayBuilder<osg::Vec2usArray,
                                                 TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
-                                                TINYGLTF_TYPE_VEC2>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC2>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC3:
                         osgArray = ArrayBuilder<osg::Vec3usArray,
                                                 TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
-                                                TINYGLTF_TYPE_VEC3>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC3>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC4:
                         osgArray = ArrayBuilder<osg::Vec4usArray,
                                                 TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
-                                                TINYGLTF_TYPE_VEC4>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC4>::makeArray(data, bufferView, accessor);
                         break;
                     default:
                         break;
@@ -799,22 +1149,22 @@ public:
                     case TINYGLTF_TYPE_SCALAR:
                         osgArray = ArrayBuilder<osg::IntArray,
                                                 TINYGLTF_COMPONENT_TYPE_INT,
-                                                TINYGLTF_TYPE_SCALAR>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_SCALAR>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC2:
                         osgArray = ArrayBuilder<osg::Vec2uiArray,
                                                 TINYGLTF_COMPONENT_TYPE_INT,
-                                                TINYGLTF_TYPE_VEC2>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC2>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC3:
                         osgArray = ArrayBuilder<osg::Vec3uiArray,
                                                 TINYGLTF_COMPONENT_TYPE_INT,
-                                                TINYGLTF_TYPE_VEC3>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC3>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC4:
                         osgArray = ArrayBuilder<osg::Vec4uiArray,
                                                 TINYGLTF_COMPONENT_TYPE_INT,
-                                                TINYGLTF_TYPE_VEC4>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC4>::makeArray(data, bufferView, accessor);
                         break;
                     default:
                         break;
@@ -826,22 +1176,22 @@ public:
                     case TINYGLTF_TYPE_SCALAR:
                         osgArray = ArrayBuilder<osg::UIntArray,
                                                 TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT,
-                                                TINYGLTF_TYPE_SCALAR>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_SCALAR>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC2:
                         osgArray = ArrayBuilder<osg::Vec2iArray,
                                                 TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT,
-                                                TINYGLTF_TYPE_VEC2>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC2>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC3:
                         osgArray = ArrayBuilder<osg::Vec3iArray,
                                                 TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT,
-                                                TINYGLTF_TYPE_VEC3>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC3>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC4:
                         osgArray = ArrayBuilder<osg::Vec4iArray,
                                                 TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT,
-                                                TINYGLTF_TYPE_VEC4>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC4>::makeArray(data, bufferView, accessor);
                         break;
                     default:
                         break;
@@ -853,22 +1203,22 @@ public:
                     case TINYGLTF_TYPE_SCALAR:
                         osgArray = ArrayBuilder<osg::FloatArray,
                                                 TINYGLTF_COMPONENT_TYPE_FLOAT,
-                                                TINYGLTF_TYPE_SCALAR>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_SCALAR>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC2:
                         osgArray = ArrayBuilder<osg::Vec2Array,
                                                 TINYGLTF_COMPONENT_TYPE_FLOAT,
-                                                TINYGLTF_TYPE_VEC2>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC2>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC3:
                         osgArray = ArrayBuilder<osg::Vec3Array,
                                                 TINYGLTF_COMPONENT_TYPE_FLOAT,
-                                                TINYGLTF_TYPE_VEC3>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC3>::makeArray(data, bufferView, accessor);
                         break;
                     case TINYGLTF_TYPE_VEC4:
                         osgArray = ArrayBuilder<osg::Vec4Array,
                                                 TINYGLTF_COMPONENT_TYPE_FLOAT,
-                                                TINYGLTF_TYPE_VEC4>::makeArray(buffer, bufferView, accessor);
+                                                TINYGLTF_TYPE_VEC4>::makeArray(data, bufferView, accessor);
                         break;
                     default:
                         break;
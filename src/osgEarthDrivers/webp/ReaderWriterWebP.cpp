@@ -28,6 +28,8 @@
 #include <osgDB/FileUtils>
 #include <osgDB/Registry>
 
+#include <osgEarth/ByteBuffer>
+
 #include <string>
 #include <sstream>
 #include <vector>
@@ -102,16 +104,27 @@ public:
 
     if (stream_size > 0)
     {
+      const char *vp8_data = NULL;
 
-      size_of_vp8_image_data = stream_size;
-      vp8_buffer = new char[stream_size];
-
-      int version = WebPGetEncoderVersion();
-      size_of_vp8_image_data = fin.read(vp8_buffer, size_of_vp8_image_data).gcount();
+      // an in-memory stream (an HTTP response, say) is decoded in place;
+      // anything else is read into a temporary buffer first
+      osgEarth::Util::ByteBufferStream *memory = dynamic_cast<osgEarth::Util::ByteBufferStream *>(&fin);
+      if (memory)
+      {
+        vp8_data = memory->current();
+        size_of_vp8_image_data = memory->remaining();
+      }
+      else
+      {
+        size_of_vp8_image_data = stream_size;
+        vp8_buffer = new char[stream_size];
+        size_of_vp8_image_data = fin.read(vp8_buffer, size_of_vp8_image_data).gcount();
+        vp8_data = vp8_buffer;
+      }
 
       WebPDecoderConfig config;
       WebPInitDecoderConfig(&config);
-      int status = WebPGetFeatures((const uint8_t *)vp8_buffer, (uint32_t)size_of_vp8_image_data, &config.input);
+      int status = WebPGetFeatures((const uint8_t *)vp8_data, (uint32_t)size_of_vp8_image_data, &config.input);
       if (status == VP8_STATUS_OK)
       {
 
@@ -147,7 +160,7 @@ public:
 
         config.output.is_external_memory = 1;
 
-        status = WebPDecode((const uint8_t *)vp8_buffer, (uint32_t)size_of_vp8_image_data, &config);
+        status = WebPDecode((const uint8_t *)vp8_data, (uint32_t)size_of_vp8_image_data, &config);
       }
       delete[] vp8_buffer;
     }
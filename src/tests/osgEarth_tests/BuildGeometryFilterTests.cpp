@@ -0,0 +1,98 @@
+/* -*-c++-*- */
+/* osgEarth - Dynamic map generation toolkit for OpenSceneGraph
+* Copyright 2018 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <osgEarth/catch.hpp>
+
+#include <osgEarth/BuildGeometryFilter>
+#include <osgEarth/FilterContext>
+#include <osgEarth/PolygonSymbol>
+#include <osgEarth/Feature>
+#include <osg/Geometry>
+#include <osg/NodeVisitor>
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+namespace
+{
+    struct CountGeometry : public osg::NodeVisitor
+    {
+        unsigned drawables, verts, indices;
+        CountGeometry() : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN), drawables(0), verts(0), indices(0) { }
+        void apply(osg::Drawable& drawable)
+        {
+            osg::Geometry* geom = drawable.asGeometry();
+            if (geom && geom->getVertexArray())
+            {
+                ++drawables;
+                verts += geom->getVertexArray()->getNumElements();
+                REQUIRE(geom->getNormalArray() != 0L);
+                REQUIRE(geom->getColorArray()->getNumElements() == geom->getVertexArray()->getNumElements());
+                for (unsigned i = 0; i < geom->getNumPrimitiveSets(); ++i)
+                    indices += geom->getPrimitiveSet(i)->getNumIndices();
+            }
+        }
+    };
+
+    osg::ref_ptr<osg::Node> buildSquares(bool arenas, unsigned threads)
+    {
+        FeatureList features;
+        for (unsigned i = 0; i < 200; ++i)
+        {
+            double x = (double)(i % 20) * 20.0, y = (double)(i / 20) * 20.0;
+            Polygon* poly = new Polygon();
+            poly->push_back(osg::Vec3d(x, y, 0));
+            poly->push_back(osg::Vec3d(x + 10, y, 0));
+            poly->push_back(osg::Vec3d(x + 10, y + 10, 0));
+            poly->push_back(osg::Vec3d(x, y + 10, 0));
+            features.push_back(new Feature(poly, 0L, Style(), i));
+        }
+
+        Style style;
+        style.getOrCreate<PolygonSymbol>()->fill()->color() = Color::Red;
+        BuildGeometryFilter filter(style);
+        filter.arenaAllocation() = arenas;
+        filter.setNumThreads(threads);
+
+        FilterContext cx;
+        return filter.push(features, cx);
+    }
+}
+
+TEST_CASE("BuildGeometryFilter arena mode matches per-part output")
+{
+    CountGeometry perPart, serial, threaded;
+    buildSquares(false, 0)->accept(perPart);
+    buildSquares(true, 0)->accept(serial);
+    buildSquares(true, 4)->accept(threaded);
+
+    REQUIRE(perPart.verts == 800);
+    REQUIRE(perPart.indices == 1200);
+
+    REQUIRE(serial.drawables == 1);
+    REQUIRE(serial.verts == perPart.verts);
+    REQUIRE(serial.indices == perPart.indices);
+
+    REQUIRE(threaded.drawables == 1);
+    REQUIRE(threaded.verts == perPart.verts);
+    REQUIRE(threaded.indices == perPart.indices);
+}
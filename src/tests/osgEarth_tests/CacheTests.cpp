@@ -24,6 +24,7 @@
 #include <osgEarth/GeoData>
 #include <osgEarth/Registry>
 #include <osgEarth/MemCache>
+#include <osgEarth/ByteBuffer>
 
 using namespace osgEarth;
 
@@ -83,3 +84,45 @@ TEST_CASE( "Cache" ) {
         REQUIRE(r2.failed());
     }  
 }
+
+TEST_CASE( "ByteBuffer" ) {
+
+    SECTION("Pooled storage is reused")
+    {
+        osg::ref_ptr<Util::ByteBuffer> buffer = Util::ByteBuffer::create(1000);
+        REQUIRE(buffer->capacity() >= 1000u);
+        buffer->append("abc", 3);
+        buffer = 0L;
+
+        // the storage just released comes back, emptied
+        buffer = Util::ByteBuffer::create();
+        REQUIRE(buffer->empty());
+        REQUIRE(buffer->capacity() >= 1000u);
+    }
+
+    SECTION("Stream reads the buffer in place")
+    {
+        osg::ref_ptr<Util::ByteBuffer> buffer = Util::ByteBuffer::create();
+        buffer->append("hello world", 11);
+
+        Util::ByteBufferStream in(buffer.get());
+        REQUIRE(in.current() == buffer->data());
+        REQUIRE(in.remaining() == 11u);
+
+        std::string word;
+        in >> word;
+        REQUIRE(word == "hello");
+
+        in.seekg(0, std::ios::end);
+        REQUIRE((int)in.tellg() == 11);
+        in.seekg(6, std::ios::beg);
+        REQUIRE(in.current() == buffer->data() + 6);
+        in >> word;
+        REQUIRE(word == "world");
+
+        // bytes appended later are visible after a rewind
+        buffer->append("!", 1);
+        in.rewind();
+        REQUIRE(in.remaining() == 12u);
+    }
+}
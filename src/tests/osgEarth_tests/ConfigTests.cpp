@@ -0,0 +1,92 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+* Copyright 2020 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <osgEarth/catch.hpp>
+#include <osgEarth/Config>
+#include <sstream>
+
+using namespace osgEarth;
+
+TEST_CASE( "Config binary encoding" ) {
+
+    Config map("map");
+    map.set("name", "test map");
+    map.set("version", 2);
+
+    Config layer("image");
+    layer.set("name", "layer 1");
+    layer.set("url", "world.tif");
+    map.add(layer);
+    layer.set("name", "layer 2");
+    map.add(layer);
+
+    std::stringstream buf;
+    REQUIRE(map.toBinary(buf));
+
+    std::string data = buf.str();
+    REQUIRE(Config::isBinary(data.data(), data.size()));
+
+    SECTION("Round trip")
+    {
+        Config out;
+        REQUIRE(out.fromBinary(data.data(), data.size()));
+        REQUIRE(out.key() == "map");
+        REQUIRE(out.value("name") == "test map");
+        REQUIRE(out.value<int>("version", 0) == 2);
+        REQUIRE(out.isNumber() == false);
+        REQUIRE(out.children("image").size() == 2);
+        REQUIRE(out.children("image").back().value("name") == "layer 2");
+        REQUIRE(out.toJSON() == map.toJSON());
+    }
+
+    SECTION("Truncated data is rejected")
+    {
+        Config out;
+        REQUIRE(out.fromBinary(data.data(), data.size()-1) == false);
+        REQUIRE(out.empty());
+    }
+
+    SECTION("Included referrers move with the document")
+    {
+        Config doc("map");
+        doc.setReferrer("/data/maps/world.earth");
+        Config included("image");
+        included.setReferrer("/data/maps/layers/base.xml");
+        doc.add(included);
+
+        std::stringstream docBuf;
+        REQUIRE(doc.toBinary(docBuf));
+        std::string docData = docBuf.str();
+        REQUIRE(docData.find("/data/maps") == std::string::npos);
+
+        Config out;
+        REQUIRE(out.fromBinary(docData.data(), docData.size(), "/moved/world.earth"));
+        REQUIRE(out.referrer() == "/moved/world.earth");
+        REQUIRE(out.child("image").referrer() == "/moved/layers/base.xml");
+    }
+
+    SECTION("XML is not mistaken for binary")
+    {
+        std::string xml = "<map name=\"test\"/>";
+        REQUIRE(Config::isBinary(xml.data(), xml.size()) == false);
+    }
+}
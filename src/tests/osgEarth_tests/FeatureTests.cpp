@@ -24,8 +24,12 @@
 
 #include <osgEarth/Feature>
 #include <osgEarth/GeometryUtils>
+#include <osgEarth/GeoJSONReader>
+#include <osgEarth/FeatureTileCache>
+#include <sstream>
 
 using namespace osgEarth;
+using namespace osgEarth::Util;
 
 TEST_CASE("Feature::splitAcrossDateLine doesn't modify features that don't cross the dateline") {
     osg::ref_ptr< Feature > feature = new Feature(GeometryUtils::geometryFromWKT("POLYGON((-81 26, -40.5 45, -40.5 75.5, -81 60))"), osgEarth::SpatialReference::create("wgs84"));
@@ -109,3 +113,151 @@ TEST_CASE("Feature handles attributes correctly.") {
         REQUIRE(feature->getBool("bool") == false);
     }
 }
+
+TEST_CASE("GeoJSONReader streams features") {
+    const std::string json =
+        "{\"type\":\"FeatureCollection\",\"features\":["
+        "{\"type\":\"Feature\",\"id\":7,\"properties\":{\"Name\":\"a\",\"count\":3,\"tags\":[1,2]},"
+        " \"geometry\":{\"coordinates\":[1.0,2.0],\"type\":\"Point\"}},"
+        "{\"type\":\"Feature\",\"geometry\":{\"type\":\"Polygon\",\"coordinates\":"
+        " [[[10,10],[20,10],[20,20],[10,20],[10,10]],[[12,12],[12,14],[14,14],[12,12]]]},"
+        " \"properties\":{\"name\":\"b\",\"value\":null}}"
+        "]}";
+
+    SECTION("All features") {
+        GeoJSONReader reader;
+        FeatureList features;
+        REQUIRE(reader.read(json, features));
+        REQUIRE(features.size() == 2);
+
+        Feature* point = features.front().get();
+        REQUIRE(point->getFID() == 7);
+        REQUIRE(point->getString("name") == "a");
+        REQUIRE(point->getInt("count") == 3);
+        REQUIRE(point->getString("tags") == "[1,2]");
+        REQUIRE(point->getGeometry()->getType() == Geometry::TYPE_POINT);
+
+        Polygon* poly = dynamic_cast<Polygon*>(features.back()->getGeometry());
+        REQUIRE(poly != 0L);
+        REQUIRE(poly->size() == 4);
+        REQUIRE(poly->getHoles().size() == 1);
+        REQUIRE(features.back()->getFID() == 1);
+    }
+
+    SECTION("Bounds filter") {
+        GeoJSONReader reader;
+        reader.setBounds(Bounds(15, 15, 30, 30));
+        FeatureList features;
+        REQUIRE(reader.read(json, features));
+        REQUIRE(features.size() == 1);
+        REQUIRE(features.front()->getString("name") == "b");
+        REQUIRE(reader.getNumFeaturesSkipped() == 1);
+    }
+
+    SECTION("Columnar batches") {
+        GeoJSONReader reader;
+        std::istringstream in(json);
+        unsigned rows = 0;
+        REQUIRE(reader.readBatches(in, [&](GeoJSONReader::FeatureBatch& batch) {
+            rows += batch.size();
+            int col = batch.getColumnIndex("count");
+            REQUIRE(col >= 0);
+            REQUIRE(batch.values[col].size() == batch.size());
+            REQUIRE(batch.values[col][1].second.set == false);
+            return true;
+        }));
+        REQUIRE(rows == 2);
+    }
+
+    SECTION("Parse error") {
+        GeoJSONReader reader;
+        FeatureList features;
+        REQUIRE(reader.read(std::string("{\"type\":\"FeatureCollection\",\"features\":[{"), features) == false);
+        REQUIRE(reader.hasError());
+    }
+}
+
+TEST_CASE("Feature::evalBatch matches Feature::eval") {
+    FeatureList features;
+    for (int i = 0; i < 1000; ++i)
+    {
+        Feature* f = new Feature(new Point(), 0L);
+        f->set("height", (double)i * 0.5);
+        if (i % 3 != 0)
+            f->set("Levels", i % 7);
+        features.push_back(f);
+    }
+
+    NumericExpression expr("max([height], [levels] * 3.5) + 2 - [missing] % 4");
+
+    std::vector<double> batch;
+    REQUIRE(Feature::evalBatch(expr, features, batch));
+    REQUIRE(batch.size() == features.size());
+
+    unsigned i = 0;
+    for (FeatureList::iterator f = features.begin(); f != features.end(); ++f, ++i)
+    {
+        double single = f->get()->eval(expr, (Session*)0L);
+        REQUIRE(batch[i] == Approx(single));
+    }
+
+    // script calls cannot be compiled
+    NumericExpression script("myfunc([height])");
+    REQUIRE(Feature::evalBatch(script, features, batch) == false);
+}
+
+TEST_CASE("FeatureTileCache encodes features and bounds memory") {
+    FeatureList features;
+    Feature* f = new Feature(GeometryUtils::geometryFromWKT("POLYGON((0 0, 10 0, 10 10, 0 10),(2 2, 4 2, 4 4))"), 0L, Style(), 42);
+    f->set("name", std::string("building"));
+    f->set("height", 12.5);
+    f->set("floors", 3);
+    f->set("occupied", true);
+    f->setNull("owner", ATTRTYPE_STRING);
+    features.push_back(f);
+    features.push_back(new Feature(GeometryUtils::geometryFromWKT("MULTILINESTRING((0 0, 1 1),(2 2, 3 3, 4 4))"), 0L, Style(), 43));
+
+    std::string buffer;
+    REQUIRE(FeatureTileCache::encode(features, buffer));
+
+    FeatureList decoded;
+    REQUIRE(FeatureTileCache::decode(buffer, 0L, optional<GeoInterpolation>(), decoded));
+    REQUIRE(decoded.size() == 2);
+
+    const Feature* d = decoded.front().get();
+    REQUIRE(d->getFID() == 42);
+    REQUIRE(d->getString("name") == "building");
+    REQUIRE(d->getDouble("height") == 12.5);
+    REQUIRE(d->getInt("floors") == 3);
+    REQUIRE(d->getBool("occupied") == true);
+    REQUIRE(d->hasAttr("owner"));
+    REQUIRE(d->isSet("owner") == false);
+    REQUIRE(d->getGeometry()->getType() == Geometry::TYPE_POLYGON);
+    REQUIRE(d->getGeometry()->size() == f->getGeometry()->size());
+    REQUIRE(static_cast<const Polygon*>(d->getGeometry())->getHoles().size() == 1);
+    REQUIRE(decoded.back()->getGeometry()->getType() == Geometry::TYPE_MULTI);
+    REQUIRE(decoded.back()->getGeometry()->getTotalPointCount() == 5);
+
+    // corrupt input is rejected
+    FeatureList bad;
+    REQUIRE(FeatureTileCache::decode(buffer.substr(0, buffer.size() / 2), 0L, optional<GeoInterpolation>(), bad) == false);
+    REQUIRE(bad.empty());
+
+    // the LRU evicts the oldest tiles once over budget
+    size_t tileBytes = FeatureTileCache::getSizeInBytes(f) * 4;
+    osg::ref_ptr<FeatureTileCache> cache = new FeatureTileCache(tileBytes * 2);
+    for (int i = 0; i < 20; ++i)
+        cache->insert(Stringify() << "tile" << i, 1, features);
+
+    FeatureTileCache::Stats stats = cache->getStats();
+    REQUIRE(stats._bytes <= stats._maxBytes);
+    REQUIRE(stats._evictions > 0);
+
+    FeatureList hit;
+    REQUIRE(cache->get("tile19", hit));
+    REQUIRE(hit.size() == 2);
+    REQUIRE(cache->get("tile0", hit) == false);
+
+    cache->remove(1);
+    REQUIRE(cache->getStats()._entries == 0);
+}
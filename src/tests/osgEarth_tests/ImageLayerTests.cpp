@@ -25,6 +25,12 @@
 #include <osgEarth/ImageLayer>
 #include <osgEarth/Registry>
 #include <osgEarth/GDAL>
+#include <osgEarth/ImagePool>
+#include <osgEarth/ImageUtils>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 using namespace osgEarth;
 
@@ -67,4 +73,98 @@ TEST_CASE("Attribution works")
 
     REQUIRE(status.isOK());
     REQUIRE(layer->getAttribution() == attribution);
-}
\ No newline at end of file
+}
+
+TEST_CASE("GDALImageLayer reads concurrently from many threads")
+{
+    osg::ref_ptr<GDALImageLayer> layer = new GDALImageLayer();
+    layer->setURL("../data/world.tif");
+    REQUIRE(layer->open().isOK());
+
+    // every key on level 2, read once serially as the reference
+    std::vector<TileKey> keys;
+    unsigned cols, rows;
+    layer->getProfile()->getNumTiles(2, cols, rows);
+    for (unsigned y = 0; y < rows; ++y)
+        for (unsigned x = 0; x < cols; ++x)
+            keys.push_back(TileKey(2, x, y, layer->getProfile()));
+
+    std::vector< osg::ref_ptr<const osg::Image> > expected;
+    for (unsigned i = 0; i < keys.size(); ++i)
+    {
+        GeoImage image = layer->createImage(keys[i]);
+        REQUIRE(image.valid());
+        expected.push_back(image.getImage());
+    }
+
+    // 32 threads each read every key several times, in different orders
+    const unsigned numThreads = 32u;
+    const unsigned passes = 4u;
+    std::atomic<unsigned> failures(0u);
+    std::atomic<unsigned> reads(0u);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            for (unsigned p = 0; p < passes; ++p)
+            {
+                for (unsigned j = 0; j < keys.size(); ++j)
+                {
+                    unsigned i = (j + t * 7u + p) % keys.size();
+                    GeoImage image = layer->createImage(keys[i]);
+                    const osg::Image* a = image.getImage();
+                    const osg::Image* b = expected[i].get();
+                    if (!a || a->getTotalSizeInBytes() != b->getTotalSizeInBytes() ||
+                        memcmp(a->data(), b->data(), b->getTotalSizeInBytes()) != 0)
+                    {
+                        ++failures;
+                    }
+                    ++reads;
+                }
+            }
+        }));
+    }
+
+    for (unsigned t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    REQUIRE(reads == numThreads * passes * keys.size());
+    REQUIRE(failures == 0u);
+
+    layer->close();
+}
+
+TEST_CASE( "PooledImage reuses pixel buffers" )
+{
+    Util::ImagePool& pool = Util::ImagePool::instance();
+    pool.trim();
+    Util::ImagePool::Stats before = pool.getStats();
+
+    osg::ref_ptr<Util::PooledImage> image = new Util::PooledImage();
+    image->allocateImage(256, 256, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+    REQUIRE(image->data() != 0L);
+    unsigned char* buffer = image->data();
+
+    // same size again keeps the buffer
+    image->allocateImage(256, 256, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+    REQUIRE(image->data() == buffer);
+
+    // a released buffer goes to the next image that needs one
+    image = 0L;
+    image = new Util::PooledImage();
+    image->allocateImage(256, 256, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+    REQUIRE(image->data() == buffer);
+
+    // clones are plain images with their own data
+    osg::ref_ptr<osg::Image> clone = ImageUtils::cloneImage(image.get());
+    REQUIRE(clone->data() != buffer);
+
+    Util::ImagePool::Stats after = pool.getStats();
+    REQUIRE(after.allocations - before.allocations == 2u);
+    REQUIRE(after.threadHits - before.threadHits == 1u);
+
+    image = 0L;
+    REQUIRE(pool.getStats().bytesInUse == before.bytesInUse);
+}
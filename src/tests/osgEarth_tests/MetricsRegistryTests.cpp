@@ -0,0 +1,71 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+* Copyright 2018 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <osgEarth/catch.hpp>
+#include <osgEarth/MetricsRegistry>
+#include <thread>
+#include <vector>
+
+using namespace osgEarth;
+
+TEST_CASE("MetricsRegistry aggregates and exports metrics") {
+    using namespace osgEarth::Util;
+    MetricsRegistry& registry = MetricsRegistry::instance();
+
+    MetricsRegistry::Labels labels;
+    labels["layer"] = "test";
+
+    // same name and labels, same counter
+    MetricsRegistry::Counter* counter = registry.counter("oe_test_events_total", "Test events", labels);
+    REQUIRE(registry.counter("oe_test_events_total", "Test events", labels) == counter);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; ++t)
+    {
+        threads.push_back(std::thread([counter]() {
+            for (unsigned i = 0; i < 10000; ++i)
+                counter->increment();
+        }));
+    }
+    for (unsigned t = 0; t < threads.size(); ++t)
+        threads[t].join();
+    REQUIRE(counter->value() == 40000u);
+
+    MetricsRegistry::Histogram* histogram = registry.histogram("oe_test_latency_seconds", "Test latency");
+    for (unsigned i = 1; i <= 1000; ++i)
+        histogram->record(0.001 * i);
+    REQUIRE(histogram->getCount() == 1000u);
+    REQUIRE(histogram->getQuantile(0.5) == Approx(0.5).epsilon(0.05));
+    REQUIRE(histogram->getQuantile(0.99) == Approx(0.99).epsilon(0.05));
+    REQUIRE(histogram->getMax() == Approx(1.0));
+
+    MetricsRegistry::Snapshot snapshot = registry.snapshot();
+    const MetricsRegistry::Sample* sample = snapshot.find("oe_test_events_total", labels);
+    REQUIRE(sample != nullptr);
+    REQUIRE(sample->value == 40000.0);
+
+    std::string text = snapshot.toPrometheus();
+    REQUIRE(text.find("# TYPE oe_test_events_total counter") != std::string::npos);
+    REQUIRE(text.find("oe_test_events_total{layer=\"test\"} 40000") != std::string::npos);
+    REQUIRE(text.find("oe_test_latency_seconds_count 1000") != std::string::npos);
+    REQUIRE(snapshot.toJSON().find("\"name\":\"oe_test_latency_seconds\"") != std::string::npos);
+}
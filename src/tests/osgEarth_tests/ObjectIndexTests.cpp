@@ -0,0 +1,125 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+* Copyright 2018 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <osgEarth/catch.hpp>
+#include <osgEarth/ObjectIndex>
+#include <thread>
+#include <atomic>
+#include <set>
+#include <vector>
+
+using namespace osgEarth;
+
+TEST_CASE("ObjectIndex handles concurrent inserts, removes and lookups") {
+    osg::ref_ptr<ObjectIndex> index = new ObjectIndex();
+
+    // generations: a removed ID never resolves to the object that reuses its slot
+    osg::ref_ptr<osg::Referenced> a = new osg::Referenced();
+    osg::ref_ptr<osg::Referenced> b = new osg::Referenced();
+    ObjectID idA = index->insert(a.get());
+    REQUIRE(index->get<osg::Referenced>(idA) == a);
+    index->remove(idA);
+    ObjectID idB = index->insert(b.get());
+    REQUIRE(idB != idA);
+    REQUIRE(index->get<osg::Referenced>(idA).valid() == false);
+    REQUIRE(index->get<osg::Referenced>(idB) == b);
+
+    // objects are observed, not owned
+    {
+        osg::ref_ptr<osg::Referenced> temp = new osg::Referenced();
+        ObjectID idTemp = index->insert(temp.get());
+        temp = 0L;
+        REQUIRE(index->get<osg::Referenced>(idTemp).valid() == false);
+        index->remove(idTemp);
+    }
+    index->remove(idB);
+    REQUIRE(index->size() == 0);
+
+    // a slot is retired rather than wrapping its generation, so reusing
+    // one object many times never hands out the same ID twice
+    {
+        std::set<ObjectID> issued;
+        for (unsigned i = 0; i < 600; ++i)
+        {
+            ObjectID id = index->insert(a.get());
+            REQUIRE(id != OSGEARTH_OBJECTID_EMPTY);
+            REQUIRE(id != OSGEARTH_OBJECTID_TERRAIN);
+            REQUIRE(issued.insert(id).second);
+            index->remove(id);
+            REQUIRE(index->get<osg::Referenced>(id).valid() == false);
+        }
+        REQUIRE(index->size() == 0);
+    }
+
+    // batches of "tiles" inserted and removed on several threads while others read
+    const unsigned numWriters = 4, numTiles = 50, tileSize = 500;
+    std::vector<osg::ref_ptr<osg::Referenced> > objects;
+    std::vector<osg::Referenced*> raw;
+    for (unsigned i = 0; i < tileSize; ++i)
+    {
+        objects.push_back(new osg::Referenced());
+        raw.push_back(objects.back().get());
+    }
+
+    std::atomic<bool> done(false);
+    std::atomic<unsigned> errors(0);
+    std::vector<std::thread> writers, readers;
+
+    for (unsigned w = 0; w < numWriters; ++w)
+    {
+        writers.push_back(std::thread([&]() {
+            for (unsigned t = 0; t < numTiles; ++t)
+            {
+                std::vector<ObjectID> ids;
+                index->insert(raw, ids);
+                for (unsigned i = 0; i < ids.size(); ++i)
+                    if (index->get<osg::Referenced>(ids[i]).get() != raw[i])
+                        ++errors;
+                index->remove(ids.begin(), ids.end());
+                for (unsigned i = 0; i < ids.size(); ++i)
+                    if (index->get<osg::Referenced>(ids[i]).valid())
+                        ++errors;
+            }
+        }));
+    }
+
+    for (unsigned r = 0; r < 2; ++r)
+    {
+        readers.push_back(std::thread([&]() {
+            ObjectID id = 10;
+            while (!done)
+            {
+                osg::ref_ptr<osg::Referenced> object = index->get<osg::Referenced>(id);
+                id = (id * 2654435761u) ^ (id >> 7);
+            }
+        }));
+    }
+
+    for (unsigned i = 0; i < writers.size(); ++i)
+        writers[i].join();
+    done = true;
+    for (unsigned i = 0; i < readers.size(); ++i)
+        readers[i].join();
+
+    REQUIRE(errors == 0);
+    REQUIRE(index->size() == 0);
+}
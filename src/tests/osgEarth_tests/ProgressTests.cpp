@@ -0,0 +1,61 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+* Copyright 2018 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <osgEarth/catch.hpp>
+#include <osgEarth/Progress>
+#include <osgEarth/MetricsRegistry>
+#include <thread>
+#include <atomic>
+
+using namespace osgEarth;
+
+TEST_CASE("ProgressCallback cancelation is visible across threads and timed") {
+    using namespace osgEarth::Util;
+    osg::ref_ptr<osgEarth::ProgressCallback> progress = new osgEarth::ProgressCallback();
+    REQUIRE(progress->isCanceled() == false);
+    REQUIRE(progress->getTimeSinceCanceled() == 0.0);
+
+    // a worker polls the callback the way an I/O loop would
+    std::atomic<bool> stopped(false);
+    std::thread worker([&progress, &stopped]() {
+        while (!progress->isCanceled())
+            std::this_thread::yield();
+        progress->recordCancelation("test");
+        stopped = true;
+    });
+
+    progress->cancel();
+    worker.join();
+    REQUIRE(stopped == true);
+    REQUIRE(progress->getTimeSinceCanceled() >= 0.0);
+
+    MetricsRegistry::Labels labels;
+    labels["stage"] = "test";
+    MetricsRegistry::Snapshot snapshot = MetricsRegistry::instance().snapshot();
+    const MetricsRegistry::Sample* sample = snapshot.find("oe_cancel_latency_seconds", labels);
+    REQUIRE(sample != nullptr);
+    REQUIRE(sample->count >= 1u);
+
+    progress->reset();
+    REQUIRE(progress->isCanceled() == false);
+    REQUIRE(progress->getTimeSinceCanceled() == 0.0);
+}
@@ -23,6 +23,8 @@
 #include <osgEarth/catch.hpp>
 
 #include <osgEarth/SpatialReference>
+#include <osgEarth/VerticalDatum>
+#include <osgEarth/GeoData>
 
 using namespace osgEarth;
 
@@ -197,4 +199,48 @@ TEST_CASE("getGeocentricSRS") {
 
     REQUIRE(ecef->transform(np_ecef, wgs84, temp));
     REQUIRE(vec_eq(temp, np_wgs84));
-}
\ No newline at end of file
+}
+
+TEST_CASE("Batch vertical datum conversions match the per-point ones") {
+    // a synthetic 1-degree geoid
+    osg::HeightField* hf = new osg::HeightField();
+    hf->allocate(361, 181);
+    hf->setOrigin(osg::Vec3(-180.0f, -90.0f, 0.0f));
+    hf->setXInterval(1.0f);
+    hf->setYInterval(1.0f);
+    for (unsigned r = 0; r < 181; ++r)
+        for (unsigned c = 0; c < 361; ++c)
+            hf->setHeight(c, r, 50.0f * sinf(0.1f * (float)c) * cosf(0.07f * (float)r));
+
+    osg::ref_ptr<Geoid> geoid = new Geoid();
+    geoid->setHeightField(hf);
+    geoid->setName("test");
+    osg::ref_ptr<VerticalDatum> vdatum = new VerticalDatum("test", "test", geoid.get());
+
+    std::vector<osg::Vec3d> points;
+    for (unsigned i = 0; i < 100; ++i)
+        points.push_back(osg::Vec3d(-179.5 + 3.59 * (double)i, -89.0 + 1.78 * (double)i, 100.0 + (double)i));
+
+    std::vector<osg::Vec3d> batch(points);
+    REQUIRE(VerticalDatum::transform(vdatum.get(), nullptr, batch));
+    for (unsigned i = 0; i < points.size(); ++i)
+    {
+        double z = points[i].z();
+        REQUIRE(VerticalDatum::transform(vdatum.get(), nullptr, points[i].y(), points[i].x(), z));
+        REQUIRE(batch[i].z() == Approx(z).margin(1e-3));
+    }
+
+    // whole heightfields, against the geoid at each post
+    const SpatialReference* wgs84 = SpatialReference::get("wgs84");
+    GeoExtent extent(wgs84, 10.0, 20.0, 11.0, 21.0);
+    osg::ref_ptr<osg::HeightField> tile = new osg::HeightField();
+    tile->allocate(17, 17);
+    for (unsigned i = 0; i < 17 * 17; ++i)
+        tile->getFloatArray()->at(i) = 10.0f;
+    tile->setHeight(3, 3, NO_DATA_VALUE);
+
+    REQUIRE(VerticalDatum::transform(nullptr, vdatum.get(), extent, tile.get()));
+    REQUIRE(tile->getHeight(3, 3) == NO_DATA_VALUE);
+    REQUIRE(tile->getHeight(16, 8) == Approx(10.0 - geoid->getHeight(20.5, 11.0)).margin(1e-3));
+    REQUIRE(tile->getHeight(0, 0) == Approx(10.0 - geoid->getHeight(20.0, 10.0)).margin(1e-3));
+}
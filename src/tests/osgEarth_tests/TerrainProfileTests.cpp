@@ -0,0 +1,103 @@
+/* -*-c++-*- */
+/* osgEarth - Dynamic map generation toolkit for OpenSceneGraph
+* Copyright 2018 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <osgEarth/catch.hpp>
+
+#include <osgEarth/TerrainProfile>
+#include <osgEarth/ElevationLayer>
+#include <osgEarth/Elevation>
+#include <osgEarth/Map>
+#include <algorithm>
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+namespace
+{
+    // Elevation layer whose heights are the level of detail of each tile
+    class LODElevationLayer : public ElevationLayer
+    {
+    public:
+        META_Layer(osgEarth, LODElevationLayer, ElevationLayer::Options, ElevationLayer, LODElevation);
+
+    protected:
+        void init() override
+        {
+            ElevationLayer::init();
+            setProfile(Profile::create("global-geodetic"));
+        }
+
+        Status openImplementation() override
+        {
+            Status parent = ElevationLayer::openImplementation();
+            if (parent.isError())
+                return parent;
+
+            dataExtents().push_back(DataExtent(getProfile()->getExtent(), 0u, 19u));
+            return Status::NoError;
+        }
+
+        GeoHeightField createHeightFieldImplementation(const TileKey& key, ProgressCallback*) const override
+        {
+            osg::ref_ptr<osg::HeightField> hf = new osg::HeightField();
+            hf->allocate(ELEVATION_TILE_SIZE, ELEVATION_TILE_SIZE);
+            std::fill(hf->getFloatArray()->begin(), hf->getFloatArray()->end(), (float)key.getLOD());
+            return GeoHeightField(hf.get(), key.getExtent());
+        }
+    };
+}
+
+TEST_CASE("TerrainProfileSampler samples at the level of detail of its resolution")
+{
+    osg::ref_ptr<Map> map = new Map();
+    osg::ref_ptr<LODElevationLayer> layer = new LODElevationLayer();
+    map->addLayer(layer.get());
+    REQUIRE(layer->isOpen());
+
+    TerrainProfileSampler sampler(map.get());
+    sampler.setResolution(Distance(2000.0, Units::METERS));
+    sampler.setNumThreads(2);
+
+    // the higher latitude path needs a coarser level for the same resolution
+    std::vector< std::vector<osg::Vec3d> > paths(2);
+    paths[0].push_back(osg::Vec3d(10.0, 40.0, 0.0));
+    paths[0].push_back(osg::Vec3d(10.5, 40.2, 0.0));
+    paths[1].push_back(osg::Vec3d(-20.0, 75.0, 0.0));
+    paths[1].push_back(osg::Vec3d(-19.0, 75.0, 0.0));
+
+    std::vector<TerrainProfileSampler::Result> results;
+    REQUIRE(sampler.sample(paths, map->getSRS(), results));
+    REQUIRE(results.size() == 2u);
+
+    for (unsigned p = 0; p < results.size(); ++p)
+    {
+        const TerrainProfileSampler::Result& result = results[p];
+        REQUIRE(result.points.size() > 2u);
+
+        for (unsigned i = 0; i < result.points.size(); ++i)
+        {
+            double res = sampler.getResolution().asDistance(map->getSRS()->getUnits(), result.points[i].y());
+            unsigned lod = map->getProfile()->getLevelOfDetailForHorizResolution(res, ELEVATION_TILE_SIZE);
+            REQUIRE(result.elevations[i] == (double)lod);
+        }
+    }
+}
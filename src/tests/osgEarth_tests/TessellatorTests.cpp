@@ -0,0 +1,65 @@
+/* -*-c++-*- */
+/* osgEarth - Dynamic map generation toolkit for OpenSceneGraph
+* Copyright 2018 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <osgEarth/catch.hpp>
+
+#include <osgEarth/Tessellator>
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+TEST_CASE("PolygonTriangulator handles holes")
+{
+    // A 10x10 square with a 2x2 hole, after one unrelated vertex.
+    osg::ref_ptr<osg::Vec3Array> verts = new osg::Vec3Array();
+    verts->push_back(osg::Vec3(100, 100, 0));
+    verts->push_back(osg::Vec3(0, 0, 0));
+    verts->push_back(osg::Vec3(10, 0, 0));
+    verts->push_back(osg::Vec3(10, 10, 0));
+    verts->push_back(osg::Vec3(0, 10, 0));
+    verts->push_back(osg::Vec3(4, 4, 0));
+    verts->push_back(osg::Vec3(4, 6, 0));
+    verts->push_back(osg::Vec3(6, 6, 0));
+    verts->push_back(osg::Vec3(6, 4, 0));
+
+    std::vector<unsigned> ringSizes;
+    ringSizes.push_back(4);
+    ringSizes.push_back(4);
+
+    PolygonTriangulator triangulator;
+    std::vector<GLuint> indices;
+    REQUIRE(triangulator.triangulate(*verts, 1, ringSizes, indices));
+    REQUIRE(indices.size() % 3 == 0);
+
+    double area = 0.0;
+    for (unsigned i = 0; i < indices.size(); i += 3)
+    {
+        REQUIRE(indices[i] > 0);
+        const osg::Vec3& a = (*verts)[indices[i]];
+        const osg::Vec3& b = (*verts)[indices[i+1]];
+        const osg::Vec3& c = (*verts)[indices[i+2]];
+        double cross = (b.x()-a.x())*(c.y()-a.y()) - (c.x()-a.x())*(b.y()-a.y());
+        REQUIRE(cross > 0.0);
+        area += 0.5 * cross;
+    }
+    REQUIRE(area == Approx(96.0));
+}
@@ -0,0 +1,66 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+* Copyright 2018 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <osgEarth/catch.hpp>
+
+#include <osgEarth/TexturePipeline>
+
+using namespace osgEarth;
+
+TEST_CASE("TexturePipeline compresses and mipmaps")
+{
+    osg::ref_ptr<osg::Image> image = new osg::Image();
+    image->allocateImage(64, 32, 1, GL_RGB, GL_UNSIGNED_BYTE);
+    image->setInternalTextureFormat(GL_RGB8);
+    for (int i = 0; i < 64 * 32; ++i)
+    {
+        image->data()[i*3+0] = 255;
+        image->data()[i*3+1] = 0;
+        image->data()[i*3+2] = 0;
+    }
+
+    Util::TexturePipeline pipeline;
+    REQUIRE(pipeline.setMethod("bc1:fast"));
+    REQUIRE_FALSE(pipeline.setMethod("bc2"));
+
+    SECTION("BC1 encodes solid color blocks exactly")
+    {
+        osg::ref_ptr<osg::Image> output = pipeline.process(image.get());
+        REQUIRE(output.valid());
+        REQUIRE(output->getPixelFormat() == GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+        REQUIRE(output->getNumMipmapLevels() == 7);
+
+        // pure red is 0xF800 in RGB565
+        const unsigned char* block = output->getMipmapData(3);
+        REQUIRE(block[0] == 0x00);
+        REQUIRE(block[1] == 0xF8);
+    }
+
+    SECTION("BC7 uses mode 6 blocks")
+    {
+        REQUIRE(pipeline.setMethod("bc7:kaiser"));
+        osg::ref_ptr<osg::Image> output = pipeline.process(image.get());
+        REQUIRE(output.valid());
+        REQUIRE(output->getPixelFormat() == GL_COMPRESSED_RGBA_BPTC_UNORM_ARB);
+        REQUIRE((output->data()[0] & 0x7f) == 0x40);
+    }
+}
@@ -23,6 +23,7 @@
 #include <osgEarth/catch.hpp>
 #include <osgEarth/Threading>
 #include <thread>
+#include <atomic>
 
 using namespace osgEarth;
 
@@ -133,4 +134,39 @@ TEST_CASE( "ReadWriteMutex can handle multiple read locks from the same thread w
     REQUIRE(!thread2.isRunning());
     REQUIRE(elapsedTime < maxTimeSeconds);
 }
-*/
\ No newline at end of file
+*/
+
+TEST_CASE("parallelFor runs every iteration once, including nested calls") {
+    const unsigned count = 1000u;
+    std::vector<std::atomic<unsigned> > hits(count);
+    for (auto& h : hits)
+        h = 0u;
+
+    Threading::parallelFor(count, [&](unsigned i) { ++hits[i]; });
+    unsigned total = 0u;
+    for (auto& h : hits)
+    {
+        REQUIRE(h == 1u);
+        total += h;
+    }
+    REQUIRE(total == count);
+
+    // nested calls from inside the pool must not deadlock
+    std::atomic<unsigned> inner(0u);
+    Threading::parallelFor(16u, [&](unsigned)
+    {
+        Threading::parallelFor(64u, [&](unsigned) { ++inner; });
+    });
+    REQUIRE(inner == 16u * 64u);
+
+    // maxThreads = 1 runs everything on the calling thread
+    std::thread::id caller = std::this_thread::get_id();
+    std::atomic<unsigned> others(0u);
+    Threading::parallelFor(100u, [&](unsigned)
+    {
+        if (std::this_thread::get_id() != caller)
+            ++others;
+    },
+    1u);
+    REQUIRE(others == 0u);
+}
@@ -0,0 +1,85 @@
+/* -*-c++-*- */
+/* osgEarth - Dynamic map generation toolkit for OpenSceneGraph
+* Copyright 2018 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <osgEarth/catch.hpp>
+
+#include <osgEarth/TileIndex>
+#include <osgEarth/FileUtils>
+#include <cstdio>
+#include <sstream>
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+TEST_CASE("Native TileIndex queries, repacks and reloads") {
+    const std::string filename = "osgEarth_tests_tileindex.oeidx";
+    osg::ref_ptr<Contrib::TileIndex> index = Contrib::TileIndex::create(filename, SpatialReference::get("wgs84"));
+    REQUIRE(index.valid());
+
+    // a 40x40 grid of 1-degree files, added one at a time so the
+    // pending list gets packed into the tree along the way
+    for (int y = 0; y < 40; ++y)
+    {
+        for (int x = 0; x < 40; ++x)
+        {
+            Contrib::TileIndex::Entry entry;
+            std::stringstream buf;
+            buf << "tile_" << x << "_" << y << ".tif";
+            entry.filename = buf.str();
+            entry.xMin = x + 0.05;
+            entry.xMax = x + 0.95;
+            entry.yMin = y + 0.05;
+            entry.yMax = y + 0.95;
+            entry.resolution = 0.001;
+            entry.hasNoData = (x == 3);
+            entry.noDataValue = -9999.0;
+            REQUIRE(index->add(entry));
+        }
+    }
+    REQUIRE(index->getNumEntries() == 1600u);
+
+    GeoExtent query(SpatialReference::get("wgs84"), 2.5, 10.5, 4.5, 11.5);
+    std::vector<Contrib::TileIndex::Entry> entries;
+    index->getEntries(query, entries);
+    REQUIRE(entries.size() == 6u);
+    // results come back in the order they were added
+    REQUIRE(entries[0].filename == getFullPath(filename, "tile_2_10.tif"));
+    REQUIRE(entries[5].filename == getFullPath(filename, "tile_4_11.tif"));
+    REQUIRE(entries[1].hasNoData);
+    REQUIRE(entries[1].noDataValue == -9999.0);
+
+    REQUIRE(index->save());
+    index = Contrib::TileIndex::load(filename);
+    REQUIRE(index.valid());
+    REQUIRE(index->getNumEntries() == 1600u);
+
+    std::vector<std::string> files;
+    index->getFiles(query, files);
+    REQUIRE(files.size() == 6u);
+    REQUIRE(files[0] == entries[0].filename);
+
+    index->getFiles(GeoExtent(SpatialReference::get("wgs84"), 100.0, 60.0, 110.0, 70.0), files);
+    REQUIRE(files.empty());
+
+    index = 0L;
+    ::remove(filename.c_str());
+}
@@ -0,0 +1,77 @@
+/* -*-c++-*- */
+/* osgEarth - Geospatial SDK for OpenSceneGraph
+* Copyright 2018 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <osgEarth/catch.hpp>
+#include <osgEarth/TileTracer>
+#include <osgEarth/TileKey>
+#include <osgEarth/Profile>
+#include <thread>
+#include <vector>
+
+using namespace osgEarth;
+
+TEST_CASE("TileTracer records tile events as a Chrome trace") {
+    using namespace osgEarth::Util;
+    TileTracer& tracer = TileTracer::instance();
+    bool wasEnabled = tracer.isEnabled();
+
+    osgEarth::TileKey key(5, 10, 12, osgEarth::Profile::create("global-geodetic"));
+
+    // nothing recorded while disabled
+    tracer.setEnabled(false);
+    tracer.clear();
+    tracer.record(TileTracer::QUEUED, key, "test");
+    REQUIRE(tracer.toChromeTrace().find("queued") == std::string::npos);
+
+    tracer.setEnabled(true);
+    tracer.record(TileTracer::QUEUED, key, "test");
+    {
+        TileTracer::Scope fetch(TileTracer::FETCH, key, "test");
+        TileTracer::Scope decode(TileTracer::DECODE);
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; ++t)
+    {
+        threads.push_back(std::thread([&tracer, &key]() {
+            for (unsigned i = 0; i < 1000; ++i)
+                tracer.record(TileTracer::CACHE_HIT, key, "test");
+        }));
+    }
+    for (unsigned t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    std::string trace = tracer.toChromeTrace();
+    REQUIRE(trace.find("\"traceEvents\"") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"queued 5/10/12\"") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"fetch 5/10/12\",\"cat\":\"tile\",\"ph\":\"X\"") != std::string::npos);
+    // the decode is attributed to the enclosing fetch's tile and layer
+    REQUIRE(trace.find("\"name\":\"decode 5/10/12\"") != std::string::npos);
+
+    unsigned hits = 0;
+    for (std::string::size_type p = trace.find("cache_hit"); p != std::string::npos; p = trace.find("cache_hit", p + 1))
+        ++hits;
+    REQUIRE(hits == 4000u);
+
+    tracer.clear();
+    tracer.setEnabled(wasEnabled);
+}
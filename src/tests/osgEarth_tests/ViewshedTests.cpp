@@ -0,0 +1,65 @@
+/* -*-c++-*- */
+/* osgEarth - Dynamic map generation toolkit for OpenSceneGraph
+* Copyright 2018 Pelican Mapping
+* http://osgearth.org
+*
+* osgEarth is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <osgEarth/catch.hpp>
+
+#include <osgEarth/Viewshed>
+#include <algorithm>
+#include <vector>
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+TEST_CASE("Viewshed sweeps a height grid")
+{
+    const unsigned size = 101;
+    std::vector<float> heights(size*size, 0.0f);
+
+    Viewshed viewshed;
+    viewshed.setCurvature(false);
+    viewshed.setNumThreads(4);
+
+    // Everything within the radius of a flat plane is visible.
+    REQUIRE(viewshed.run(heights, size, 10.0));
+    REQUIRE(viewshed.getVisibility()[55*size + 70] == Viewshed::VISIBLE);
+    REQUIRE(viewshed.getVisibility()[0] == Viewshed::OUT_OF_RANGE);
+    unsigned flat = viewshed.getNumVisible();
+
+    // A wall east of the observer hides the cells behind it, but not
+    // the ones in front of it.
+    for (unsigned r = 0; r < size; ++r)
+        heights[r*size + 60] = 50.0f;
+
+    REQUIRE(viewshed.run(heights, size, 10.0));
+    REQUIRE(viewshed.getVisibility()[50*size + 55] == Viewshed::VISIBLE);
+    REQUIRE(viewshed.getVisibility()[50*size + 60] == Viewshed::VISIBLE);
+    REQUIRE(viewshed.getVisibility()[50*size + 70] == Viewshed::HIDDEN);
+    REQUIRE(viewshed.getVisibility()[50*size + 30] == Viewshed::VISIBLE);
+    REQUIRE(viewshed.getNumVisible() < flat);
+
+    // Over a long enough distance the curvature of the earth hides a flat plane.
+    std::fill(heights.begin(), heights.end(), 0.0f);
+    viewshed.setCurvature(true);
+    REQUIRE(viewshed.run(heights, size, 200.0));
+    REQUIRE(viewshed.getVisibility()[50*size + 55] == Viewshed::VISIBLE);
+    REQUIRE(viewshed.getVisibility()[50*size + 99] == Viewshed::HIDDEN);
+}
@@ -40,6 +40,12 @@
 //  - v2.0.1 Add comparsion feature(Thanks to @Selmar).
 //  - v2.0.0 glTF 2.0!.
 //
+// osgEarth local patch (not upstream; re-apply when updating this file):
+//  - Options::alias_binary_buffer lets GLTFReader read the embedded GLB BIN
+//    chunk in place instead of copying it into Buffer::data. The changed
+//    lines are marked "osgEarth local patch"; the full change is in
+//    osgearth-alias-binary-buffer.patch next to this file.
+//
 // Tiny glTF loader is using following third party libraries:
 //
 //  - jsonhpp: C++ JSON library.
@@ -1171,6 +1177,13 @@ enum SectionCheck {
 
 struct Options {
     bool skip_imagery = false;
+
+    // osgEarth local patch:
+    // When loading binary glTF, leave Buffer::data empty for the embedded
+    // BIN chunk instead of copying it. The caller reads buffer views directly
+    // from the input bytes, which must outlive the Model. Ignored when the
+    // model uses KHR_draco_mesh_compression.
+    bool alias_binary_buffer = false;
 };
 
 ///
@@ -3837,7 +3850,8 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
                         FsCallbacks *fs, const std::string &basedir,
                         bool is_binary = false,
                         const unsigned char *bin_data = nullptr,
-                        size_t bin_size = 0) {
+                        size_t bin_size = 0,
+                        bool alias_bin_data = false) {  // osgEarth local patch
   size_t byteLength;
   if (!ParseUnsignedProperty(&byteLength, err, o, "byteLength", true,
                              "Buffer")) {
@@ -3908,9 +3922,11 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
         return false;
       }
 
-      // Read buffer data
-      buffer->data.resize(static_cast<size_t>(byteLength));
-      memcpy(&(buffer->data.at(0)), bin_data, static_cast<size_t>(byteLength));
+      // Read buffer data, unless the caller will alias it (osgEarth local patch)
+      if (!alias_bin_data) {
+        buffer->data.resize(static_cast<size_t>(byteLength));
+        memcpy(&(buffer->data.at(0)), bin_data, static_cast<size_t>(byteLength));
+      }
     }
 
   } else {
@@ -5448,6 +5464,13 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
     });
   }
 
+  // osgEarth local patch:
+  // Draco decoding reads Buffer::data, so it cannot be aliased.
+  bool alias_bin_data =
+      is_binary_ && options && options->alias_binary_buffer &&
+      std::find(model->extensionsUsed.begin(), model->extensionsUsed.end(),
+                "KHR_draco_mesh_compression") == model->extensionsUsed.end();
+
   // 3. Parse Buffer
   {
     bool success = ForEachInArray(v, "buffers", [&](const json &o) {
@@ -5460,7 +5483,8 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
       Buffer buffer;
       if (!ParseBuffer(&buffer, err, o,
                        store_original_json_for_extras_and_extensions_, &fs,
-                       base_dir, is_binary_, bin_data_, bin_size_)) {
+                       base_dir, is_binary_, bin_data_, bin_size_,
+                       alias_bin_data)) {  // osgEarth local patch
         return false;
       }
 
@@ -5749,9 +5773,13 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
           }
           return false;
         }
+        // osgEarth local patch: images in an aliased BIN chunk
+        const unsigned char *bufferData =
+            (alias_bin_data && buffer.uri.empty()) ? bin_data_
+                                                   : buffer.data.data();
         bool ret = LoadImageData(
             &image, idx, err, warn, image.width, image.height,
-            &buffer.data[bufferView.byteOffset],
+            bufferData + bufferView.byteOffset,
             static_cast<int>(bufferView.byteLength), load_image_user_data_);
         if (!ret) {
           return false;